@@ -43,6 +43,7 @@ struct jio_context_create_info_T
     const jio_allocator_callbacks*  allocator_callbacks;
     const jio_allocator_callbacks*  stack_allocator_callbacks;
     const jio_error_callbacks*      error_callbacks;
+    uint32_t                        thread_count;   //  Threads used by functions which can run in parallel (0 means 1)
 };
 
 typedef struct jio_memory_file_info_T jio_memory_file_info;
@@ -63,6 +64,9 @@ jio_result jio_memory_file_create(
 
 jio_result jio_memory_file_sync(const jio_memory_file* file, int sync);
 
+//  Maps the file again if it grew since it was mapped, which may move its contents to a different address
+jio_result jio_memory_file_remap(jio_memory_file* file);
+
 unsigned jio_memory_file_count_lines(const jio_memory_file* file);
 
 unsigned jio_memory_file_count_non_empty_lines(const jio_memory_file* file);
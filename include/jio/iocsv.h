@@ -19,18 +19,157 @@ struct jio_csv_column_T
 };
 typedef struct jio_csv_data_T jio_csv_data;
 
+typedef struct jio_csv_compact_cell_T jio_csv_compact_cell;
+struct jio_csv_compact_cell_T
+{
+    uint32_t offset;                //  Offset of the entry from the base of the column
+    uint32_t len;                   //  Length of the entry
+};
+
+typedef struct jio_csv_compact_column_T jio_csv_compact_column;
+struct jio_csv_compact_column_T
+{
+    jio_string_segment header;          //  Optional header
+    uint32_t count;                     //  How many cells there are
+    const char* base;                   //  Address which offsets of cells are relative to
+    const jio_csv_compact_cell* cells;  //  Cell array
+};
+
+static inline jio_string_segment jio_csv_compact_cell_segment(const jio_csv_compact_column* column, uint32_t index)
+{
+    const jio_string_segment segment = {.begin = column->base + column->cells[index].offset, .len = column->cells[index].len};
+    return segment;
+}
+
+typedef struct jio_csv_dictionary_T jio_csv_dictionary;
+struct jio_csv_dictionary_T
+{
+    jio_string_segment header;          //  Optional header
+    uint32_t value_count;               //  How many distinct values there are
+    jio_string_segment* values;         //  Distinct values, in order of their first appearance in the column
+    uint32_t count;                     //  How many codes there are
+    uint32_t code_size;                 //  Size of each code in bytes (1, 2 or 4)
+    void* codes;                        //  Index of the value of each cell
+};
+
+static inline uint32_t jio_csv_dictionary_code(const jio_csv_dictionary* dictionary, uint32_t index)
+{
+    switch (dictionary->code_size)
+    {
+    case 1:
+        return ((const uint8_t*)dictionary->codes)[index];
+    case 2:
+        return ((const uint16_t*)dictionary->codes)[index];
+    default:
+        return ((const uint32_t*)dictionary->codes)[index];
+    }
+}
+
+enum jio_csv_filter_type_enum
+{
+    JIO_CSV_FILTER_EQUALS,      //  Entry is equal to the value
+    JIO_CSV_FILTER_PREFIX,      //  Entry begins with the value
+    JIO_CSV_FILTER_RANGE,       //  Entry is a number on the interval [min, max]
+
+    JIO_CSV_FILTER_COUNT,
+};
+typedef enum jio_csv_filter_type_enum jio_csv_filter_type;
+
+typedef struct jio_csv_filter_T jio_csv_filter;
+struct jio_csv_filter_T
+{
+    jio_csv_filter_type type;           //  Check which is done on the entry
+    bool invert;                        //  Keep rows which fail the check instead
+    uint32_t column;                    //  Index of the column in the file (not in the selection)
+    jio_string_segment column_name;     //  Header of the column (used instead of the index if begin is not NULL)
+    jio_string_segment value;           //  Value used by JIO_CSV_FILTER_EQUALS and JIO_CSV_FILTER_PREFIX
+    double min;                         //  Lower bound used by JIO_CSV_FILTER_RANGE
+    double max;                         //  Upper bound used by JIO_CSV_FILTER_RANGE
+};
+
+typedef struct jio_csv_parse_info_T jio_csv_parse_info;
+struct jio_csv_parse_info_T
+{
+    const char* separator;                      //  Separator between entries in a row
+    bool trim_whitespace;                       //  Remove whitespace around entries
+    bool has_headers;                           //  First row holds the column headers
+    uint32_t selected_count;                    //  Number of columns to keep (0 keeps all of them)
+    const uint32_t* selected_indices;           //  Indices of columns to keep, in output order
+    const jio_string_segment* selected_names;   //  Headers of columns to keep, in output order (used instead of indices if not NULL)
+    uint32_t filter_count;                      //  Number of filters a row must pass to be kept
+    const jio_csv_filter* filters;              //  Filters a row must pass to be kept
+    //  Called with kept entries of each row that passed the filters, returns false if the row should not be kept
+    bool (* row_filter)(uint32_t column_count, const jio_string_segment* row, void* param);
+    void* row_filter_param;                     //  Parameter passed to row_filter
+    //  Only find where rows begin, so that each column is parsed the first time it is accessed. Accessing columns of
+    //  lazy data modifies it, so it must not be done from multiple threads at once. Editing lazy data parses all columns.
+    bool lazy;
+    //  Store entries as compact cells (offsets into the file and lengths), so that they use half the memory. Elements of
+    //  a column are created when it is first accessed with jio_csv_get_column. Only works for files smaller than 4 GiB.
+    bool compact;
+};
+
 jio_result jio_csv_column_index(const jio_csv_data* data, const jio_csv_column* column, uint32_t* p_idx);
 
 jio_result jio_parse_csv(
         const jio_context* ctx, const jio_memory_file* mem_file, const char* separator, bool trim_whitespace,
         bool has_headers, jio_csv_data** pp_csv);
 
+jio_result jio_parse_csv_ex(
+        const jio_context* ctx, const jio_memory_file* mem_file, const jio_csv_parse_info* info, jio_csv_data** pp_csv);
+
+//  Parses rows which were appended to the file since the data was parsed from it (or since the last call), remapping
+//  the file if it grew. Only lines which end with a new line are parsed, so a row which is still being written is held
+//  back until it is complete. If the file did not end with a new line when the data was parsed, its last row is parsed
+//  again once the line is complete. Only works for data parsed without filters, whose columns were not added or removed.
+jio_result jio_csv_parse_append(const jio_context* ctx, jio_csv_data* data, jio_memory_file* mem_file);
+
+//  Parses only the rows which begin on [begin_offset, end_offset) of the file, so that a file split into consecutive
+//  ranges can be parsed in parts, with each row parsed exactly once. Headers are always taken from the beginning of the
+//  file and are never parsed as a row.
+jio_result jio_parse_csv_range(
+        const jio_context* ctx, const jio_memory_file* mem_file, size_t begin_offset, size_t end_offset,
+        const jio_csv_parse_info* info, jio_csv_data** pp_csv);
+
+//  Parser which parses the file in steps, so that parsing can be interleaved with other work. The file and everything
+//  the parse info points to must remain valid until the parser is finished or destroyed. Lazy parsing is not supported.
+typedef struct jio_csv_parser_T jio_csv_parser;
+
+jio_result jio_csv_parser_create(
+        const jio_context* ctx, const jio_memory_file* mem_file, const jio_csv_parse_info* info,
+        jio_csv_parser** pp_parser);
+
+//  Parses rows until either byte_budget bytes or row_budget rows were parsed (0 means there is no limit), setting
+//  p_done to true once all rows were parsed. A row is only checked against the budget before it is parsed. After a
+//  step fails, the parser can only be destroyed.
+jio_result jio_csv_parser_step(jio_csv_parser* parser, size_t byte_budget, uint32_t row_budget, bool* p_done);
+
+//  Gives the offset in the file up to which rows were parsed and the number of rows that were kept
+void jio_csv_parser_progress(const jio_csv_parser* parser, size_t* p_offset, uint32_t* p_rows);
+
+//  Parses any rows that are left and gives the parsed data. The parser is destroyed even if this fails.
+jio_result jio_csv_parser_finish(jio_csv_parser* parser, jio_csv_data** pp_csv);
+
+void jio_csv_parser_destroy(jio_csv_parser* parser);
+
 jio_result jio_process_csv_exact(
         const jio_context* ctx, const jio_memory_file* mem_file, const char* separator, uint32_t column_count,
         const jio_string_segment* headers, bool (** converter_array)(jio_string_segment*, void*), void** param_array);
 
+//  Calls block_callback with up to block_rows rows at a time, given as an array of column_count columns, each holding
+//  row_count elements. Buffers are reused between calls. Returning false from the callback stops the processing.
+jio_result jio_process_csv_blocks(
+        const jio_context* ctx, const jio_memory_file* mem_file, const char* separator, bool trim_whitespace,
+        bool has_headers, uint32_t block_rows,
+        bool (* block_callback)(uint32_t column_count, uint32_t row_count, const jio_string_segment* headers, const jio_string_segment* const* columns, void* param),
+        void* param);
+
 jio_result jio_csv_get_column(const jio_csv_data* data, uint32_t index, const jio_csv_column** pp_column);
 
+jio_result jio_csv_get_compact_column(const jio_csv_data* data, uint32_t index, jio_csv_compact_column* p_column);
+
+void jio_csv_compact_expand(const jio_csv_compact_column* column, uint32_t begin, uint32_t count, jio_string_segment* out);
+
 jio_result jio_csv_get_column_by_name(
         const jio_context* ctx, const jio_csv_data* data, const char* name, const jio_csv_column** pp_column);
 
@@ -38,6 +177,147 @@ jio_result jio_csv_get_column_by_name_segment(
         const jio_context* ctx, const jio_csv_data* data, const jio_string_segment* name,
         const jio_csv_column** pp_column);
 
+typedef struct jio_csv_stats_T jio_csv_stats;
+struct jio_csv_stats_T
+{
+    uint32_t count;                 //  Number of elements
+    uint32_t max_length;            //  Length of the longest element
+    uint64_t total_length;          //  Total length of all elements
+};
+
+//  Stats are computed on first use and then kept up to date by functions which modify the data, so this should not be
+//  called on the same data from multiple threads at once before the first call returns. Snapshots made by
+//  jio_csv_snapshot_create already have their stats, so they can be called on from any number of threads.
+jio_result jio_csv_column_stats(const jio_csv_data* data, uint32_t index, jio_csv_stats* p_stats);
+
+//  Encodes a column as a table of its distinct values and a code for each cell, which uses the smallest integer type able
+//  to index the table. Values point to the same memory as elements of the column.
+jio_result jio_csv_column_dictionary_encode(
+        const jio_context* ctx, const jio_csv_data* data, uint32_t index, jio_csv_dictionary* p_dictionary);
+
+void jio_csv_dictionary_release(const jio_context* ctx, jio_csv_dictionary* dictionary);
+
+enum jio_csv_field_type_enum
+{
+    JIO_CSV_FIELD_INT32,                //  int32_t
+    JIO_CSV_FIELD_INT64,                //  int64_t
+    JIO_CSV_FIELD_UINT32,               //  uint32_t
+    JIO_CSV_FIELD_UINT64,               //  uint64_t
+    JIO_CSV_FIELD_FLOAT,                //  float
+    JIO_CSV_FIELD_DOUBLE,               //  double
+    JIO_CSV_FIELD_STRING,               //  jio_string_segment, which points to the same memory as the element
+};
+typedef enum jio_csv_field_type_enum jio_csv_field_type;
+
+typedef struct jio_csv_field_T jio_csv_field;
+struct jio_csv_field_T
+{
+    const char* name;                   //  Header of the column, or NULL if the column is given by its index
+    uint32_t index;                     //  Index of the column, used when name is NULL
+    jio_csv_field_type type;            //  Type of the struct member
+    size_t offset;                      //  Offset of the member in the struct
+    bool has_default;                   //  Are empty elements and missing columns given the default value
+    union
+    {
+        int64_t i64;                    //  Used by signed integer fields
+        uint64_t u64;                   //  Used by unsigned integer fields
+        double f64;                     //  Used by floating point fields
+        jio_string_segment str;         //  Used by string fields
+    } default_value;
+};
+
+//  Fills row_count structs, each stride bytes apart, with members decoded from rows [first_row, first_row + row_count)
+//  of the data. Blocks of rows are bound in parallel. If an element can not be decoded, the error reports the first such
+//  row and JIO_RESULT_BAD_VALUE is returned, with the contents of the structs unspecified.
+jio_result jio_csv_bind_rows(
+        const jio_context* ctx, const jio_csv_data* data, uint32_t field_count, const jio_csv_field* fields,
+        uint32_t first_row, uint32_t row_count, size_t stride, void* rows);
+
+typedef struct jio_csv_index_T jio_csv_index;
+
+//  Creates a hash index of the column, which maps contents of its elements to the rows they are in. Functions which
+//  modify the data keep the index up to date: rows appended to the end are added to it, while other changes to rows of
+//  the column cause it to be rebuilt on next lookup. Indices which are not destroyed are destroyed with the data.
+jio_result jio_csv_index_create(const jio_context* ctx, jio_csv_data* data, uint32_t column, jio_csv_index** pp_index);
+
+//  Finds the first row whose element is equal to the key, giving UINT32_MAX if there is none
+jio_result jio_csv_index_find(jio_csv_index* index, jio_string_segment key, uint32_t* p_row);
+
+//  Gives the next row with an element equal to that of the given row, or UINT32_MAX if there is none. The row must have
+//  been given by jio_csv_index_find or this function, with no changes to the data since.
+uint32_t jio_csv_index_next(const jio_csv_index* index, uint32_t row);
+
+void jio_csv_index_destroy(jio_csv_index* index);
+
+typedef struct jio_csv_join_T jio_csv_join;
+struct jio_csv_join_T
+{
+    uint32_t count;                     //  Number of pairs of rows
+    uint32_t* left_rows;                //  Row of the left data in each pair
+    uint32_t* right_rows;               //  Row of the right data in each pair
+};
+
+//  Finds all pairs of rows whose keys are equal, ordered by the left row first and the right row second. Right data is
+//  looked up through an index of its key column if it has one which is up to date, otherwise a temporary one is built.
+//  Neither data is modified, apart from key columns of lazy data being parsed, so joins can run on the same data from
+//  many threads at once.
+jio_result jio_csv_hash_join(
+        const jio_context* ctx, const jio_csv_data* left, uint32_t left_key, const jio_csv_data* right,
+        uint32_t right_key, jio_csv_join* p_join);
+
+void jio_csv_join_release(const jio_context* ctx, jio_csv_join* join);
+
+typedef struct jio_csv_aggregate_info_T jio_csv_aggregate_info;
+struct jio_csv_aggregate_info_T
+{
+    bool count_distinct;                //  Count distinct elements of each group
+    uint32_t percentile_count;          //  Number of percentiles to find
+    const double* percentiles;          //  Percentiles to find, as fractions on [0, 1]
+};
+
+typedef struct jio_csv_aggregate_group_T jio_csv_aggregate_group;
+struct jio_csv_aggregate_group_T
+{
+    jio_string_segment key;             //  Element of the group by column which rows of the group share
+    uint32_t row_count;                 //  Number of rows in the group
+    uint32_t count;                     //  Number of elements which are numbers
+    uint32_t distinct_count;            //  Number of distinct elements (0 if they were not counted)
+    double sum;                         //  Sum of numbers
+    double min;                         //  Smallest number (0 if there are none)
+    double max;                         //  Largest number (0 if there are none)
+    double mean;                        //  Mean of numbers (0 if there are none)
+    double* percentiles;                //  Number at each percentile, interpolated between closest ranks (NULL if none)
+};
+
+typedef struct jio_csv_aggregation_T jio_csv_aggregation;
+struct jio_csv_aggregation_T
+{
+    uint32_t group_count;               //  Number of groups
+    jio_csv_aggregate_group* groups;    //  Groups in order of first appearance of their keys
+};
+
+//  Aggregates elements of the column which are numbers (empty elements and those which are not numbers are skipped),
+//  grouping rows by elements of group_by_column, or putting all of them in one group if it is UINT32_MAX. Numbers are
+//  parsed and reduced by blocks of rows in parallel, while percentiles and distinct elements are found for groups in
+//  parallel. Without groups, blocks also sort their numbers and find their distinct elements in parallel, after which
+//  percentiles are selected from the sorted blocks and distinct elements are merged in parallel by their hash. Keys of
+//  groups point to the same memory as elements of the group by column.
+jio_result jio_csv_aggregate(
+        const jio_context* ctx, const jio_csv_data* data, uint32_t column, const jio_csv_aggregate_info* info,
+        uint32_t group_by_column, jio_csv_aggregation* p_aggregation);
+
+void jio_csv_aggregation_release(const jio_context* ctx, jio_csv_aggregation* aggregation);
+
+//  Resolves indices of many columns at once, setting the index of those which are not found to UINT32_MAX
+jio_result jio_csv_resolve_columns(
+        const jio_context* ctx, const jio_csv_data* data, uint32_t count, const jio_string_segment* names,
+        uint32_t* indices);
+
+//  Lookup of columns by name uses an index, which is built on first use, so the lookup functions should not be called
+//  on the same data from multiple threads at once before the first one returns. Snapshots made by
+//  jio_csv_snapshot_create already have their index, so they can be called on from any number of threads.
+void jio_csv_set_case_insensitive_headers(jio_csv_data* data, bool case_insensitive);
+
 jio_result jio_csv_add_rows(
         const jio_context* ctx, jio_csv_data* data, uint32_t position, uint32_t row_count,
         const jio_string_segment* const* rows);
@@ -59,8 +339,185 @@ jio_result jio_csv_replace_cols(
 
 void jio_csv_shape(const jio_csv_data* data, uint32_t* p_rows, uint32_t* p_cols);
 
+typedef struct jio_csv_view_T jio_csv_view;
+
+//  Creates a view of rows [first_row, first_row + row_count) and columns [first_column, first_column + column_count) of
+//  the data, without copying any elements. Views can be made of the data of other views. The data of the view works with
+//  every function which takes const data, and stays valid until the viewed data is modified or released. Viewed columns
+//  of lazily parsed data are created by this function, so elements of the view can be read from many threads once it
+//  returns.
+jio_result jio_csv_view_create(
+        const jio_context* ctx, const jio_csv_data* data, uint32_t first_row, uint32_t row_count, uint32_t first_column,
+        uint32_t column_count, jio_csv_view** pp_view);
+
+const jio_csv_data* jio_csv_view_data(const jio_csv_view* view);
+
+void jio_csv_view_destroy(jio_csv_view* view);
+
+typedef struct jio_csv_snapshot_T jio_csv_snapshot;
+
+//  Creates a copy-on-write snapshot of the data, which shares arrays of elements with it instead of copying them, so it
+//  takes time proportional to the number of columns, plus the time to compute stats of columns which the data has no
+//  stats for. Functions which modify the data copy an array only before they change elements which a snapshot can see,
+//  so appending rows that fit the capacity of columns copies nothing. Data of the snapshot works with every function
+//  which takes const data, and never changes, since its header index and stats are built when it is created. Any number
+//  of threads can therefore read it without locking, look up its columns by name and get their stats, while one thread
+//  keeps modifying the data. Functions which allocate memory use the allocators of the context, so calling them from
+//  several threads at once needs allocators which allow that. Snapshots must be created by the thread which modifies
+//  the data and with the context of the data, but can be destroyed by any thread, in any order. Destroying a snapshot
+//  only hands it back to the data, and its memory is freed by the thread which modifies the data, the next time that
+//  thread changes elements, creates a snapshot or releases the data, so the allocators are never used by other threads.
+//  Strings are not copied, so the data must be released after all of its snapshots, and the file it was parsed from
+//  must not be remapped while snapshots exist (which jio_csv_parse_append may do). These snapshots are unrelated to
+//  jio_csv_save_snapshot.
+jio_result jio_csv_snapshot_create(const jio_context* ctx, jio_csv_data* data, jio_csv_snapshot** pp_snapshot);
+
+const jio_csv_data* jio_csv_snapshot_data(const jio_csv_snapshot* snapshot);
+
+void jio_csv_snapshot_destroy(jio_csv_snapshot* snapshot);
+
+//  Strings copied by the functions below are stored in memory owned by the data, which is released along with it.
+//  When deduplication is enabled, equal strings copied into the data share the same memory.
+void jio_csv_set_deduplication(jio_csv_data* data, bool deduplicate);
+
+jio_result jio_csv_copy_string(
+        const jio_context* ctx, jio_csv_data* data, jio_string_segment str, jio_string_segment* p_out);
+
+jio_result jio_csv_set_cell(
+        const jio_context* ctx, jio_csv_data* data, uint32_t column, uint32_t row, jio_string_segment value);
+
+jio_result jio_csv_add_rows_copy(
+        const jio_context* ctx, jio_csv_data* data, uint32_t position, uint32_t row_count,
+        const jio_string_segment* const* rows);
+
+jio_result jio_csv_replace_rows_copy(
+        const jio_context* ctx, jio_csv_data* data, uint32_t begin, uint32_t count, uint32_t row_count,
+        const jio_string_segment* const* rows);
+
+//  Copies both the elements and the headers of the columns, so the caller keeps ownership of cols
+jio_result jio_csv_add_cols_copy(
+        const jio_context* ctx, jio_csv_data* data, uint32_t position, uint32_t col_count, const jio_csv_column* cols);
+
+//  Batch of row and column edits, which are all applied at once by jio_csv_edit_commit. Positions always refer to the
+//  data as it was when the edit began, inserted rows have as many elements as the data had columns then, and inserted
+//  columns must have the row count the data will have after the commit. The data must not be changed otherwise until
+//  the edit is committed or aborted.
+typedef struct jio_csv_edit_T jio_csv_edit;
+
+jio_result jio_csv_edit_begin(const jio_context* ctx, jio_csv_data* data, jio_csv_edit** pp_edit);
+
+jio_result jio_csv_edit_add_rows(
+        jio_csv_edit* edit, uint32_t position, uint32_t row_count, const jio_string_segment* const* rows);
+
+jio_result jio_csv_edit_remove_rows(jio_csv_edit* edit, uint32_t position, uint32_t row_count);
+
+jio_result jio_csv_edit_replace_rows(
+        jio_csv_edit* edit, uint32_t begin, uint32_t count, uint32_t row_count, const jio_string_segment* const* rows);
+
+jio_result jio_csv_edit_add_cols(jio_csv_edit* edit, uint32_t position, uint32_t col_count, const jio_csv_column* cols);
+
+jio_result jio_csv_edit_remove_cols(jio_csv_edit* edit, uint32_t position, uint32_t col_count);
+
+jio_result jio_csv_edit_replace_cols(
+        jio_csv_edit* edit, uint32_t begin, uint32_t count, uint32_t col_count, const jio_csv_column* cols);
+
+//  Applies all queued edits with a single pass over each column and releases the edit. On failure the data is left
+//  unchanged and the inserted columns remain owned by the caller.
+jio_result jio_csv_edit_commit(jio_csv_edit* edit, bool shrink_to_fit);
+
+void jio_csv_edit_abort(jio_csv_edit* edit);
+
+//  Column stored in fixed-size blocks of a B+ tree, so that elements can be inserted or removed at any position in
+//  O(log n). Appending many elements at once fills the last block directly, which takes one descent of the tree per
+//  block instead of one per element. Insertion which fails leaves the column as it was.
+typedef struct jio_csv_chunked_column_T jio_csv_chunked_column;
+
+jio_result jio_csv_chunked_column_create(
+        const jio_context* ctx, const jio_csv_column* src, jio_csv_chunked_column** pp_column);
+
+void jio_csv_chunked_column_destroy(const jio_context* ctx, jio_csv_chunked_column* column);
+
+uint32_t jio_csv_chunked_column_count(const jio_csv_chunked_column* column);
+
+jio_string_segment jio_csv_chunked_column_header(const jio_csv_chunked_column* column);
+
+jio_result jio_csv_chunked_column_get(const jio_csv_chunked_column* column, uint32_t index, jio_string_segment* p_element);
+
+jio_result jio_csv_chunked_column_set(jio_csv_chunked_column* column, uint32_t index, jio_string_segment element);
+
+//  Gives the contiguous block of elements which starts at index, which is the fastest way to iterate over elements
+jio_result jio_csv_chunked_column_block(
+        const jio_csv_chunked_column* column, uint32_t index, const jio_string_segment** p_elements, uint32_t* p_count);
+
+jio_result jio_csv_chunked_column_copy(
+        const jio_csv_chunked_column* column, uint32_t begin, uint32_t count, jio_string_segment* out);
+
+jio_result jio_csv_chunked_column_insert(
+        const jio_context* ctx, jio_csv_chunked_column* column, uint32_t position, uint32_t count,
+        const jio_string_segment* elements);
+
+jio_result jio_csv_chunked_column_remove(
+        const jio_context* ctx, jio_csv_chunked_column* column, uint32_t position, uint32_t count);
+
+jio_result jio_csv_chunked_column_to_column(
+        const jio_context* ctx, const jio_csv_chunked_column* column, jio_csv_column* p_out);
+
 void jio_csv_release(const jio_context* ctx, jio_csv_data* data);
 
+typedef struct jio_csv_sort_key_T jio_csv_sort_key;
+struct jio_csv_sort_key_T
+{
+    uint32_t column;                //  Index of the column to sort by
+    bool numeric;                   //  Compare elements as numbers (elements which are not numbers go after those which are)
+    bool descending;                //  Sort in descending order
+};
+
+//  Stable sort of rows by the given keys, where later keys are only used to order rows which earlier keys find equal
+jio_result jio_csv_sort(const jio_context* ctx, jio_csv_data* data, uint32_t key_count, const jio_csv_sort_key* keys);
+
+//  Saves the data to a binary snapshot, which can be opened without parsing. If source is not NULL, its size and hash
+//  are stored, so that opening the snapshot can check that it is still up to date.
+jio_result jio_csv_save_snapshot(
+        const jio_context* ctx, const jio_csv_data* data, const jio_memory_file* source, const char* filename);
+
+//  Opens a snapshot by mapping it to memory. Elements of the data point into the snapshot, which stays mapped until the
+//  data is released. If source is not NULL, the snapshot must have been made from the same contents of that file.
+jio_result jio_csv_open_snapshot(
+        const jio_context* ctx, const char* filename, const jio_memory_file* source, jio_csv_data** pp_csv);
+
+//  Writer which formats entries of csv rows straight into a buffer, which is given to a sink whenever it fills up, so
+//  that csv output of any size can be produced without storing it. Entries are only quoted if they contain the
+//  separator, quotes, or new lines. The csv parser does not handle quotes, so such output can not be parsed back: quoted
+//  entries with the separator or new lines break up their row, while other quoted entries keep their quotes. Output in
+//  which no entry needed quotes is parsed back exactly.
+typedef struct jio_csv_writer_T jio_csv_writer;
+
+//  Sink returns false if it could not take the data. Buffer size of 0 uses the default size.
+jio_result jio_csv_writer_create(
+        const jio_context* ctx, const char* separator, size_t buffer_size,
+        bool (* sink)(void* param, const char* data, size_t size), void* param, jio_csv_writer** pp_writer);
+
+//  Writer which writes to a file, which is created or truncated
+jio_result jio_csv_writer_create_file(
+        const jio_context* ctx, const char* filename, const char* separator, size_t buffer_size,
+        jio_csv_writer** pp_writer);
+
+jio_result jio_csv_writer_write_i64(jio_csv_writer* writer, int64_t value);
+
+//  Writes the shortest text which is parsed back to exactly the same value, always with '.' as the decimal point. Values
+//  which are not finite are written as nan, inf, or -inf.
+jio_result jio_csv_writer_write_f64(jio_csv_writer* writer, double value);
+
+jio_result jio_csv_writer_write_str(jio_csv_writer* writer, jio_string_segment value);
+
+jio_result jio_csv_writer_end_row(jio_csv_writer* writer);
+
+//  Gives everything in the buffer to the sink
+jio_result jio_csv_writer_flush(jio_csv_writer* writer);
+
+//  Flushes the writer and destroys it, even if flushing fails
+jio_result jio_csv_writer_destroy(jio_csv_writer* writer);
+
 jio_result jio_csv_print_size(const jio_csv_data* data, size_t* p_size, size_t separator_length, uint32_t extra_padding, bool same_width);
 
 jio_result jio_csv_print(const jio_csv_data* data, size_t* p_usage, char* restrict buffer, const char* separator, uint32_t extra_padding, bool same_width, bool align_left);
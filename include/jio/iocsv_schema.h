@@ -0,0 +1,228 @@
+//
+// Created by jan on 19.10.2026.
+//
+
+#ifndef JIO_IOCSV_SCHEMA_H
+#define JIO_IOCSV_SCHEMA_H
+#include "ioerr.h"
+#include "iobase.h"
+#include <stdint.h>
+#include <stddef.h>
+#include <stdlib.h>
+#include <string.h>
+
+//  Parsers specialized for csv files whose separator and columns are known at compile time. Columns of a schema are
+//  given as an X-macro, which calls its argument with the name and the type of each column, in order:
+//
+//      #define MEASUREMENT_COLUMNS(X) X(id, UINT) X(station, STRING) X(temperature, FLOAT)
+//      JIO_CSV_DEFINE_SCHEMA(measurement, ',', MEASUREMENT_COLUMNS)
+//
+//  This defines the struct type measurement, with a member for each column, the constant measurement_column_count,
+//  and the function
+//
+//      jio_result measurement_parse(const jio_context* ctx, const jio_memory_file* mem_file, bool has_headers,
+//                                   uint32_t capacity, measurement* rows, uint32_t* p_count);
+//
+//  which parses the file straight into the array of rows, with the loop over columns unrolled. Headers must be equal to
+//  the names of the columns. Empty lines are skipped, so jio_memory_file_count_non_empty_lines gives enough capacity.
+//  The number of rows parsed is given even if parsing fails, which gives JIO_RESULT_BAD_CSV_HEADER for bad headers,
+//  JIO_RESULT_BAD_CSV_FORMAT for rows with the wrong number of entries, JIO_RESULT_BAD_VALUE for entries which could
+//  not be decoded, and JIO_RESULT_BAD_ALLOC if there are more than capacity rows. Failures are reported through the
+//  context, with the row, the column and the byte offset in the file where parsing stopped.
+//
+//  Types of columns are INT (int64_t), UINT (uint64_t), FLOAT (double) and STRING (jio_string_segment, which points
+//  into the file). Entries are not trimmed.
+
+#define JIO_CSV_SCHEMA_TYPE_INT int64_t
+#define JIO_CSV_SCHEMA_TYPE_UINT uint64_t
+#define JIO_CSV_SCHEMA_TYPE_FLOAT double
+#define JIO_CSV_SCHEMA_TYPE_STRING jio_string_segment
+
+static inline bool jio_csv_schema_decode_UINT(const char* begin, const char* end, uint64_t* p_out)
+{
+    if (begin == end)
+    {
+        return false;
+    }
+    uint64_t v = 0;
+    for (const char* ptr = begin; ptr != end; ++ptr)
+    {
+        const unsigned digit = (unsigned char)*ptr - (unsigned)'0';
+        if (digit > 9 || v > (UINT64_MAX - digit) / 10)
+        {
+            return false;
+        }
+        v = v * 10 + digit;
+    }
+    *p_out = v;
+    return true;
+}
+
+static inline bool jio_csv_schema_decode_INT(const char* begin, const char* end, int64_t* p_out)
+{
+    const bool negative = begin != end && *begin == '-';
+    if (begin != end && (*begin == '-' || *begin == '+'))
+    {
+        begin += 1;
+    }
+    uint64_t v;
+    if (!jio_csv_schema_decode_UINT(begin, end, &v) || v > (uint64_t)INT64_MAX + negative)
+    {
+        return false;
+    }
+    *p_out = negative ? -(int64_t)(v - 1) - 1 : (int64_t)v;
+    return true;
+}
+
+static inline bool jio_csv_schema_decode_FLOAT(const char* begin, const char* end, double* p_out)
+{
+    //  Entries are not null-terminated, so they are copied to make sure strtod does not read past them
+    char buffer[64];
+    const size_t len = end - begin;
+    if (len == 0 || len >= sizeof(buffer))
+    {
+        return false;
+    }
+    memcpy(buffer, begin, len);
+    buffer[len] = 0;
+    char* p_end;
+    const double v = strtod(buffer, &p_end);
+    if (p_end != buffer + len)
+    {
+        return false;
+    }
+    *p_out = v;
+    return true;
+}
+
+static inline bool jio_csv_schema_decode_STRING(const char* begin, const char* end, jio_string_segment* p_out)
+{
+    p_out->begin = begin;
+    p_out->len = end - begin;
+    return true;
+}
+
+//  Reports a failure of a schema parser, which stopped on the row (0 for headers) and column (NULL if the row has more
+//  entries than there are columns, or does not fit into the rows) at the given byte offset of the file
+void jio_csv_schema_report_error(
+        const jio_context* ctx, const jio_memory_file* mem_file, const char* function, jio_result res, uint32_t row,
+        const char* column, size_t offset);
+
+//  Finds where the entry which begins at ptr ends
+static inline const char* jio_csv_schema_entry_end(const char* ptr, const char* end, const char separator)
+{
+    while (ptr != end && *ptr != separator && *ptr != '\n' && *ptr)
+    {
+        ptr += 1;
+    }
+    return ptr;
+}
+
+//  Moves past the end of an entry, remembering what ended it
+#define JIO_CSV_SCHEMA_ADVANCE()                                                                                       \
+    terminator = entry_end != end ? *entry_end : 0;                                                                     \
+    pos = terminator == separator || terminator == '\n' ? entry_end + 1 : entry_end;
+
+#define JIO_CSV_SCHEMA_MEMBER(name, type) JIO_CSV_SCHEMA_TYPE_##type name;
+
+#define JIO_CSV_SCHEMA_COUNT(name, type) + 1
+
+#define JIO_CSV_SCHEMA_HEADER(name, type)                                                                              \
+    failed_column = #name;                                                                                              \
+    if (terminator != separator)                                                                                        \
+    {                                                                                                                   \
+        res = JIO_RESULT_BAD_CSV_HEADER;                                                                                \
+        goto done;                                                                                                      \
+    }                                                                                                                   \
+    entry_end = jio_csv_schema_entry_end(pos, end, separator);                                                          \
+    if ((size_t)(entry_end - pos) != sizeof(#name) - 1 || memcmp(pos, #name, sizeof(#name) - 1) != 0)                  \
+    {                                                                                                                   \
+        res = JIO_RESULT_BAD_CSV_HEADER;                                                                                \
+        goto done;                                                                                                      \
+    }                                                                                                                   \
+    JIO_CSV_SCHEMA_ADVANCE()
+
+#define JIO_CSV_SCHEMA_ENTRY(name, type)                                                                               \
+    failed_column = #name;                                                                                              \
+    if (terminator != separator)                                                                                        \
+    {                                                                                                                   \
+        res = JIO_RESULT_BAD_CSV_FORMAT;                                                                                \
+        goto done;                                                                                                      \
+    }                                                                                                                   \
+    entry_end = jio_csv_schema_entry_end(pos, end, separator);                                                          \
+    if (!jio_csv_schema_decode_##type(pos, entry_end, &row->name))                                                      \
+    {                                                                                                                   \
+        res = JIO_RESULT_BAD_VALUE;                                                                                     \
+        goto done;                                                                                                      \
+    }                                                                                                                   \
+    JIO_CSV_SCHEMA_ADVANCE()
+
+#define JIO_CSV_DEFINE_SCHEMA(schema, separator_char, COLUMNS)                                                         \
+typedef struct schema##_T schema;                                                                                       \
+struct schema##_T                                                                                                       \
+{                                                                                                                       \
+    COLUMNS(JIO_CSV_SCHEMA_MEMBER)                                                                                      \
+};                                                                                                                      \
+enum {schema##_column_count = 0 COLUMNS(JIO_CSV_SCHEMA_COUNT)};                                                         \
+static inline jio_result schema##_parse(                                                                                \
+        const jio_context* ctx, const jio_memory_file* mem_file, bool has_headers, uint32_t capacity, schema* rows,     \
+        uint32_t* p_count)                                                                                              \
+{                                                                                                                       \
+    const char separator = (separator_char);                                                                            \
+    const jio_memory_file_info file_info = jio_memory_file_get_info(mem_file);                                          \
+    const char* pos = (const char*)file_info.memory;                                                                    \
+    const char* const end = pos + file_info.size;                                                                       \
+    const char* entry_end;                                                                                              \
+    const char* failed_column = NULL;                                                                                   \
+    bool parsing_headers = has_headers;                                                                                 \
+    char terminator;                                                                                                    \
+    jio_result res = JIO_RESULT_SUCCESS;                                                                                \
+    uint32_t count = 0;                                                                                                 \
+    if (has_headers)                                                                                                    \
+    {                                                                                                                   \
+        terminator = separator;                                                                                         \
+        COLUMNS(JIO_CSV_SCHEMA_HEADER)                                                                                  \
+        if (terminator == separator)                                                                                    \
+        {                                                                                                               \
+            failed_column = NULL;                                                                                       \
+            res = JIO_RESULT_BAD_CSV_HEADER;                                                                            \
+            goto done;                                                                                                  \
+        }                                                                                                               \
+        parsing_headers = false;                                                                                        \
+    }                                                                                                                   \
+    while (pos != end && *pos)                                                                                          \
+    {                                                                                                                   \
+        if (*pos == '\n')                                                                                               \
+        {                                                                                                               \
+            pos += 1;                                                                                                   \
+            continue;                                                                                                   \
+        }                                                                                                               \
+        if (count == capacity)                                                                                          \
+        {                                                                                                               \
+            failed_column = NULL;                                                                                       \
+            res = JIO_RESULT_BAD_ALLOC;                                                                                 \
+            goto done;                                                                                                  \
+        }                                                                                                               \
+        schema* const row = rows + count;                                                                               \
+        terminator = separator;                                                                                         \
+        COLUMNS(JIO_CSV_SCHEMA_ENTRY)                                                                                   \
+        if (terminator == separator)                                                                                    \
+        {                                                                                                               \
+            failed_column = NULL;                                                                                       \
+            res = JIO_RESULT_BAD_CSV_FORMAT;                                                                            \
+            goto done;                                                                                                  \
+        }                                                                                                               \
+        count += 1;                                                                                                     \
+    }                                                                                                                   \
+done:                                                                                                                   \
+    if (res != JIO_RESULT_SUCCESS)                                                                                      \
+    {                                                                                                                   \
+        jio_csv_schema_report_error(                                                                                    \
+                ctx, mem_file, #schema "_parse", res, parsing_headers ? 0 : count + 1, failed_column,                     \
+                (size_t)(pos - (const char*)file_info.memory));                                                         \
+    }                                                                                                                   \
+    *p_count = count;                                                                                                   \
+    return res;                                                                                                         \
+}
+
+#endif //JIO_IOCSV_SCHEMA_H
@@ -7,10 +7,13 @@
 #include <stdio.h>
 #include <malloc.h>
 #include <assert.h>
+#include <stdlib.h>
 #include "internal.h"
 
 #ifdef _WIN32
     #define strncasecmp(first, second, n) _strnicmp((first), (second), (n))
+#else
+    #include <pthread.h>
 #endif
 
 bool jio_string_segment_equal(const jio_string_segment* first, const jio_string_segment* second)
@@ -40,6 +43,26 @@ bool jio_iswhitespace(unsigned c)
     return c == ' ' || c == '\t' || c == '\n' || c == '\r';
 }
 
+bool jio_string_segment_to_double(const jio_string_segment* segment, double* p_out)
+{
+    //  Segments are not null-terminated, so they are copied to make sure strtod does not read past them
+    char buffer[64];
+    if (segment->len == 0 || segment->len >= sizeof(buffer))
+    {
+        return false;
+    }
+    memcpy(buffer, segment->begin, segment->len);
+    buffer[segment->len] = 0;
+    char* end;
+    const double v = strtod(buffer, &end);
+    if (end != buffer + segment->len)
+    {
+        return false;
+    }
+    *p_out = v;
+    return true;
+}
+
 void* jio_alloc(const jio_context* ctx, size_t size)
 {
     return ctx->allocator_callbacks.alloc(ctx->allocator_callbacks.param, size);
@@ -112,3 +135,138 @@ void jio_error_report(const jio_context* ctx, const char* fmt, const char* file,
 }
 
 
+
+typedef struct parallel_for_state_T parallel_for_state;
+struct parallel_for_state_T
+{
+    void (* task)(void* param, uint32_t index);
+    void* param;
+    uint32_t task_count;
+    volatile long next_task;
+};
+
+static void parallel_for_run(parallel_for_state* state)
+{
+    for (;;)
+    {
+#ifdef _WIN32
+        const uint32_t idx = (uint32_t)(InterlockedIncrement(&state->next_task) - 1);
+#else
+        const uint32_t idx = (uint32_t)__atomic_fetch_add(&state->next_task, 1, __ATOMIC_RELAXED);
+#endif
+        if (idx >= state->task_count)
+        {
+            break;
+        }
+        state->task(state->param, idx);
+    }
+}
+
+#ifdef _WIN32
+static DWORD WINAPI parallel_for_thread(LPVOID param)
+{
+    parallel_for_run(param);
+    return 0;
+}
+#else
+static void* parallel_for_thread(void* param)
+{
+    parallel_for_run(param);
+    return NULL;
+}
+#endif
+
+void jio_parallel_for(const jio_context* ctx, uint32_t task_count, void (* task)(void* param, uint32_t index), void* param)
+{
+    parallel_for_state state = {.task = task, .param = param, .task_count = task_count, .next_task = 0};
+    uint32_t thread_count = ctx->thread_count < task_count ? ctx->thread_count : task_count;
+#ifdef _WIN32
+    HANDLE* threads = NULL;
+#else
+    pthread_t* threads = NULL;
+#endif
+    if (thread_count > 1)
+    {
+        threads = jio_alloc_stack(ctx, sizeof(*threads) * (thread_count - 1));
+    }
+    //  Calling thread also runs tasks, so only thread_count - 1 are created. If creating any fails, the threads which
+    //  were created along with the calling thread still finish all the tasks
+    uint32_t created = 0;
+    if (threads)
+    {
+        for (; created < thread_count - 1; ++created)
+        {
+#ifdef _WIN32
+            threads[created] = CreateThread(NULL, 0, parallel_for_thread, &state, 0, NULL);
+            if (!threads[created])
+            {
+                break;
+            }
+#else
+            if (pthread_create(threads + created, NULL, parallel_for_thread, &state) != 0)
+            {
+                break;
+            }
+#endif
+        }
+    }
+
+    parallel_for_run(&state);
+
+    for (uint32_t i = 0; i < created; ++i)
+    {
+#ifdef _WIN32
+        (void)WaitForSingleObject(threads[i], INFINITE);
+        (void)CloseHandle(threads[i]);
+#else
+        (void)pthread_join(threads[i], NULL);
+#endif
+    }
+    jio_free_stack(ctx, threads);
+}
+
+long jio_atomic_increment(volatile long* p_value)
+{
+#ifdef _WIN32
+    return InterlockedIncrement(p_value);
+#else
+    return __atomic_add_fetch(p_value, 1, __ATOMIC_ACQ_REL);
+#endif
+}
+
+long jio_atomic_decrement(volatile long* p_value)
+{
+#ifdef _WIN32
+    return InterlockedDecrement(p_value);
+#else
+    return __atomic_sub_fetch(p_value, 1, __ATOMIC_ACQ_REL);
+#endif
+}
+
+long jio_atomic_load(volatile long* p_value)
+{
+#ifdef _WIN32
+    return InterlockedCompareExchange(p_value, 0, 0);
+#else
+    return __atomic_load_n(p_value, __ATOMIC_ACQUIRE);
+#endif
+}
+
+void* jio_atomic_exchange_pointer(void* volatile* p_value, void* value)
+{
+#ifdef _WIN32
+    return InterlockedExchangePointer(p_value, value);
+#else
+    return __atomic_exchange_n(p_value, value, __ATOMIC_ACQ_REL);
+#endif
+}
+
+void* jio_atomic_compare_exchange_pointer(void* volatile* p_value, void* expected, void* desired)
+{
+#ifdef _WIN32
+    return InterlockedCompareExchangePointer(p_value, desired, expected);
+#else
+    (void)__atomic_compare_exchange_n(p_value, &expected, desired, false, __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE);
+    return expected;
+#endif
+}
@@ -31,6 +31,7 @@ struct jio_context_T
     jio_allocator_callbacks allocator_callbacks;
     jio_allocator_callbacks stack_allocator_callbacks;
     jio_error_callbacks error_callbacks;
+    uint32_t thread_count;
 };
 
 
@@ -69,4 +70,23 @@ bool jio_string_segment_equal_str_case(const jio_string_segment* first, const ch
 
 bool jio_iswhitespace(unsigned c);
 
+//  Calls task(param, i) for each i in [0, task_count), using up to ctx->thread_count threads. Tasks must not use the
+//  context's allocators or report errors, since they may run on threads other than the calling one.
+void jio_parallel_for(const jio_context* ctx, uint32_t task_count, void (* task)(void* param, uint32_t index), void* param);
+
+//  Atomic operations on counters shared between threads. Increment and decrement give the new value.
+long jio_atomic_increment(volatile long* p_value);
+
+long jio_atomic_decrement(volatile long* p_value);
+
+long jio_atomic_load(volatile long* p_value);
+
+//  Atomic operations on pointers shared between threads. Both give the value the pointer had before the operation, and
+//  the compare exchange only stores the desired value if that was the expected one.
+void* jio_atomic_exchange_pointer(void* volatile* p_value, void* value);
+
+void* jio_atomic_compare_exchange_pointer(void* volatile* p_value, void* expected, void* desired);
+
+bool jio_string_segment_to_double(const jio_string_segment* segment, double* p_out);
+
 #endif //JIO_INTERNAL_H
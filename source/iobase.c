@@ -179,6 +179,34 @@ void jio_memory_file_destroy(jio_memory_file* mem_file)
     jio_free(mem_file->ctx, mem_file);
 }
 
+jio_result jio_memory_file_remap(jio_memory_file* file)
+{
+    const jio_context* ctx = file->ctx;
+    struct stat file_stats;
+    if (stat(file->name, &file_stats) < 0)
+    {
+        JIO_ERROR(ctx, "Could not retrieve stats for file \"%s\", reason: %s", file->name, strerror(errno));
+        return JIO_RESULT_BAD_PATH;
+    }
+    //  Mapping always has space for a null terminator after the end of the file
+    if ((size_t)file_stats.st_size < file->file_size)
+    {
+        return JIO_RESULT_SUCCESS;
+    }
+
+    size_t new_size = 0;
+    void* const ptr = file_to_memory(ctx, file->name, &new_size, file->can_write, 0);
+    if (!ptr)
+    {
+        JIO_ERROR(ctx, "Failed mapping file \"%s\" to memory again", file->name);
+        return JIO_RESULT_BAD_MAP;
+    }
+    file_from_memory(ctx, file->ptr, file->file_size);
+    file->ptr = ptr;
+    file->file_size = new_size;
+    return JIO_RESULT_SUCCESS;
+}
+
 jio_result jio_memory_file_sync(const jio_memory_file* file, int sync)
 {
     const jio_context* ctx = file->ctx;
@@ -310,6 +338,47 @@ jio_result jio_memory_file_create(
 }
 
 
+jio_result jio_memory_file_remap(jio_memory_file* file)
+{
+    const jio_context* ctx = file->ctx;
+    LARGE_INTEGER size;
+    if (!GetFileSizeEx(file->file_handle, &size))
+    {
+        JIO_ERROR(ctx, "Could not retrieve Win32 file size of file \"%s\"", file->name);
+        return JIO_RESULT_BAD_WINDOWS;
+    }
+    if ((size_t)size.QuadPart <= file->file_size)
+    {
+        return JIO_RESULT_SUCCESS;
+    }
+
+    HANDLE view_handle = CreateFileMappingA(
+            file->file_handle,
+            NULL,
+            file->can_write ? PAGE_READWRITE : PAGE_READONLY,
+            (DWORD)size.HighPart,
+            size.LowPart,
+            NULL);
+    if (!view_handle)
+    {
+        JIO_ERROR(ctx, "Could not create Win32 file mapping for file \"%s\"", file->name);
+        return JIO_RESULT_BAD_MAP;
+    }
+    LPVOID mapping_ptr = MapViewOfFile(view_handle, file->can_write ? FILE_MAP_ALL_ACCESS : FILE_MAP_READ, 0, 0, 0);
+    if (!mapping_ptr)
+    {
+        JIO_ERROR(ctx, "Could not map Win32 file view to memory for file \"%s\"", file->name);
+        CloseHandle(view_handle);
+        return JIO_RESULT_BAD_MAP;
+    }
+    (void) UnmapViewOfFile(file->ptr);
+    (void) CloseHandle(file->view_handle);
+    file->ptr = mapping_ptr;
+    file->view_handle = view_handle;
+    file->file_size = (size_t)size.QuadPart;
+    return JIO_RESULT_SUCCESS;
+}
+
 jio_result jio_memory_file_sync(const jio_memory_file* file, int sync)
 {
     (void) sync;
@@ -452,6 +521,7 @@ jio_result jio_context_create(const jio_context_create_info* create_info, jio_co
     this->allocator_callbacks = *info.allocator_callbacks;
     this->stack_allocator_callbacks = *info.stack_allocator_callbacks;
     this->error_callbacks = *info.error_callbacks;
+    this->thread_count = info.thread_count ? info.thread_count : 1;
     *p_context = this;
 
     return JIO_RESULT_SUCCESS;
@@ -3,20 +3,169 @@
 //
 
 #include <inttypes.h>
+#include <ctype.h>
+#include <stdlib.h>
 #include <string.h>
 #include <assert.h>
+#include <float.h>
 #include "../include/jio/iocsv.h"
 #include "internal.h"
 
 
+//  Rows of csv data per task when materializing a column
+#define CSV_ROWS_PER_TASK 16384
+
+//  State of data whose columns' elements are created on demand, either because it was parsed lazily, or because its
+//  entries are stored as compact cells, or both.
+typedef struct csv_deferred_state_T csv_deferred_state;
+struct csv_deferred_state_T
+{
+    bool* materialized;                     //  Were elements of the column already created
+    //  Lazy parsing (rows is NULL if data was not parsed lazily)
+    char* separator;                        //  Copy of the separator
+    size_t sep_len;                         //  Length of the separator
+    bool trim_whitespace;                   //  Trim entries when extracting them
+    uint32_t* sources;                      //  Index of the column in the file for each column
+    const char** rows;                      //  Beginning of each row in the file
+    //  Compact cells (cells is NULL if data is not compact)
+    const char* base;                       //  Address which offsets of cells are relative to
+    jio_csv_compact_cell** cells;           //  Cells of each column (NULL if not yet created)
+    bool borrowed_cells;                    //  Cells point into a snapshot, so they are not freed along with the state
+};
+
+//  Strings copied into csv data are stored in blocks of at least this size
+#define CSV_ARENA_BLOCK_SIZE (64 << 10)
+
+typedef struct csv_arena_block_T csv_arena_block;
+struct csv_arena_block_T
+{
+    csv_arena_block* prev;                  //  Previously filled block
+    size_t used;                            //  Number of bytes used
+    size_t capacity;                        //  Number of bytes available in the block
+    char data[];
+};
+
+//  Append-only storage for strings which the csv data owns
+typedef struct csv_string_arena_T csv_string_arena;
+struct csv_string_arena_T
+{
+    csv_arena_block* current;               //  Block which is being filled
+    //  Hash table of stored strings, used for deduplication (NULL if not used)
+    uint32_t table_count;
+    uint32_t table_capacity;
+    jio_string_segment* table;
+};
+
+//  Hash table mapping headers to column indices, which is built on the first lookup by name
+typedef struct csv_header_index_T csv_header_index;
+struct csv_header_index_T
+{
+    uint32_t capacity;                      //  Number of slots, which is a power of two (0 if index is not built)
+    uint32_t count;                         //  Number of used slots
+    uint32_t* slots;                        //  Index of the column plus one for each slot (0 if slot is empty)
+};
+
+//  Settings of parsing, kept so that rows appended to the file later can be parsed the same way
+typedef struct csv_append_state_T csv_append_state;
+struct csv_append_state_T
+{
+    char* separator;                        //  Copy of the separator
+    size_t sep_len;                         //  Length of the separator
+    bool trim_whitespace;                   //  Trim entries when extracting them
+    uint32_t file_column_count;             //  Number of columns in the file
+    uint32_t column_count;                  //  Number of columns kept
+    uint32_t* slots;                        //  Position of each column of the file in a row (NULL if all are kept)
+    size_t offset;                          //  Offset in the file of the first line which was not completely parsed
+    bool has_partial;                       //  Was the last row parsed from a line which had not yet ended
+};
+
+//  Cached stats of a column's elements
+typedef struct csv_column_stats_T csv_column_stats;
+struct csv_column_stats_T
+{
+    uint64_t total_length;                  //  Total length of all elements
+    uint32_t max_length;                    //  Length of the longest element
+    bool valid;                             //  Are the stats up to date (if not, they are recomputed when needed)
+};
+
+//  Rows with equal keys are chained in order, with each slot of the index holding the first and the last row of a chain
+typedef struct csv_index_slot_T csv_index_slot;
+struct csv_index_slot_T
+{
+    uint32_t head;                          //  First row with the key plus one (0 if slot is empty)
+    uint32_t tail;                          //  Last row with the key
+    uint64_t hash;                          //  Hash of the key
+};
+
+//  Array of column elements shared between data and its copy-on-write snapshots. Elements before frozen_count can be seen
+//  by snapshots, so while the array is shared they must not be changed, nor can the array be reallocated or freed.
+typedef struct csv_shared_elements_T csv_shared_elements;
+struct csv_shared_elements_T
+{
+    volatile long ref_count;                //  Number of snapshots which use the array, plus one for the data
+    jio_string_segment* elements;
+    uint32_t frozen_count;                  //  Number of elements which snapshots can see
+};
+
+struct jio_csv_index_T
+{
+    jio_csv_data* data;                     //  Data which is indexed
+    uint32_t column;                        //  Key column (UINT32_MAX if it was removed)
+    bool stale;                             //  Must the index be rebuilt before it is next used
+    uint32_t slot_count;                    //  Number of slots, which is a power of two
+    uint32_t used_slots;                    //  Number of distinct keys
+    csv_index_slot* slots;
+    uint32_t row_capacity;                  //  Number of rows there is space for in next
+    uint32_t* next;                         //  Next row with the same key (UINT32_MAX for the last one)
+    jio_csv_index* next_index;              //  Next index of the same data
+};
+
 struct jio_csv_data_T
 {
     uint32_t column_capacity;               //  Max size of columns before resizing the array
     uint32_t column_count;                  //  Number of columns used
     uint32_t column_length;                 //  Length of each column
     jio_csv_column* columns;                //  Columns themselves
+    const jio_context* ctx;                 //  Context used to create the data
+    csv_deferred_state* deferred;           //  State needed to create column elements on demand (NULL if not needed)
+    csv_string_arena* arena;                //  Strings copied into the data (NULL if none were)
+    bool deduplicate;                       //  Should equal strings copied into the data share memory
+    bool case_insensitive_headers;          //  Should lookup by name ignore case of headers
+    csv_header_index header_index;          //  Index used for lookup by name
+    uint32_t stats_capacity;                //  Number of columns there is space for in the stats array
+    csv_column_stats* stats;                //  Stats of each column (NULL if they were never needed)
+    jio_memory_file* snapshot_file;         //  Snapshot which the data was opened from (NULL if it was not)
+    csv_append_state* append;               //  State needed to parse rows appended to the file (NULL if not possible)
+    jio_csv_index* indices;                 //  Indices of key columns, which are kept up to date (NULL if none)
+    uint32_t share_capacity;                //  Number of slots in the table of shared elements (power of two, or 0)
+    uint32_t share_count;                   //  Number of shared element arrays
+    csv_shared_elements** shares;           //  Table of element arrays shared with snapshots, looked up by address
+    void* volatile released_snapshots;      //  Snapshots destroyed since they were last freed, added to by any thread
 };
 
+static uint64_t csv_string_hash(const char* str, size_t len)
+{
+    //  FNV-1a
+    uint64_t hash = 0xcbf29ce484222325;
+    for (size_t i = 0; i < len; ++i)
+    {
+        hash ^= (unsigned char)str[i];
+        hash *= 0x100000001b3;
+    }
+    return hash;
+}
+
+static uint64_t csv_string_hash_case(const char* str, size_t len)
+{
+    uint64_t hash = 0xcbf29ce484222325;
+    for (size_t i = 0; i < len; ++i)
+    {
+        hash ^= (unsigned char)tolower((unsigned char)str[i]);
+        hash *= 0x100000001b3;
+    }
+    return hash;
+}
+
 static inline jio_string_segment extract_string_segment(const char* ptr, const char* const row_end, const char** p_end, const char* restrict separator)
 {
     jio_string_segment ret = {.begin = NULL, .len = 0};
@@ -42,16 +191,40 @@ static inline uint32_t count_row_entries(const char* const csv, const char* cons
     return so_far + 1;
 }
 
+static inline jio_string_segment trim_string_segment(jio_string_segment segment)
+{
+    //  Trim front whitespace
+    while (jio_iswhitespace(*segment.begin) && segment.len)
+    {
+        segment.begin += 1;
+        segment.len -= 1;
+    }
+    //  Trim back whitespace
+    while (jio_iswhitespace(*(segment.begin + segment.len - 1)) && segment.len)
+    {
+        segment.len -= 1;
+    }
+    return segment;
+}
+
+//  Extracts entries of a row into p_out with a stride. If slots is not NULL, entry i is only stored at the position
+//  slots[i] (or not at all if it is UINT32_MAX), so entries that are not needed are never stored or trimmed.
 static inline jio_result extract_row_entries(
         const jio_context* ctx, const uint32_t expected_elements, const char* const row_begin,
-        const char* const row_end, const char* sep, size_t sep_len, const bool trim, jio_string_segment* const p_out)
+        const char* const row_end, const char* sep, size_t sep_len, const bool trim, jio_string_segment* const p_out,
+        const size_t stride, const uint32_t* const slots)
 {
     uint32_t i;
     const char* end = NULL, *begin = row_begin;
     for (i = 0; i < expected_elements && end < row_end; ++i)
     {
-        p_out[i] = extract_string_segment(begin, row_end, &end, sep);
+        const jio_string_segment segment = extract_string_segment(begin, row_end, &end, sep);
         begin = end + sep_len;
+        const uint32_t slot = slots ? slots[i] : i;
+        if (slot != UINT32_MAX)
+        {
+            p_out[slot * stride] = trim ? trim_string_segment(segment) : segment;
+        }
     }
     
     if (i != expected_elements)
@@ -65,774 +238,6361 @@ static inline jio_result extract_row_entries(
         return JIO_RESULT_BAD_CSV_FORMAT;
     }
 
+    return JIO_RESULT_SUCCESS;
+}
+
+//  Gives where the next row would begin, which is past the new line that ends the row
+static inline const char* row_after(const char* row_end, const char* const file_end)
+{
+    return row_end != file_end && *row_end == '\n' ? row_end + 1 : row_end;
+}
+
+//  Moves to the next row, returning false if there are no more rows
+static inline bool advance_row(const char** p_row_begin, const char** p_row_end, const char* const file_end)
+{
+    const char* row_end = *p_row_end;
+    if (row_end == file_end || !*row_end)
+    {
+        return false;
+    }
+    const char* const row_begin = row_end + 1;
+    row_end = strchr(row_begin, '\n');
+    if (!row_end)
+    {
+        row_end = strchr(row_begin, 0);
+    }
+    *p_row_begin = row_begin;
+    *p_row_end = row_end;
+    return row_end - row_begin >= 2;
+}
 
-    if (trim)
+//  Extracts only the entry at the specified index from a row, which is found by only knowing where the row begins
+static inline bool extract_row_entry(
+        const char* row_begin, const uint32_t index, const char* sep, const size_t sep_len, const bool trim,
+        jio_string_segment* const p_out)
+{
+    const char* begin = row_begin;
+    for (uint32_t i = 0;; ++i)
     {
-        for (i = 0; i < expected_elements; ++i)
+        const char* end = begin;
+        while (*end && *end != '\n' && (*end != *sep || memcmp(end, sep, sep_len) != 0))
         {
-            jio_string_segment segment = p_out[i];
-            //  Trim front whitespace
-            while (jio_iswhitespace(*segment.begin) && segment.len)
-            {
-                segment.begin += 1;
-                segment.len -= 1;
-            }
-            //  Trim back whitespace
-            while (jio_iswhitespace(*(segment.begin + segment.len - 1)) && segment.len)
-            {
-                segment.len -= 1;
-            }
-            p_out[i] = segment;
+            end += 1;
+        }
+        if (i == index)
+        {
+            const jio_string_segment segment = {.begin = begin, .len = end - begin};
+            *p_out = trim ? trim_string_segment(segment) : segment;
+            return true;
+        }
+        if (*end != *sep)
+        {
+            //  Row ended before the entry
+            return false;
         }
+        begin = end + sep_len;
     }
-
-    return JIO_RESULT_SUCCESS;
 }
 
-jio_result jio_parse_csv(
-        const jio_context* ctx, const jio_memory_file* mem_file, const char* separator, bool trim_whitespace,
-        bool has_headers, jio_csv_data** pp_csv)
+typedef struct csv_row_filter_T csv_row_filter;
+struct csv_row_filter_T
 {
+    jio_csv_filter_type type;
+    bool invert;
+    uint32_t slot;
+    jio_string_segment value;
+    double min;
+    double max;
+};
 
-    jio_result res;
-    jio_string_segment* segments = NULL;
-    jio_csv_data* const csv = jio_alloc(ctx, sizeof(*csv));
-    if (!csv)
+static inline bool csv_row_filter_check(const csv_row_filter* filter, const jio_string_segment* row)
+{
+    const jio_string_segment* const segment = row + filter->slot;
+    bool pass;
+    switch (filter->type)
     {
-        res = JIO_RESULT_BAD_ALLOC;
-        goto end;
+    case JIO_CSV_FILTER_EQUALS:
+        pass = jio_string_segment_equal(segment, &filter->value);
+        break;
+    case JIO_CSV_FILTER_PREFIX:
+        pass = segment->len >= filter->value.len && memcmp(segment->begin, filter->value.begin, filter->value.len) == 0;
+        break;
+    case JIO_CSV_FILTER_RANGE:
+        {
+            double v;
+            pass = jio_string_segment_to_double(segment, &v) && v >= filter->min && v <= filter->max;
+        }
+        break;
+    default:
+        pass = false;
+        break;
     }
+    return pass != filter->invert;
+}
 
-    memset(csv, 0, sizeof(*csv));
+static jio_result find_header_index(
+        const jio_context* ctx, const jio_string_segment* headers, uint32_t column_count, const jio_string_segment* name,
+        uint32_t* p_idx)
+{
+    if (!headers)
+    {
+        JIO_ERROR(ctx, "Columns can only be referred to by name if the csv file has headers");
+        return JIO_RESULT_BAD_CSV_HEADER;
+    }
+    for (uint32_t j = 0; j < column_count; ++j)
+    {
+        if (jio_string_segment_equal(headers + j, name))
+        {
+            *p_idx = j;
+            return JIO_RESULT_SUCCESS;
+        }
+    }
+    JIO_ERROR(ctx, "Csv file has no header that matches \"%.*s\"", (int)name->len, name->begin);
+    return JIO_RESULT_BAD_CSV_HEADER;
+}
 
-    //  Parse the first row
-    const char* row_begin = mem_file->ptr;
-    const char* row_end = strchr(row_begin, '\n');
+//  Fills slots, which maps each column of the file to the position its entry is stored at in each parsed row. Selected
+//  columns come first, followed by columns that are only needed by filters. Also compiles the filters.
+static jio_result resolve_column_slots(
+        const jio_context* ctx, const jio_csv_parse_info* info, const char* row_begin, const char* row_end,
+        uint32_t column_count, size_t sep_len, uint32_t* slots, csv_row_filter* filters, uint32_t* p_stored_count)
+{
+    jio_result res = JIO_RESULT_SUCCESS;
+    jio_string_segment* headers = NULL;
 
-    //  Count columns in the csv file
-    size_t sep_len = strlen(separator);
-    const uint32_t column_count = count_row_entries(row_begin, row_end ? row_end : (const char*)mem_file->ptr + mem_file->file_size, separator,
-                                               sep_len);
-    uint32_t row_capacity = 128;
-    uint32_t row_count = 0;
-    segments = jio_alloc_stack(ctx, sizeof(*segments) * row_capacity * column_count);
-    if (!segments)
+    bool needs_headers = info->selected_count && info->selected_names;
+    for (uint32_t i = 0; i < info->filter_count; ++i)
     {
-        res = JIO_RESULT_BAD_ALLOC;
-        JIO_ERROR(ctx, "Could not allocate memory for csv parsing");
-        goto end;
+        needs_headers = needs_headers || info->filters[i].column_name.begin;
     }
-
-    for (;;)
+    if (needs_headers && info->has_headers)
     {
-        //  Check if more space is needed to parse the row
-        if (row_capacity == row_count)
+        headers = jio_alloc_stack(ctx, sizeof(*headers) * column_count);
+        if (!headers)
         {
-            const uint32_t new_capacity = row_capacity + 128;
-            jio_string_segment* const new_ptr = jio_realloc_stack(ctx, segments, sizeof(*segments) * new_capacity * column_count);
-            if (!new_ptr)
-            {
-                res = JIO_RESULT_BAD_ALLOC;
-                JIO_ERROR(ctx, "Could not reallocate memory for csv parsing");
-                goto end;
-            }
-            segments = new_ptr;
-            row_capacity = new_capacity;
+            JIO_ERROR(ctx, "Could not allocate memory for csv headers");
+            res = JIO_RESULT_BAD_ALLOC;
+            goto end;
         }
-
-        if ((res = extract_row_entries(ctx, column_count, row_begin, row_end, separator, sep_len, trim_whitespace,
-                                       segments + row_count * column_count)))
+        if ((res = extract_row_entries(ctx, column_count, row_begin, row_end, info->separator, sep_len, info->trim_whitespace, headers, 1, NULL)))
         {
-            JIO_ERROR(ctx, "Failed parsing row %u of CSV file \"%s\", reason: %s", row_count + 1, mem_file->name, jio_result_to_str(res));
+            JIO_ERROR(ctx, "Failed extracting the headers of the csv file, reason: %s", jio_result_to_str(res));
             goto end;
         }
+    }
 
-        row_count += 1;
-        //  Move to the next row
-        if (row_end == (const char*)mem_file->ptr + mem_file->file_size)
+    uint32_t stored_count;
+    if (info->selected_count)
+    {
+        for (uint32_t i = 0; i < column_count; ++i)
         {
-            break;
+            slots[i] = UINT32_MAX;
         }
-        row_begin = row_end + 1;
-        row_end = strchr(row_end + 1, '\n');
-        if (!row_end)
+        for (uint32_t i = 0; i < info->selected_count; ++i)
         {
-            row_end = strchr(row_begin, 0);
+            uint32_t idx;
+            if (info->selected_names)
+            {
+                if ((res = find_header_index(ctx, headers, column_count, info->selected_names + i, &idx)))
+                {
+                    goto end;
+                }
+            }
+            else
+            {
+                idx = info->selected_indices[i];
+                if (idx >= column_count)
+                {
+                    JIO_ERROR(ctx, "Column %"PRIu32" was selected, but csv file only has %"PRIu32" columns", idx, column_count);
+                    res = JIO_RESULT_BAD_INDEX;
+                    goto end;
+                }
+            }
+            if (slots[idx] != UINT32_MAX)
+            {
+                JIO_ERROR(ctx, "Column %"PRIu32" was selected more than once", idx);
+                res = JIO_RESULT_BAD_INDEX;
+                goto end;
+            }
+            slots[idx] = i;
         }
-        if (row_end - row_begin < 2)
+        stored_count = info->selected_count;
+    }
+    else
+    {
+        for (uint32_t i = 0; i < column_count; ++i)
         {
-            break;
+            slots[i] = i;
         }
+        stored_count = column_count;
     }
 
-    //  Convert the data into appropriate format
-    csv->column_count = column_count;
-    csv->column_length = row_count - (has_headers ? 1 : 0);
-
-    jio_csv_column* const columns = jio_alloc(ctx, sizeof(*columns) * column_count);
-    if (!columns)
+    for (uint32_t i = 0; i < info->filter_count; ++i)
     {
-        res = JIO_RESULT_BAD_ALLOC;
-        JIO_ERROR(ctx, "Could not allocate memory for csv column array");
-        goto end;
-    }
-    for (uint32_t i = 0; i < column_count; ++i)
-    {
-        jio_csv_column* const p_column = columns + i;
-        p_column->capacity = (p_column->count = csv->column_length);
-        jio_string_segment* const elements = jio_alloc(ctx, sizeof(*elements) * p_column->count);
-        if (!elements)
+        const jio_csv_filter* const filter = info->filters + i;
+        uint32_t idx;
+        if (filter->column_name.begin)
         {
-            for (uint32_t j = 0; j < i; ++j)
+            if ((res = find_header_index(ctx, headers, column_count, &filter->column_name, &idx)))
             {
-                jio_free(ctx, columns[j].elements);
+                goto end;
             }
-            JIO_ERROR(ctx, "Could not allocate memory for csv column elements");
-            goto end;
         }
-        if (has_headers)
+        else
         {
-            for (uint32_t j = 0; j < row_count - 1; ++j)
+            idx = filter->column;
+            if (idx >= column_count)
             {
-                elements[j] = segments[i + j * column_count + column_count];
+                JIO_ERROR(ctx, "Filter %"PRIu32" was for column %"PRIu32", but csv file only has %"PRIu32" columns", i, idx, column_count);
+                res = JIO_RESULT_BAD_INDEX;
+                goto end;
             }
         }
-        else
+        if (filter->type >= JIO_CSV_FILTER_COUNT)
         {
-            for (uint32_t j = 0; j < row_count; ++j)
-            {
-                elements[j] = segments[i + j * column_count];
-            }
+            JIO_ERROR(ctx, "Filter %"PRIu32" has an invalid type %u", i, (unsigned)filter->type);
+            res = JIO_RESULT_BAD_VALUE;
+            goto end;
         }
-        p_column->elements = elements;
-        p_column->header = has_headers ? segments[i] : (jio_string_segment){ .begin = NULL, .len = 0 };
-
+        if (slots[idx] == UINT32_MAX)
+        {
+            //  Column is not kept, but it must still be extracted for the filter
+            slots[idx] = stored_count++;
+        }
+        filters[i] = (csv_row_filter){.type = filter->type, .invert = filter->invert, .slot = slots[idx], .value = filter->value, .min = filter->min, .max = filter->max};
     }
-    jio_free_stack(ctx, segments);
-    csv->columns = columns;
-
-    *pp_csv = csv;
-    return JIO_RESULT_SUCCESS;
 
+    *p_stored_count = stored_count;
 end:
-    jio_free_stack(ctx, segments);
-    jio_free(ctx, csv);
+    jio_free_stack(ctx, headers);
     return res;
 }
 
-void jio_csv_release(const jio_context* ctx, jio_csv_data* data)
+static void csv_deferred_release(const jio_context* ctx, csv_deferred_state* deferred, uint32_t column_count)
 {
-    for (unsigned i = 0; i < data->column_count; ++i)
+    if (deferred->cells)
     {
-        jio_free(ctx, data->columns[i].elements);
+        for (uint32_t i = 0; i < column_count && !deferred->borrowed_cells; ++i)
+        {
+            jio_free(ctx, deferred->cells[i]);
+        }
+        jio_free(ctx, deferred->cells);
     }
-
-    jio_free(ctx, data->columns);
-    jio_free(ctx, data);
+    jio_free(ctx, deferred->separator);
+    jio_free(ctx, deferred->sources);
+    jio_free(ctx, deferred->materialized);
+    jio_free(ctx, deferred->rows);
+    jio_free(ctx, deferred);
 }
 
-void jio_csv_shape(const jio_csv_data* data, uint32_t* p_rows, uint32_t* p_cols)
+static jio_result csv_deferred_create(
+        const jio_context* ctx, uint32_t column_count, bool compact, const jio_memory_file* mem_file,
+        csv_deferred_state** pp_out)
 {
-    if (p_rows)
+    if (compact && mem_file->file_size > UINT32_MAX)
     {
-        *p_rows = data->column_length;
+        JIO_ERROR(ctx, "Csv file \"%s\" is too large (%zu bytes) to be stored in compact cells", mem_file->name, mem_file->file_size);
+        return JIO_RESULT_BAD_VALUE;
     }
-    if (p_cols)
+    csv_deferred_state* const deferred = jio_alloc(ctx, sizeof(*deferred));
+    if (!deferred)
     {
-        *p_cols = data->column_count;
+        JIO_ERROR(ctx, "Could not allocate memory for csv state");
+        return JIO_RESULT_BAD_ALLOC;
+    }
+    memset(deferred, 0, sizeof(*deferred));
+    deferred->materialized = jio_alloc(ctx, sizeof(*deferred->materialized) * (column_count ? column_count : 1));
+    if (compact)
+    {
+        deferred->base = mem_file->ptr;
+        deferred->cells = jio_alloc(ctx, sizeof(*deferred->cells) * (column_count ? column_count : 1));
+    }
+    if (!deferred->materialized || (compact && !deferred->cells))
+    {
+        JIO_ERROR(ctx, "Could not allocate memory for csv state");
+        csv_deferred_release(ctx, deferred, 0);
+        return JIO_RESULT_BAD_ALLOC;
+    }
+    memset(deferred->materialized, 0, sizeof(*deferred->materialized) * column_count);
+    if (compact)
+    {
+        memset(deferred->cells, 0, sizeof(*deferred->cells) * column_count);
     }
+    *pp_out = deferred;
+    return JIO_RESULT_SUCCESS;
 }
 
-jio_result jio_csv_get_column(const jio_csv_data* data, uint32_t index, const jio_csv_column** pp_column)
+static void csv_append_state_release(const jio_context* ctx, csv_append_state* append)
 {
-    if (data->column_count <= index)
+    jio_free(ctx, append->separator);
+    jio_free(ctx, append->slots);
+    jio_free(ctx, append);
+}
+
+static jio_result csv_append_state_create(
+        const jio_context* ctx, const jio_csv_parse_info* info, uint32_t file_column_count, uint32_t column_count,
+        const uint32_t* slots, csv_append_state** pp_out)
+{
+    csv_append_state* const append = jio_alloc(ctx, sizeof(*append));
+    if (!append)
     {
-        return JIO_RESULT_BAD_INDEX;
+        JIO_ERROR(ctx, "Could not allocate memory for csv state");
+        return JIO_RESULT_BAD_ALLOC;
     }
-    *pp_column = data->columns + index;
+    memset(append, 0, sizeof(*append));
+    append->sep_len = strlen(info->separator);
+    append->trim_whitespace = info->trim_whitespace;
+    append->file_column_count = file_column_count;
+    append->column_count = column_count;
+    append->separator = jio_alloc(ctx, append->sep_len + 1);
+    if (slots)
+    {
+        append->slots = jio_alloc(ctx, sizeof(*append->slots) * file_column_count);
+    }
+    if (!append->separator || (slots && !append->slots))
+    {
+        JIO_ERROR(ctx, "Could not allocate memory for csv state");
+        csv_append_state_release(ctx, append);
+        return JIO_RESULT_BAD_ALLOC;
+    }
+    memcpy(append->separator, info->separator, append->sep_len + 1);
+    if (slots)
+    {
+        memcpy(append->slots, slots, sizeof(*append->slots) * file_column_count);
+    }
+    *pp_out = append;
     return JIO_RESULT_SUCCESS;
 }
 
-jio_result jio_csv_get_column_by_name(
-        const jio_context* ctx, const jio_csv_data* data, const char* name, const jio_csv_column** pp_column)
+//  Remembers where parsing continues once rows are appended to the file. A row whose line did not yet end is parsed
+//  again once it does, but headers are never parsed again.
+static inline void csv_append_mark(
+        csv_append_state* append, const jio_memory_file* mem_file, const char* row_begin, const char* row_end,
+        bool is_header)
 {
-    jio_result res;
-    uint32_t idx = UINT32_MAX;
-    for (uint32_t i = 0; i < data->column_count; ++i)
+    if (!append)
     {
-        const jio_csv_column* column = data->columns + i;
-        if (jio_string_segment_equal_str(&column->header, name))
-        {
-#ifndef NDEBUG
-            assert(idx == UINT32_MAX);
-            idx = i;
-#else
-            idx = i;
-            break;
-#endif
-        }
+        return;
+    }
+    const char* const file_begin = mem_file->ptr;
+    const bool complete = row_end != file_begin + mem_file->file_size && *row_end == '\n';
+    if (complete || is_header)
+    {
+        append->offset = (row_end - file_begin) + complete;
+        append->has_partial = false;
+    }
+    else
+    {
+        append->offset = row_begin - file_begin;
+        append->has_partial = true;
     }
+}
 
-    if (idx == UINT32_MAX)
+//  Finds the beginning of the first row which begins at or after the offset
+static const char* csv_row_boundary(const jio_memory_file* mem_file, size_t offset)
+{
+    const char* const file_begin = mem_file->ptr;
+    if (offset == 0)
     {
-        JIO_ERROR(ctx, "Csv file has no header that matches \"%s\"", name);
-        res = JIO_RESULT_BAD_CSV_HEADER;
-        goto end;
+        return file_begin;
     }
+    if (offset > mem_file->file_size)
+    {
+        offset = mem_file->file_size;
+    }
+    const char* const new_line = memchr(file_begin + offset - 1, '\n', mem_file->file_size - offset + 1);
+    return new_line ? new_line + 1 : file_begin + mem_file->file_size;
+}
 
-    res = jio_csv_get_column(data, idx, pp_column);
-end:
-    return res;
+//  Moves to the row which begins at row_begin, returning false if there is no such row
+static inline bool seek_row(const char* row_begin, const char** p_row_begin, const char** p_row_end, const char* const file_end)
+{
+    if (row_begin == file_end)
+    {
+        return false;
+    }
+    const char* row_end = strchr(row_begin, '\n');
+    if (!row_end)
+    {
+        row_end = strchr(row_begin, 0);
+    }
+    *p_row_begin = row_begin;
+    *p_row_end = row_end;
+    return row_end - row_begin >= 2;
 }
 
-jio_result jio_csv_get_column_by_name_segment(
-        const jio_context* ctx, const jio_csv_data* data, const jio_string_segment* name,
-        const jio_csv_column** pp_column)
+//  Only finds where each (kept) row begins. Rows are only tokenized if they have to pass any filters.
+static jio_result parse_csv_lazy(
+        const jio_context* ctx, const jio_memory_file* mem_file, const jio_csv_parse_info* info, const char* row_begin,
+        const char* row_end, const uint32_t file_column_count, const uint32_t column_count, const uint32_t stored_count,
+        const uint32_t* slots, const csv_row_filter* filters, const char* range_begin, const char* range_end,
+        jio_csv_data* csv)
 {
     jio_result res;
-
-    uint32_t idx = UINT32_MAX;
-    for (uint32_t i = 0; i < data->column_count; ++i)
+    const char* const file_end = (const char*)mem_file->ptr + mem_file->file_size;
+    const size_t sep_len = strlen(info->separator);
+    jio_csv_column* columns = NULL;
+    jio_string_segment* row = NULL;
+    csv_deferred_state* lazy;
+    if ((res = csv_deferred_create(ctx, column_count, info->compact, mem_file, &lazy)))
+    {
+        return res;
+    }
+    lazy->sep_len = sep_len;
+    lazy->trim_whitespace = info->trim_whitespace;
+    lazy->separator = jio_alloc(ctx, sep_len + 1);
+    lazy->sources = jio_alloc(ctx, sizeof(*lazy->sources) * column_count);
+    columns = jio_alloc(ctx, sizeof(*columns) * column_count);
+    row = jio_alloc_stack(ctx, sizeof(*row) * stored_count);
+    if (!lazy->separator || !lazy->sources || !columns || !row)
+    {
+        JIO_ERROR(ctx, "Could not allocate memory for lazy csv state");
+        res = JIO_RESULT_BAD_ALLOC;
+        goto end;
+    }
+    memcpy(lazy->separator, info->separator, sep_len + 1);
+    for (uint32_t i = 0; i < file_column_count; ++i)
     {
-        const jio_csv_column* column = data->columns + i;
-        if (jio_string_segment_equal(&column->header, name))
+        const uint32_t slot = slots ? slots[i] : i;
+        if (slot < column_count)
         {
-#ifndef NDEBUG
-            assert(idx == UINT32_MAX);
-            idx = i;
-#else
-            idx = i;
-            break;
-#endif
+            lazy->sources[slot] = i;
         }
     }
+    memset(columns, 0, sizeof(*columns) * column_count);
 
-    if (idx == UINT32_MAX)
+    bool has_rows = true;
+    if (info->has_headers)
     {
-        JIO_ERROR(ctx, "Csv file has no header that matches \"%.*s\"", (int)name->len, name->begin);
-        res = JIO_RESULT_BAD_CSV_HEADER;
-        goto end;
+        if ((res = extract_row_entries(ctx, file_column_count, row_begin, row_end, info->separator, sep_len, info->trim_whitespace, row, 1, slots)))
+        {
+            JIO_ERROR(ctx, "Failed extracting the headers from CSV file \"%s\", reason: %s", mem_file->name, jio_result_to_str(res));
+            goto end;
+        }
+        for (uint32_t i = 0; i < column_count; ++i)
+        {
+            columns[i].header = row[i];
+        }
+        csv_append_mark(csv->append, mem_file, row_begin, row_end, true);
+        has_rows = advance_row(&row_begin, &row_end, file_end);
     }
 
-    res = jio_csv_get_column(data, idx, pp_column);
+    if (range_begin && range_begin > row_begin)
+    {
+        has_rows = seek_row(range_begin, &row_begin, &row_end, file_end);
+    }
 
-end:
-    return res;
-}
+    const bool has_filters = info->filter_count || info->row_filter;
+    uint32_t row_capacity = 0;
+    uint32_t row_count = 0;
+    uint32_t parsed_rows = 0;
+    while (has_rows && row_begin < range_end)
+    {
+        bool keep = true;
+        if (has_filters)
+        {
+            if ((res = extract_row_entries(ctx, file_column_count, row_begin, row_end, info->separator, sep_len, info->trim_whitespace, row, 1, slots)))
+            {
+                JIO_ERROR(ctx, "Failed parsing row %u of CSV file \"%s\", reason: %s", parsed_rows + 1, mem_file->name, jio_result_to_str(res));
+                goto end;
+            }
+            for (uint32_t i = 0; keep && i < info->filter_count; ++i)
+            {
+                keep = csv_row_filter_check(filters + i, row);
+            }
+            if (keep && info->row_filter)
+            {
+                keep = info->row_filter(column_count, row, info->row_filter_param);
+            }
+        }
+        parsed_rows += 1;
+
+        if (keep)
+        {
+            if (row_count == row_capacity)
+            {
+                const uint32_t new_capacity = row_capacity ? row_capacity * 2 : 1024;
+                const char** const new_ptr = jio_realloc(ctx, lazy->rows, sizeof(*lazy->rows) * new_capacity);
+                if (!new_ptr)
+                {
+                    JIO_ERROR(ctx, "Could not reallocate memory for csv row index");
+                    res = JIO_RESULT_BAD_ALLOC;
+                    goto end;
+                }
+                lazy->rows = new_ptr;
+                row_capacity = new_capacity;
+            }
+            lazy->rows[row_count++] = row_begin;
+            csv_append_mark(csv->append, mem_file, row_begin, row_end, false);
+        }
+
+        has_rows = advance_row(&row_begin, &row_end, file_end);
+    }
+
+    for (uint32_t i = 0; i < column_count; ++i)
+    {
+        columns[i].count = row_count;
+        columns[i].capacity = row_count;
+    }
+    csv->columns = columns;
+    csv->column_count = column_count;
+    csv->column_capacity = column_count;
+    csv->column_length = row_count;
+    csv->deferred = lazy;
+    jio_free_stack(ctx, row);
+    return JIO_RESULT_SUCCESS;
+
+end:
+    jio_free_stack(ctx, row);
+    jio_free(ctx, columns);
+    csv_deferred_release(ctx, lazy, column_count);
+    return res;
+}
+
+typedef struct csv_materialize_job_T csv_materialize_job;
+struct csv_materialize_job_T
+{
+    const csv_deferred_state* deferred;
+    uint32_t source;                        //  Column in the file to extract entries of
+    uint32_t row_count;
+    const jio_csv_compact_cell* cells;      //  Cells to expand (if NULL, entries are extracted from rows instead)
+    jio_string_segment* elements;           //  Elements to create (if NULL, compact cells are created instead)
+    jio_csv_compact_cell* out_cells;        //  Compact cells to create
+    uint32_t* failed_rows;                  //  First row which could not be extracted by each task
+};
+
+static void csv_materialize_task(void* param, uint32_t index)
+{
+    const csv_materialize_job* const job = param;
+    const csv_deferred_state* const deferred = job->deferred;
+    const uint32_t begin = index * CSV_ROWS_PER_TASK;
+    const uint32_t end = job->row_count - begin > CSV_ROWS_PER_TASK ? begin + CSV_ROWS_PER_TASK : job->row_count;
+    job->failed_rows[index] = UINT32_MAX;
+    if (job->cells)
+    {
+        for (uint32_t i = begin; i < end; ++i)
+        {
+            job->elements[i] = (jio_string_segment){.begin = deferred->base + job->cells[i].offset, .len = job->cells[i].len};
+        }
+        return;
+    }
+    for (uint32_t i = begin; i < end; ++i)
+    {
+        jio_string_segment segment;
+        if (!extract_row_entry(deferred->rows[i], job->source, deferred->separator, deferred->sep_len, deferred->trim_whitespace, &segment))
+        {
+            job->failed_rows[index] = i;
+            return;
+        }
+        if (job->elements)
+        {
+            job->elements[i] = segment;
+        }
+        else
+        {
+            job->out_cells[i] = (jio_csv_compact_cell){.offset = (uint32_t)(segment.begin - deferred->base), .len = (uint32_t)segment.len};
+        }
+    }
+}
+
+static jio_result csv_run_materialize_job(const jio_context* ctx, csv_materialize_job* job)
+{
+    const uint32_t task_count = (job->row_count + CSV_ROWS_PER_TASK - 1) / CSV_ROWS_PER_TASK;
+    job->failed_rows = jio_alloc_stack(ctx, sizeof(*job->failed_rows) * (task_count ? task_count : 1));
+    if (!job->failed_rows)
+    {
+        JIO_ERROR(ctx, "Could not allocate memory for csv column materialization");
+        return JIO_RESULT_BAD_ALLOC;
+    }
+    jio_parallel_for(ctx, task_count, csv_materialize_task, job);
+    jio_result res = JIO_RESULT_SUCCESS;
+    for (uint32_t i = 0; i < task_count; ++i)
+    {
+        if (job->failed_rows[i] != UINT32_MAX)
+        {
+            JIO_ERROR(ctx, "Row %"PRIu32" of csv data has no entry for column %"PRIu32, job->failed_rows[i] + 1, job->source + 1);
+            res = JIO_RESULT_BAD_CSV_FORMAT;
+            break;
+        }
+    }
+    jio_free_stack(ctx, job->failed_rows);
+    return res;
+}
+
+//  Creates elements of the column if they were not yet created. Data is taken as const, since this is called by
+//  accessors, which means that such data may not be accessed from multiple threads at once.
+static jio_result csv_materialize_column(const jio_csv_data* data, uint32_t index)
+{
+    csv_deferred_state* const deferred = data->deferred;
+    if (!deferred || deferred->materialized[index])
+    {
+        return JIO_RESULT_SUCCESS;
+    }
+    const jio_context* const ctx = data->ctx;
+    jio_csv_column* const column = data->columns + index;
+    jio_string_segment* const elements = jio_alloc(ctx, sizeof(*elements) * (data->column_length ? data->column_length : 1));
+    if (!elements)
+    {
+        JIO_ERROR(ctx, "Could not allocate memory for csv column elements");
+        return JIO_RESULT_BAD_ALLOC;
+    }
+
+    csv_materialize_job job =
+            {
+                    .deferred = deferred,
+                    .source = deferred->sources ? deferred->sources[index] : index,
+                    .row_count = data->column_length,
+                    .cells = deferred->cells ? deferred->cells[index] : NULL,
+                    .elements = elements,
+            };
+    const jio_result res = csv_run_materialize_job(ctx, &job);
+    if (res != JIO_RESULT_SUCCESS)
+    {
+        jio_free(ctx, elements);
+        return res;
+    }
+
+    column->elements = elements;
+    column->capacity = data->column_length ? data->column_length : 1;
+    deferred->materialized[index] = true;
+    return JIO_RESULT_SUCCESS;
+}
+
+//  Creates compact cells of the column if they were not yet created
+static jio_result csv_compact_column(const jio_csv_data* data, uint32_t index)
+{
+    csv_deferred_state* const deferred = data->deferred;
+    if (!deferred || !deferred->cells)
+    {
+        JIO_ERROR(data->ctx, "Csv data does not store compact cells");
+        return JIO_RESULT_BAD_VALUE;
+    }
+    if (deferred->cells[index])
+    {
+        return JIO_RESULT_SUCCESS;
+    }
+    const jio_context* const ctx = data->ctx;
+    jio_csv_compact_cell* const cells = jio_alloc(ctx, sizeof(*cells) * (data->column_length ? data->column_length : 1));
+    if (!cells)
+    {
+        JIO_ERROR(ctx, "Could not allocate memory for csv column cells");
+        return JIO_RESULT_BAD_ALLOC;
+    }
+    csv_materialize_job job =
+            {
+                    .deferred = deferred,
+                    .source = deferred->sources[index],
+                    .row_count = data->column_length,
+                    .out_cells = cells,
+            };
+    const jio_result res = csv_run_materialize_job(ctx, &job);
+    if (res != JIO_RESULT_SUCCESS)
+    {
+        jio_free(ctx, cells);
+        return res;
+    }
+    deferred->cells[index] = cells;
+    return JIO_RESULT_SUCCESS;
+}
+
+//  Materializes all columns and drops the deferred state, which is needed before the data is modified
+static jio_result csv_make_eager(jio_csv_data* data)
+{
+    if (!data->deferred)
+    {
+        return JIO_RESULT_SUCCESS;
+    }
+    for (uint32_t i = 0; i < data->column_count; ++i)
+    {
+        const jio_result res = csv_materialize_column(data, i);
+        if (res != JIO_RESULT_SUCCESS)
+        {
+            return res;
+        }
+    }
+    csv_deferred_release(data->ctx, data->deferred, data->column_count);
+    data->deferred = NULL;
+    return JIO_RESULT_SUCCESS;
+}
+
+static jio_result csv_materialize_all(const jio_csv_data* data)
+{
+    for (uint32_t i = 0; data->deferred && i < data->column_count; ++i)
+    {
+        const jio_result res = csv_materialize_column(data, i);
+        if (res != JIO_RESULT_SUCCESS)
+        {
+            return res;
+        }
+    }
+    return JIO_RESULT_SUCCESS;
+}
+
+//  Builds columns of csv data by appending rows directly to each column, which grow geometrically
+typedef struct csv_builder_T csv_builder;
+struct csv_builder_T
+{
+    uint32_t column_count;                  //  Number of columns built
+    uint32_t row_count;                     //  Number of rows appended
+    uint32_t row_capacity;                  //  Number of rows there is space for in each column
+    const char* base;                       //  Base of compact cells (NULL if elements are built instead)
+    jio_string_segment** elements;          //  Elements of each column
+    jio_csv_compact_cell** cells;           //  Compact cells of each column
+};
+
+static void csv_builder_release(const jio_context* ctx, csv_builder* builder)
+{
+    for (uint32_t i = 0; i < builder->column_count; ++i)
+    {
+        if (builder->elements)
+        {
+            jio_free(ctx, builder->elements[i]);
+        }
+        if (builder->cells)
+        {
+            jio_free(ctx, builder->cells[i]);
+        }
+    }
+    jio_free(ctx, builder->elements);
+    jio_free(ctx, builder->cells);
+    memset(builder, 0, sizeof(*builder));
+}
+
+static jio_result csv_builder_create(
+        const jio_context* ctx, uint32_t column_count, const char* compact_base, csv_builder* builder)
+{
+    memset(builder, 0, sizeof(*builder));
+    builder->base = compact_base;
+    void* ptr;
+    if (compact_base)
+    {
+        ptr = builder->cells = jio_alloc(ctx, sizeof(*builder->cells) * (column_count ? column_count : 1));
+    }
+    else
+    {
+        ptr = builder->elements = jio_alloc(ctx, sizeof(*builder->elements) * (column_count ? column_count : 1));
+    }
+    if (!ptr)
+    {
+        JIO_ERROR(ctx, "Could not allocate memory for csv columns");
+        return JIO_RESULT_BAD_ALLOC;
+    }
+    memset(ptr, 0, sizeof(void*) * column_count);
+    builder->column_count = column_count;
+    return JIO_RESULT_SUCCESS;
+}
+
+//  Reallocates one column of the builder, which is left as it was if that fails
+static bool csv_builder_resize_column(const jio_context* ctx, csv_builder* builder, uint32_t column, uint32_t capacity)
+{
+    void* new_ptr;
+    if (builder->cells)
+    {
+        new_ptr = jio_realloc(ctx, builder->cells[column], sizeof(**builder->cells) * capacity);
+        if (new_ptr)
+        {
+            builder->cells[column] = new_ptr;
+        }
+    }
+    else
+    {
+        new_ptr = jio_realloc(ctx, builder->elements[column], sizeof(**builder->elements) * capacity);
+        if (new_ptr)
+        {
+            builder->elements[column] = new_ptr;
+        }
+    }
+    return new_ptr != NULL;
+}
+
+static jio_result csv_builder_reserve(const jio_context* ctx, csv_builder* builder, uint32_t capacity)
+{
+    //  If a reallocation fails, columns which were already reallocated just have more space than they need
+    assert(capacity >= builder->row_capacity);
+    for (uint32_t i = 0; i < builder->column_count; ++i)
+    {
+        if (!csv_builder_resize_column(ctx, builder, i, capacity))
+        {
+            JIO_ERROR(ctx, "Could not reallocate memory for csv column to fit %"PRIu32" rows", capacity);
+            return JIO_RESULT_BAD_ALLOC;
+        }
+    }
+    builder->row_capacity = capacity;
+    return JIO_RESULT_SUCCESS;
+}
+
+static inline jio_result csv_builder_append(const jio_context* ctx, csv_builder* builder, const jio_string_segment* row)
+{
+    if (builder->row_count == builder->row_capacity)
+    {
+        if (builder->row_capacity == UINT32_MAX)
+        {
+            JIO_ERROR(ctx, "Csv data can not have more than %"PRIu32" rows", UINT32_MAX);
+            return JIO_RESULT_BAD_ALLOC;
+        }
+        uint32_t new_capacity = builder->row_capacity ? builder->row_capacity * 2 : 64;
+        if (new_capacity < builder->row_capacity)
+        {
+            new_capacity = UINT32_MAX;
+        }
+        const jio_result res = csv_builder_reserve(ctx, builder, new_capacity);
+        if (res != JIO_RESULT_SUCCESS)
+        {
+            return res;
+        }
+    }
+
+    const uint32_t idx = builder->row_count;
+    if (builder->cells)
+    {
+        for (uint32_t i = 0; i < builder->column_count; ++i)
+        {
+            builder->cells[i][idx] = (jio_csv_compact_cell){.offset = (uint32_t)(row[i].begin - builder->base), .len = (uint32_t)row[i].len};
+        }
+    }
+    else
+    {
+        for (uint32_t i = 0; i < builder->column_count; ++i)
+        {
+            builder->elements[i][idx] = row[i];
+        }
+    }
+    builder->row_count = idx + 1;
+    return JIO_RESULT_SUCCESS;
+}
+
+//  Shrinks the columns to only take up the space they need
+static void csv_builder_trim(const jio_context* ctx, csv_builder* builder)
+{
+    const uint32_t capacity = builder->row_count ? builder->row_count : 1;
+    if (capacity == builder->row_capacity)
+    {
+        return;
+    }
+    //  Column which could not be shrunk keeps more space than it needs, so every column still fits the new capacity
+    for (uint32_t i = 0; i < builder->column_count; ++i)
+    {
+        (void)csv_builder_resize_column(ctx, builder, i, capacity);
+    }
+    builder->row_capacity = capacity;
+}
+
+jio_result jio_parse_csv(
+        const jio_context* ctx, const jio_memory_file* mem_file, const char* separator, bool trim_whitespace,
+        bool has_headers, jio_csv_data** pp_csv)
+{
+    const jio_csv_parse_info info =
+            {
+                    .separator = separator,
+                    .trim_whitespace = trim_whitespace,
+                    .has_headers = has_headers,
+            };
+    return jio_parse_csv_ex(ctx, mem_file, &info, pp_csv);
+}
+
+struct jio_csv_parser_T
+{
+    const jio_context* ctx;
+    const jio_memory_file* mem_file;
+    jio_csv_parse_info info;                //  Copy of the parse info
+    jio_csv_data* csv;                      //  Data which is being parsed
+    jio_csv_column* columns;                //  Columns of the data
+    csv_deferred_state* compact;            //  State of compact data (NULL if data is not compact)
+    csv_builder builder;                    //  Builder of the columns
+    uint32_t* slots;                        //  Position of each column of the file in a row (NULL if all are kept)
+    csv_row_filter* filters;                //  Compiled filters
+    jio_string_segment* row;                //  Entries of the row being parsed
+    size_t sep_len;
+    uint32_t file_column_count;             //  Number of columns in the file
+    uint32_t column_count;                  //  Number of columns kept
+    uint32_t stored_count;                  //  Number of entries stored for each row
+    const char* row_begin;                  //  Beginning of the next row to parse
+    const char* row_end;                    //  End of the next row to parse
+    const char* range_end;                  //  Rows which begin at or after this are not parsed
+    bool has_rows;                          //  Are there more rows to parse
+    const char* parsed_end;                 //  End of the last row which was parsed, including its new line
+    uint32_t parsed_rows;                   //  Number of rows parsed so far (including the header)
+    jio_result status;                      //  Error which stopped parsing (success if there was none)
+};
+
+void jio_csv_parser_destroy(jio_csv_parser* parser)
+{
+    const jio_context* const ctx = parser->ctx;
+    csv_builder_release(ctx, &parser->builder);
+    if (parser->compact)
+    {
+        csv_deferred_release(ctx, parser->compact, parser->column_count);
+    }
+    if (parser->csv)
+    {
+        if (parser->csv->append)
+        {
+            csv_append_state_release(ctx, parser->csv->append);
+        }
+        jio_free(ctx, parser->csv);
+    }
+    jio_free(ctx, parser->columns);
+    jio_free(ctx, parser->row);
+    jio_free(ctx, parser->slots);
+    jio_free(ctx, parser->filters);
+    jio_free(ctx, parser);
+}
+
+//  Finds the columns of the file and parses the header. Lazy parsing only uses what is found here, while other parsing
+//  also prepares the columns.
+static jio_result csv_parser_create(
+        const jio_context* ctx, const jio_memory_file* mem_file, const jio_csv_parse_info* info,
+        jio_csv_parser** pp_parser)
+{
+    jio_result res;
+    jio_csv_parser* const parser = jio_alloc(ctx, sizeof(*parser));
+    if (!parser)
+    {
+        JIO_ERROR(ctx, "Could not allocate memory for csv parser");
+        return JIO_RESULT_BAD_ALLOC;
+    }
+    memset(parser, 0, sizeof(*parser));
+    parser->ctx = ctx;
+    parser->mem_file = mem_file;
+    parser->info = *info;
+    const char* const separator = info->separator;
+    jio_csv_data* const csv = jio_alloc(ctx, sizeof(*csv));
+    if (!csv)
+    {
+        res = JIO_RESULT_BAD_ALLOC;
+        goto end;
+    }
+
+    memset(csv, 0, sizeof(*csv));
+    csv->ctx = ctx;
+    parser->csv = csv;
+
+    //  Parse the first row
+    const char* row_begin = mem_file->ptr;
+    const char* row_end = strchr(row_begin, '\n');
+    if (!row_end)
+    {
+        row_end = strchr(row_begin, 0);
+    }
+
+    //  Count columns in the csv file
+    const size_t sep_len = strlen(separator);
+    const uint32_t file_column_count = count_row_entries(row_begin, row_end, separator, sep_len);
+    parser->sep_len = sep_len;
+    parser->file_column_count = file_column_count;
+
+    //  Find which columns are kept and which are needed by filters. Each parsed row stores stored_count entries, of
+    //  which the first column_count are kept
+    const uint32_t column_count = info->selected_count ? info->selected_count : file_column_count;
+    uint32_t stored_count = column_count;
+    if (info->selected_count || info->filter_count)
+    {
+        if (info->selected_count && !info->selected_indices && !info->selected_names)
+        {
+            JIO_ERROR(ctx, "Column selection was requested, but neither indices nor names were given");
+            res = JIO_RESULT_BAD_PTR;
+            goto end;
+        }
+        parser->slots = jio_alloc(ctx, sizeof(*parser->slots) * file_column_count);
+        if (info->filter_count)
+        {
+            parser->filters = jio_alloc(ctx, sizeof(*parser->filters) * info->filter_count);
+        }
+        if (!parser->slots || (info->filter_count && !parser->filters))
+        {
+            res = JIO_RESULT_BAD_ALLOC;
+            JIO_ERROR(ctx, "Could not allocate memory for csv column selection");
+            goto end;
+        }
+        if ((res = resolve_column_slots(ctx, info, row_begin, row_end, file_column_count, sep_len, parser->slots, parser->filters, &stored_count)))
+        {
+            goto end;
+        }
+    }
+    parser->column_count = column_count;
+    parser->stored_count = stored_count;
+    parser->row_begin = row_begin;
+    parser->row_end = row_end;
+    parser->parsed_end = row_begin;
+    parser->range_end = (const char*)mem_file->ptr + mem_file->file_size;
+
+    //  Rows appended to the file can only be parsed later if no filters have to be applied to them
+    if (!info->filter_count && !info->row_filter
+        && (res = csv_append_state_create(ctx, info, file_column_count, column_count, parser->slots, &csv->append)))
+    {
+        goto end;
+    }
+    if (info->lazy)
+    {
+        *pp_parser = parser;
+        return JIO_RESULT_SUCCESS;
+    }
+
+    //  Compact data keeps offsets and lengths of entries only, elements are created when they are first accessed
+    if (info->compact && (res = csv_deferred_create(ctx, column_count, true, mem_file, &parser->compact)))
+    {
+        goto end;
+    }
+    //  Rows are tokenized into a single row buffer, from which the kept entries are appended directly to their columns
+    parser->row = jio_alloc(ctx, sizeof(*parser->row) * (stored_count ? stored_count : 1));
+    parser->columns = jio_alloc(ctx, sizeof(*parser->columns) * (column_count ? column_count : 1));
+    if (!parser->row || !parser->columns)
+    {
+        res = JIO_RESULT_BAD_ALLOC;
+        JIO_ERROR(ctx, "Could not allocate memory for csv parsing");
+        goto end;
+    }
+    memset(parser->columns, 0, sizeof(*parser->columns) * column_count);
+    if ((res = csv_builder_create(ctx, column_count, parser->compact ? mem_file->ptr : NULL, &parser->builder)))
+    {
+        goto end;
+    }
+
+    const char* const file_end = (const char*)mem_file->ptr + mem_file->file_size;
+    parser->has_rows = true;
+    if (info->has_headers)
+    {
+        if ((res = extract_row_entries(ctx, file_column_count, row_begin, row_end, separator, sep_len, info->trim_whitespace, parser->row, 1, parser->slots)))
+        {
+            JIO_ERROR(ctx, "Failed extracting the headers from CSV file \"%s\", reason: %s", mem_file->name, jio_result_to_str(res));
+            goto end;
+        }
+        for (uint32_t i = 0; i < column_count; ++i)
+        {
+            parser->columns[i].header = parser->row[i];
+        }
+        csv_append_mark(csv->append, mem_file, row_begin, row_end, true);
+        parser->parsed_rows += 1;
+        parser->parsed_end = row_after(row_end, file_end);
+        parser->has_rows = advance_row(&parser->row_begin, &parser->row_end, file_end);
+    }
+
+    *pp_parser = parser;
+    return JIO_RESULT_SUCCESS;
+
+end:
+    jio_csv_parser_destroy(parser);
+    return res;
+}
+
+jio_result jio_csv_parser_create(
+        const jio_context* ctx, const jio_memory_file* mem_file, const jio_csv_parse_info* info,
+        jio_csv_parser** pp_parser)
+{
+    if (info->lazy)
+    {
+        JIO_ERROR(ctx, "Lazy parsing only finds where rows begin, so it can not be done in steps");
+        return JIO_RESULT_BAD_VALUE;
+    }
+    return csv_parser_create(ctx, mem_file, info, pp_parser);
+}
+
+//  Extracts the entries of the row the parser is at into p_out with a stride, counting the row as parsed. This is the
+//  row loop which is shared by the parser and block processing, the latter giving a column-major buffer.
+static jio_result csv_parser_extract_row(jio_csv_parser* parser, jio_string_segment* p_out, size_t stride)
+{
+    const jio_context* const ctx = parser->ctx;
+    const jio_memory_file* const mem_file = parser->mem_file;
+    const jio_csv_parse_info* const info = &parser->info;
+    const jio_result res = extract_row_entries(
+            ctx, parser->file_column_count, parser->row_begin, parser->row_end, info->separator, parser->sep_len,
+            info->trim_whitespace, p_out, stride, parser->slots);
+    if (res)
+    {
+        JIO_ERROR(ctx, "Failed parsing row %u of CSV file \"%s\", reason: %s", parser->parsed_rows + 1, mem_file->name, jio_result_to_str(res));
+        return res;
+    }
+    parser->parsed_rows += 1;
+    parser->parsed_end = row_after(parser->row_end, (const char*)mem_file->ptr + mem_file->file_size);
+    return JIO_RESULT_SUCCESS;
+}
+
+//  Moves the parser past the row it is at
+static void csv_parser_advance(jio_csv_parser* parser)
+{
+    const char* const file_end = (const char*)parser->mem_file->ptr + parser->mem_file->file_size;
+    parser->has_rows = advance_row(&parser->row_begin, &parser->row_end, file_end);
+}
+
+jio_result jio_csv_parser_step(jio_csv_parser* parser, size_t byte_budget, uint32_t row_budget, bool* p_done)
+{
+    if (parser->status != JIO_RESULT_SUCCESS)
+    {
+        return parser->status;
+    }
+    const jio_context* const ctx = parser->ctx;
+    const jio_memory_file* const mem_file = parser->mem_file;
+    const jio_csv_parse_info* const info = &parser->info;
+    //  Budgets are checked before each row, so the last row of a step may go over the byte budget
+    const char* byte_limit = parser->range_end;
+    if (byte_budget && parser->row_begin < byte_limit && (size_t)(byte_limit - parser->row_begin) > byte_budget)
+    {
+        byte_limit = parser->row_begin + byte_budget;
+    }
+    const uint32_t row_limit = row_budget && UINT32_MAX - parser->parsed_rows > row_budget ? parser->parsed_rows + row_budget : UINT32_MAX;
+    jio_string_segment* const row = parser->row;
+    jio_result res = JIO_RESULT_SUCCESS;
+
+    while (parser->has_rows && parser->row_begin < byte_limit && parser->parsed_rows < row_limit)
+    {
+        if ((res = csv_parser_extract_row(parser, row, 1)))
+        {
+            break;
+        }
+
+        //  Rejected rows are never stored
+        bool keep = true;
+        for (uint32_t i = 0; keep && i < info->filter_count; ++i)
+        {
+            keep = csv_row_filter_check(parser->filters + i, row);
+        }
+        if (keep && info->row_filter)
+        {
+            keep = info->row_filter(parser->column_count, row, info->row_filter_param);
+        }
+        if (keep && (res = csv_builder_append(ctx, &parser->builder, row)))
+        {
+            JIO_ERROR(ctx, "Failed storing row %u of CSV file \"%s\", reason: %s", parser->parsed_rows, mem_file->name, jio_result_to_str(res));
+            break;
+        }
+        if (keep)
+        {
+            csv_append_mark(parser->csv->append, mem_file, parser->row_begin, parser->row_end, false);
+        }
+
+        csv_parser_advance(parser);
+    }
+    if (parser->row_begin >= parser->range_end)
+    {
+        parser->has_rows = false;
+    }
+
+    parser->status = res;
+    *p_done = !parser->has_rows;
+    return res;
+}
+
+void jio_csv_parser_progress(const jio_csv_parser* parser, size_t* p_offset, uint32_t* p_rows)
+{
+    if (p_offset)
+    {
+        //  Once all rows were parsed, parsing stopped after the last of them, not at the end of the mapped file
+        const char* const offset = parser->has_rows ? parser->row_begin : parser->parsed_end;
+        *p_offset = (size_t)(offset - (const char*)parser->mem_file->ptr);
+    }
+    if (p_rows)
+    {
+        *p_rows = parser->builder.row_count;
+    }
+}
+
+jio_result jio_csv_parser_finish(jio_csv_parser* parser, jio_csv_data** pp_csv)
+{
+    bool done = !parser->has_rows;
+    jio_result res = parser->status;
+    while (res == JIO_RESULT_SUCCESS && !done)
+    {
+        res = jio_csv_parser_step(parser, 0, 0, &done);
+    }
+    if (res != JIO_RESULT_SUCCESS)
+    {
+        jio_csv_parser_destroy(parser);
+        return res;
+    }
+
+    //  Columns get the memory of the builder
+    const jio_context* const ctx = parser->ctx;
+    csv_builder* const builder = &parser->builder;
+    jio_csv_data* const csv = parser->csv;
+    csv_builder_trim(ctx, builder);
+    for (uint32_t i = 0; i < parser->column_count; ++i)
+    {
+        jio_csv_column* const p_column = parser->columns + i;
+        p_column->count = builder->row_count;
+        p_column->capacity = builder->row_capacity;
+        if (parser->compact)
+        {
+            parser->compact->cells[i] = builder->cells[i];
+            builder->cells[i] = NULL;
+        }
+        else
+        {
+            p_column->elements = builder->elements[i];
+            builder->elements[i] = NULL;
+        }
+    }
+    csv->column_count = parser->column_count;
+    csv->column_capacity = parser->column_count;
+    csv->column_length = builder->row_count;
+    csv->columns = parser->columns;
+    csv->deferred = parser->compact;
+    parser->columns = NULL;
+    parser->compact = NULL;
+    parser->csv = NULL;
+    jio_csv_parser_destroy(parser);
+
+    *pp_csv = csv;
+    return JIO_RESULT_SUCCESS;
+}
+
+jio_result jio_parse_csv_ex(
+        const jio_context* ctx, const jio_memory_file* mem_file, const jio_csv_parse_info* info, jio_csv_data** pp_csv)
+{
+    jio_csv_parser* parser;
+    jio_result res = csv_parser_create(ctx, mem_file, info, &parser);
+    if (res != JIO_RESULT_SUCCESS)
+    {
+        return res;
+    }
+    if (!info->lazy)
+    {
+        return jio_csv_parser_finish(parser, pp_csv);
+    }
+
+    if ((res = parse_csv_lazy(ctx, mem_file, info, parser->row_begin, parser->row_end, parser->file_column_count, parser->column_count, parser->stored_count, parser->slots, parser->filters, NULL, parser->range_end, parser->csv)) == JIO_RESULT_SUCCESS)
+    {
+        *pp_csv = parser->csv;
+        parser->csv = NULL;
+    }
+    jio_csv_parser_destroy(parser);
+    return res;
+}
+
+jio_result jio_parse_csv_range(
+        const jio_context* ctx, const jio_memory_file* mem_file, size_t begin_offset, size_t end_offset,
+        const jio_csv_parse_info* info, jio_csv_data** pp_csv)
+{
+    if (begin_offset > end_offset)
+    {
+        JIO_ERROR(ctx, "Range of csv file to parse begins at %zu, which is after its end at %zu", begin_offset, end_offset);
+        return JIO_RESULT_BAD_INDEX;
+    }
+    jio_csv_parser* parser;
+    jio_result res = csv_parser_create(ctx, mem_file, info, &parser);
+    if (res != JIO_RESULT_SUCCESS)
+    {
+        return res;
+    }
+    //  Rows appended to the file would not belong to the range
+    if (parser->csv->append)
+    {
+        csv_append_state_release(ctx, parser->csv->append);
+        parser->csv->append = NULL;
+    }
+    const char* const file_end = (const char*)mem_file->ptr + mem_file->file_size;
+    const char* const range_begin = csv_row_boundary(mem_file, begin_offset);
+    parser->range_end = csv_row_boundary(mem_file, end_offset);
+    if (info->lazy)
+    {
+        if ((res = parse_csv_lazy(ctx, mem_file, info, parser->row_begin, parser->row_end, parser->file_column_count, parser->column_count, parser->stored_count, parser->slots, parser->filters, range_begin, parser->range_end, parser->csv)) == JIO_RESULT_SUCCESS)
+        {
+            *pp_csv = parser->csv;
+            parser->csv = NULL;
+        }
+        jio_csv_parser_destroy(parser);
+        return res;
+    }
+
+    //  Header was already parsed by the parser, so it is only moved to the range if it is past it
+    if (range_begin > parser->row_begin)
+    {
+        parser->has_rows = seek_row(range_begin, &parser->row_begin, &parser->row_end, file_end);
+    }
+    return jio_csv_parser_finish(parser, pp_csv);
+}
+
+static uint32_t csv_share_slot(const jio_csv_data* data, const jio_string_segment* elements)
+{
+    //  Fibonacci hashing of the address
+    return (uint32_t)(((uint64_t)(uintptr_t)elements >> 4) * 0x9E3779B97F4A7C15 >> 32) & (data->share_capacity - 1);
+}
+
+static csv_shared_elements* csv_share_find(const jio_csv_data* data, const jio_string_segment* elements)
+{
+    if (!data->share_count)
+    {
+        return NULL;
+    }
+    const uint32_t mask = data->share_capacity - 1;
+    for (uint32_t slot = csv_share_slot(data, elements); data->shares[slot]; slot = (slot + 1) & mask)
+    {
+        if (data->shares[slot]->elements == elements)
+        {
+            return data->shares[slot];
+        }
+    }
+    return NULL;
+}
+
+//  Makes sure the table has room for count more shared arrays
+static jio_result csv_share_reserve(jio_csv_data* data, uint32_t count)
+{
+    if (2 * ((uint64_t)data->share_count + count) <= data->share_capacity)
+    {
+        return JIO_RESULT_SUCCESS;
+    }
+    uint32_t new_capacity = data->share_capacity ? data->share_capacity : 16;
+    while (new_capacity < 2 * ((uint64_t)data->share_count + count))
+    {
+        new_capacity <<= 1;
+    }
+    csv_shared_elements** const new_shares = jio_alloc(data->ctx, sizeof(*new_shares) * new_capacity);
+    if (!new_shares)
+    {
+        JIO_ERROR(data->ctx, "Could not allocate memory for table of shared csv elements");
+        return JIO_RESULT_BAD_ALLOC;
+    }
+    memset(new_shares, 0, sizeof(*new_shares) * new_capacity);
+    csv_shared_elements** const old_shares = data->shares;
+    const uint32_t old_capacity = data->share_capacity;
+    data->shares = new_shares;
+    data->share_capacity = new_capacity;
+    for (uint32_t i = 0; i < old_capacity; ++i)
+    {
+        if (!old_shares[i])
+        {
+            continue;
+        }
+        uint32_t slot = csv_share_slot(data, old_shares[i]->elements);
+        while (new_shares[slot])
+        {
+            slot = (slot + 1) & (new_capacity - 1);
+        }
+        new_shares[slot] = old_shares[i];
+    }
+    jio_free(data->ctx, old_shares);
+    return JIO_RESULT_SUCCESS;
+}
+
+//  Gives up the data's reference to the shared array. If no snapshot uses it anymore, it is freed unless it is kept.
+static void csv_share_drop(jio_csv_data* data, csv_shared_elements* share, bool keep_elements)
+{
+    const uint32_t mask = data->share_capacity - 1;
+    uint32_t slot = csv_share_slot(data, share->elements);
+    while (data->shares[slot] != share)
+    {
+        slot = (slot + 1) & mask;
+    }
+    data->shares[slot] = NULL;
+    data->share_count -= 1;
+    //  Later entries of the same cluster are moved back, so that they can still be found without tombstones
+    for (uint32_t next = (slot + 1) & mask; data->shares[next]; next = (next + 1) & mask)
+    {
+        const uint32_t home = csv_share_slot(data, data->shares[next]->elements);
+        if (((next - home) & mask) >= ((next - slot) & mask))
+        {
+            data->shares[slot] = data->shares[next];
+            data->shares[next] = NULL;
+            slot = next;
+        }
+    }
+    if (jio_atomic_decrement(&share->ref_count) == 0)
+    {
+        if (!keep_elements)
+        {
+            jio_free(data->ctx, share->elements);
+        }
+        jio_free(data->ctx, share);
+    }
+}
+
+//  Snapshot holds data of its own, whose columns share element arrays with the data it was taken of. Arrays of the data
+//  are copied by the editor before elements which the snapshot can see are changed, so the snapshot never changes.
+struct jio_csv_snapshot_T
+{
+    jio_csv_data data;
+    csv_shared_elements** shares;           //  Shared array of each column
+    jio_csv_data* source;                   //  Data which the snapshot was taken of
+    jio_csv_snapshot* next_released;        //  Next snapshot destroyed before this one, which is not yet freed
+};
+
+static void csv_snapshot_free(jio_csv_snapshot* snapshot)
+{
+    const jio_context* const ctx = snapshot->data.ctx;
+    for (uint32_t i = 0; i < snapshot->data.column_count; ++i)
+    {
+        csv_shared_elements* const share = snapshot->shares[i];
+        if (jio_atomic_decrement(&share->ref_count) == 0)
+        {
+            jio_free(ctx, share->elements);
+            jio_free(ctx, share);
+        }
+    }
+    jio_free(ctx, snapshot->data.header_index.slots);
+    jio_free(ctx, snapshot->data.stats);
+    jio_free(ctx, snapshot->data.columns);
+    jio_free(ctx, snapshot->shares);
+    jio_free(ctx, snapshot);
+}
+
+//  Frees snapshots which were destroyed since the last call. Snapshots can be destroyed by any thread, but allocators
+//  of the context may only be used by the thread which modifies the data, so destroying a snapshot only hands it back.
+static void csv_snapshots_collect(jio_csv_data* data)
+{
+    jio_csv_snapshot* snapshot = jio_atomic_exchange_pointer(&data->released_snapshots, NULL);
+    while (snapshot)
+    {
+        jio_csv_snapshot* const next = snapshot->next_released;
+        csv_snapshot_free(snapshot);
+        snapshot = next;
+    }
+}
+
+//  Replaces elements of the column with a private copy, leaving the shared array to snapshots
+static jio_result csv_column_unshare(jio_csv_data* data, uint32_t column, csv_shared_elements* share, uint32_t capacity)
+{
+    jio_csv_column* const col = data->columns + column;
+    jio_string_segment* const elements = jio_alloc(data->ctx, sizeof(*elements) * capacity);
+    if (!elements)
+    {
+        JIO_ERROR(data->ctx, "Could not copy elements of column %"PRIu32" shared with a snapshot", column);
+        return JIO_RESULT_BAD_ALLOC;
+    }
+    memcpy(elements, col->elements, sizeof(*elements) * col->count);
+    col->elements = elements;
+    col->capacity = capacity;
+    csv_share_drop(data, share, false);
+    return JIO_RESULT_SUCCESS;
+}
+
+//  Makes sure elements of the column from first onwards can be changed in place, copying them if snapshots can see them.
+//  Snapshots can only be taken by the thread which modifies the data, so a reference count of one can not grow.
+static jio_result csv_column_prepare(jio_csv_data* data, uint32_t column, uint32_t first)
+{
+    csv_snapshots_collect(data);
+    csv_shared_elements* const share = csv_share_find(data, data->columns[column].elements);
+    if (!share || first >= share->frozen_count)
+    {
+        return JIO_RESULT_SUCCESS;
+    }
+    if (jio_atomic_load(&share->ref_count) == 1)
+    {
+        csv_share_drop(data, share, true);
+        return JIO_RESULT_SUCCESS;
+    }
+    return csv_column_unshare(data, column, share, data->columns[column].capacity);
+}
+
+//  Reallocates elements of the column, or copies them if they are shared
+static jio_result csv_column_resize(jio_csv_data* data, uint32_t column, uint32_t capacity)
+{
+    csv_snapshots_collect(data);
+    jio_csv_column* const col = data->columns + column;
+    csv_shared_elements* const share = csv_share_find(data, col->elements);
+    if (share && jio_atomic_load(&share->ref_count) > 1)
+    {
+        return csv_column_unshare(data, column, share, capacity);
+    }
+    if (share)
+    {
+        csv_share_drop(data, share, true);
+    }
+    jio_string_segment* const new_ptr = jio_realloc(data->ctx, col->elements, sizeof(*new_ptr) * capacity);
+    if (!new_ptr)
+    {
+        return JIO_RESULT_BAD_ALLOC;
+    }
+    col->elements = new_ptr;
+    col->capacity = capacity;
+    return JIO_RESULT_SUCCESS;
+}
+
+//  Frees elements which the data no longer uses, unless snapshots still do
+static void csv_elements_release(jio_csv_data* data, jio_string_segment* elements)
+{
+    csv_snapshots_collect(data);
+    csv_shared_elements* const share = csv_share_find(data, elements);
+    if (share)
+    {
+        csv_share_drop(data, share, false);
+    }
+    else
+    {
+        jio_free(data->ctx, elements);
+    }
+}
+
+static void csv_string_arena_release(const jio_context* ctx, csv_string_arena* arena)
+{
+    csv_arena_block* block = arena->current;
+    while (block)
+    {
+        csv_arena_block* const prev = block->prev;
+        jio_free(ctx, block);
+        block = prev;
+    }
+    jio_free(ctx, arena->table);
+    jio_free(ctx, arena);
+}
+
+void jio_csv_release(const jio_context* ctx, jio_csv_data* data)
+{
+    csv_snapshots_collect(data);
+    for (unsigned i = 0; i < data->column_count; ++i)
+    {
+        csv_elements_release(data, data->columns[i].elements);
+    }
+    jio_free(ctx, data->shares);
+    if (data->deferred)
+    {
+        csv_deferred_release(ctx, data->deferred, data->column_count);
+    }
+    if (data->arena)
+    {
+        csv_string_arena_release(ctx, data->arena);
+    }
+    jio_free(ctx, data->header_index.slots);
+    jio_free(ctx, data->stats);
+    if (data->snapshot_file)
+    {
+        jio_memory_file_destroy(data->snapshot_file);
+    }
+    if (data->append)
+    {
+        csv_append_state_release(ctx, data->append);
+    }
+    while (data->indices)
+    {
+        jio_csv_index* const index = data->indices;
+        data->indices = index->next_index;
+        jio_free(ctx, index->slots);
+        jio_free(ctx, index->next);
+        jio_free(ctx, index);
+    }
+
+    jio_free(ctx, data->columns);
+    jio_free(ctx, data);
+}
+
+void jio_csv_shape(const jio_csv_data* data, uint32_t* p_rows, uint32_t* p_cols)
+{
+    if (p_rows)
+    {
+        *p_rows = data->column_length;
+    }
+    if (p_cols)
+    {
+        *p_cols = data->column_count;
+    }
+}
+
+//  View holds data of its own, whose columns point into elements of the viewed data, so that every function which takes
+//  const data works on views as well. Only caches (stats and the header index) are ever allocated for it.
+struct jio_csv_view_T
+{
+    jio_csv_data data;
+};
+
+jio_result jio_csv_view_create(
+        const jio_context* ctx, const jio_csv_data* data, uint32_t first_row, uint32_t row_count, uint32_t first_column,
+        uint32_t column_count, jio_csv_view** pp_view)
+{
+    if (first_row > data->column_length || data->column_length - first_row < row_count
+        || first_column > data->column_count || data->column_count - first_column < column_count)
+    {
+        JIO_ERROR(ctx, "View of rows [%"PRIu32", %"PRIu32") and columns [%"PRIu32", %"PRIu32") does not fit csv data with %u rows and %u columns",
+                  first_row, first_row + row_count, first_column, first_column + column_count, data->column_length, data->column_count);
+        return JIO_RESULT_BAD_INDEX;
+    }
+    jio_result res;
+    for (uint32_t i = 0; i < column_count; ++i)
+    {
+        if ((res = csv_materialize_column(data, first_column + i)))
+        {
+            return res;
+        }
+    }
+    jio_csv_view* const view = jio_alloc(ctx, sizeof(*view));
+    jio_csv_column* const columns = jio_alloc(ctx, sizeof(*columns) * (column_count ? column_count : 1));
+    if (!view || !columns)
+    {
+        jio_free(ctx, view);
+        jio_free(ctx, columns);
+        JIO_ERROR(ctx, "Could not allocate memory for csv view");
+        return JIO_RESULT_BAD_ALLOC;
+    }
+    memset(view, 0, sizeof(*view));
+    for (uint32_t i = 0; i < column_count; ++i)
+    {
+        const jio_csv_column* const column = data->columns + first_column + i;
+        columns[i].header = column->header;
+        columns[i].count = row_count;
+        columns[i].capacity = row_count;
+        columns[i].elements = column->elements + first_row;
+    }
+    view->data.column_capacity = column_count;
+    view->data.column_count = column_count;
+    view->data.column_length = row_count;
+    view->data.columns = columns;
+    view->data.ctx = ctx;
+    view->data.case_insensitive_headers = data->case_insensitive_headers;
+    *pp_view = view;
+    return JIO_RESULT_SUCCESS;
+}
+
+const jio_csv_data* jio_csv_view_data(const jio_csv_view* view)
+{
+    return &view->data;
+}
+
+void jio_csv_view_destroy(jio_csv_view* view)
+{
+    const jio_context* const ctx = view->data.ctx;
+    jio_free(ctx, view->data.header_index.slots);
+    jio_free(ctx, view->data.stats);
+    jio_free(ctx, view->data.columns);
+    jio_free(ctx, view);
+}
+
+jio_result jio_csv_get_column(const jio_csv_data* data, uint32_t index, const jio_csv_column** pp_column)
+{
+    if (data->column_count <= index)
+    {
+        return JIO_RESULT_BAD_INDEX;
+    }
+    const jio_result res = csv_materialize_column(data, index);
+    if (res != JIO_RESULT_SUCCESS)
+    {
+        return res;
+    }
+    *pp_column = data->columns + index;
+    return JIO_RESULT_SUCCESS;
+}
+
+jio_result jio_csv_get_compact_column(const jio_csv_data* data, uint32_t index, jio_csv_compact_column* p_column)
+{
+    if (data->column_count <= index)
+    {
+        return JIO_RESULT_BAD_INDEX;
+    }
+    const jio_result res = csv_compact_column(data, index);
+    if (res != JIO_RESULT_SUCCESS)
+    {
+        return res;
+    }
+    *p_column = (jio_csv_compact_column)
+            {
+                    .header = data->columns[index].header,
+                    .count = data->column_length,
+                    .base = data->deferred->base,
+                    .cells = data->deferred->cells[index],
+            };
+    return JIO_RESULT_SUCCESS;
+}
+
+void jio_csv_compact_expand(const jio_csv_compact_column* column, uint32_t begin, uint32_t count, jio_string_segment* out)
+{
+    const jio_csv_compact_cell* const cells = column->cells + begin;
+    const char* const base = column->base;
+    for (uint32_t i = 0; i < count; ++i)
+    {
+        out[i] = (jio_string_segment){.begin = base + cells[i].offset, .len = cells[i].len};
+    }
+}
+
+static uint32_t csv_header_index_hash(const jio_csv_data* data, const char* str, size_t len)
+{
+    return (uint32_t)(data->case_insensitive_headers ? csv_string_hash_case(str, len) : csv_string_hash(str, len));
+}
+
+//  Adds the column to the index, unless a column with the same header is already in it
+static void csv_header_index_insert(const jio_csv_data* data, csv_header_index* index, uint32_t column_idx)
+{
+    const jio_string_segment* const header = &data->columns[column_idx].header;
+    uint32_t slot = csv_header_index_hash(data, header->begin, header->len) & (index->capacity - 1);
+    for (; index->slots[slot]; slot = (slot + 1) & (index->capacity - 1))
+    {
+        const jio_string_segment* const other = &data->columns[index->slots[slot] - 1].header;
+        if (data->case_insensitive_headers ? jio_string_segment_equal_case(header, other) : jio_string_segment_equal(header, other))
+        {
+            return;
+        }
+    }
+    index->slots[slot] = column_idx + 1;
+    index->count += 1;
+}
+
+//  Builds the index if needed. Data is taken as const for the same reason as in csv_materialize_column.
+static jio_result csv_header_index_build(const jio_csv_data* data)
+{
+    csv_header_index* const index = (csv_header_index*)&data->header_index;
+    if (index->capacity)
+    {
+        return JIO_RESULT_SUCCESS;
+    }
+    uint32_t capacity = 16;
+    while (capacity < 2 * (uint64_t)data->column_count)
+    {
+        capacity <<= 1;
+    }
+    uint32_t* const slots = jio_alloc(data->ctx, sizeof(*slots) * capacity);
+    if (!slots)
+    {
+        JIO_ERROR(data->ctx, "Could not allocate memory for csv header index");
+        return JIO_RESULT_BAD_ALLOC;
+    }
+    memset(slots, 0, sizeof(*slots) * capacity);
+    index->slots = slots;
+    index->capacity = capacity;
+    index->count = 0;
+    for (uint32_t i = 0; i < data->column_count; ++i)
+    {
+        csv_header_index_insert(data, index, i);
+    }
+    return JIO_RESULT_SUCCESS;
+}
+
+static void csv_header_index_drop(jio_csv_data* data)
+{
+    jio_free(data->ctx, data->header_index.slots);
+    data->header_index = (csv_header_index){.capacity = 0, .count = 0, .slots = NULL};
+}
+
+//  Keeps the index in sync after columns on [position, position + inserted) replaced removed ones. Appended columns are
+//  added to the index, while other changes shift indices of columns, so the index is rebuilt on the next lookup.
+static void csv_header_index_update(jio_csv_data* data, uint32_t position, uint32_t removed, uint32_t inserted)
+{
+    csv_header_index* const index = &data->header_index;
+    if (!index->capacity)
+    {
+        return;
+    }
+    if (removed || position + inserted != data->column_count || 2 * ((uint64_t)index->count + inserted) > index->capacity)
+    {
+        csv_header_index_drop(data);
+        return;
+    }
+    for (uint32_t i = position; i < data->column_count; ++i)
+    {
+        csv_header_index_insert(data, index, i);
+    }
+}
+
+static jio_result csv_header_index_find(const jio_csv_data* data, const char* name, size_t len, uint32_t* p_idx)
+{
+    const jio_result res = csv_header_index_build(data);
+    if (res != JIO_RESULT_SUCCESS)
+    {
+        return res;
+    }
+    const csv_header_index* const index = &data->header_index;
+    const jio_string_segment segment = {.begin = name, .len = len};
+    uint32_t slot = csv_header_index_hash(data, name, len) & (index->capacity - 1);
+    for (; index->slots[slot]; slot = (slot + 1) & (index->capacity - 1))
+    {
+        const uint32_t idx = index->slots[slot] - 1;
+        const jio_string_segment* const header = &data->columns[idx].header;
+        if (data->case_insensitive_headers ? jio_string_segment_equal_case(header, &segment) : jio_string_segment_equal(header, &segment))
+        {
+            *p_idx = idx;
+            return JIO_RESULT_SUCCESS;
+        }
+    }
+    return JIO_RESULT_BAD_CSV_HEADER;
+}
+
+void jio_csv_set_case_insensitive_headers(jio_csv_data* data, bool case_insensitive)
+{
+    if (data->case_insensitive_headers != case_insensitive)
+    {
+        csv_header_index_drop(data);
+    }
+    data->case_insensitive_headers = case_insensitive;
+}
+
+jio_result jio_csv_get_column_by_name(
+        const jio_context* ctx, const jio_csv_data* data, const char* name, const jio_csv_column** pp_column)
+{
+    uint32_t idx;
+    jio_result res = csv_header_index_find(data, name, strlen(name), &idx);
+    if (res == JIO_RESULT_BAD_CSV_HEADER)
+    {
+        JIO_ERROR(ctx, "Csv file has no header that matches \"%s\"", name);
+    }
+    if (res != JIO_RESULT_SUCCESS)
+    {
+        goto end;
+    }
+
+    res = jio_csv_get_column(data, idx, pp_column);
+end:
+    return res;
+}
+
+jio_result jio_csv_get_column_by_name_segment(
+        const jio_context* ctx, const jio_csv_data* data, const jio_string_segment* name,
+        const jio_csv_column** pp_column)
+{
+    uint32_t idx;
+    jio_result res = csv_header_index_find(data, name->begin, name->len, &idx);
+    if (res == JIO_RESULT_BAD_CSV_HEADER)
+    {
+        JIO_ERROR(ctx, "Csv file has no header that matches \"%.*s\"", (int)name->len, name->begin);
+    }
+    if (res != JIO_RESULT_SUCCESS)
+    {
+        goto end;
+    }
+
+    res = jio_csv_get_column(data, idx, pp_column);
+
+end:
+    return res;
+}
+
+jio_result jio_csv_resolve_columns(
+        const jio_context* ctx, const jio_csv_data* data, uint32_t count, const jio_string_segment* names,
+        uint32_t* indices)
+{
+    jio_result res = csv_header_index_build(data);
+    if (res != JIO_RESULT_SUCCESS)
+    {
+        return res;
+    }
+    for (uint32_t i = 0; i < count; ++i)
+    {
+        if (csv_header_index_find(data, names[i].begin, names[i].len, indices + i) != JIO_RESULT_SUCCESS)
+        {
+            JIO_ERROR(ctx, "Csv file has no header that matches \"%.*s\"", (int)names[i].len, names[i].begin);
+            indices[i] = UINT32_MAX;
+            res = JIO_RESULT_BAD_CSV_HEADER;
+        }
+    }
+    return res;
+}
+
+static void csv_stats_drop(jio_csv_data* data)
+{
+    jio_free(data->ctx, data->stats);
+    data->stats = NULL;
+    data->stats_capacity = 0;
+}
+
+//  Updates stats of the column after elements were added to it
+static void csv_stats_add(jio_csv_data* data, uint32_t column, const jio_string_segment* elements, uint32_t count)
+{
+    if (!data->stats || !data->stats[column].valid)
+    {
+        return;
+    }
+    csv_column_stats* const stats = data->stats + column;
+    for (uint32_t i = 0; i < count; ++i)
+    {
+        stats->total_length += elements[i].len;
+        if (elements[i].len > stats->max_length)
+        {
+            stats->max_length = elements[i].len;
+        }
+    }
+}
+
+//  Updates stats of the column before elements are removed from it. If one of the longest elements is removed, the
+//  maximum length is no longer known, so stats of the column are recomputed when next needed.
+static void csv_stats_remove(jio_csv_data* data, uint32_t column, const jio_string_segment* elements, uint32_t count)
+{
+    if (!data->stats || !data->stats[column].valid)
+    {
+        return;
+    }
+    csv_column_stats* const stats = data->stats + column;
+    for (uint32_t i = 0; i < count; ++i)
+    {
+        stats->total_length -= elements[i].len;
+        if (elements[i].len == stats->max_length)
+        {
+            stats->valid = false;
+            return;
+        }
+    }
+}
+
+//  Moves stats after columns on [position, position + removed) were replaced by inserted new ones, whose stats are
+//  computed when next needed
+static void csv_stats_replace_columns(jio_csv_data* data, uint32_t position, uint32_t removed, uint32_t inserted)
+{
+    if (!data->stats)
+    {
+        return;
+    }
+    //  Column count was already updated
+    const uint32_t old_count = data->column_count + removed - inserted;
+    if (data->column_count > data->stats_capacity)
+    {
+        csv_column_stats* const new_ptr = jio_realloc(data->ctx, data->stats, sizeof(*new_ptr) * data->column_count);
+        if (!new_ptr)
+        {
+            //  Stats are only a cache, so they can be dropped instead
+            csv_stats_drop(data);
+            return;
+        }
+        data->stats = new_ptr;
+        data->stats_capacity = data->column_count;
+    }
+    memmove(data->stats + position + inserted, data->stats + position + removed, sizeof(*data->stats) * (old_count - position - removed));
+    for (uint32_t i = 0; i < inserted; ++i)
+    {
+        data->stats[position + i].valid = false;
+    }
+}
+
+typedef struct csv_stats_job_T csv_stats_job;
+struct csv_stats_job_T
+{
+    const jio_csv_data* data;
+    const uint32_t* columns;                //  Columns whose stats are computed
+    uint32_t blocks_per_column;             //  Number of row blocks in each column
+    uint64_t* block_total;                  //  Total length of elements in each block
+    uint32_t* block_max;                    //  Maximum length of elements in each block
+};
+
+static void csv_stats_task(void* param, uint32_t index)
+{
+    const csv_stats_job* const job = param;
+    const jio_csv_data* const data = job->data;
+    const jio_string_segment* const elements = data->columns[job->columns[index / job->blocks_per_column]].elements;
+    const uint32_t begin = (index % job->blocks_per_column) * CSV_ROWS_PER_TASK;
+    const uint32_t end = data->column_length - begin < CSV_ROWS_PER_TASK ? data->column_length : begin + CSV_ROWS_PER_TASK;
+    uint64_t total = 0;
+    uint32_t max = 0;
+    for (uint32_t i = begin; i < end; ++i)
+    {
+        total += elements[i].len;
+        if (elements[i].len > max)
+        {
+            max = elements[i].len;
+        }
+    }
+    job->block_total[index] = total;
+    job->block_max[index] = max;
+}
+
+//  Computes stats of all columns which do not have them. Data is taken as const for the same reason as in
+//  csv_materialize_column.
+static jio_result csv_stats_compute(const jio_csv_data* data)
+{
+    const jio_context* const ctx = data->ctx;
+    jio_csv_data* const mutable_data = (jio_csv_data*)data;
+    jio_result res = csv_materialize_all(data);
+    if (res != JIO_RESULT_SUCCESS)
+    {
+        return res;
+    }
+    if (!data->stats)
+    {
+        const uint32_t capacity = data->column_count ? data->column_count : 1;
+        mutable_data->stats = jio_alloc(ctx, sizeof(*data->stats) * capacity);
+        if (!data->stats)
+        {
+            JIO_ERROR(ctx, "Could not allocate memory for csv column stats");
+            return JIO_RESULT_BAD_ALLOC;
+        }
+        mutable_data->stats_capacity = capacity;
+        for (uint32_t i = 0; i < data->column_count; ++i)
+        {
+            data->stats[i].valid = false;
+        }
+    }
+
+    uint32_t column_count = 0;
+    for (uint32_t i = 0; i < data->column_count; ++i)
+    {
+        column_count += !data->stats[i].valid;
+    }
+    if (!column_count)
+    {
+        return JIO_RESULT_SUCCESS;
+    }
+    csv_stats_job job = {.data = data};
+    job.blocks_per_column = (data->column_length + CSV_ROWS_PER_TASK - 1) / CSV_ROWS_PER_TASK;
+    if (!job.blocks_per_column)
+    {
+        job.blocks_per_column = 1;
+    }
+    const uint32_t task_count = column_count * job.blocks_per_column;
+    uint32_t* const columns = jio_alloc(ctx, sizeof(*columns) * (column_count + 1) + (sizeof(*job.block_total) + sizeof(*job.block_max)) * task_count);
+    if (!columns)
+    {
+        JIO_ERROR(ctx, "Could not allocate memory for computing csv column stats");
+        return JIO_RESULT_BAD_ALLOC;
+    }
+    job.block_total = (uint64_t*)(columns + column_count + (column_count & 1));
+    job.block_max = (uint32_t*)(job.block_total + task_count);
+    for (uint32_t i = 0, j = 0; i < data->column_count; ++i)
+    {
+        if (!data->stats[i].valid)
+        {
+            columns[j++] = i;
+        }
+    }
+    job.columns = columns;
+    jio_parallel_for(ctx, task_count, csv_stats_task, &job);
+    for (uint32_t i = 0; i < column_count; ++i)
+    {
+        csv_column_stats* const stats = data->stats + columns[i];
+        stats->total_length = 0;
+        stats->max_length = 0;
+        for (uint32_t j = 0; j < job.blocks_per_column; ++j)
+        {
+            stats->total_length += job.block_total[i * job.blocks_per_column + j];
+            if (job.block_max[i * job.blocks_per_column + j] > stats->max_length)
+            {
+                stats->max_length = job.block_max[i * job.blocks_per_column + j];
+            }
+        }
+        stats->valid = true;
+    }
+    jio_free(ctx, columns);
+    return JIO_RESULT_SUCCESS;
+}
+
+jio_result jio_csv_column_stats(const jio_csv_data* data, uint32_t index, jio_csv_stats* p_stats)
+{
+    if (index >= data->column_count)
+    {
+        return JIO_RESULT_BAD_INDEX;
+    }
+    const jio_result res = csv_stats_compute(data);
+    if (res != JIO_RESULT_SUCCESS)
+    {
+        return res;
+    }
+    p_stats->count = data->column_length;
+    p_stats->max_length = data->stats[index].max_length;
+    p_stats->total_length = data->stats[index].total_length;
+    return JIO_RESULT_SUCCESS;
+}
+
+jio_result jio_csv_snapshot_create(const jio_context* ctx, jio_csv_data* data, jio_csv_snapshot** pp_snapshot)
+{
+    jio_result res;
+    csv_snapshots_collect(data);
+    if ((res = csv_materialize_all(data)) || (res = csv_share_reserve(data, data->column_count)))
+    {
+        return res;
+    }
+    //  Arrays which are not yet shared get their records first, which the data owns on its own until it is referenced
+    const uint32_t column_count = data->column_count;
+    for (uint32_t i = 0; i < column_count; ++i)
+    {
+        jio_string_segment* const elements = data->columns[i].elements;
+        if (csv_share_find(data, elements))
+        {
+            continue;
+        }
+        csv_shared_elements* const share = jio_alloc(data->ctx, sizeof(*share));
+        if (!share)
+        {
+            JIO_ERROR(ctx, "Could not allocate memory for csv snapshot");
+            return JIO_RESULT_BAD_ALLOC;
+        }
+        share->ref_count = 1;
+        share->elements = elements;
+        share->frozen_count = 0;
+        uint32_t slot = csv_share_slot(data, elements);
+        while (data->shares[slot])
+        {
+            slot = (slot + 1) & (data->share_capacity - 1);
+        }
+        data->shares[slot] = share;
+        data->share_count += 1;
+    }
+    jio_csv_snapshot* const snapshot = jio_alloc(ctx, sizeof(*snapshot));
+    jio_csv_column* const columns = jio_alloc(ctx, sizeof(*columns) * (column_count ? column_count : 1));
+    csv_shared_elements** const shares = jio_alloc(ctx, sizeof(*shares) * (column_count ? column_count : 1));
+    if (!snapshot || !columns || !shares)
+    {
+        jio_free(ctx, snapshot);
+        jio_free(ctx, columns);
+        jio_free(ctx, shares);
+        JIO_ERROR(ctx, "Could not allocate memory for csv snapshot");
+        return JIO_RESULT_BAD_ALLOC;
+    }
+    memset(snapshot, 0, sizeof(*snapshot));
+    for (uint32_t i = 0; i < column_count; ++i)
+    {
+        const jio_csv_column* const column = data->columns + i;
+        csv_shared_elements* const share = csv_share_find(data, column->elements);
+        jio_atomic_increment(&share->ref_count);
+        if (share->frozen_count < column->count)
+        {
+            share->frozen_count = column->count;
+        }
+        shares[i] = share;
+        columns[i] = *column;
+        columns[i].capacity = column->count;
+    }
+    snapshot->data.column_capacity = column_count;
+    snapshot->data.column_count = column_count;
+    snapshot->data.column_length = data->column_length;
+    snapshot->data.columns = columns;
+    snapshot->data.ctx = ctx;
+    snapshot->data.case_insensitive_headers = data->case_insensitive_headers;
+    snapshot->shares = shares;
+    snapshot->source = data;
+    //  Caches are built now, by the thread which modifies the data, since building them on first use would change the
+    //  snapshot while other threads read it. Stats which the data already has are copied instead of computed again.
+    if (data->stats && column_count)
+    {
+        snapshot->data.stats = jio_alloc(ctx, sizeof(*data->stats) * column_count);
+        if (snapshot->data.stats)
+        {
+            memcpy(snapshot->data.stats, data->stats, sizeof(*data->stats) * column_count);
+            snapshot->data.stats_capacity = column_count;
+        }
+    }
+    if ((res = csv_header_index_build(&snapshot->data)) || (res = csv_stats_compute(&snapshot->data)))
+    {
+        csv_snapshot_free(snapshot);
+        return res;
+    }
+    *pp_snapshot = snapshot;
+    return JIO_RESULT_SUCCESS;
+}
+
+const jio_csv_data* jio_csv_snapshot_data(const jio_csv_snapshot* snapshot)
+{
+    return &snapshot->data;
+}
+
+void jio_csv_snapshot_destroy(jio_csv_snapshot* snapshot)
+{
+    //  Pushed onto the list of released snapshots, to be freed by the thread which modifies the data
+    jio_csv_data* const data = snapshot->source;
+    void* head = NULL;
+    for (;;)
+    {
+        snapshot->next_released = head;
+        void* const previous = jio_atomic_compare_exchange_pointer(&data->released_snapshots, head, snapshot);
+        if (previous == head)
+        {
+            break;
+        }
+        head = previous;
+    }
+}
+
+//  Capacity grows geometrically, so that repeated insertion of rows is amortized O(1) per row
+static uint32_t csv_grow_row_capacity(uint32_t capacity, uint32_t required, uint32_t minimum)
+{
+    uint32_t new_capacity = capacity > UINT32_MAX / 2 ? UINT32_MAX : capacity * 2;
+    if (new_capacity < minimum)
+    {
+        new_capacity = minimum;
+    }
+    //  Capacity checks expect at least one spare slot
+    if (new_capacity <= required)
+    {
+        new_capacity = required < UINT32_MAX ? required + 1 : UINT32_MAX;
+    }
+    return new_capacity;
+}
+
+typedef struct csv_index_hash_job_T csv_index_hash_job;
+struct csv_index_hash_job_T
+{
+    const jio_string_segment* elements;
+    uint32_t count;
+    uint64_t* hashes;
+};
+
+static void csv_index_hash_task(void* param, uint32_t index)
+{
+    const csv_index_hash_job* const job = param;
+    const uint32_t begin = index * CSV_ROWS_PER_TASK;
+    const uint32_t end = job->count - begin < CSV_ROWS_PER_TASK ? job->count : begin + CSV_ROWS_PER_TASK;
+    for (uint32_t i = begin; i < end; ++i)
+    {
+        job->hashes[i] = csv_string_hash(job->elements[i].begin, job->elements[i].len);
+    }
+}
+
+//  Finds the slot of the key, or NULL if there is none
+static const csv_index_slot* csv_index_probe(
+        const jio_csv_index* index, const jio_string_segment* elements, const char* key, size_t len, uint64_t hash)
+{
+    const uint32_t mask = index->slot_count - 1;
+    for (uint32_t slot = (uint32_t)hash & mask; index->slots[slot].head; slot = (slot + 1) & mask)
+    {
+        const csv_index_slot* const s = index->slots + slot;
+        const jio_string_segment* const other = elements + s->tail;
+        if (s->hash == hash && other->len == len && memcmp(other->begin, key, len) == 0)
+        {
+            return s;
+        }
+    }
+    return NULL;
+}
+
+static void csv_index_insert(jio_csv_index* index, const jio_string_segment* elements, uint32_t row, uint64_t hash)
+{
+    const uint32_t mask = index->slot_count - 1;
+    const jio_string_segment* const element = elements + row;
+    index->next[row] = UINT32_MAX;
+    for (uint32_t slot = (uint32_t)hash & mask;; slot = (slot + 1) & mask)
+    {
+        csv_index_slot* const s = index->slots + slot;
+        if (!s->head)
+        {
+            s->head = row + 1;
+            s->tail = row;
+            s->hash = hash;
+            index->used_slots += 1;
+            return;
+        }
+        const jio_string_segment* const other = elements + s->tail;
+        if (s->hash == hash && other->len == element->len && memcmp(other->begin, element->begin, element->len) == 0)
+        {
+            index->next[s->tail] = row;
+            s->tail = row;
+            return;
+        }
+    }
+}
+
+//  Builds the index from scratch. Hashes of all elements are computed in parallel, then inserted in order, so that
+//  chains are sorted by row. The slots are sized for the capacity of rows, leaving room for rows appended later.
+static jio_result csv_index_build(jio_csv_index* index)
+{
+    jio_csv_data* const data = index->data;
+    const jio_context* const ctx = data->ctx;
+    if (index->column == UINT32_MAX)
+    {
+        JIO_ERROR(ctx, "Key column of csv index was removed");
+        return JIO_RESULT_BAD_CSV_COLUMN;
+    }
+    jio_result res = csv_materialize_column(data, index->column);
+    if (res != JIO_RESULT_SUCCESS)
+    {
+        return res;
+    }
+    const uint32_t row_count = data->column_length;
+    if (row_count >= index->row_capacity)
+    {
+        //  Room for a quarter more rows is left, so that appended rows can be added without rebuilding
+        const uint32_t minimum = row_count > (UINT32_MAX >> 2) ? row_count : row_count + row_count / 4 + 64;
+        const uint32_t new_capacity = csv_grow_row_capacity(index->row_capacity, row_count, minimum);
+        if (new_capacity > (UINT32_MAX >> 2))
+        {
+            JIO_ERROR(ctx, "Csv index can not hold %"PRIu32" rows", row_count);
+            return JIO_RESULT_BAD_ALLOC;
+        }
+        uint32_t slot_count = 64;
+        while (slot_count < 2 * new_capacity)
+        {
+            slot_count <<= 1;
+        }
+        csv_index_slot* const new_slots = jio_alloc(ctx, sizeof(*new_slots) * slot_count);
+        uint32_t* const new_next = new_slots ? jio_realloc(ctx, index->next, sizeof(*new_next) * new_capacity) : NULL;
+        if (!new_next)
+        {
+            jio_free(ctx, new_slots);
+            JIO_ERROR(ctx, "Could not allocate memory for csv index");
+            return JIO_RESULT_BAD_ALLOC;
+        }
+        jio_free(ctx, index->slots);
+        index->slots = new_slots;
+        index->slot_count = slot_count;
+        index->next = new_next;
+        index->row_capacity = new_capacity;
+    }
+    csv_index_hash_job job =
+            {
+                    .elements = data->columns[index->column].elements,
+                    .count = row_count,
+                    .hashes = jio_alloc(ctx, sizeof(*job.hashes) * (row_count ? row_count : 1)),
+            };
+    if (!job.hashes)
+    {
+        JIO_ERROR(ctx, "Could not allocate memory for csv index");
+        return JIO_RESULT_BAD_ALLOC;
+    }
+    jio_parallel_for(ctx, (row_count + CSV_ROWS_PER_TASK - 1) / CSV_ROWS_PER_TASK, csv_index_hash_task, &job);
+    memset(index->slots, 0, sizeof(*index->slots) * index->slot_count);
+    index->used_slots = 0;
+    for (uint32_t i = 0; i < row_count; ++i)
+    {
+        csv_index_insert(index, job.elements, i, job.hashes[i]);
+    }
+    jio_free(ctx, job.hashes);
+    index->stale = false;
+    return JIO_RESULT_SUCCESS;
+}
+
+//  Updates indices after row_count rows were inserted at position. Rows appended to the end are added to the index,
+//  unless it would need more space, while anything else requires the index to be rebuilt.
+static void csv_indices_rows_added(jio_csv_data* data, uint32_t position, uint32_t row_count)
+{
+    for (jio_csv_index* index = data->indices; index; index = index->next_index)
+    {
+        if (index->stale)
+        {
+            continue;
+        }
+        if (position + row_count != data->column_length || data->column_length > index->row_capacity
+            || 2 * ((uint64_t)index->used_slots + row_count) > index->slot_count)
+        {
+            index->stale = true;
+            continue;
+        }
+        const jio_string_segment* const elements = data->columns[index->column].elements;
+        for (uint32_t i = position; i < position + row_count; ++i)
+        {
+            csv_index_insert(index, elements, i, csv_string_hash(elements[i].begin, elements[i].len));
+        }
+    }
+}
+
+//  Marks indices of the column as stale, or all of them if column is UINT32_MAX
+static void csv_indices_invalidate(jio_csv_data* data, uint32_t column)
+{
+    for (jio_csv_index* index = data->indices; index; index = index->next_index)
+    {
+        if (column == UINT32_MAX || index->column == column)
+        {
+            index->stale = true;
+        }
+    }
+}
+
+//  Moves key columns of indices after columns on [position, position + removed) were replaced by inserted new ones
+static void csv_indices_replace_columns(jio_csv_data* data, uint32_t position, uint32_t removed, uint32_t inserted)
+{
+    for (jio_csv_index* index = data->indices; index; index = index->next_index)
+    {
+        if (index->column == UINT32_MAX || index->column < position)
+        {
+            continue;
+        }
+        if (index->column < position + removed)
+        {
+            index->column = UINT32_MAX;
+            index->stale = true;
+        }
+        else
+        {
+            index->column = index->column - removed + inserted;
+        }
+    }
+}
+
+static void csv_index_free(jio_csv_index* index)
+{
+    const jio_context* const ctx = index->data->ctx;
+    jio_free(ctx, index->slots);
+    jio_free(ctx, index->next);
+    jio_free(ctx, index);
+}
+
+jio_result jio_csv_index_create(const jio_context* ctx, jio_csv_data* data, uint32_t column, jio_csv_index** pp_index)
+{
+    if (column >= data->column_count)
+    {
+        JIO_ERROR(ctx, "Csv index was to be created for column %"PRIu32", but csv data has only %"PRIu32" columns", column, data->column_count);
+        return JIO_RESULT_BAD_INDEX;
+    }
+    jio_csv_index* const index = jio_alloc(ctx, sizeof(*index));
+    if (!index)
+    {
+        JIO_ERROR(ctx, "Could not allocate memory for csv index");
+        return JIO_RESULT_BAD_ALLOC;
+    }
+    memset(index, 0, sizeof(*index));
+    index->data = data;
+    index->column = column;
+    const jio_result res = csv_index_build(index);
+    if (res != JIO_RESULT_SUCCESS)
+    {
+        csv_index_free(index);
+        return res;
+    }
+    index->next_index = data->indices;
+    data->indices = index;
+    *pp_index = index;
+    return JIO_RESULT_SUCCESS;
+}
+
+jio_result jio_csv_index_find(jio_csv_index* index, jio_string_segment key, uint32_t* p_row)
+{
+    jio_result res;
+    if (index->stale && (res = csv_index_build(index)))
+    {
+        return res;
+    }
+    const csv_index_slot* const slot = csv_index_probe(
+            index, index->data->columns[index->column].elements, key.begin, key.len, csv_string_hash(key.begin, key.len));
+    *p_row = slot ? slot->head - 1 : UINT32_MAX;
+    return JIO_RESULT_SUCCESS;
+}
+
+uint32_t jio_csv_index_next(const jio_csv_index* index, uint32_t row)
+{
+    return index->next[row];
+}
+
+void jio_csv_index_destroy(jio_csv_index* index)
+{
+    jio_csv_index** p_link = &index->data->indices;
+    while (*p_link != index)
+    {
+        p_link = &(*p_link)->next_index;
+    }
+    *p_link = index->next_index;
+    csv_index_free(index);
+}
+
+typedef struct csv_join_job_T csv_join_job;
+struct csv_join_job_T
+{
+    const jio_csv_index* index;             //  Index of the right key column
+    const jio_string_segment* left;         //  Keys of the left data
+    const jio_string_segment* right;        //  Keys of the right data
+    uint32_t left_count;
+    uint32_t* first_match;                  //  First matching right row of each left row (UINT32_MAX if none)
+    uint64_t* block_offsets;                //  Number of pairs in each block, then offset of its first pair
+    uint32_t* left_rows;
+    uint32_t* right_rows;
+};
+
+static void csv_join_count_task(void* param, uint32_t index)
+{
+    const csv_join_job* const job = param;
+    const uint32_t begin = index * CSV_ROWS_PER_TASK;
+    const uint32_t end = job->left_count - begin < CSV_ROWS_PER_TASK ? job->left_count : begin + CSV_ROWS_PER_TASK;
+    uint64_t count = 0;
+    for (uint32_t i = begin; i < end; ++i)
+    {
+        const jio_string_segment* const key = job->left + i;
+        const csv_index_slot* const slot = csv_index_probe(
+                job->index, job->right, key->begin, key->len, csv_string_hash(key->begin, key->len));
+        job->first_match[i] = slot ? slot->head - 1 : UINT32_MAX;
+        for (uint32_t row = job->first_match[i]; row != UINT32_MAX; row = job->index->next[row])
+        {
+            count += 1;
+        }
+    }
+    job->block_offsets[index] = count;
+}
+
+static void csv_join_write_task(void* param, uint32_t index)
+{
+    const csv_join_job* const job = param;
+    const uint32_t begin = index * CSV_ROWS_PER_TASK;
+    const uint32_t end = job->left_count - begin < CSV_ROWS_PER_TASK ? job->left_count : begin + CSV_ROWS_PER_TASK;
+    uint64_t pos = job->block_offsets[index];
+    for (uint32_t i = begin; i < end; ++i)
+    {
+        for (uint32_t row = job->first_match[i]; row != UINT32_MAX; row = job->index->next[row])
+        {
+            job->left_rows[pos] = i;
+            job->right_rows[pos] = row;
+            pos += 1;
+        }
+    }
+}
+
+jio_result jio_csv_hash_join(
+        const jio_context* ctx, const jio_csv_data* left, uint32_t left_key, const jio_csv_data* right,
+        uint32_t right_key, jio_csv_join* p_join)
+{
+    if (left_key >= left->column_count || right_key >= right->column_count)
+    {
+        JIO_ERROR(ctx, "Csv join was to use columns %"PRIu32" and %"PRIu32", but csv data have only %"PRIu32" and %"PRIu32" columns", left_key, right_key, left->column_count, right->column_count);
+        return JIO_RESULT_BAD_INDEX;
+    }
+    jio_result res;
+    if ((res = csv_materialize_column(left, left_key)))
+    {
+        return res;
+    }
+    //  An index of the right key column is used if it is up to date, otherwise a temporary one is built, since rebuilding
+    //  the index in place would modify the right data. Building the temporary index only reads the data.
+    jio_csv_index temporary = {.data = (jio_csv_data*)right, .column = right_key, .stale = true};
+    const jio_csv_index* index = right->indices;
+    while (index && (index->column != right_key || index->stale))
+    {
+        index = index->next_index;
+    }
+    if (!index)
+    {
+        index = &temporary;
+    }
+    csv_join_job job = {.index = index, .left = left->columns[left_key].elements, .left_count = left->column_length};
+    const uint32_t task_count = (job.left_count + CSV_ROWS_PER_TASK - 1) / CSV_ROWS_PER_TASK;
+    if (index == &temporary && (res = csv_index_build(&temporary)))
+    {
+        goto end;
+    }
+    job.right = right->columns[right_key].elements;
+    job.first_match = jio_alloc(ctx, sizeof(*job.first_match) * (job.left_count ? job.left_count : 1));
+    job.block_offsets = jio_alloc(ctx, sizeof(*job.block_offsets) * (task_count ? task_count : 1));
+    if (!job.first_match || !job.block_offsets)
+    {
+        JIO_ERROR(ctx, "Could not allocate memory for csv join");
+        res = JIO_RESULT_BAD_ALLOC;
+        goto end;
+    }
+    jio_parallel_for(ctx, task_count, csv_join_count_task, &job);
+    uint64_t total = 0;
+    for (uint32_t i = 0; i < task_count; ++i)
+    {
+        const uint64_t count = job.block_offsets[i];
+        job.block_offsets[i] = total;
+        total += count;
+    }
+    if (total > UINT32_MAX)
+    {
+        JIO_ERROR(ctx, "Csv join would produce %"PRIu64" pairs of rows, which is too many", total);
+        res = JIO_RESULT_BAD_ALLOC;
+        goto end;
+    }
+    job.left_rows = jio_alloc(ctx, sizeof(*job.left_rows) * (total ? total : 1));
+    job.right_rows = jio_alloc(ctx, sizeof(*job.right_rows) * (total ? total : 1));
+    if (!job.left_rows || !job.right_rows)
+    {
+        jio_free(ctx, job.left_rows);
+        jio_free(ctx, job.right_rows);
+        JIO_ERROR(ctx, "Could not allocate memory for csv join");
+        res = JIO_RESULT_BAD_ALLOC;
+        goto end;
+    }
+    jio_parallel_for(ctx, task_count, csv_join_write_task, &job);
+    p_join->count = (uint32_t)total;
+    p_join->left_rows = job.left_rows;
+    p_join->right_rows = job.right_rows;
+
+end:
+    jio_free(ctx, job.block_offsets);
+    jio_free(ctx, job.first_match);
+    jio_free(ctx, temporary.slots);
+    jio_free(ctx, temporary.next);
+    return res;
+}
+
+void jio_csv_join_release(const jio_context* ctx, jio_csv_join* join)
+{
+    jio_free(ctx, join->left_rows);
+    jio_free(ctx, join->right_rows);
+    memset(join, 0, sizeof(*join));
+}
+
+jio_result
+jio_csv_add_rows(
+        const jio_context* ctx, jio_csv_data* data, uint32_t position, uint32_t row_count,
+        const jio_string_segment* const* rows)
+{
+    jio_result res = JIO_RESULT_SUCCESS;
+    if ((res = csv_make_eager(data)))
+    {
+        goto end;
+    }
+
+    if (position > data->column_length && position != UINT32_MAX)
+    {
+        JIO_ERROR(ctx, "Rows were to be inserted at position %"PRIu32", but csv data has only %u rows", position, data->column_length);
+        res = JIO_RESULT_BAD_INDEX;
+        goto end;
+    }
+
+    if (data->columns[0].count + row_count >= data->columns[0].capacity)
+    {
+        //  Need to resize all columns to fit all columns
+        const uint32_t new_capacity = csv_grow_row_capacity(data->columns[0].capacity, data->columns[0].count + row_count, 64);
+        for (uint32_t i = 0; i < data->column_count; ++i)
+        {
+            if (csv_column_resize(data, i, new_capacity) != JIO_RESULT_SUCCESS)
+            {
+                JIO_ERROR(ctx, "Could not reallocate column %u to fit additional %u row elements", i, row_count);
+                res = JIO_RESULT_BAD_ALLOC;
+                goto end;
+            }
+        }
+    }
+    //  Elements which snapshots can see must not be overwritten
+    for (uint32_t i = 0; i < data->column_count; ++i)
+    {
+        if ((res = csv_column_prepare(data, i, position == UINT32_MAX ? data->column_length : position)))
+        {
+            goto end;
+        }
+    }
+
+    //  Now move the old data out of the way of the new if needed
+    if (position == UINT32_MAX)
+    {
+        //  Appending
+        position = data->column_length;
+    }
+    else if (position != data->column_length)
+    {
+        //  Moving
+        for (uint32_t i = 0; i < data->column_count; ++i)
+        {
+            const jio_csv_column* const column = data->columns + i;
+            jio_string_segment* const elements = column->elements;
+            memmove(elements + position + row_count, elements + position, sizeof(*elements) * (column->count - position));
+        }
+    }
+
+    //  Inserting the new elements and correcting the column lengths
+    for (uint32_t i = 0; i < data->column_count; ++i)
+    {
+        jio_csv_column* const column = data->columns + i;
+        jio_string_segment* const elements = column->elements;
+        for (uint32_t j = 0; j < row_count; ++j)
+        {
+            elements[position + j] = rows[j][i];
+        }
+        csv_stats_add(data, i, elements + position, row_count);
+        column->count += row_count;
+    }
+    data->column_length += row_count;
+    csv_indices_rows_added(data, position, row_count);
+
+end:
+    return res;
+}
+
+jio_result jio_csv_add_cols(
+        const jio_context* ctx, jio_csv_data* data, uint32_t position, uint32_t col_count, const jio_csv_column* cols)
+{
+    jio_result res = JIO_RESULT_SUCCESS;
+    if ((res = csv_make_eager(data)))
+    {
+        goto end;
+    }
+
+    if (position > data->column_count&& position != UINT32_MAX)
+    {
+        JIO_ERROR(ctx, "Columns were to be inserted at position %"PRIu32", but csv data has only %u columns", position, data->column_count);
+        res = JIO_RESULT_BAD_INDEX;
+        goto end;
+    }
+    bool bad = false;
+    for (uint32_t i = 0; i < col_count; ++i)
+    {
+        if (cols[i].count != data->column_length)
+        {
+            JIO_ERROR(ctx, "Column %u to be inserted had a length of %"PRIu32", but others have the length of %u", i, cols[i].count, data->column_length);
+            bad = true;
+        }
+    }
+    if (bad)
+    {
+        res = JIO_RESULT_BAD_CSV_COLUMN;
+        goto end;
+    }
+
+    //  Resize the columns array if needed
+    if (data->column_count + col_count >= data->column_capacity)
+    {
+        const uint32_t new_capacity = data->column_capacity + (col_count < 8 ? 8 :  col_count);
+        jio_csv_column* const new_ptr = jio_realloc(ctx, data->columns, sizeof(*new_ptr) * new_capacity);
+        if (!new_ptr)
+        {
+            JIO_ERROR(ctx, "Could not reallocate memory for column array");
+            res = JIO_RESULT_BAD_ALLOC;
+            goto end;
+        }
+        data->columns = new_ptr;
+        data->column_capacity = new_capacity;
+    }
+
+    //  Now move the old data out of the way of the new if needed
+    if (position == UINT32_MAX)
+    {
+        //  Appending
+        position = data->column_count;
+    }
+    else if (position != data->column_count)
+    {
+        //  Moving
+        memmove(data->columns + position + col_count, data->columns + position, sizeof(*data->columns) * (data->column_count - position));
+    }
+
+    //  Now insert the new data
+    memcpy(data->columns + position, cols, sizeof(*cols) * col_count);
+
+    data->column_count += col_count;
+    csv_header_index_update(data, position, 0, col_count);
+    csv_stats_replace_columns(data, position, 0, col_count);
+    csv_indices_replace_columns(data, position, 0, col_count);
+end:
+    return res;
+}
+
+jio_result jio_csv_remove_rows(const jio_context* ctx, jio_csv_data* data, uint32_t position, uint32_t row_count)
+{
+    //  Done already?
+    if (!row_count || (data && position == data->column_length)) return JIO_RESULT_SUCCESS;
+    jio_result res = JIO_RESULT_SUCCESS;
+    if ((res = csv_make_eager(data)))
+    {
+        goto end;
+    }
+    //  Check that the range to remove lies within the list of available rows
+    const uint32_t begin = position, end = position + row_count;
+    if (begin > data->column_length || end > data->column_length)
+    {
+        JIO_ERROR(ctx, "Range of rows to remove is [%"PRIu32", %"PRIu32"), but the csv file only has %"PRIu32" rows", begin, end, data->column_length);
+        res = JIO_RESULT_BAD_INDEX;
+        goto end;
+    }
+    for (uint32_t i = 0; i < data->column_count; ++i)
+    {
+        if ((res = csv_column_prepare(data, i, begin)))
+        {
+            goto end;
+        }
+    }
+
+    for (uint32_t i = 0; i < data->column_count; ++i)
+    {
+        jio_csv_column* const column = data->columns + i;
+        csv_stats_remove(data, i, column->elements + begin, row_count);
+        memmove(column->elements + begin, column->elements + end, sizeof(*column->elements) * (column->count - end));
+        assert(column->count >= row_count);
+        column->count -= row_count;
+    }
+    data->column_length -= row_count;
+    csv_indices_invalidate(data, UINT32_MAX);
+end:
+    return res;
+}
+
+jio_result jio_csv_remove_cols(const jio_context* ctx, jio_csv_data* data, uint32_t position, uint32_t col_count)
+{
+    //  Done already?
+    jio_result res = JIO_RESULT_SUCCESS;
+    if ((res = csv_make_eager(data)))
+    {
+        goto end;
+    }
+    //  Check that the range to remove lies within the list of available rows
+    const uint32_t begin = position, end = position + col_count;
+    if (begin > data->column_count || end > data->column_count)
+    {
+        JIO_ERROR(ctx, "Range of columns to remove is [%"PRIu32", %"PRIu32"), but the csv file only has %"PRIu32" columns", begin, end, data->column_count);
+        res = JIO_RESULT_BAD_INDEX;
+        goto end;
+    }
+
+    for (uint32_t i = begin; i < end; ++i)
+    {
+        csv_elements_release(data, data->columns[i].elements);
+    }
+    memmove(data->columns + begin, data->columns + end, sizeof(*data->columns) * (data->column_count - end));
+    data->column_count -= col_count;
+    csv_header_index_update(data, begin, col_count, 0);
+    csv_stats_replace_columns(data, begin, col_count, 0);
+    csv_indices_replace_columns(data, begin, col_count, 0);
+end:
+    return res;
+}
+
+jio_result jio_csv_replace_cols(
+        const jio_context* ctx, jio_csv_data* data, uint32_t begin, uint32_t count, uint32_t col_count,
+        const jio_csv_column* cols)
+{
+    jio_result res = JIO_RESULT_SUCCESS;
+    if ((res = csv_make_eager(data)))
+    {
+        goto end;
+    }
+
+
+    const uint32_t end = begin + count;
+    if (begin >= data->column_count || end >= data->column_count)
+    {
+        JIO_ERROR(ctx, "Columns to be replaced were on the interval [%"PRIu32", %"PRIu32"), but only values on interval [0, %"PRIu32") can be given", begin, end, data->column_count);
+        res = JIO_RESULT_BAD_INDEX;
+        goto end;
+    }
+
+    //  What is the overall change in column count
+    const int32_t d_col = (int32_t)col_count - (int32_t)count;
+    //  Reallocate the memory for all the new columns
+    if (d_col + data->column_count >= data->column_capacity)
+    {
+        const uint32_t new_capacity = data->column_capacity + (d_col < 8 ? 8 : d_col);
+        jio_csv_column* const columns = jio_realloc(ctx, data->columns, sizeof(*data->columns) * new_capacity);
+        if (!columns)
+        {
+            JIO_ERROR(ctx, "Could not reallocate memory for columns");
+            res = JIO_RESULT_BAD_ALLOC;
+            goto end;
+        }
+        data->columns = columns;
+        data->column_capacity = new_capacity;
+    }
+
+    for (uint32_t i = begin; i < end; ++i)
+    {
+        csv_elements_release(data, data->columns[i].elements);
+    }
+    if (end != data->column_count)
+    {
+        //  This if is not really needed, I just don't want a call to memmove if not needed
+        memmove(data->columns + begin + col_count, data->columns + end, sizeof(*data->columns) * (data->column_count - end));
+    }
+    //  Insert the new columns
+    memcpy(data->columns + begin, cols, sizeof(*cols) * col_count);
+    data->column_count += d_col;
+    csv_header_index_update(data, begin, count, col_count);
+    csv_stats_replace_columns(data, begin, count, col_count);
+    csv_indices_replace_columns(data, begin, count, col_count);
+end:
+    return res;
+}
+
+jio_result jio_csv_replace_rows(
+        const jio_context* ctx, jio_csv_data* data, uint32_t begin, uint32_t count, uint32_t row_count,
+        const jio_string_segment* const* rows)
+{
+    jio_result res = JIO_RESULT_SUCCESS;
+    if ((res = csv_make_eager(data)))
+    {
+        goto end;
+    }
+
+    const uint32_t end = begin + count;
+    if (begin >= data->column_length || end >= data->column_length)
+    {
+        JIO_ERROR(ctx, "Rows to be replaced were on the interval [%"PRIu32", %"PRIu32"), but only values on interval [0, %"PRIu32") can be given", begin, end, data->column_count);
+        res = JIO_RESULT_BAD_INDEX;
+        goto end;
+    }
+
+    //  What is the overall change in column count
+    const int32_t d_row = (int32_t)row_count - (int32_t)count;
+    //  Reallocate the memory for all the new columns
+    if (d_row + data->column_length >= data->columns[0].capacity)
+    {
+        for (uint32_t i = 0; i < data->column_count; ++i)
+        {
+            jio_csv_column* const column = data->columns + i;
+            const uint32_t new_capacity = csv_grow_row_capacity(column->capacity, data->column_length + d_row, 8);
+            if (csv_column_resize(data, i, new_capacity) != JIO_RESULT_SUCCESS)
+            {
+                JIO_ERROR(ctx, "Could not reallocate memory for column elements");
+                res = JIO_RESULT_BAD_ALLOC;
+                goto end;
+            }
+        }
+    }
+    for (uint32_t i = 0; i < data->column_count; ++i)
+    {
+        if ((res = csv_column_prepare(data, i, begin)))
+        {
+            goto end;
+        }
+    }
+
+    for (uint32_t i = 0; i < data->column_count; ++i)
+    {
+        jio_csv_column* const column = data->columns + i;
+        csv_stats_remove(data, i, column->elements + begin, count);
+        memmove(column->elements + begin + row_count, column->elements + end, sizeof(*column->elements) * (data->column_length - end));
+        //  Insert the new elements for each row
+        for (uint32_t j = 0; j < row_count; ++j)
+        {
+            column->elements[j + begin] = rows[j][i];
+        }
+        csv_stats_add(data, i, column->elements + begin, row_count);
+        column->count += d_row;
+    }
+    data->column_length += d_row;
+    csv_indices_invalidate(data, UINT32_MAX);
+
+end:
+    return res;
+}
+
+//  Edit which removes rows or columns on [position, position + remove_count) of the data as it was before the edit
+//  began and inserts new ones in their place
+typedef struct csv_edit_op_T csv_edit_op;
+struct csv_edit_op_T
+{
+    uint32_t position;                      //  Position in the original data
+    uint32_t remove_count;                  //  Number of original rows/columns to remove
+    uint32_t insert_count;                  //  Number of new rows/columns to insert
+    uint32_t order;                         //  Order in which the edit was queued
+    size_t insert_offset;                   //  Offset of the first inserted element/column in the edit's buffer
+};
+
+struct jio_csv_edit_T
+{
+    const jio_context* ctx;
+    jio_csv_data* data;
+    uint32_t column_count;                  //  Number of columns when the edit began
+    uint32_t column_length;                 //  Number of rows when the edit began
+    //  Row edits
+    uint32_t row_op_count;
+    uint32_t row_op_capacity;
+    csv_edit_op* row_ops;
+    size_t element_count;                   //  Elements of inserted rows, stored row by row
+    size_t element_capacity;
+    jio_string_segment* elements;
+    //  Column edits
+    uint32_t col_op_count;
+    uint32_t col_op_capacity;
+    csv_edit_op* col_ops;
+    uint32_t new_column_count;              //  Inserted columns
+    uint32_t new_column_capacity;
+    jio_csv_column* new_columns;
+};
+
+jio_result jio_csv_edit_begin(const jio_context* ctx, jio_csv_data* data, jio_csv_edit** pp_edit)
+{
+    jio_result res = csv_make_eager(data);
+    if (res != JIO_RESULT_SUCCESS)
+    {
+        return res;
+    }
+    jio_csv_edit* const edit = jio_alloc(ctx, sizeof(*edit));
+    if (!edit)
+    {
+        JIO_ERROR(ctx, "Could not allocate memory for csv edit");
+        return JIO_RESULT_BAD_ALLOC;
+    }
+    memset(edit, 0, sizeof(*edit));
+    edit->ctx = ctx;
+    edit->data = data;
+    edit->column_count = data->column_count;
+    edit->column_length = data->column_length;
+    *pp_edit = edit;
+    return JIO_RESULT_SUCCESS;
+}
+
+void jio_csv_edit_abort(jio_csv_edit* edit)
+{
+    const jio_context* const ctx = edit->ctx;
+    jio_free(ctx, edit->row_ops);
+    jio_free(ctx, edit->elements);
+    jio_free(ctx, edit->col_ops);
+    jio_free(ctx, edit->new_columns);
+    jio_free(ctx, edit);
+}
+
+static csv_edit_op* csv_edit_push_op(const jio_context* ctx, csv_edit_op** p_ops, uint32_t* p_count, uint32_t* p_capacity)
+{
+    if (*p_count == *p_capacity)
+    {
+        const uint32_t new_capacity = *p_capacity ? *p_capacity * 2 : 16;
+        csv_edit_op* const new_ptr = jio_realloc(ctx, *p_ops, sizeof(*new_ptr) * new_capacity);
+        if (!new_ptr)
+        {
+            JIO_ERROR(ctx, "Could not reallocate memory for csv edit operations");
+            return NULL;
+        }
+        *p_ops = new_ptr;
+        *p_capacity = new_capacity;
+    }
+    csv_edit_op* const op = *p_ops + *p_count;
+    op->order = *p_count;
+    *p_count += 1;
+    return op;
+}
+
+jio_result jio_csv_edit_replace_rows(
+        jio_csv_edit* edit, uint32_t begin, uint32_t count, uint32_t row_count, const jio_string_segment* const* rows)
+{
+    const jio_context* const ctx = edit->ctx;
+    if (begin == UINT32_MAX)
+    {
+        begin = edit->column_length;
+    }
+    if (begin > edit->column_length || count > edit->column_length - begin)
+    {
+        JIO_ERROR(ctx, "Rows to be edited were on the interval [%"PRIu32", %"PRIu64"), but only values on interval [0, %"PRIu32") can be given", begin, (uint64_t)begin + count, edit->column_length);
+        return JIO_RESULT_BAD_INDEX;
+    }
+    const size_t needed = edit->element_count + (size_t)row_count * edit->column_count;
+    if (needed > edit->element_capacity)
+    {
+        size_t new_capacity = edit->element_capacity ? edit->element_capacity * 2 : 256;
+        if (new_capacity < needed)
+        {
+            new_capacity = needed;
+        }
+        jio_string_segment* const new_ptr = jio_realloc(ctx, edit->elements, sizeof(*new_ptr) * new_capacity);
+        if (!new_ptr)
+        {
+            JIO_ERROR(ctx, "Could not reallocate memory for csv edit elements");
+            return JIO_RESULT_BAD_ALLOC;
+        }
+        edit->elements = new_ptr;
+        edit->element_capacity = new_capacity;
+    }
+    csv_edit_op* const op = csv_edit_push_op(ctx, &edit->row_ops, &edit->row_op_count, &edit->row_op_capacity);
+    if (!op)
+    {
+        return JIO_RESULT_BAD_ALLOC;
+    }
+    op->position = begin;
+    op->remove_count = count;
+    op->insert_count = row_count;
+    op->insert_offset = edit->element_count;
+    for (uint32_t i = 0; i < row_count; ++i)
+    {
+        memcpy(edit->elements + edit->element_count, rows[i], sizeof(*edit->elements) * edit->column_count);
+        edit->element_count += edit->column_count;
+    }
+    return JIO_RESULT_SUCCESS;
+}
+
+jio_result jio_csv_edit_add_rows(
+        jio_csv_edit* edit, uint32_t position, uint32_t row_count, const jio_string_segment* const* rows)
+{
+    return jio_csv_edit_replace_rows(edit, position, 0, row_count, rows);
+}
+
+jio_result jio_csv_edit_remove_rows(jio_csv_edit* edit, uint32_t position, uint32_t row_count)
+{
+    return jio_csv_edit_replace_rows(edit, position, row_count, 0, NULL);
+}
+
+jio_result jio_csv_edit_replace_cols(
+        jio_csv_edit* edit, uint32_t begin, uint32_t count, uint32_t col_count, const jio_csv_column* cols)
+{
+    const jio_context* const ctx = edit->ctx;
+    if (begin == UINT32_MAX)
+    {
+        begin = edit->column_count;
+    }
+    if (begin > edit->column_count || count > edit->column_count - begin)
+    {
+        JIO_ERROR(ctx, "Columns to be edited were on the interval [%"PRIu32", %"PRIu64"), but only values on interval [0, %"PRIu32") can be given", begin, (uint64_t)begin + count, edit->column_count);
+        return JIO_RESULT_BAD_INDEX;
+    }
+    if (col_count > UINT32_MAX - edit->new_column_count)
+    {
+        JIO_ERROR(ctx, "Too many columns were inserted by the csv edit");
+        return JIO_RESULT_BAD_INDEX;
+    }
+    const uint32_t needed = edit->new_column_count + col_count;
+    if (needed > edit->new_column_capacity)
+    {
+        uint32_t new_capacity = edit->new_column_capacity ? edit->new_column_capacity * 2 : 8;
+        if (new_capacity < needed)
+        {
+            new_capacity = needed;
+        }
+        jio_csv_column* const new_ptr = jio_realloc(ctx, edit->new_columns, sizeof(*new_ptr) * new_capacity);
+        if (!new_ptr)
+        {
+            JIO_ERROR(ctx, "Could not reallocate memory for csv edit columns");
+            return JIO_RESULT_BAD_ALLOC;
+        }
+        edit->new_columns = new_ptr;
+        edit->new_column_capacity = new_capacity;
+    }
+    csv_edit_op* const op = csv_edit_push_op(ctx, &edit->col_ops, &edit->col_op_count, &edit->col_op_capacity);
+    if (!op)
+    {
+        return JIO_RESULT_BAD_ALLOC;
+    }
+    op->position = begin;
+    op->remove_count = count;
+    op->insert_count = col_count;
+    op->insert_offset = edit->new_column_count;
+    if (col_count)
+    {
+        memcpy(edit->new_columns + edit->new_column_count, cols, sizeof(*cols) * col_count);
+        edit->new_column_count += col_count;
+    }
+    return JIO_RESULT_SUCCESS;
+}
+
+jio_result jio_csv_edit_add_cols(jio_csv_edit* edit, uint32_t position, uint32_t col_count, const jio_csv_column* cols)
+{
+    return jio_csv_edit_replace_cols(edit, position, 0, col_count, cols);
+}
+
+jio_result jio_csv_edit_remove_cols(jio_csv_edit* edit, uint32_t position, uint32_t col_count)
+{
+    return jio_csv_edit_replace_cols(edit, position, col_count, 0, NULL);
+}
+
+static int csv_edit_op_compare(const void* a, const void* b)
+{
+    const csv_edit_op* const op1 = a, * const op2 = b;
+    if (op1->position != op2->position)
+    {
+        return op1->position < op2->position ? -1 : +1;
+    }
+    return op1->order < op2->order ? -1 : (op1->order > op2->order);
+}
+
+//  Sorts the operations by position and checks that no two remove the same rows/columns. Insertions which fall
+//  inside a removed range are placed where that range used to be.
+static jio_result csv_edit_prepare_ops(
+        const jio_context* ctx, csv_edit_op* ops, uint32_t op_count, uint32_t original_count, uint32_t* p_new_count,
+        const char* what)
+{
+    if (op_count)
+    {
+        qsort(ops, op_count, sizeof(*ops), csv_edit_op_compare);
+    }
+    uint64_t new_count = original_count;
+    uint32_t cursor = 0;
+    for (uint32_t i = 0; i < op_count; ++i)
+    {
+        const csv_edit_op* const op = ops + i;
+        if (op->remove_count)
+        {
+            if (op->position < cursor)
+            {
+                JIO_ERROR(ctx, "Csv edit removes %s on [%"PRIu32", %"PRIu32") more than once", what, op->position, cursor);
+                return JIO_RESULT_BAD_VALUE;
+            }
+            cursor = op->position + op->remove_count;
+        }
+        new_count += op->insert_count;
+        new_count -= op->remove_count;
+    }
+    if (new_count > UINT32_MAX)
+    {
+        JIO_ERROR(ctx, "Csv edit would result in %"PRIu64" %s, which is too many", new_count, what);
+        return JIO_RESULT_BAD_INDEX;
+    }
+    *p_new_count = (uint32_t)new_count;
+    return JIO_RESULT_SUCCESS;
+}
+
+typedef struct csv_edit_merge_job_T csv_edit_merge_job;
+struct csv_edit_merge_job_T
+{
+    const jio_csv_edit* edit;
+    jio_string_segment** new_elements;      //  New element arrays for each original column (NULL if it is removed)
+};
+
+//  Builds the new elements of a column in a single pass over the original ones
+static void csv_edit_merge_task(void* param, uint32_t index)
+{
+    const csv_edit_merge_job* const job = param;
+    jio_string_segment* out = job->new_elements[index];
+    if (!out)
+    {
+        return;
+    }
+    const jio_csv_edit* const edit = job->edit;
+    const jio_string_segment* const in = edit->data->columns[index].elements;
+    uint32_t cursor = 0;
+    for (uint32_t i = 0; i < edit->row_op_count; ++i)
+    {
+        const csv_edit_op* const op = edit->row_ops + i;
+        if (op->position > cursor)
+        {
+            memcpy(out, in + cursor, sizeof(*out) * (op->position - cursor));
+            out += op->position - cursor;
+            cursor = op->position;
+        }
+        const jio_string_segment* inserted = edit->elements + op->insert_offset + index;
+        for (uint32_t j = 0; j < op->insert_count; ++j)
+        {
+            *out = *inserted;
+            out += 1;
+            inserted += edit->column_count;
+        }
+        if (op->remove_count)
+        {
+            cursor = op->position + op->remove_count;
+        }
+    }
+    memcpy(out, in + cursor, sizeof(*out) * (edit->column_length - cursor));
+}
+
+jio_result jio_csv_edit_commit(jio_csv_edit* edit, bool shrink_to_fit)
+{
+    const jio_context* const ctx = edit->ctx;
+    jio_csv_data* const data = edit->data;
+    jio_result res;
+    jio_string_segment** new_elements = NULL;
+    jio_csv_column* new_columns = NULL;
+    uint32_t new_length, new_column_count;
+    assert(data->column_count == edit->column_count && data->column_length == edit->column_length);
+
+    if ((res = csv_edit_prepare_ops(ctx, edit->row_ops, edit->row_op_count, edit->column_length, &new_length, "rows")))
+    {
+        goto end;
+    }
+    if ((res = csv_edit_prepare_ops(ctx, edit->col_ops, edit->col_op_count, edit->column_count, &new_column_count, "columns")))
+    {
+        goto end;
+    }
+    for (uint32_t i = 0; i < edit->new_column_count; ++i)
+    {
+        if (edit->new_columns[i].count != new_length)
+        {
+            JIO_ERROR(ctx, "Column %u to be inserted had a length of %"PRIu32", but others will have the length of %"PRIu32, i, edit->new_columns[i].count, new_length);
+            res = JIO_RESULT_BAD_CSV_COLUMN;
+        }
+    }
+    if (res != JIO_RESULT_SUCCESS)
+    {
+        goto end;
+    }
+
+    //  Everything is allocated before data is touched, so that failure leaves it unchanged
+    new_columns = jio_alloc(ctx, sizeof(*new_columns) * (new_column_count ? new_column_count : 1));
+    new_elements = jio_alloc(ctx, sizeof(*new_elements) * (edit->column_count ? edit->column_count : 1));
+    if (!new_columns || !new_elements)
+    {
+        JIO_ERROR(ctx, "Could not allocate memory for csv edit");
+        res = JIO_RESULT_BAD_ALLOC;
+        goto end;
+    }
+    memset(new_elements, 0, sizeof(*new_elements) * edit->column_count);
+    const bool rebuild_rows = edit->row_op_count || shrink_to_fit;
+    uint32_t row_capacity = new_length ? new_length : 1;
+    if (!shrink_to_fit && edit->column_count)
+    {
+        const uint32_t capacity = data->columns[0].capacity;
+        row_capacity = new_length < capacity ? capacity : csv_grow_row_capacity(capacity, new_length, 64);
+    }
+    //  Mark removed columns, which need not be rebuilt
+    uint32_t col_op = 0;
+    for (uint32_t i = 0; i < edit->column_count && rebuild_rows; ++i)
+    {
+        while (col_op < edit->col_op_count && edit->col_ops[col_op].position + edit->col_ops[col_op].remove_count <= i)
+        {
+            col_op += 1;
+        }
+        if (col_op < edit->col_op_count && edit->col_ops[col_op].position <= i)
+        {
+            continue;
+        }
+        new_elements[i] = jio_alloc(ctx, sizeof(**new_elements) * row_capacity);
+        if (!new_elements[i])
+        {
+            JIO_ERROR(ctx, "Could not allocate memory for %"PRIu32" elements of column %u", row_capacity, i);
+            res = JIO_RESULT_BAD_ALLOC;
+            goto end;
+        }
+    }
+
+    if (rebuild_rows)
+    {
+        const csv_edit_merge_job job = {.edit = edit, .new_elements = new_elements};
+        jio_parallel_for(ctx, edit->column_count, csv_edit_merge_task, (void*)&job);
+    }
+
+    //  Update stats of columns, which still have their original indices
+    for (uint32_t i = 0; i < edit->column_count && data->stats; ++i)
+    {
+        for (uint32_t j = 0; j < edit->row_op_count; ++j)
+        {
+            const csv_edit_op* const op = edit->row_ops + j;
+            csv_stats_remove(data, i, data->columns[i].elements + op->position, op->remove_count);
+            for (uint32_t k = 0; k < op->insert_count; ++k)
+            {
+                csv_stats_add(data, i, edit->elements + op->insert_offset + (size_t)k * edit->column_count + i, 1);
+            }
+        }
+    }
+    if (edit->col_op_count)
+    {
+        csv_stats_drop(data);
+    }
+
+    //  Assemble the new array of columns
+    uint32_t out = 0, cursor = 0;
+    for (uint32_t i = 0; i <= edit->col_op_count; ++i)
+    {
+        const csv_edit_op* const op = i < edit->col_op_count ? edit->col_ops + i : NULL;
+        const uint32_t keep_end = op ? op->position : edit->column_count;
+        for (; cursor < keep_end; ++cursor)
+        {
+            jio_csv_column* const column = data->columns + cursor;
+            if (rebuild_rows)
+            {
+                csv_elements_release(data, column->elements);
+                column->elements = new_elements[cursor];
+                new_elements[cursor] = NULL;
+                column->capacity = row_capacity;
+                column->count = new_length;
+            }
+            new_columns[out++] = *column;
+        }
+        if (!op)
+        {
+            break;
+        }
+        memcpy(new_columns + out, edit->new_columns + op->insert_offset, sizeof(*new_columns) * op->insert_count);
+        out += op->insert_count;
+        if (op->remove_count)
+        {
+            for (; cursor < op->position + op->remove_count; ++cursor)
+            {
+                csv_elements_release(data, data->columns[cursor].elements);
+            }
+        }
+    }
+    assert(out == new_column_count);
+    jio_free(ctx, data->columns);
+    data->columns = new_columns;
+    new_columns = NULL;
+    data->column_count = new_column_count;
+    if (edit->col_op_count)
+    {
+        csv_header_index_drop(data);
+    }
+    data->column_capacity = new_column_count ? new_column_count : 1;
+    data->column_length = new_length;
+    //  Column operations are applied from the last, so that positions of the earlier ones stay valid
+    for (uint32_t i = edit->col_op_count; i > 0; --i)
+    {
+        const csv_edit_op* const op = edit->col_ops + i - 1;
+        csv_indices_replace_columns(data, op->position, op->remove_count, op->insert_count);
+    }
+    if (edit->row_op_count)
+    {
+        csv_indices_invalidate(data, UINT32_MAX);
+    }
+
+end:
+    if (new_elements)
+    {
+        for (uint32_t i = 0; i < edit->column_count; ++i)
+        {
+            jio_free(ctx, new_elements[i]);
+        }
+        jio_free(ctx, new_elements);
+    }
+    jio_free(ctx, new_columns);
+    jio_csv_edit_abort(edit);
+    return res;
+}
+
+static jio_result csv_arena_table_grow(const jio_context* ctx, csv_string_arena* arena)
+{
+    const uint32_t new_capacity = arena->table_capacity ? arena->table_capacity * 2 : 1024;
+    jio_string_segment* const table = jio_alloc(ctx, sizeof(*table) * new_capacity);
+    if (!table)
+    {
+        JIO_ERROR(ctx, "Could not allocate memory for csv string table");
+        return JIO_RESULT_BAD_ALLOC;
+    }
+    memset(table, 0, sizeof(*table) * new_capacity);
+    for (uint32_t i = 0; i < arena->table_capacity; ++i)
+    {
+        const jio_string_segment entry = arena->table[i];
+        if (!entry.begin)
+        {
+            continue;
+        }
+        uint32_t j = (uint32_t)csv_string_hash(entry.begin, entry.len) & (new_capacity - 1);
+        while (table[j].begin)
+        {
+            j = (j + 1) & (new_capacity - 1);
+        }
+        table[j] = entry;
+    }
+    jio_free(ctx, arena->table);
+    arena->table = table;
+    arena->table_capacity = new_capacity;
+    return JIO_RESULT_SUCCESS;
+}
+
+//  Copies the string into the data's arena (creating it if needed), so that its lifetime matches the data
+static jio_result csv_copy_string(
+        const jio_context* ctx, jio_csv_data* data, const jio_string_segment* str, jio_string_segment* p_out)
+{
+    csv_string_arena* arena = data->arena;
+    if (!arena)
+    {
+        arena = jio_alloc(ctx, sizeof(*arena));
+        if (!arena)
+        {
+            JIO_ERROR(ctx, "Could not allocate memory for csv string arena");
+            return JIO_RESULT_BAD_ALLOC;
+        }
+        memset(arena, 0, sizeof(*arena));
+        data->arena = arena;
+    }
+
+    uint32_t slot = 0;
+    if (data->deduplicate)
+    {
+        if (2 * (arena->table_count + 1) > arena->table_capacity)
+        {
+            const jio_result res = csv_arena_table_grow(ctx, arena);
+            if (res != JIO_RESULT_SUCCESS)
+            {
+                return res;
+            }
+        }
+        slot = (uint32_t)csv_string_hash(str->begin, str->len) & (arena->table_capacity - 1);
+        for (; arena->table[slot].begin; slot = (slot + 1) & (arena->table_capacity - 1))
+        {
+            const jio_string_segment entry = arena->table[slot];
+            if (entry.len == str->len && memcmp(entry.begin, str->begin, str->len) == 0)
+            {
+                *p_out = entry;
+                return JIO_RESULT_SUCCESS;
+            }
+        }
+    }
+
+    //  Strings are stored with a terminating zero
+    csv_arena_block* block = arena->current;
+    const size_t needed = str->len + 1;
+    if (!block || block->capacity - block->used < needed)
+    {
+        const size_t capacity = needed > CSV_ARENA_BLOCK_SIZE ? needed : CSV_ARENA_BLOCK_SIZE;
+        block = jio_alloc(ctx, sizeof(*block) + capacity);
+        if (!block)
+        {
+            JIO_ERROR(ctx, "Could not allocate %zu bytes for csv string arena", capacity);
+            return JIO_RESULT_BAD_ALLOC;
+        }
+        block->capacity = capacity;
+        block->used = 0;
+        if (arena->current && needed > CSV_ARENA_BLOCK_SIZE)
+        {
+            //  Oversized strings get their own block, so the current one can still be filled
+            block->prev = arena->current->prev;
+            arena->current->prev = block;
+        }
+        else
+        {
+            block->prev = arena->current;
+            arena->current = block;
+        }
+    }
+    char* const ptr = block->data + block->used;
+    memcpy(ptr, str->begin, str->len);
+    ptr[str->len] = 0;
+    block->used += needed;
+    *p_out = (jio_string_segment){.begin = ptr, .len = str->len};
+
+    if (data->deduplicate)
+    {
+        arena->table[slot] = *p_out;
+        arena->table_count += 1;
+    }
+    return JIO_RESULT_SUCCESS;
+}
+
+void jio_csv_set_deduplication(jio_csv_data* data, bool deduplicate)
+{
+    if (!deduplicate && data->arena)
+    {
+        //  Table is no longer kept up to date, so it must be dropped
+        jio_free(data->ctx, data->arena->table);
+        data->arena->table = NULL;
+        data->arena->table_count = 0;
+        data->arena->table_capacity = 0;
+    }
+    data->deduplicate = deduplicate;
+}
+
+jio_result jio_csv_copy_string(
+        const jio_context* ctx, jio_csv_data* data, jio_string_segment str, jio_string_segment* p_out)
+{
+    return csv_copy_string(ctx, data, &str, p_out);
+}
+
+jio_result jio_csv_set_cell(
+        const jio_context* ctx, jio_csv_data* data, uint32_t column, uint32_t row, jio_string_segment value)
+{
+    jio_result res;
+    if ((res = csv_make_eager(data)))
+    {
+        return res;
+    }
+    if (column >= data->column_count || row >= data->column_length)
+    {
+        JIO_ERROR(ctx, "Cell (%"PRIu32", %"PRIu32") was to be set, but csv data has only %u columns and %u rows", column, row, data->column_count, data->column_length);
+        return JIO_RESULT_BAD_INDEX;
+    }
+    jio_string_segment copy;
+    if ((res = csv_copy_string(ctx, data, &value, &copy)))
+    {
+        return res;
+    }
+    if ((res = csv_column_prepare(data, column, row)))
+    {
+        return res;
+    }
+    csv_stats_remove(data, column, data->columns[column].elements + row, 1);
+    csv_stats_add(data, column, &copy, 1);
+    data->columns[column].elements[row] = copy;
+    csv_indices_invalidate(data, column);
+    return JIO_RESULT_SUCCESS;
+}
+
+//  Copies rows into the arena, giving back an array of row pointers to pass on, which must be freed with jio_free_stack
+static jio_result csv_copy_rows(
+        const jio_context* ctx, jio_csv_data* data, uint32_t row_count, const jio_string_segment* const* rows,
+        jio_string_segment*** p_out)
+{
+    const uint32_t column_count = data->column_count;
+    jio_string_segment** const out = jio_alloc_stack(
+            ctx, sizeof(*out) * row_count + sizeof(**out) * row_count * column_count);
+    if (!out)
+    {
+        JIO_ERROR(ctx, "Could not allocate memory for copying csv rows");
+        return JIO_RESULT_BAD_ALLOC;
+    }
+    jio_string_segment* const elements = (jio_string_segment*)(out + row_count);
+    for (uint32_t i = 0; i < row_count; ++i)
+    {
+        out[i] = elements + (size_t)i * column_count;
+        for (uint32_t j = 0; j < column_count; ++j)
+        {
+            const jio_result res = csv_copy_string(ctx, data, rows[i] + j, out[i] + j);
+            if (res != JIO_RESULT_SUCCESS)
+            {
+                jio_free_stack(ctx, out);
+                return res;
+            }
+        }
+    }
+    *p_out = out;
+    return JIO_RESULT_SUCCESS;
+}
+
+jio_result jio_csv_add_rows_copy(
+        const jio_context* ctx, jio_csv_data* data, uint32_t position, uint32_t row_count,
+        const jio_string_segment* const* rows)
+{
+    jio_result res;
+    if ((res = csv_make_eager(data)))
+    {
+        return res;
+    }
+    jio_string_segment** copies;
+    if ((res = csv_copy_rows(ctx, data, row_count, rows, &copies)))
+    {
+        return res;
+    }
+    res = jio_csv_add_rows(ctx, data, position, row_count, (const jio_string_segment* const*)copies);
+    jio_free_stack(ctx, copies);
+    return res;
+}
+
+jio_result jio_csv_replace_rows_copy(
+        const jio_context* ctx, jio_csv_data* data, uint32_t begin, uint32_t count, uint32_t row_count,
+        const jio_string_segment* const* rows)
+{
+    jio_result res;
+    if ((res = csv_make_eager(data)))
+    {
+        return res;
+    }
+    jio_string_segment** copies;
+    if ((res = csv_copy_rows(ctx, data, row_count, rows, &copies)))
+    {
+        return res;
+    }
+    res = jio_csv_replace_rows(ctx, data, begin, count, row_count, (const jio_string_segment* const*)copies);
+    jio_free_stack(ctx, copies);
+    return res;
+}
+
+jio_result jio_csv_add_cols_copy(
+        const jio_context* ctx, jio_csv_data* data, uint32_t position, uint32_t col_count, const jio_csv_column* cols)
+{
+    jio_result res;
+    if ((res = csv_make_eager(data)))
+    {
+        return res;
+    }
+    jio_csv_column* const copies = jio_alloc_stack(ctx, sizeof(*copies) * col_count);
+    if (!copies)
+    {
+        JIO_ERROR(ctx, "Could not allocate memory for copying csv columns");
+        return JIO_RESULT_BAD_ALLOC;
+    }
+    memset(copies, 0, sizeof(*copies) * col_count);
+    for (uint32_t i = 0; i < col_count; ++i)
+    {
+        const jio_csv_column* const src = cols + i;
+        jio_csv_column* const dst = copies + i;
+        dst->count = src->count;
+        dst->capacity = src->count ? src->count : 1;
+        dst->elements = jio_alloc(ctx, sizeof(*dst->elements) * dst->capacity);
+        if (!dst->elements)
+        {
+            JIO_ERROR(ctx, "Could not allocate memory for column elements");
+            res = JIO_RESULT_BAD_ALLOC;
+            goto end;
+        }
+        if ((res = csv_copy_string(ctx, data, &src->header, &dst->header)))
+        {
+            goto end;
+        }
+        for (uint32_t j = 0; j < src->count; ++j)
+        {
+            if ((res = csv_copy_string(ctx, data, src->elements + j, dst->elements + j)))
+            {
+                goto end;
+            }
+        }
+    }
+    res = jio_csv_add_cols(ctx, data, position, col_count, copies);
+
+end:
+    if (res != JIO_RESULT_SUCCESS)
+    {
+        for (uint32_t i = 0; i < col_count; ++i)
+        {
+            jio_free(ctx, copies[i].elements);
+        }
+    }
+    jio_free_stack(ctx, copies);
+    return res;
+}
+
+jio_result jio_csv_column_index(const jio_csv_data* data, const jio_csv_column* column, uint32_t* p_idx)
+{
+    jio_result res = JIO_RESULT_SUCCESS;
+
+    const uintptr_t idx = column - data->columns;
+    if (idx < data->column_count)
+    {
+        *p_idx = idx;
+    }
+    else
+    {
+        res = JIO_RESULT_BAD_PTR;
+    }
+
+    return res;
+}
+
+jio_result jio_process_csv_exact(
+        const jio_context* ctx, const jio_memory_file* mem_file, const char* separator, uint32_t column_count,
+        const jio_string_segment* headers, bool (** converter_array)(jio_string_segment*, void*), void** param_array)
+{
+    {
+        bool converters_complete = true;
+        for (uint32_t i = 0; i < column_count; ++i)
+        {
+            if (converter_array[i] == NULL)
+            {
+                converters_complete = false;
+                JIO_ERROR(ctx, "Converter for column %u (%.*s) was not provided", i, (int)headers[i].len, headers[i].begin);
+            }
+        }
+        if (!converters_complete)
+        {
+            return JIO_RESULT_BAD_CONVERTER;
+        }
+    }
+    jio_result res;
+
+    //  Parse the first row
+    const char* row_begin = mem_file->ptr;
+    const char* row_end = strchr(row_begin, '\n');
+    jio_string_segment* segments = NULL;
+    //  Count columns in the csv file
+    size_t sep_len = strlen(separator);
+    {
+        const uint32_t real_column_count = count_row_entries(
+                row_begin, row_end ? row_end : (const char*)mem_file->ptr + mem_file->file_size, separator, sep_len);
+        if (real_column_count != column_count)
+        {
+            JIO_ERROR(ctx, "Csv file has %"PRIu32" columns, but %"PRIu32" were specified", real_column_count, column_count);
+            res = JIO_RESULT_BAD_CSV_HEADER;
+            goto end;
+        }
+    }
+    segments = jio_alloc_stack(ctx, sizeof(*segments) * column_count);
+    if (!segments)
+    {
+        res = JIO_RESULT_BAD_ALLOC;
+        JIO_ERROR(ctx, "Could not allocate memory for csv parsing");
+        goto end;
+    }
+    if ((res = extract_row_entries(NULL, column_count, row_begin, row_end, separator, sep_len, true, segments, 1, NULL)) != JIO_RESULT_SUCCESS)
+    {
+        JIO_ERROR(ctx, "Failed extracting the headers from CSV file \"%s\", reason: %s", mem_file->name,
+                  jio_result_to_str(res));
+        goto end;
+    }
+    for (uint32_t i = 0; i < column_count; ++i)
+    {
+        if (!jio_string_segment_equal(segments + i, headers + i))
+        {
+            JIO_ERROR(ctx, "Column %u had a header \"%.*s\", but \"%.*s\" was expected", i + 1, (int)segments[i].len, segments[i].begin, (int)headers[i].len, headers[i].begin);
+            goto end;
+        }
+    }
+
+    uint32_t row_count = 0;
+    while (row_end)
+    {
+        if ((res = extract_row_entries(NULL, column_count, row_begin, row_end, separator, sep_len, true, segments, 1, NULL)))
+        {
+            JIO_ERROR(ctx, "Failed parsing row %u of CSV file \"%s\", reason: %s", row_count + 1, mem_file->name, jio_result_to_str(res));
+            goto end;
+        }
+        for (uint32_t i = 0; row_count && i < column_count; ++i)
+        {
+            if (!converter_array[i](segments + i, param_array[i]))
+            {
+                JIO_ERROR(ctx, "Element %"PRIu32" in row %"PRIu32" could not be converted", i + 1, row_count + 1);
+                res = JIO_RESULT_BAD_VALUE;
+                goto end;
+            }
+        }
+
+        row_count += 1;
+        //  Move to the next row
+        row_begin = row_end + 1;
+        row_end = strchr(row_end + 1, '\n');
+    }
+
+end:
+    jio_free_stack(ctx, segments);
+    return res;
+}
+
+jio_result jio_process_csv_blocks(
+        const jio_context* ctx, const jio_memory_file* mem_file, const char* separator, bool trim_whitespace,
+        bool has_headers, uint32_t block_rows,
+        bool (* block_callback)(uint32_t column_count, uint32_t row_count, const jio_string_segment* headers, const jio_string_segment* const* columns, void* param),
+        void* param)
+{
+    if (!block_rows)
+    {
+        JIO_ERROR(ctx, "Block size for csv processing must be non-zero");
+        return JIO_RESULT_BAD_VALUE;
+    }
+    jio_string_segment* headers = NULL;
+    jio_string_segment* block = NULL;
+    jio_string_segment** columns = NULL;
+
+    //  Parser finds the columns and parses the headers, after which its rows are extracted into the block
+    const jio_csv_parse_info info =
+            {
+                    .separator = separator,
+                    .trim_whitespace = trim_whitespace,
+                    .has_headers = has_headers,
+            };
+    jio_csv_parser* parser;
+    jio_result res = csv_parser_create(ctx, mem_file, &info, &parser);
+    if (res != JIO_RESULT_SUCCESS)
+    {
+        return res;
+    }
+    const uint32_t column_count = parser->column_count;
+
+    //  Block buffer is column-major, so each column of the block is contiguous and reused for every block
+    block = jio_alloc_stack(ctx, sizeof(*block) * block_rows * column_count);
+    columns = jio_alloc_stack(ctx, sizeof(*columns) * column_count);
+    if (has_headers)
+    {
+        headers = jio_alloc_stack(ctx, sizeof(*headers) * column_count);
+    }
+    if (!block || !columns || (has_headers && !headers))
+    {
+        res = JIO_RESULT_BAD_ALLOC;
+        JIO_ERROR(ctx, "Could not allocate memory for csv block of %"PRIu32" rows", block_rows);
+        goto end;
+    }
+    for (uint32_t i = 0; i < column_count; ++i)
+    {
+        columns[i] = block + (size_t)i * block_rows;
+        if (headers)
+        {
+            headers[i] = parser->columns[i].header;
+        }
+    }
+
+    uint32_t block_count = 0;
+    while (parser->has_rows)
+    {
+        if ((res = csv_parser_extract_row(parser, block + block_count, block_rows)))
+        {
+            goto end;
+        }
+        block_count += 1;
+        csv_parser_advance(parser);
+
+        if (block_count == block_rows || !parser->has_rows)
+        {
+            if (!block_callback(column_count, block_count, headers, (const jio_string_segment* const*)columns, param))
+            {
+                //  Callback asked for processing to stop
+                break;
+            }
+            block_count = 0;
+        }
+    }
+
+end:
+    jio_free_stack(ctx, headers);
+    jio_free_stack(ctx, columns);
+    jio_free_stack(ctx, block);
+    jio_csv_parser_destroy(parser);
+    return res;
+}
+
+//  Rows of csv data per task when printing
+#define CSV_PRINT_ROWS_PER_TASK 4096
+
+typedef struct csv_print_job_T csv_print_job;
+struct csv_print_job_T
+{
+    const jio_csv_data* data;
+    //  Scan of the elements
+    size_t* block_chars;                    //  Total length of elements in each block of rows
+    //  Printing
+    char* buffer;
+    const size_t* offsets;                  //  Offset in the buffer where each block of rows is printed
+    const char* separator;
+    size_t sep_len;
+    uint32_t extra_padding;
+    uint32_t min_width;
+    bool align_left;
+};
+
+static void csv_print_scan_task(void* param, uint32_t index)
+{
+    const csv_print_job* const job = param;
+    const jio_csv_data* const data = job->data;
+    const uint32_t begin = index * CSV_PRINT_ROWS_PER_TASK;
+    const uint32_t end = data->column_length - begin < CSV_PRINT_ROWS_PER_TASK ? data->column_length : begin + CSV_PRINT_ROWS_PER_TASK;
+    size_t chars = 0;
+    for (uint32_t i = 0; i < data->column_count; ++i)
+    {
+        const jio_string_segment* const elements = data->columns[i].elements;
+        for (uint32_t j = begin; j < end; ++j)
+        {
+            chars += elements[j].len;
+        }
+    }
+    job->block_chars[index] = chars;
+}
+
+jio_result jio_csv_print_size(
+        const jio_csv_data* const data, size_t* const p_size, const size_t separator_length, const uint32_t extra_padding, const bool same_width)
+{
+    jio_result res = JIO_RESULT_SUCCESS;
+    if ((res = csv_materialize_all(data)))
+    {
+        return res;
+    }
+
+    if ((res = csv_stats_compute(data)))
+    {
+        return res;
+    }
+    size_t total_chars = 0;
+    uint32_t width = 0;
+    for (uint32_t i = 0; i < data->column_count; ++i)
+    {
+        const jio_csv_column* const column = data->columns + i;
+        total_chars += column->header.len + data->stats[i].total_length;
+        if (column->header.len > width)
+        {
+            width = column->header.len;
+        }
+        if (data->stats[i].max_length > width)
+        {
+            width = data->stats[i].max_length;
+        }
+    }
+    if (!same_width)
+    {
+        //  characters needed to pad entries
+        total_chars += (size_t)(extra_padding) * (data->column_length + 1) * data->column_count;
+    }
+    else
+    {
+        //  characters needed to fit entries
+        total_chars = (size_t)(width + extra_padding) * (data->column_length + 1) * data->column_count;
+    }
+    //  characters needed for separators
+    total_chars += (size_t)(data->column_count - 1) * (data->column_length + 1) * separator_length;
+    //  Characters needed for new line characters (headers included)
+    total_chars += (size_t)(data->column_length) + 1;
+
+    *p_size = total_chars + 1;
+
+    return res;
+}
+
+static size_t print_entry(char* restrict buffer, const char* restrict src, size_t n, uint32_t extra_padding, uint32_t min_width, bool align_left)
+{
+    uint32_t same_pad = 0;
+    if (n < min_width)
+    {
+        same_pad = min_width - n;
+    }
+    if (align_left)
+    {
+        memcpy(buffer, src, n);
+        memset(buffer + n, ' ', same_pad + extra_padding);
+    }
+    else
+    {
+        memset(buffer, ' ', same_pad + extra_padding);
+        memcpy(buffer + same_pad + extra_padding, src, n);
+    }
+    return same_pad + extra_padding + n;
+}
+
+static char* print_rows(const csv_print_job* job, uint32_t begin, uint32_t end, char* pos)
+{
+    const jio_csv_data* const data = job->data;
+    for (uint32_t i = begin; i < end; ++i)
+    {
+        pos += print_entry(pos, data->columns[0].elements[i].begin, data->columns[0].elements[i].len, job->extra_padding, job->min_width, job->align_left);
+        for (uint32_t j = 1; j < data->column_count; ++j)
+        {
+            const jio_string_segment segment = data->columns[j].elements[i];
+            memcpy(pos, job->separator, job->sep_len); pos += job->sep_len;
+            pos += print_entry(pos, segment.begin, segment.len, job->extra_padding, job->min_width, job->align_left);
+        }
+        *pos = '\n'; ++pos;
+    }
+    return pos;
+}
+
+static void csv_print_task(void* param, uint32_t index)
+{
+    const csv_print_job* const job = param;
+    const uint32_t begin = index * CSV_PRINT_ROWS_PER_TASK;
+    const uint32_t end = job->data->column_length - begin < CSV_PRINT_ROWS_PER_TASK ? job->data->column_length : begin + CSV_PRINT_ROWS_PER_TASK;
+    char* const pos = print_rows(job, begin, end, job->buffer + job->offsets[index]);
+    (void)pos;
+    assert(pos == job->buffer + job->offsets[index + 1]);
+}
+
+jio_result jio_csv_print(
+        const jio_csv_data* data, size_t* p_usage, char* restrict buffer, const char* separator, uint32_t extra_padding, bool same_width,
+        bool align_left)
+{
+    jio_result res = JIO_RESULT_SUCCESS;
+    if ((res = csv_materialize_all(data)))
+    {
+        return res;
+    }
+    const jio_context* const ctx = data->ctx;
+    const uint32_t block_count = (data->column_length + CSV_PRINT_ROWS_PER_TASK - 1) / CSV_PRINT_ROWS_PER_TASK;
+    //  With multiple threads, each block of rows is printed separately. Output size of each block is found first, so that
+    //  offsets where blocks are printed are known in advance.
+    const bool parallel = ctx->thread_count > 1 && block_count > 1;
+    size_t* offsets = NULL;
+    csv_print_job job =
+            {
+                    .data = data,
+                    .buffer = buffer,
+                    .separator = separator,
+                    .sep_len = strlen(separator),
+                    .extra_padding = extra_padding,
+                    .min_width = 0,
+                    .align_left = align_left,
+            };
+    if (same_width)
+    {
+        if ((res = csv_stats_compute(data)))
+        {
+            return res;
+        }
+        for (uint32_t i = 0; i < data->column_count; ++i)
+        {
+            if (data->columns[i].header.len > job.min_width)
+            {
+                job.min_width = data->columns[i].header.len;
+            }
+            if (data->stats[i].max_length > job.min_width)
+            {
+                job.min_width = data->stats[i].max_length;
+            }
+        }
+    }
+    if (parallel)
+    {
+        offsets = jio_alloc(ctx, (sizeof(*offsets) * 2) * (block_count + 1));
+        if (!offsets)
+        {
+            JIO_ERROR(ctx, "Could not allocate memory for csv print job");
+            return JIO_RESULT_BAD_ALLOC;
+        }
+        job.block_chars = offsets + block_count + 1;
+        if (!same_width)
+        {
+            //  Lengths of elements are needed for each block, so totals of columns are not enough
+            jio_parallel_for(ctx, block_count, csv_print_scan_task, &job);
+        }
+    }
+
+    //  Print headers
+    char* pos = buffer;
+    pos += print_entry(pos, data->columns[0].header.begin, data->columns[0].header.len, extra_padding, job.min_width, align_left);
+    for (uint32_t i = 1; i < data->column_count; ++i)
+    {
+        memcpy(pos, separator, job.sep_len); pos += job.sep_len;
+        pos += print_entry(pos, data->columns[i].header.begin, data->columns[i].header.len, extra_padding, job.min_width, align_left);
+    }
+    *pos = '\n'; ++pos;
+
+    //  Now to print all entries to the buffer
+    if (parallel)
+    {
+        //  Width of each entry is either its length, or the same for all of them
+        const size_t row_overhead = (size_t)(data->column_count - 1) * job.sep_len + 1;
+        offsets[0] = pos - buffer;
+        for (uint32_t i = 0; i < block_count; ++i)
+        {
+            const uint32_t rows = i + 1 == block_count ? data->column_length - i * CSV_PRINT_ROWS_PER_TASK : CSV_PRINT_ROWS_PER_TASK;
+            const size_t cells = (size_t)rows * data->column_count;
+            const size_t chars = same_width ? cells * job.min_width : job.block_chars[i];
+            offsets[i + 1] = offsets[i] + chars + cells * extra_padding + rows * row_overhead;
+        }
+        job.offsets = offsets;
+        jio_parallel_for(ctx, block_count, csv_print_task, &job);
+        pos = buffer + offsets[block_count];
+        jio_free(ctx, offsets);
+    }
+    else
+    {
+        pos = print_rows(&job, 0, data->column_length, pos);
+    }
+    *pos = 0;
+
+    if (p_usage)
+    {
+        *p_usage = pos - buffer;
+    }
+
+    return res;
+}
+
+//  Snapshots store csv data in the following layout, so that they can be used directly once mapped to memory:
+//      - header
+//      - column directory, with an entry for each column
+//      - compact cells of each column
+//      - string heap, which offsets of headers and cells are relative to
+#define CSV_SNAPSHOT_MAGIC "JIOCSVS"
+#define CSV_SNAPSHOT_VERSION 1
+#define CSV_SNAPSHOT_BYTE_ORDER 0x01020304
+#define CSV_SNAPSHOT_HAS_SOURCE 1
+
+typedef struct csv_snapshot_header_T csv_snapshot_header;
+struct csv_snapshot_header_T
+{
+    char magic[8];                          //  Identifies the file as a snapshot
+    uint32_t version;                       //  Version of the format
+    uint32_t byte_order;                    //  Detects snapshots made on machines with different byte order
+    uint32_t column_count;
+    uint32_t row_count;
+    uint32_t flags;
+    uint32_t padding;
+    uint64_t source_size;                   //  Size of the contents of the file data was parsed from
+    uint64_t source_hash;                   //  Hash of the file data was parsed from
+    uint64_t heap_offset;                   //  Offset of the string heap from the start of the snapshot
+    uint64_t heap_size;                     //  Size of the string heap
+};
+
+typedef struct csv_snapshot_column_T csv_snapshot_column;
+struct csv_snapshot_column_T
+{
+    uint32_t header_offset;                 //  Offset of the header in the string heap
+    uint32_t header_len;                    //  Length of the header
+    uint64_t cells_offset;                  //  Offset of the column's cells from the start of the snapshot
+};
+
+//  Length of the contents of the file, which end at the first null character as they do for the parser. Mapping of the
+//  file can be longer than its contents, by a different amount on each platform.
+static size_t csv_snapshot_source_size(const jio_memory_file* source)
+{
+    const char* const end = memchr(source->ptr, 0, source->file_size);
+    return end ? (size_t)(end - (const char*)source->ptr) : source->file_size;
+}
+
+//  Hashes the contents of the file eight bytes at a time, which is far cheaper than parsing it
+static uint64_t csv_snapshot_source_hash(const jio_memory_file* source, size_t size)
+{
+    const unsigned char* const ptr = source->ptr;
+    uint64_t hash = 0x9E3779B97F4A7C15 ^ size;
+    size_t i;
+    for (i = 0; i + 8 <= size; i += 8)
+    {
+        uint64_t word;
+        memcpy(&word, ptr + i, sizeof(word));
+        hash = (hash ^ word) * 0xBF58476D1CE4E5B9;
+        hash ^= hash >> 31;
+    }
+    for (; i < size; ++i)
+    {
+        hash = (hash ^ ptr[i]) * 0x94D049BB133111EB;
+    }
+    return hash;
+}
+
+typedef struct csv_snapshot_job_T csv_snapshot_job;
+struct csv_snapshot_job_T
+{
+    const jio_csv_data* data;
+    unsigned char* snapshot;
+    const csv_snapshot_column* directory;
+    char* heap;
+    const uint64_t* heap_offsets;           //  Offset in the heap where elements of each column begin
+};
+
+typedef struct csv_snapshot_check_job_T csv_snapshot_check_job;
+struct csv_snapshot_check_job_T
+{
+    jio_csv_compact_cell* const* cells;     //  Cells of each column
+    uint32_t row_count;
+    uint64_t heap_size;
+    bool* corrupted;                        //  Set for each column with a cell outside the heap
+};
+
+static void csv_snapshot_check_task(void* param, uint32_t index)
+{
+    const csv_snapshot_check_job* const job = param;
+    const jio_csv_compact_cell* const cells = job->cells[index];
+    //  Offsets and lengths have 32 bits, so their sum can not overflow 64 bits
+    bool corrupted = false;
+    for (uint32_t i = 0; i < job->row_count; ++i)
+    {
+        corrupted |= (uint64_t)cells[i].offset + cells[i].len > job->heap_size;
+    }
+    job->corrupted[index] = corrupted;
+}
+
+static void csv_snapshot_write_task(void* param, uint32_t index)
+{
+    const csv_snapshot_job* const job = param;
+    const jio_csv_column* const column = job->data->columns + index;
+    jio_csv_compact_cell* const cells = (jio_csv_compact_cell*)(job->snapshot + job->directory[index].cells_offset);
+    uint64_t offset = job->heap_offsets[index];
+    for (uint32_t i = 0; i < column->count; ++i)
+    {
+        const jio_string_segment element = column->elements[i];
+        memcpy(job->heap + offset, element.begin, element.len);
+        cells[i] = (jio_csv_compact_cell){.offset = (uint32_t)offset, .len = (uint32_t)element.len};
+        offset += element.len;
+    }
+}
+
+jio_result jio_csv_save_snapshot(
+        const jio_context* ctx, const jio_csv_data* data, const jio_memory_file* source, const char* filename)
+{
+    jio_result res;
+    uint64_t* heap_offsets = NULL;
+    jio_memory_file* file = NULL;
+    if ((res = csv_stats_compute(data)))
+    {
+        goto end;
+    }
+    heap_offsets = jio_alloc(ctx, sizeof(*heap_offsets) * (data->column_count ? data->column_count : 1));
+    if (!heap_offsets)
+    {
+        JIO_ERROR(ctx, "Could not allocate memory for csv snapshot");
+        res = JIO_RESULT_BAD_ALLOC;
+        goto end;
+    }
+
+    //  Headers go at the start of the heap, followed by elements of each column
+    uint64_t heap_size = 0;
+    for (uint32_t i = 0; i < data->column_count; ++i)
+    {
+        heap_size += data->columns[i].header.len;
+    }
+    for (uint32_t i = 0; i < data->column_count; ++i)
+    {
+        heap_offsets[i] = heap_size;
+        heap_size += data->stats[i].total_length;
+    }
+    if (heap_size > UINT32_MAX)
+    {
+        JIO_ERROR(ctx, "Csv data has %"PRIu64" bytes of strings, which is too many to be stored in a snapshot", heap_size);
+        res = JIO_RESULT_BAD_VALUE;
+        goto end;
+    }
+    const uint64_t directory_offset = sizeof(csv_snapshot_header);
+    const uint64_t cells_offset = directory_offset + sizeof(csv_snapshot_column) * (uint64_t)data->column_count;
+    const uint64_t heap_offset = cells_offset + sizeof(jio_csv_compact_cell) * (uint64_t)data->column_count * data->column_length;
+    const uint64_t total_size = heap_offset + heap_size;
+
+    if ((res = jio_memory_file_create(ctx, filename, &file, 1, 1, (size_t)total_size)))
+    {
+        JIO_ERROR(ctx, "Could not create csv snapshot file \"%s\"", filename);
+        goto end;
+    }
+    unsigned char* const snapshot = file->ptr;
+    const size_t source_size = source ? csv_snapshot_source_size(source) : 0;
+    csv_snapshot_header header =
+            {
+                    .version = CSV_SNAPSHOT_VERSION,
+                    .byte_order = CSV_SNAPSHOT_BYTE_ORDER,
+                    .column_count = data->column_count,
+                    .row_count = data->column_length,
+                    .flags = source ? CSV_SNAPSHOT_HAS_SOURCE : 0,
+                    .source_size = source_size,
+                    .source_hash = source ? csv_snapshot_source_hash(source, source_size) : 0,
+                    .heap_offset = heap_offset,
+                    .heap_size = heap_size,
+            };
+    memcpy(header.magic, CSV_SNAPSHOT_MAGIC, sizeof(header.magic));
+    memcpy(snapshot, &header, sizeof(header));
+
+    csv_snapshot_column* const directory = (csv_snapshot_column*)(snapshot + directory_offset);
+    char* const heap = (char*)snapshot + heap_offset;
+    uint32_t header_offset = 0;
+    for (uint32_t i = 0; i < data->column_count; ++i)
+    {
+        const jio_string_segment* const column_header = &data->columns[i].header;
+        memcpy(heap + header_offset, column_header->begin, column_header->len);
+        directory[i] = (csv_snapshot_column)
+                {
+                        .header_offset = header_offset,
+                        .header_len = (uint32_t)column_header->len,
+                        .cells_offset = cells_offset + sizeof(jio_csv_compact_cell) * (uint64_t)i * data->column_length,
+                };
+        header_offset += column_header->len;
+    }
+    const csv_snapshot_job job =
+            {
+                    .data = data,
+                    .snapshot = snapshot,
+                    .directory = directory,
+                    .heap = heap,
+                    .heap_offsets = heap_offsets,
+            };
+    jio_parallel_for(ctx, data->column_count, csv_snapshot_write_task, (void*)&job);
+
+    if ((res = jio_memory_file_sync(file, 1)))
+    {
+        JIO_ERROR(ctx, "Could not write csv snapshot file \"%s\"", filename);
+        goto end;
+    }
+
+end:
+    if (file)
+    {
+        jio_memory_file_destroy(file);
+    }
+    jio_free(ctx, heap_offsets);
+    return res;
+}
+
+jio_result jio_csv_open_snapshot(
+        const jio_context* ctx, const char* filename, const jio_memory_file* source, jio_csv_data** pp_csv)
+{
+    jio_result res;
+    jio_memory_file* file = NULL;
+    jio_csv_data* csv = NULL;
+    bool* corrupted = NULL;
+    if ((res = jio_memory_file_create(ctx, filename, &file, 0, 0, 0)))
+    {
+        JIO_ERROR(ctx, "Could not open csv snapshot file \"%s\"", filename);
+        goto end;
+    }
+    const unsigned char* const snapshot = file->ptr;
+    csv_snapshot_header header;
+    if (file->file_size < sizeof(header))
+    {
+        JIO_ERROR(ctx, "File \"%s\" is too small to be a csv snapshot", filename);
+        res = JIO_RESULT_BAD_VALUE;
+        goto end;
+    }
+    memcpy(&header, snapshot, sizeof(header));
+    if (memcmp(header.magic, CSV_SNAPSHOT_MAGIC, sizeof(header.magic)) != 0 || header.byte_order != CSV_SNAPSHOT_BYTE_ORDER)
+    {
+        JIO_ERROR(ctx, "File \"%s\" is not a csv snapshot, or was made on a machine with different byte order", filename);
+        res = JIO_RESULT_BAD_VALUE;
+        goto end;
+    }
+    if (header.version != CSV_SNAPSHOT_VERSION)
+    {
+        JIO_ERROR(ctx, "Csv snapshot \"%s\" has version %"PRIu32", but only version %u is supported", filename, header.version, CSV_SNAPSHOT_VERSION);
+        res = JIO_RESULT_BAD_VALUE;
+        goto end;
+    }
+    //  Sizes are compared to the size of the file before they are added up, so that no sum can overflow
+    const uint64_t file_size = file->file_size;
+    const uint64_t directory_size = sizeof(csv_snapshot_column) * (uint64_t)header.column_count;
+    if (header.heap_offset > file_size || header.heap_size > file_size - header.heap_offset || header.heap_size > UINT32_MAX
+        || directory_size > file_size || (uint64_t)header.column_count * header.row_count > file_size / sizeof(jio_csv_compact_cell)
+        || header.heap_offset < sizeof(header) + directory_size + sizeof(jio_csv_compact_cell) * (uint64_t)header.column_count * header.row_count)
+    {
+        JIO_ERROR(ctx, "Csv snapshot \"%s\" is corrupted", filename);
+        res = JIO_RESULT_BAD_VALUE;
+        goto end;
+    }
+    const size_t source_size = source ? csv_snapshot_source_size(source) : 0;
+    if (source && (!(header.flags & CSV_SNAPSHOT_HAS_SOURCE) || header.source_size != source_size
+                   || header.source_hash != csv_snapshot_source_hash(source, source_size)))
+    {
+        JIO_ERROR(ctx, "Csv snapshot \"%s\" was not made from the current contents of file \"%s\"", filename, source->name);
+        res = JIO_RESULT_BAD_VALUE;
+        goto end;
+    }
+
+    csv = jio_alloc(ctx, sizeof(*csv));
+    if (!csv)
+    {
+        JIO_ERROR(ctx, "Could not allocate memory for csv data");
+        res = JIO_RESULT_BAD_ALLOC;
+        goto end;
+    }
+    memset(csv, 0, sizeof(*csv));
+    csv->ctx = ctx;
+    const uint32_t column_count = header.column_count;
+    csv->columns = jio_alloc(ctx, sizeof(*csv->columns) * (column_count ? column_count : 1));
+    if (!csv->columns)
+    {
+        JIO_ERROR(ctx, "Could not allocate memory for csv columns");
+        res = JIO_RESULT_BAD_ALLOC;
+        goto end;
+    }
+    if ((res = csv_deferred_create(ctx, column_count, false, file, &csv->deferred)))
+    {
+        goto end;
+    }
+    csv_deferred_state* const deferred = csv->deferred;
+    deferred->cells = jio_alloc(ctx, sizeof(*deferred->cells) * (column_count ? column_count : 1));
+    if (!deferred->cells)
+    {
+        JIO_ERROR(ctx, "Could not allocate memory for csv state");
+        res = JIO_RESULT_BAD_ALLOC;
+        goto end;
+    }
+    deferred->borrowed_cells = true;
+    deferred->base = (const char*)snapshot + header.heap_offset;
+
+    const csv_snapshot_column* const directory = (const csv_snapshot_column*)(snapshot + sizeof(header));
+    for (uint32_t i = 0; i < column_count; ++i)
+    {
+        const csv_snapshot_column entry = directory[i];
+        if ((uint64_t)entry.header_offset + entry.header_len > header.heap_size
+            || entry.cells_offset < sizeof(header) + directory_size || entry.cells_offset > header.heap_offset
+            || sizeof(jio_csv_compact_cell) * (uint64_t)header.row_count > header.heap_offset - entry.cells_offset
+            || entry.cells_offset % sizeof(uint32_t))
+        {
+            JIO_ERROR(ctx, "Csv snapshot \"%s\" is corrupted", filename);
+            res = JIO_RESULT_BAD_VALUE;
+            goto end;
+        }
+        csv->columns[i] = (jio_csv_column)
+                {
+                        .header = {.begin = deferred->base + entry.header_offset, .len = entry.header_len},
+                        .count = header.row_count,
+                        .capacity = header.row_count,
+                        .elements = NULL,
+                };
+        deferred->cells[i] = (jio_csv_compact_cell*)(snapshot + entry.cells_offset);
+    }
+    //  Every cell must lie within the heap, so that elements made from them can be read safely
+    corrupted = jio_alloc(ctx, sizeof(*corrupted) * (column_count ? column_count : 1));
+    if (!corrupted)
+    {
+        JIO_ERROR(ctx, "Could not allocate memory for checking csv snapshot");
+        res = JIO_RESULT_BAD_ALLOC;
+        goto end;
+    }
+    const csv_snapshot_check_job check_job =
+            {
+                    .cells = deferred->cells,
+                    .row_count = header.row_count,
+                    .heap_size = header.heap_size,
+                    .corrupted = corrupted,
+            };
+    jio_parallel_for(ctx, column_count, csv_snapshot_check_task, (void*)&check_job);
+    for (uint32_t i = 0; i < column_count; ++i)
+    {
+        if (corrupted[i])
+        {
+            JIO_ERROR(ctx, "Csv snapshot \"%s\" is corrupted, cells of column %"PRIu32" are outside of its strings", filename, i);
+            res = JIO_RESULT_BAD_VALUE;
+            goto end;
+        }
+    }
+    csv->column_count = column_count;
+    csv->column_capacity = column_count;
+    csv->column_length = header.row_count;
+    csv->snapshot_file = file;
+    file = NULL;
+    *pp_csv = csv;
+    csv = NULL;
+
+end:
+    if (csv)
+    {
+        if (csv->deferred)
+        {
+            csv_deferred_release(ctx, csv->deferred, 0);
+        }
+        jio_free(ctx, csv->columns);
+        jio_free(ctx, csv);
+    }
+    jio_free(ctx, corrupted);
+    if (file)
+    {
+        jio_memory_file_destroy(file);
+    }
+    return res;
+}
+
+//  Rows sorted directly by insertion sort instead of being merged
+#define CSV_SORT_INSERTION_RUN 16
+
+typedef struct csv_sort_item_T csv_sort_item;
+struct csv_sort_item_T
+{
+    uint64_t prefix;                        //  Order-preserving prefix of the first key
+    uint32_t row;                           //  Index of the row in the data
+};
+
+//  Part of a merge of two adjacent sorted runs, which writes output positions [out_begin, out_end) of the merged run
+typedef struct csv_sort_piece_T csv_sort_piece;
+struct csv_sort_piece_T
+{
+    uint32_t left;                          //  Where the left run begins
+    uint32_t mid;                           //  Where the left run ends and the right one begins
+    uint32_t right_end;                     //  Where the right run ends
+    uint32_t out_begin;
+    uint32_t out_end;
+};
+
+typedef struct csv_sort_job_T csv_sort_job;
+struct csv_sort_job_T
+{
+    const jio_csv_data* data;
+    uint32_t key_count;
+    const jio_csv_sort_key* keys;
+    double** numbers;                       //  Values of each numeric key (NULL for keys which are not)
+    uint8_t** valid;                        //  Which values of each numeric key could be converted
+    csv_sort_item* items;
+    csv_sort_item* scratch;
+    uint32_t block_count;
+    uint32_t shift;                         //  Shift of the prefix which gives the radix digit
+    uint32_t* counts;                       //  Count (and later offset) of each digit in each block
+    uint32_t bucket_offsets[257];           //  Where each bucket begins after partitioning
+    //  Buckets are split into chunks of at most CSV_ROWS_PER_TASK rows, which are sorted on their own and then merged
+    uint32_t* chunk_offsets;                //  Where each chunk begins, followed by where the last one ends
+    csv_sort_piece* pieces;                 //  Pieces of merges done in parallel
+    const csv_sort_item* merge_src;
+    csv_sort_item* merge_dst;
+    //  Applying the permutation
+    const jio_string_segment* src;
+    jio_string_segment* dst;
+};
+
+static inline uint32_t csv_sort_block_end(const csv_sort_job* job, uint32_t begin)
+{
+    const uint32_t row_count = job->data->column_length;
+    return row_count - begin < CSV_ROWS_PER_TASK ? row_count : begin + CSV_ROWS_PER_TASK;
+}
+
+//  Maps a double to an integer with the same ordering
+static inline uint64_t csv_sort_double_key(double v)
+{
+    uint64_t bits;
+    memcpy(&bits, &v, sizeof(bits));
+    return bits & 0x8000000000000000 ? ~bits : bits | 0x8000000000000000;
+}
+
+static void csv_sort_prefix_task(void* param, uint32_t index)
+{
+    const csv_sort_job* const job = param;
+    const jio_csv_sort_key* const key = job->keys;
+    const jio_string_segment* const elements = job->data->columns[key->column].elements;
+    const uint32_t begin = index * CSV_ROWS_PER_TASK;
+    const uint32_t end = csv_sort_block_end(job, begin);
+    for (uint32_t k = 0; k < job->key_count; ++k)
+    {
+        if (!job->numbers[k])
+        {
+            continue;
+        }
+        const jio_string_segment* const key_elements = job->data->columns[job->keys[k].column].elements;
+        for (uint32_t i = begin; i < end; ++i)
+        {
+            job->valid[k][i] = jio_string_segment_to_double(key_elements + i, job->numbers[k] + i);
+        }
+    }
+    for (uint32_t i = begin; i < end; ++i)
+    {
+        uint64_t prefix = 0;
+        if (job->numbers[0])
+        {
+            //  Values which are not numbers go after all numbers, even in descending order
+            if (!job->valid[0][i])
+            {
+                job->items[i] = (csv_sort_item){.prefix = UINT64_MAX, .row = i};
+                continue;
+            }
+            prefix = csv_sort_double_key(job->numbers[0][i]);
+        }
+        else
+        {
+            const jio_string_segment element = elements[i];
+            for (uint32_t j = 0; j < 8; ++j)
+            {
+                prefix = (prefix << 8) | (j < element.len ? (unsigned char)element.begin[j] : 0);
+            }
+        }
+        job->items[i] = (csv_sort_item){.prefix = key->descending ? ~prefix : prefix, .row = i};
+    }
+}
+
+static int csv_sort_compare(const csv_sort_job* job, const csv_sort_item* a, const csv_sort_item* b)
+{
+    if (a->prefix != b->prefix)
+    {
+        return a->prefix < b->prefix ? -1 : +1;
+    }
+    for (uint32_t k = 0; k < job->key_count; ++k)
+    {
+        const jio_csv_sort_key* const key = job->keys + k;
+        int cmp;
+        if (job->numbers[k])
+        {
+            const bool valid_a = job->valid[k][a->row], valid_b = job->valid[k][b->row];
+            if (valid_a != valid_b)
+            {
+                //  Not affected by the order of the key
+                return valid_a ? -1 : +1;
+            }
+            else if (!valid_a)
+            {
+                cmp = 0;
+            }
+            else
+            {
+                const double v_a = job->numbers[k][a->row], v_b = job->numbers[k][b->row];
+                cmp = v_a < v_b ? -1 : (v_a > v_b);
+            }
+        }
+        else
+        {
+            const jio_string_segment* const elements = job->data->columns[key->column].elements;
+            const jio_string_segment e_a = elements[a->row], e_b = elements[b->row];
+            cmp = memcmp(e_a.begin, e_b.begin, e_a.len < e_b.len ? e_a.len : e_b.len);
+            if (!cmp)
+            {
+                cmp = e_a.len < e_b.len ? -1 : (e_a.len > e_b.len);
+            }
+        }
+        if (cmp)
+        {
+            return key->descending ? -cmp : cmp;
+        }
+    }
+    //  Original order is kept for equal rows
+    return a->row < b->row ? -1 : (a->row > b->row);
+}
+
+static void csv_sort_histogram_task(void* param, uint32_t index)
+{
+    const csv_sort_job* const job = param;
+    uint32_t* const counts = job->counts + 256 * index;
+    memset(counts, 0, sizeof(*counts) * 256);
+    const uint32_t begin = index * CSV_ROWS_PER_TASK;
+    const uint32_t end = csv_sort_block_end(job, begin);
+    for (uint32_t i = begin; i < end; ++i)
+    {
+        counts[(job->items[i].prefix >> job->shift) & 0xFF] += 1;
+    }
+}
+
+static void csv_sort_scatter_task(void* param, uint32_t index)
+{
+    const csv_sort_job* const job = param;
+    uint32_t* const offsets = job->counts + 256 * index;
+    const uint32_t begin = index * CSV_ROWS_PER_TASK;
+    const uint32_t end = csv_sort_block_end(job, begin);
+    for (uint32_t i = begin; i < end; ++i)
+    {
+        const csv_sort_item item = job->items[i];
+        job->scratch[offsets[(item.prefix >> job->shift) & 0xFF]++] = item;
+    }
+}
+
+//  Sorts items of one chunk, which are in scratch, with a merge sort using items as the temporary buffer
+static void csv_sort_chunk_task(void* param, uint32_t index)
+{
+    const csv_sort_job* const job = param;
+    const uint32_t begin = job->chunk_offsets[index], end = job->chunk_offsets[index + 1];
+    const uint32_t count = end - begin;
+    csv_sort_item* src = job->scratch + begin;
+    csv_sort_item* dst = job->items + begin;
+    for (uint32_t run = 0; run < count; run += CSV_SORT_INSERTION_RUN)
+    {
+        const uint32_t run_end = count - run < CSV_SORT_INSERTION_RUN ? count : run + CSV_SORT_INSERTION_RUN;
+        for (uint32_t i = run + 1; i < run_end; ++i)
+        {
+            const csv_sort_item item = src[i];
+            uint32_t j = i;
+            for (; j > run && csv_sort_compare(job, &item, src + j - 1) < 0; --j)
+            {
+                src[j] = src[j - 1];
+            }
+            src[j] = item;
+        }
+    }
+    for (uint32_t width = CSV_SORT_INSERTION_RUN; width < count; width *= 2)
+    {
+        for (uint32_t left = 0; left < count; left += 2 * width)
+        {
+            const uint32_t mid = count - left < width ? count : left + width;
+            const uint32_t right_end = count - mid < width ? count : mid + width;
+            uint32_t i = left, j = mid, k = left;
+            while (i < mid && j < right_end)
+            {
+                dst[k++] = csv_sort_compare(job, src + j, src + i) < 0 ? src[j++] : src[i++];
+            }
+            memcpy(dst + k, src + i, sizeof(*dst) * (mid - i));
+            k += mid - i;
+            memcpy(dst + k, src + j, sizeof(*dst) * (right_end - j));
+        }
+        csv_sort_item* const tmp = src;
+        src = dst;
+        dst = tmp;
+    }
+    //  Sorted items must end up in items
+    if (src != job->items + begin)
+    {
+        memcpy(job->items + begin, src, sizeof(*src) * count);
+    }
+}
+
+//  Finds how many of the first k items of the merge of runs a and b come from a
+static uint32_t csv_sort_co_rank(
+        const csv_sort_job* job, uint32_t k, const csv_sort_item* a, uint32_t a_count, const csv_sort_item* b,
+        uint32_t b_count)
+{
+    uint32_t low = k > b_count ? k - b_count : 0;
+    uint32_t high = k < a_count ? k : a_count;
+    while (low < high)
+    {
+        const uint32_t i = low + (high - low) / 2;
+        //  No two items compare equal, so the merge is the same whichever run is favoured
+        if (csv_sort_compare(job, a + i, b + (k - i - 1)) < 0)
+        {
+            low = i + 1;
+        }
+        else
+        {
+            high = i;
+        }
+    }
+    return low;
+}
+
+//  Writes one piece of the merge of two sorted runs, so that one large merge can be split between many tasks
+static void csv_sort_merge_task(void* param, uint32_t index)
+{
+    const csv_sort_job* const job = param;
+    const csv_sort_piece* const piece = job->pieces + index;
+    const csv_sort_item* const a = job->merge_src + piece->left;
+    const csv_sort_item* const b = job->merge_src + piece->mid;
+    const uint32_t a_count = piece->mid - piece->left, b_count = piece->right_end - piece->mid;
+    const uint32_t k = piece->out_begin - piece->left;
+    uint32_t i = csv_sort_co_rank(job, k, a, a_count, b, b_count);
+    uint32_t j = k - i;
+    for (uint32_t out = piece->out_begin; out < piece->out_end; ++out)
+    {
+        if (j == b_count || (i < a_count && csv_sort_compare(job, a + i, b + j) < 0))
+        {
+            job->merge_dst[out] = a[i++];
+        }
+        else
+        {
+            job->merge_dst[out] = b[j++];
+        }
+    }
+}
+
+//  Splits merges of adjacent runs of the given width within each bucket larger than a chunk into pieces, giving their
+//  count. A run without a neighbour is merged with an empty one, which copies it.
+static uint32_t csv_sort_plan_merges(const csv_sort_job* job, uint32_t width)
+{
+    uint32_t piece_count = 0;
+    for (uint32_t d = 0; d < 256; ++d)
+    {
+        const uint32_t begin = job->bucket_offsets[d], end = job->bucket_offsets[d + 1];
+        if (end - begin <= CSV_ROWS_PER_TASK)
+        {
+            continue;
+        }
+        for (uint32_t left = begin, right_end; left < end; left = right_end)
+        {
+            const uint32_t mid = end - left < width ? end : left + width;
+            right_end = end - mid < width ? end : mid + width;
+            for (uint32_t out = left; out < right_end; out += CSV_ROWS_PER_TASK)
+            {
+                job->pieces[piece_count++] = (csv_sort_piece)
+                        {
+                                .left = left,
+                                .mid = mid,
+                                .right_end = right_end,
+                                .out_begin = out,
+                                .out_end = right_end - out < CSV_ROWS_PER_TASK ? right_end : out + CSV_ROWS_PER_TASK,
+                        };
+            }
+        }
+    }
+    return piece_count;
+}
+
+static void csv_sort_gather_task(void* param, uint32_t index)
+{
+    const csv_sort_job* const job = param;
+    const uint32_t begin = index * CSV_ROWS_PER_TASK;
+    const uint32_t end = csv_sort_block_end(job, begin);
+    for (uint32_t i = begin; i < end; ++i)
+    {
+        job->dst[i] = job->src[job->items[i].row];
+    }
+}
+
+jio_result jio_csv_sort(const jio_context* ctx, jio_csv_data* data, uint32_t key_count, const jio_csv_sort_key* keys)
+{
+    jio_result res;
+    if ((res = csv_make_eager(data)))
+    {
+        return res;
+    }
+    if (!key_count)
+    {
+        JIO_ERROR(ctx, "At least one key must be given to sort csv data");
+        return JIO_RESULT_BAD_VALUE;
+    }
+    for (uint32_t i = 0; i < key_count; ++i)
+    {
+        if (keys[i].column >= data->column_count)
+        {
+            JIO_ERROR(ctx, "Sort key %"PRIu32" uses column %"PRIu32", but csv data has only %u columns", i, keys[i].column, data->column_count);
+            return JIO_RESULT_BAD_INDEX;
+        }
+    }
+    const uint32_t row_count = data->column_length;
+    if (row_count < 2)
+    {
+        return JIO_RESULT_SUCCESS;
+    }
+
+    csv_sort_job job =
+            {
+                    .data = data,
+                    .key_count = key_count,
+                    .keys = keys,
+                    .block_count = (row_count + CSV_ROWS_PER_TASK - 1) / CSV_ROWS_PER_TASK,
+            };
+    jio_string_segment* scratch_elements = NULL;
+    job.numbers = jio_alloc(ctx, (sizeof(*job.numbers) + sizeof(*job.valid)) * key_count);
+    if (job.numbers)
+    {
+        job.valid = (uint8_t**)(job.numbers + key_count);
+        memset(job.numbers, 0, (sizeof(*job.numbers) + sizeof(*job.valid)) * key_count);
+    }
+    job.items = jio_alloc(ctx, sizeof(*job.items) * row_count);
+    job.scratch = jio_alloc(ctx, sizeof(*job.scratch) * row_count);
+    job.counts = jio_alloc(ctx, sizeof(*job.counts) * 256 * job.block_count);
+    //  Each bucket has at most one chunk which is not full, and each merge at most one piece which is not full
+    job.chunk_offsets = jio_alloc(ctx, sizeof(*job.chunk_offsets) * (job.block_count + 257));
+    job.pieces = jio_alloc(ctx, sizeof(*job.pieces) * (2 * job.block_count + 256));
+    if (!job.numbers || !job.items || !job.scratch || !job.counts || !job.chunk_offsets || !job.pieces)
+    {
+        JIO_ERROR(ctx, "Could not allocate memory for sorting csv data");
+        res = JIO_RESULT_BAD_ALLOC;
+        goto end;
+    }
+    for (uint32_t i = 0; i < key_count; ++i)
+    {
+        if (!keys[i].numeric)
+        {
+            continue;
+        }
+        job.numbers[i] = jio_alloc(ctx, sizeof(**job.numbers) * row_count);
+        job.valid[i] = jio_alloc(ctx, sizeof(**job.valid) * row_count);
+        if (!job.numbers[i] || !job.valid[i])
+        {
+            JIO_ERROR(ctx, "Could not allocate memory for numeric values of csv sort key %"PRIu32, i);
+            res = JIO_RESULT_BAD_ALLOC;
+            goto end;
+        }
+    }
+    jio_parallel_for(ctx, job.block_count, csv_sort_prefix_task, &job);
+
+    //  Radix digit is taken from the highest bits in which prefixes differ, so that buckets are not all the same
+    uint64_t differing = 0;
+    for (uint32_t i = 1; i < row_count; ++i)
+    {
+        differing |= job.items[i].prefix ^ job.items[0].prefix;
+    }
+    uint32_t shift = 0;
+    while (shift < 56 && (differing >> (shift + 8)))
+    {
+        shift += 1;
+    }
+    job.shift = shift;
+    jio_parallel_for(ctx, job.block_count, csv_sort_histogram_task, &job);
+    //  Bucket of each digit gets items from blocks in order, which keeps the partitioning stable
+    uint32_t offset = 0;
+    for (uint32_t d = 0; d < 256; ++d)
+    {
+        job.bucket_offsets[d] = offset;
+        for (uint32_t b = 0; b < job.block_count; ++b)
+        {
+            const uint32_t count = job.counts[256 * b + d];
+            job.counts[256 * b + d] = offset;
+            offset += count;
+        }
+    }
+    job.bucket_offsets[256] = offset;
+    jio_parallel_for(ctx, job.block_count, csv_sort_scatter_task, &job);
+
+    //  When prefixes are mostly equal (long common prefixes, or few distinct keys), most rows end up in a few buckets.
+    //  Large buckets are therefore sorted as chunks, which are then merged in rounds, each split between many tasks.
+    uint32_t chunk_count = 0, largest_bucket = 0;
+    for (uint32_t d = 0; d < 256; ++d)
+    {
+        const uint32_t begin = job.bucket_offsets[d], end = job.bucket_offsets[d + 1];
+        if (end - begin > largest_bucket)
+        {
+            largest_bucket = end - begin;
+        }
+        for (uint32_t chunk = begin; chunk < end; chunk += CSV_ROWS_PER_TASK)
+        {
+            job.chunk_offsets[chunk_count++] = chunk;
+        }
+    }
+    job.chunk_offsets[chunk_count] = row_count;
+    jio_parallel_for(ctx, chunk_count, csv_sort_chunk_task, &job);
+    csv_sort_item* merge_src = job.items;
+    csv_sort_item* merge_dst = job.scratch;
+    for (uint32_t width = CSV_ROWS_PER_TASK; width < largest_bucket; width = width > UINT32_MAX / 2 ? UINT32_MAX : 2 * width)
+    {
+        job.merge_src = merge_src;
+        job.merge_dst = merge_dst;
+        jio_parallel_for(ctx, csv_sort_plan_merges(&job, width), csv_sort_merge_task, &job);
+        merge_dst = merge_src;
+        merge_src = job.merge_dst;
+    }
+    if (merge_src != job.items)
+    {
+        //  Merging a run of a whole bucket with an empty one copies it back into items
+        job.merge_src = merge_src;
+        job.merge_dst = job.items;
+        jio_parallel_for(ctx, csv_sort_plan_merges(&job, UINT32_MAX), csv_sort_merge_task, &job);
+    }
+
+    //  Apply the permutation to each column, swapping its elements with the scratch array. Elements which snapshots can
+    //  see are copied first, since old arrays are reused.
+    for (uint32_t i = 0; i < data->column_count; ++i)
+    {
+        if ((res = csv_column_prepare(data, i, 0)))
+        {
+            goto end;
+        }
+    }
+    uint32_t scratch_capacity = row_count;
+    scratch_elements = jio_alloc(ctx, sizeof(*scratch_elements) * scratch_capacity);
+    if (!scratch_elements)
+    {
+        JIO_ERROR(ctx, "Could not allocate memory for sorting csv data");
+        res = JIO_RESULT_BAD_ALLOC;
+        goto end;
+    }
+    for (uint32_t i = 0; i < data->column_count; ++i)
+    {
+        jio_csv_column* const column = data->columns + i;
+        job.src = column->elements;
+        job.dst = scratch_elements;
+        jio_parallel_for(ctx, job.block_count, csv_sort_gather_task, &job);
+        const uint32_t capacity = column->capacity;
+        scratch_elements = column->elements;
+        column->elements = job.dst;
+        column->capacity = scratch_capacity;
+        scratch_capacity = capacity;
+    }
+    csv_indices_invalidate(data, UINT32_MAX);
+
+end:
+    jio_free(ctx, scratch_elements);
+    if (job.numbers)
+    {
+        for (uint32_t i = 0; i < key_count; ++i)
+        {
+            jio_free(ctx, job.numbers[i]);
+            jio_free(ctx, job.valid[i]);
+        }
+    }
+    jio_free(ctx, job.numbers);
+    jio_free(ctx, job.items);
+    jio_free(ctx, job.scratch);
+    jio_free(ctx, job.counts);
+    jio_free(ctx, job.chunk_offsets);
+    jio_free(ctx, job.pieces);
+    return res;
+}
+
+//  Each block of rows is first deduplicated on its own, using a table of local value indices, after which the distinct
+//  values of all blocks are merged in order. Blocks are processed in waves, so that only one table per task is needed.
+#define CSV_DICTIONARY_TABLE_SIZE (2 * CSV_ROWS_PER_TASK)
+#define CSV_DICTIONARY_WAVE_PER_THREAD 4
+
+typedef struct csv_dictionary_job_T csv_dictionary_job;
+struct csv_dictionary_job_T
+{
+    const jio_string_segment* elements;
+    uint32_t count;
+    uint32_t first_block;                   //  First block of the current wave
+    uint16_t* tables;                       //  Local index + 1 of the value in each slot (0 when empty)
+    uint16_t* local;                        //  Local index of the value of each row
+    uint32_t* distinct;                     //  First row of each local value, replaced by its code after merging
+    uint32_t* distinct_counts;              //  Number of local values in each block
+    uint32_t code_size;
+    void* codes;
+};
+
+static inline uint32_t csv_dictionary_block_end(uint32_t count, uint32_t begin)
+{
+    return count - begin < CSV_ROWS_PER_TASK ? count : begin + CSV_ROWS_PER_TASK;
+}
+
+static void csv_dictionary_local_task(void* param, uint32_t index)
+{
+    const csv_dictionary_job* const job = param;
+    const uint32_t block = job->first_block + index;
+    const uint32_t begin = block * CSV_ROWS_PER_TASK;
+    const uint32_t end = csv_dictionary_block_end(job->count, begin);
+    uint16_t* const table = job->tables + (size_t)index * CSV_DICTIONARY_TABLE_SIZE;
+    uint32_t* const distinct = job->distinct + begin;
+    memset(table, 0, sizeof(*table) * CSV_DICTIONARY_TABLE_SIZE);
+    uint32_t distinct_count = 0;
+    for (uint32_t i = begin; i < end; ++i)
+    {
+        const jio_string_segment element = job->elements[i];
+        uint32_t slot = (uint32_t)csv_string_hash(element.begin, element.len) & (CSV_DICTIONARY_TABLE_SIZE - 1);
+        for (;;)
+        {
+            if (!table[slot])
+            {
+                distinct[distinct_count] = i;
+                distinct_count += 1;
+                table[slot] = (uint16_t)distinct_count;
+                break;
+            }
+            const jio_string_segment* const other = job->elements + distinct[table[slot] - 1];
+            if (other->len == element.len && memcmp(other->begin, element.begin, element.len) == 0)
+            {
+                break;
+            }
+            slot = (slot + 1) & (CSV_DICTIONARY_TABLE_SIZE - 1);
+        }
+        job->local[i] = (uint16_t)(table[slot] - 1);
+    }
+    job->distinct_counts[block] = distinct_count;
+}
+
+static void csv_dictionary_code_task(void* param, uint32_t index)
+{
+    const csv_dictionary_job* const job = param;
+    const uint32_t begin = index * CSV_ROWS_PER_TASK;
+    const uint32_t end = csv_dictionary_block_end(job->count, begin);
+    const uint32_t* const codes = job->distinct + begin;
+    switch (job->code_size)
+    {
+    case 1:
+        for (uint32_t i = begin; i < end; ++i)
+        {
+            ((uint8_t*)job->codes)[i] = (uint8_t)codes[job->local[i]];
+        }
+        break;
+    case 2:
+        for (uint32_t i = begin; i < end; ++i)
+        {
+            ((uint16_t*)job->codes)[i] = (uint16_t)codes[job->local[i]];
+        }
+        break;
+    default:
+        for (uint32_t i = begin; i < end; ++i)
+        {
+            ((uint32_t*)job->codes)[i] = codes[job->local[i]];
+        }
+        break;
+    }
+}
+
+jio_result jio_csv_column_dictionary_encode(
+        const jio_context* ctx, const jio_csv_data* data, uint32_t index, jio_csv_dictionary* p_dictionary)
+{
+    if (index >= data->column_count)
+    {
+        JIO_ERROR(ctx, "Column index %"PRIu32" is out of bounds for csv data with %u columns", index, data->column_count);
+        return JIO_RESULT_BAD_INDEX;
+    }
+    jio_result res = csv_materialize_column(data, index);
+    if (res != JIO_RESULT_SUCCESS)
+    {
+        return res;
+    }
+    const jio_csv_column* const column = data->columns + index;
+    const uint32_t count = data->column_length;
+    const uint32_t block_count = (count + CSV_ROWS_PER_TASK - 1) / CSV_ROWS_PER_TASK;
+    uint32_t wave_size = ctx->thread_count * CSV_DICTIONARY_WAVE_PER_THREAD;
+    if (wave_size > block_count)
+    {
+        wave_size = block_count;
+    }
+    csv_dictionary_job job =
+            {
+                    .elements = column->elements,
+                    .count = count,
+            };
+    jio_string_segment* values = NULL;
+    uint32_t value_count = 0;
+    uint32_t value_capacity = 0;
+    uint32_t* table = NULL;
+    uint32_t table_capacity = 0;
+    if (count)
+    {
+        job.tables = jio_alloc(ctx, sizeof(*job.tables) * CSV_DICTIONARY_TABLE_SIZE * wave_size);
+        job.local = jio_alloc(ctx, sizeof(*job.local) * count);
+        job.distinct = jio_alloc(ctx, sizeof(*job.distinct) * count);
+        job.distinct_counts = jio_alloc(ctx, sizeof(*job.distinct_counts) * block_count);
+        if (!job.tables || !job.local || !job.distinct || !job.distinct_counts)
+        {
+            JIO_ERROR(ctx, "Could not allocate memory for dictionary encoding of csv column");
+            res = JIO_RESULT_BAD_ALLOC;
+            goto end;
+        }
+    }
+
+    for (uint32_t first_block = 0; first_block < block_count; first_block += wave_size)
+    {
+        job.first_block = first_block;
+        jio_parallel_for(ctx, block_count - first_block < wave_size ? block_count - first_block : wave_size, csv_dictionary_local_task, &job);
+        //  Values are merged in order of blocks, so they are in order of their first appearance
+        for (uint32_t b = first_block; b < block_count && b < first_block + wave_size; ++b)
+        {
+            uint32_t* const distinct = job.distinct + b * CSV_ROWS_PER_TASK;
+            for (uint32_t j = 0; j < job.distinct_counts[b]; ++j)
+            {
+                //  Table is kept at most half full
+                if (2 * ((uint64_t)value_count + 1) > table_capacity)
+                {
+                    const uint32_t new_capacity = table_capacity ? 2 * table_capacity : 256;
+                    uint32_t* const new_table = jio_alloc(ctx, sizeof(*new_table) * new_capacity);
+                    if (!new_table)
+                    {
+                        JIO_ERROR(ctx, "Could not allocate memory for dictionary encoding of csv column");
+                        res = JIO_RESULT_BAD_ALLOC;
+                        goto end;
+                    }
+                    memset(new_table, 0, sizeof(*new_table) * new_capacity);
+                    for (uint32_t k = 0; k < value_count; ++k)
+                    {
+                        uint32_t slot = (uint32_t)csv_string_hash(values[k].begin, values[k].len) & (new_capacity - 1);
+                        while (new_table[slot])
+                        {
+                            slot = (slot + 1) & (new_capacity - 1);
+                        }
+                        new_table[slot] = k + 1;
+                    }
+                    jio_free(ctx, table);
+                    table = new_table;
+                    table_capacity = new_capacity;
+                }
+                const jio_string_segment element = column->elements[distinct[j]];
+                uint32_t slot = (uint32_t)csv_string_hash(element.begin, element.len) & (table_capacity - 1);
+                while (table[slot])
+                {
+                    const jio_string_segment* const other = values + table[slot] - 1;
+                    if (other->len == element.len && memcmp(other->begin, element.begin, element.len) == 0)
+                    {
+                        break;
+                    }
+                    slot = (slot + 1) & (table_capacity - 1);
+                }
+                if (!table[slot])
+                {
+                    if (value_count == value_capacity)
+                    {
+                        const uint32_t new_capacity = value_capacity ? 2 * value_capacity : 64;
+                        jio_string_segment* const new_values = jio_realloc(ctx, values, sizeof(*new_values) * new_capacity);
+                        if (!new_values)
+                        {
+                            JIO_ERROR(ctx, "Could not allocate memory for dictionary encoding of csv column");
+                            res = JIO_RESULT_BAD_ALLOC;
+                            goto end;
+                        }
+                        values = new_values;
+                        value_capacity = new_capacity;
+                    }
+                    values[value_count] = element;
+                    value_count += 1;
+                    table[slot] = value_count;
+                }
+                distinct[j] = table[slot] - 1;
+            }
+        }
+    }
+
+    job.code_size = value_count <= 0x100 ? 1 : (value_count <= 0x10000 ? 2 : 4);
+    if (count)
+    {
+        job.codes = jio_alloc(ctx, (size_t)job.code_size * count);
+        if (!job.codes)
+        {
+            JIO_ERROR(ctx, "Could not allocate memory for dictionary encoding of csv column");
+            res = JIO_RESULT_BAD_ALLOC;
+            goto end;
+        }
+        jio_parallel_for(ctx, block_count, csv_dictionary_code_task, &job);
+    }
+    if (value_count && value_count != value_capacity)
+    {
+        jio_string_segment* const new_values = jio_realloc(ctx, values, sizeof(*new_values) * value_count);
+        if (new_values)
+        {
+            values = new_values;
+        }
+    }
+
+    *p_dictionary = (jio_csv_dictionary)
+            {
+                    .header = column->header,
+                    .value_count = value_count,
+                    .values = values,
+                    .count = count,
+                    .code_size = job.code_size,
+                    .codes = job.codes,
+            };
+    values = NULL;
+    job.codes = NULL;
+end:
+    jio_free(ctx, job.codes);
+    jio_free(ctx, values);
+    jio_free(ctx, table);
+    jio_free(ctx, job.tables);
+    jio_free(ctx, job.local);
+    jio_free(ctx, job.distinct);
+    jio_free(ctx, job.distinct_counts);
+    return res;
+}
+
+void jio_csv_dictionary_release(const jio_context* ctx, jio_csv_dictionary* dictionary)
+{
+    jio_free(ctx, dictionary->values);
+    jio_free(ctx, dictionary->codes);
+    memset(dictionary, 0, sizeof(*dictionary));
+}
+
+//  Powers of ten which are exactly representable as doubles
+static const double CSV_BIND_POWERS_OF_TEN[] =
+        {
+                1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+                1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22,
+        };
+
+//  Decodes eight digits at once, by combining neighbouring pairs of digits, then pairs of those, then pairs of those
+#if (defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__) || defined(_MSC_VER)
+static inline bool csv_bind_eight_digits(const char* ptr, uint64_t* p_out)
+{
+    uint64_t v;
+    memcpy(&v, ptr, sizeof(v));
+    if (((v & 0xF0F0F0F0F0F0F0F0) | (((v + 0x0606060606060606) & 0xF0F0F0F0F0F0F0F0) >> 4)) != 0x3333333333333333)
+    {
+        return false;
+    }
+    v = ((v & 0x0F0F0F0F0F0F0F0F) * 2561) >> 8;
+    v = ((v & 0x00FF00FF00FF00FF) * 6553601) >> 16;
+    *p_out = ((v & 0x0000FFFF0000FFFF) * 42949672960001) >> 32;
+    return true;
+}
+#else
+static inline bool csv_bind_eight_digits(const char* ptr, uint64_t* p_out)
+{
+    uint64_t v = 0;
+    for (unsigned i = 0; i < 8; ++i)
+    {
+        const unsigned digit = (unsigned char)ptr[i] - (unsigned)'0';
+        if (digit > 9)
+        {
+            return false;
+        }
+        v = v * 10 + digit;
+    }
+    *p_out = v;
+    return true;
+}
+#endif
+
+static bool csv_bind_decode_magnitude(const char* ptr, const char* end, uint64_t* p_out)
+{
+    if (ptr == end)
+    {
+        return false;
+    }
+    while (end - ptr > 1 && *ptr == '0')
+    {
+        ptr += 1;
+    }
+    if (end - ptr > 20)
+    {
+        return false;
+    }
+    uint64_t v = 0;
+    //  Numbers with less than 20 digits can not overflow, so only the last digit of the longest ones needs a check
+    const char* const fast_end = end - ptr == 20 ? end - 1 : end;
+    while (fast_end - ptr >= 8)
+    {
+        uint64_t digits;
+        if (!csv_bind_eight_digits(ptr, &digits))
+        {
+            return false;
+        }
+        v = v * 100000000 + digits;
+        ptr += 8;
+    }
+    for (; ptr != fast_end; ++ptr)
+    {
+        const unsigned digit = (unsigned char)*ptr - (unsigned)'0';
+        if (digit > 9)
+        {
+            return false;
+        }
+        v = v * 10 + digit;
+    }
+    if (ptr != end)
+    {
+        const unsigned digit = (unsigned char)*ptr - (unsigned)'0';
+        if (digit > 9 || v > (UINT64_MAX - digit) / 10)
+        {
+            return false;
+        }
+        v = v * 10 + digit;
+    }
+    *p_out = v;
+    return true;
+}
+
+static bool csv_bind_decode_signed(const jio_string_segment* element, int64_t min, int64_t max, int64_t* p_out)
+{
+    const char* ptr = element->begin;
+    const char* const end = ptr + element->len;
+    const bool negative = ptr != end && *ptr == '-';
+    if (ptr != end && (*ptr == '-' || *ptr == '+'))
+    {
+        ptr += 1;
+    }
+    uint64_t v;
+    if (!csv_bind_decode_magnitude(ptr, end, &v))
+    {
+        return false;
+    }
+    if (negative ? v > (uint64_t)0 - (uint64_t)min : v > (uint64_t)max)
+    {
+        return false;
+    }
+    *p_out = negative ? (int64_t)((uint64_t)0 - v) : (int64_t)v;
+    return true;
+}
+
+static bool csv_bind_decode_unsigned(const jio_string_segment* element, uint64_t max, uint64_t* p_out)
+{
+    const char* ptr = element->begin;
+    const char* const end = ptr + element->len;
+    if (ptr != end && *ptr == '+')
+    {
+        ptr += 1;
+    }
+    uint64_t v;
+    if (!csv_bind_decode_magnitude(ptr, end, &v) || v > max)
+    {
+        return false;
+    }
+    *p_out = v;
+    return true;
+}
+
+//  Plain decimal numbers with at most 19 significant digits, whose mantissa and power of ten are both exact doubles, are
+//  correctly rounded by a single multiplication or division. Everything else is left to strtod.
+static bool csv_bind_decode_double(const jio_string_segment* element, double* p_out)
+{
+    const char* ptr = element->begin;
+    const char* const end = ptr + element->len;
+    const bool negative = ptr != end && *ptr == '-';
+    if (ptr != end && (*ptr == '-' || *ptr == '+'))
+    {
+        ptr += 1;
+    }
+    //  Leading zeros do not count towards significant digits, but all digits after them do
+    uint64_t mantissa = 0;
+    unsigned digit_count = 0;
+    int exponent = 0;
+    const char* const integer_begin = ptr;
+    for (; ptr != end && (unsigned char)*ptr - (unsigned)'0' <= 9; ++ptr)
+    {
+        mantissa = mantissa * 10 + (unsigned)(*ptr - '0');
+        digit_count += mantissa != 0;
+    }
+    bool has_digits = ptr != integer_begin;
+    if (ptr != end && *ptr == '.')
+    {
+        ptr += 1;
+        const char* const fraction_begin = ptr;
+        for (; ptr != end && (unsigned char)*ptr - (unsigned)'0' <= 9; ++ptr)
+        {
+            mantissa = mantissa * 10 + (unsigned)(*ptr - '0');
+            digit_count += mantissa != 0;
+        }
+        has_digits = has_digits || ptr != fraction_begin;
+        exponent = -(int)(ptr - fraction_begin);
+    }
+    if (has_digits && ptr != end && (*ptr == 'e' || *ptr == 'E'))
+    {
+        ptr += 1;
+        const bool negative_exponent = ptr != end && *ptr == '-';
+        if (ptr != end && (*ptr == '-' || *ptr == '+'))
+        {
+            ptr += 1;
+        }
+        int value = 0;
+        const char* const exponent_begin = ptr;
+        for (; ptr != end && (unsigned char)*ptr - (unsigned)'0' <= 9 && ptr - exponent_begin < 4; ++ptr)
+        {
+            value = value * 10 + (*ptr - '0');
+        }
+        if (ptr == exponent_begin)
+        {
+            return false;
+        }
+        exponent += negative_exponent ? -value : value;
+    }
+    if (!has_digits || ptr != end || digit_count > 19 || mantissa > ((uint64_t)1 << 53) || exponent < -22 || exponent > 22)
+    {
+        return jio_string_segment_to_double(element, p_out);
+    }
+    double v = (double)mantissa;
+    v = exponent < 0 ? v / CSV_BIND_POWERS_OF_TEN[-exponent] : v * CSV_BIND_POWERS_OF_TEN[exponent];
+    *p_out = negative ? -v : v;
+    return true;
+}
+
+typedef struct csv_bind_job_T csv_bind_job;
+struct csv_bind_job_T
+{
+    uint32_t field_count;
+    const jio_csv_field* fields;
+    const jio_string_segment* const* elements;  //  Elements of the column of each field, or NULL if it is missing
+    uint32_t first_row;
+    uint32_t row_count;
+    size_t stride;
+    unsigned char* rows;
+    uint32_t* failed_rows;                  //  First row in each block which could not be bound, or UINT32_MAX
+    uint32_t* failed_fields;                //  Field which could not be bound in that row
+};
+
+//  Binds a single field of rows [begin, end), giving the first row which could not be bound, or end if all were
+static uint32_t csv_bind_field(const csv_bind_job* job, uint32_t field_index, uint32_t begin, uint32_t end)
+{
+    const jio_csv_field* const field = job->fields + field_index;
+    const jio_string_segment* const elements = job->elements[field_index];
+    unsigned char* member = job->rows + (size_t)begin * job->stride + field->offset;
+    //  Elements are decoded to one of these, then stored as the type of the field
+    int64_t i64;
+    uint64_t u64;
+    double f64;
+    for (uint32_t i = begin; i < end; ++i, member += job->stride)
+    {
+        const jio_string_segment* const element = elements ? elements + job->first_row + i : NULL;
+        const bool use_default = !element || (element->len == 0 && field->type != JIO_CSV_FIELD_STRING);
+        if (use_default && !field->has_default)
+        {
+            return i;
+        }
+        switch (field->type)
+        {
+        case JIO_CSV_FIELD_INT32:
+            i64 = field->default_value.i64;
+            if (!use_default && !csv_bind_decode_signed(element, INT32_MIN, INT32_MAX, &i64))
+            {
+                return i;
+            }
+            *(int32_t*)member = (int32_t)i64;
+            break;
+        case JIO_CSV_FIELD_INT64:
+            i64 = field->default_value.i64;
+            if (!use_default && !csv_bind_decode_signed(element, INT64_MIN, INT64_MAX, &i64))
+            {
+                return i;
+            }
+            *(int64_t*)member = i64;
+            break;
+        case JIO_CSV_FIELD_UINT32:
+            u64 = field->default_value.u64;
+            if (!use_default && !csv_bind_decode_unsigned(element, UINT32_MAX, &u64))
+            {
+                return i;
+            }
+            *(uint32_t*)member = (uint32_t)u64;
+            break;
+        case JIO_CSV_FIELD_UINT64:
+            u64 = field->default_value.u64;
+            if (!use_default && !csv_bind_decode_unsigned(element, UINT64_MAX, &u64))
+            {
+                return i;
+            }
+            *(uint64_t*)member = u64;
+            break;
+        case JIO_CSV_FIELD_FLOAT:
+            f64 = field->default_value.f64;
+            if (!use_default && !csv_bind_decode_double(element, &f64))
+            {
+                return i;
+            }
+            //  Finite values which are out of range for a float can not be converted to it
+            if (f64 - f64 == 0 && (f64 > FLT_MAX || f64 < -FLT_MAX))
+            {
+                return i;
+            }
+            *(float*)member = (float)f64;
+            break;
+        case JIO_CSV_FIELD_DOUBLE:
+            f64 = field->default_value.f64;
+            if (!use_default && !csv_bind_decode_double(element, &f64))
+            {
+                return i;
+            }
+            *(double*)member = f64;
+            break;
+        case JIO_CSV_FIELD_STRING:
+            *(jio_string_segment*)member = use_default ? field->default_value.str : *element;
+            break;
+        }
+    }
+    return end;
+}
 
-jio_result
-jio_csv_add_rows(
-        const jio_context* ctx, jio_csv_data* data, uint32_t position, uint32_t row_count,
-        const jio_string_segment* const* rows)
+static void csv_bind_task(void* param, uint32_t index)
 {
-    jio_result res = JIO_RESULT_SUCCESS;
+    const csv_bind_job* const job = param;
+    const uint32_t begin = index * CSV_ROWS_PER_TASK;
+    uint32_t end = job->row_count - begin < CSV_ROWS_PER_TASK ? job->row_count : begin + CSV_ROWS_PER_TASK;
+    job->failed_rows[index] = UINT32_MAX;
+    //  Fields are bound one after another, so that the branch on the type is taken the same way for the whole block
+    for (uint32_t i = 0; i < job->field_count; ++i)
+    {
+        const uint32_t failed = csv_bind_field(job, i, begin, end);
+        if (failed != end)
+        {
+            //  Later fields only need to be checked up to the row which failed, since that is the one reported
+            job->failed_rows[index] = failed;
+            job->failed_fields[index] = i;
+            end = failed;
+        }
+    }
+}
 
-    if (position > data->column_length && position != UINT32_MAX)
+jio_result jio_csv_bind_rows(
+        const jio_context* ctx, const jio_csv_data* data, uint32_t field_count, const jio_csv_field* fields,
+        uint32_t first_row, uint32_t row_count, size_t stride, void* rows)
+{
+    if (first_row > data->column_length || data->column_length - first_row < row_count)
     {
-        JIO_ERROR(ctx, "Rows were to be inserted at position %"PRIu32", but csv data has only %u rows", position, data->column_length);
-        res = JIO_RESULT_BAD_INDEX;
+        JIO_ERROR(ctx, "Rows [%"PRIu32", %"PRIu32") were to be bound, but csv data has only %"PRIu32" rows", first_row, first_row + row_count, data->column_length);
+        return JIO_RESULT_BAD_INDEX;
+    }
+    jio_result res = JIO_RESULT_SUCCESS;
+    const uint32_t task_count = (row_count + CSV_ROWS_PER_TASK - 1) / CSV_ROWS_PER_TASK;
+    const jio_string_segment** const elements = jio_alloc_stack(ctx, sizeof(*elements) * (field_count ? field_count : 1));
+    uint32_t* const failed = jio_alloc_stack(ctx, sizeof(*failed) * 2 * (task_count ? task_count : 1));
+    if (!elements || !failed)
+    {
+        JIO_ERROR(ctx, "Could not allocate memory for binding csv rows");
+        res = JIO_RESULT_BAD_ALLOC;
         goto end;
     }
 
-    if (data->columns[0].count + row_count >= data->columns[0].capacity)
+    //  Columns are found (and materialized, for lazily parsed data) before any tasks start
+    for (uint32_t i = 0; i < field_count; ++i)
     {
-        //  Need to resize all columns to fit all columns
-        const uint32_t new_capacity = data->columns[0].capacity + (row_count < 64 ? 64 : row_count);
-        for (uint32_t i = 0; i < data->column_count; ++i)
+        uint32_t column_index = fields[i].index;
+        if (fields[i].name && csv_header_index_find(data, fields[i].name, strlen(fields[i].name), &column_index) != JIO_RESULT_SUCCESS)
+        {
+            column_index = UINT32_MAX;
+        }
+        if (column_index >= data->column_count)
         {
-            jio_string_segment* const new_ptr = jio_realloc(ctx, data->columns[i].elements, new_capacity * sizeof(*new_ptr));
-            if (!new_ptr)
+            if (!fields[i].has_default)
             {
-                JIO_ERROR(ctx, "Could not reallocate column %u to fit additional %u row elements", i, row_count);
-                res = JIO_RESULT_BAD_ALLOC;
+                if (fields[i].name)
+                {
+                    JIO_ERROR(ctx, "Csv file has no header that matches \"%s\" and the field has no default", fields[i].name);
+                    res = JIO_RESULT_BAD_CSV_HEADER;
+                }
+                else
+                {
+                    JIO_ERROR(ctx, "Field %"PRIu32" uses column %"PRIu32", but csv data has only %"PRIu32" columns", i, column_index, data->column_count);
+                    res = JIO_RESULT_BAD_INDEX;
+                }
                 goto end;
             }
-            data->columns[i].elements = new_ptr;
-            data->columns[i].capacity = new_capacity;
+            elements[i] = NULL;
+            continue;
         }
-    }
-
-    //  Now move the old data out of the way of the new if needed
-    if (position == UINT32_MAX)
-    {
-        //  Appending
-        position = data->column_length;
-    }
-    else if (position != data->column_length)
-    {
-        //  Moving
-        for (uint32_t i = 0; i < data->column_count; ++i)
+        if ((res = csv_materialize_column(data, column_index)))
         {
-            const jio_csv_column* const column = data->columns + i;
-            jio_string_segment* const elements = column->elements;
-            memmove(elements + position + row_count, elements + position, sizeof(*elements) * (column->count - position));
+            goto end;
         }
+        elements[i] = data->columns[column_index].elements;
     }
 
-    //  Inserting the new elements and correcting the column lengths
-    for (uint32_t i = 0; i < data->column_count; ++i)
+    csv_bind_job job =
+            {
+                    .field_count = field_count,
+                    .fields = fields,
+                    .elements = elements,
+                    .first_row = first_row,
+                    .row_count = row_count,
+                    .stride = stride,
+                    .rows = rows,
+                    .failed_rows = failed,
+                    .failed_fields = failed + task_count,
+            };
+    jio_parallel_for(ctx, task_count, csv_bind_task, &job);
+    for (uint32_t i = 0; i < task_count; ++i)
     {
-        jio_csv_column* const column = data->columns + i;
-        jio_string_segment* const elements = column->elements;
-        for (uint32_t j = 0; j < row_count; ++j)
+        if (job.failed_rows[i] != UINT32_MAX)
         {
-            elements[position + j] = rows[j][i];
+            const jio_string_segment* const element = elements[job.failed_fields[i]] ? elements[job.failed_fields[i]] + first_row + job.failed_rows[i] : NULL;
+            JIO_ERROR(ctx, "Field %"PRIu32" could not be bound from element \"%.*s\" of row %"PRIu32, job.failed_fields[i],
+                      element ? (int)element->len : 0, element ? element->begin : "", first_row + job.failed_rows[i]);
+            res = JIO_RESULT_BAD_VALUE;
+            break;
         }
-        column->count += row_count;
     }
-    data->column_length += row_count;
-
-
 
 end:
+    jio_free_stack(ctx, failed);
+    jio_free_stack(ctx, elements);
     return res;
 }
 
-jio_result jio_csv_add_cols(
-        const jio_context* ctx, jio_csv_data* data, uint32_t position, uint32_t col_count, const jio_csv_column* cols)
+//  Count, sum and extremes of numbers in a range of rows
+typedef struct csv_aggregate_partial_T csv_aggregate_partial;
+struct csv_aggregate_partial_T
 {
-    jio_result res = JIO_RESULT_SUCCESS;
+    uint32_t count;
+    double sum;
+    double min;
+    double max;
+};
 
-    if (position > data->column_count&& position != UINT32_MAX)
+//  Reduces an array of numbers using four independent accumulators, so that the loop can be vectorized
+static void csv_aggregate_reduce(const double* values, uint32_t count, csv_aggregate_partial* p_partial)
+{
+    p_partial->count = count;
+    if (!count)
     {
-        JIO_ERROR(ctx, "Columns were to be inserted at position %"PRIu32", but csv data has only %u columns", position, data->column_count);
-        res = JIO_RESULT_BAD_INDEX;
-        goto end;
+        p_partial->sum = p_partial->min = p_partial->max = 0;
+        return;
     }
-    bool bad = false;
-    for (uint32_t i = 0; i < col_count; ++i)
+    double sum[4] = {0, 0, 0, 0};
+    double min[4] = {values[0], values[0], values[0], values[0]};
+    double max[4] = {values[0], values[0], values[0], values[0]};
+    uint32_t i = 0;
+    for (; count - i >= 4; i += 4)
     {
-        if (cols[i].count != data->column_length)
+        for (unsigned j = 0; j < 4; ++j)
         {
-            JIO_ERROR(ctx, "Column %u to be inserted had a length of %"PRIu32", but others have the length of %u", i, cols[i].count, data->column_length);
-            bad = true;
+            const double v = values[i + j];
+            sum[j] += v;
+            min[j] = v < min[j] ? v : min[j];
+            max[j] = v > max[j] ? v : max[j];
         }
     }
-    if (bad)
+    for (; i < count; ++i)
     {
-        res = JIO_RESULT_BAD_CSV_COLUMN;
-        goto end;
+        sum[0] += values[i];
+        min[0] = values[i] < min[0] ? values[i] : min[0];
+        max[0] = values[i] > max[0] ? values[i] : max[0];
+    }
+    p_partial->sum = (sum[0] + sum[1]) + (sum[2] + sum[3]);
+    p_partial->min = min[0];
+    p_partial->max = max[0];
+    for (unsigned j = 1; j < 4; ++j)
+    {
+        p_partial->min = min[j] < p_partial->min ? min[j] : p_partial->min;
+        p_partial->max = max[j] > p_partial->max ? max[j] : p_partial->max;
     }
+}
 
-    //  Resize the columns array if needed
-    if (data->column_count + col_count >= data->column_capacity)
+static int csv_aggregate_compare(const void* a, const void* b)
+{
+    const double x = *(const double*)a;
+    const double y = *(const double*)b;
+    return (x > y) - (x < y);
+}
+
+//  Size of the table used to find distinct elements of a block of rows, which is at most half full
+#define CSV_DISTINCT_TABLE_SIZE (2 * CSV_ROWS_PER_TASK)
+//  Distinct elements of blocks are split by their hash into this many parts, each of which is merged by one task
+#define CSV_DISTINCT_PART_COUNT 256
+
+//  Adds a row to a table of rows with distinct elements, returning true if no row in it had the same element before
+static inline bool csv_distinct_insert(const jio_string_segment* elements, uint32_t* table, uint32_t mask, uint64_t hash, uint32_t row)
+{
+    const jio_string_segment* const element = elements + row;
+    for (uint32_t slot = (uint32_t)hash & mask;; slot = (slot + 1) & mask)
     {
-        const uint32_t new_capacity = data->column_capacity + (col_count < 8 ? 8 :  col_count);
-        jio_csv_column* const new_ptr = jio_realloc(ctx, data->columns, sizeof(*new_ptr) * new_capacity);
-        if (!new_ptr)
+        if (!table[slot])
         {
-            JIO_ERROR(ctx, "Could not reallocate memory for column array");
-            res = JIO_RESULT_BAD_ALLOC;
-            goto end;
+            table[slot] = row + 1;
+            return true;
+        }
+        const jio_string_segment* const other = elements + table[slot] - 1;
+        if (other->len == element->len && memcmp(other->begin, element->begin, element->len) == 0)
+        {
+            return false;
         }
-        data->columns = new_ptr;
-        data->column_capacity = new_capacity;
     }
+}
 
-    //  Now move the old data out of the way of the new if needed
-    if (position == UINT32_MAX)
+typedef struct csv_aggregate_job_T csv_aggregate_job;
+struct csv_aggregate_job_T
+{
+    const jio_csv_aggregate_info* info;
+    const jio_string_segment* elements;
+    uint32_t row_count;
+    uint32_t block_count;
+    bool grouped;                           //  Are there groups, or are all rows in one
+    double* values;                         //  Number of each row
+    uint8_t* valid;                         //  Is the element of each row a number
+    double* scratch;                        //  Numbers of each block or group, gathered next to each other
+    csv_aggregate_partial* partials;        //  Partial results of each block, when rows are not grouped
+    const uint32_t* order;                  //  Rows sorted by their group
+    const uint32_t* offsets;                //  Position of the first row of each group in order
+    const uint32_t* table_offsets;          //  Position of the table of each group (or part, when rows are not grouped)
+    uint32_t* tables;                       //  Tables used to count distinct elements of each group or part
+    uint32_t* block_tables;                 //  Table of distinct elements of each block, when rows are not grouped
+    uint64_t* hashes;                       //  Hash of the element of each row, when rows are not grouped
+    uint32_t* distinct_rows;                //  Rows with distinct elements of each block, ordered by their part
+    uint32_t* part_offsets;                 //  Position of the first row of each part in distinct rows of each block
+    uint32_t* part_distinct;                //  Number of distinct elements of each part
+    const uint32_t* task_groups;            //  First group of each task
+    jio_csv_aggregate_group* groups;
+};
+
+//  Finds the distinct elements of a block of rows, storing the rows which have them ordered by the part of their hash
+static void csv_aggregate_block_distinct(const csv_aggregate_job* job, uint32_t index, uint32_t begin, uint32_t end)
+{
+    uint32_t* const table = job->block_tables + (size_t)index * CSV_DISTINCT_TABLE_SIZE;
+    uint32_t* const offsets = job->part_offsets + (size_t)index * (CSV_DISTINCT_PART_COUNT + 1);
+    uint32_t* const rows = job->distinct_rows + begin;
+    memset(table, 0, sizeof(*table) * CSV_DISTINCT_TABLE_SIZE);
+    memset(offsets, 0, sizeof(*offsets) * (CSV_DISTINCT_PART_COUNT + 1));
+    for (uint32_t i = begin; i < end; ++i)
     {
-        //  Appending
-        position = data->column_count;
+        const uint64_t hash = csv_string_hash(job->elements[i].begin, job->elements[i].len);
+        job->hashes[i] = hash;
+        if (csv_distinct_insert(job->elements, table, CSV_DISTINCT_TABLE_SIZE - 1, hash, i))
+        {
+            offsets[(hash >> 56) + 1] += 1;
+        }
     }
-    else if (position != data->column_count)
+    for (uint32_t i = 0; i < CSV_DISTINCT_PART_COUNT; ++i)
     {
-        //  Moving
-        memmove(data->columns + position + col_count, data->columns + position, sizeof(*data->columns) * (data->column_count - position));
+        offsets[i + 1] += offsets[i];
     }
-
-    //  Now insert the new data
-    memcpy(data->columns + position, cols, sizeof(*cols) * col_count);
-
-    data->column_count += col_count;
-end:
-    return res;
-}
-
-jio_result jio_csv_remove_rows(const jio_context* ctx, jio_csv_data* data, uint32_t position, uint32_t row_count)
-{
-    //  Done already?
-    if (!row_count || (data && position == data->column_length)) return JIO_RESULT_SUCCESS;
-    jio_result res = JIO_RESULT_SUCCESS;
-    //  Check that the range to remove lies within the list of available rows
-    const uint32_t begin = position, end = position + row_count;
-    if (begin > data->column_length || end > data->column_length)
+    for (uint32_t i = 0; i < CSV_DISTINCT_TABLE_SIZE; ++i)
     {
-        JIO_ERROR(ctx, "Range of rows to remove is [%"PRIu32", %"PRIu32"), but the csv file only has %"PRIu32" rows", begin, end, data->column_length);
-        res = JIO_RESULT_BAD_INDEX;
-        goto end;
+        if (table[i])
+        {
+            const uint32_t part = (uint32_t)(job->hashes[table[i] - 1] >> 56);
+            rows[offsets[part]] = table[i] - 1;
+            offsets[part] += 1;
+        }
     }
-
-    for (uint32_t i = 0; i < data->column_count; ++i)
+    for (uint32_t i = CSV_DISTINCT_PART_COUNT; i > 0; --i)
     {
-        jio_csv_column* const column = data->columns + i;
-        memmove(column->elements + begin, column->elements + end, sizeof(*column->elements) * (column->count - end));
-        assert(column->count >= row_count);
-        column->count -= row_count;
+        offsets[i] = offsets[i - 1];
     }
-    data->column_length -= row_count;
-end:
-    return res;
+    offsets[0] = 0;
 }
 
-jio_result jio_csv_remove_cols(const jio_context* ctx, jio_csv_data* data, uint32_t position, uint32_t col_count)
+//  Parses numbers of a block of rows. When rows are not grouped, they are also reduced and sorted, and distinct
+//  elements of the block are found.
+static void csv_aggregate_parse_task(void* param, uint32_t index)
 {
-    //  Done already?
-    jio_result res = JIO_RESULT_SUCCESS;
-    //  Check that the range to remove lies within the list of available rows
-    const uint32_t begin = position, end = position + col_count;
-    if (begin > data->column_count || end > data->column_count)
+    const csv_aggregate_job* const job = param;
+    const uint32_t begin = index * CSV_ROWS_PER_TASK;
+    const uint32_t end = job->row_count - begin < CSV_ROWS_PER_TASK ? job->row_count : begin + CSV_ROWS_PER_TASK;
+    double* const numbers = job->scratch + begin;
+    uint32_t count = 0;
+    for (uint32_t i = begin; i < end; ++i)
     {
-        JIO_ERROR(ctx, "Range of columns to remove is [%"PRIu32", %"PRIu32"), but the csv file only has %"PRIu32" columns", begin, end, data->column_count);
-        res = JIO_RESULT_BAD_INDEX;
-        goto end;
+        const bool valid = job->elements[i].len && csv_bind_decode_double(job->elements + i, job->values + i);
+        job->valid[i] = valid;
+        if (valid)
+        {
+            numbers[count++] = job->values[i];
+        }
     }
-
-    for (uint32_t i = begin; i < end; ++i)
+    if (job->grouped)
     {
-        jio_csv_column* const column = data->columns + i;
-        jio_free(ctx, column->elements);
+        return;
+    }
+    csv_aggregate_reduce(numbers, count, job->partials + index);
+    if (job->info->percentile_count)
+    {
+        //  Each block is a sorted run, from which percentiles are selected afterwards
+        qsort(numbers, count, sizeof(*numbers), csv_aggregate_compare);
+    }
+    if (job->info->count_distinct)
+    {
+        csv_aggregate_block_distinct(job, index, begin, end);
     }
-    memmove(data->columns + begin, data->columns + end, sizeof(*data->columns) * (data->column_count - end));
-    data->column_count -= col_count;
-end:
-    return res;
 }
 
-jio_result jio_csv_replace_cols(
-        const jio_context* ctx, jio_csv_data* data, uint32_t begin, uint32_t count, uint32_t col_count,
-        const jio_csv_column* cols)
+//  Merges distinct elements of one part from all blocks
+static void csv_aggregate_merge_distinct_task(void* param, uint32_t index)
 {
-    jio_result res = JIO_RESULT_SUCCESS;
-
-
-    const uint32_t end = begin + count;
-    if (begin >= data->column_count || end >= data->column_count)
+    const csv_aggregate_job* const job = param;
+    uint32_t* const table = job->tables + job->table_offsets[index];
+    const uint32_t mask = job->table_offsets[index + 1] - job->table_offsets[index] - 1;
+    memset(table, 0, sizeof(*table) * (mask + 1));
+    uint32_t distinct = 0;
+    for (uint32_t b = 0; b < job->block_count; ++b)
     {
-        JIO_ERROR(ctx, "Columns to be replaced were on the interval [%"PRIu32", %"PRIu32"), but only values on interval [0, %"PRIu32") can be given", begin, end, data->column_count);
-        res = JIO_RESULT_BAD_INDEX;
-        goto end;
+        const uint32_t* const rows = job->distinct_rows + (size_t)b * CSV_ROWS_PER_TASK;
+        const uint32_t* const offsets = job->part_offsets + (size_t)b * (CSV_DISTINCT_PART_COUNT + 1);
+        for (uint32_t i = offsets[index]; i < offsets[index + 1]; ++i)
+        {
+            distinct += csv_distinct_insert(job->elements, table, mask, job->hashes[rows[i]], rows[i]);
+        }
     }
+    job->part_distinct[index] = distinct;
+}
 
-    //  What is the overall change in column count
-    const int32_t d_col = (int32_t)col_count - (int32_t)count;
-    //  Reallocate the memory for all the new columns
-    if (d_col + data->column_count >= data->column_capacity)
+//  Counts distinct elements of all rows by merging distinct elements of blocks, with each part of them merged in
+//  parallel into a table of its own
+static jio_result csv_aggregate_count_distinct(const jio_context* ctx, csv_aggregate_job* job, jio_csv_aggregate_group* group)
+{
+    uint32_t* const table_offsets = jio_alloc_stack(ctx, sizeof(*table_offsets) * (CSV_DISTINCT_PART_COUNT + 1));
+    uint32_t* const part_distinct = jio_alloc_stack(ctx, sizeof(*part_distinct) * CSV_DISTINCT_PART_COUNT);
+    if (!table_offsets || !part_distinct)
     {
-        const uint32_t new_capacity = data->column_capacity + (d_col < 8 ? 8 : d_col);
-        jio_csv_column* const columns = jio_realloc(ctx, data->columns, sizeof(*data->columns) * new_capacity);
-        if (!columns)
+        JIO_ERROR(ctx, "Could not allocate memory for counting distinct elements of csv column");
+        jio_free_stack(ctx, part_distinct);
+        jio_free_stack(ctx, table_offsets);
+        return JIO_RESULT_BAD_ALLOC;
+    }
+    table_offsets[0] = 0;
+    for (uint32_t i = 0; i < CSV_DISTINCT_PART_COUNT; ++i)
+    {
+        uint32_t part_count = 0;
+        for (uint32_t b = 0; b < job->block_count; ++b)
         {
-            JIO_ERROR(ctx, "Could not reallocate memory for columns");
-            res = JIO_RESULT_BAD_ALLOC;
-            goto end;
+            const uint32_t* const offsets = job->part_offsets + (size_t)b * (CSV_DISTINCT_PART_COUNT + 1);
+            part_count += offsets[i + 1] - offsets[i];
         }
-        data->columns = columns;
-        data->column_capacity = new_capacity;
+        //  Tables are at most half full
+        uint32_t table_size = 2;
+        while (table_size < 2 * part_count)
+        {
+            table_size <<= 1;
+        }
+        table_offsets[i + 1] = table_offsets[i] + table_size;
     }
-
-    for (uint32_t i = begin; i < end; ++i)
+    job->tables = jio_alloc(ctx, sizeof(*job->tables) * table_offsets[CSV_DISTINCT_PART_COUNT]);
+    if (!job->tables)
     {
-        jio_free(ctx, data->columns[i].elements);
+        JIO_ERROR(ctx, "Could not allocate memory for counting distinct elements of csv column");
+        jio_free_stack(ctx, part_distinct);
+        jio_free_stack(ctx, table_offsets);
+        return JIO_RESULT_BAD_ALLOC;
     }
-    if (end != data->column_count)
+    job->table_offsets = table_offsets;
+    job->part_distinct = part_distinct;
+    jio_parallel_for(ctx, CSV_DISTINCT_PART_COUNT, csv_aggregate_merge_distinct_task, job);
+    group->distinct_count = 0;
+    for (uint32_t i = 0; i < CSV_DISTINCT_PART_COUNT; ++i)
     {
-        //  This if is not really needed, I just don't want a call to memmove if not needed
-        memmove(data->columns + begin + col_count, data->columns + end, sizeof(*data->columns) * (data->column_count - end));
+        group->distinct_count += part_distinct[i];
     }
-    //  Insert the new columns
-    memcpy(data->columns + begin, cols, sizeof(*cols) * col_count);
-    data->column_count += d_col;
-end:
-    return res;
+    job->table_offsets = NULL;
+    job->part_distinct = NULL;
+    jio_free_stack(ctx, part_distinct);
+    jio_free_stack(ctx, table_offsets);
+    return JIO_RESULT_SUCCESS;
 }
 
-jio_result jio_csv_replace_rows(
-        const jio_context* ctx, jio_csv_data* data, uint32_t begin, uint32_t count, uint32_t row_count,
-        const jio_string_segment* const* rows)
+//  Middle of what is left of a sorted run, weighted by how many numbers are left in it
+typedef struct csv_select_candidate_T csv_select_candidate;
+struct csv_select_candidate_T
 {
-    jio_result res = JIO_RESULT_SUCCESS;
+    double value;
+    uint32_t weight;
+};
 
-    const uint32_t end = begin + count;
-    if (begin >= data->column_length || end >= data->column_length)
+static int csv_select_candidate_compare(const void* a, const void* b)
+{
+    return csv_aggregate_compare(&((const csv_select_candidate*)a)->value, &((const csv_select_candidate*)b)->value);
+}
+
+//  Gives the number of elements of a sorted run which are less than (or if inclusive, less than or equal to) the value
+static uint32_t csv_aggregate_rank(const double* run, uint32_t count, double value, bool inclusive)
+{
+    uint32_t low = 0, high = count;
+    while (low < high)
     {
-        JIO_ERROR(ctx, "Rows to be replaced were on the interval [%"PRIu32", %"PRIu32"), but only values on interval [0, %"PRIu32") can be given", begin, end, data->column_count);
-        res = JIO_RESULT_BAD_INDEX;
-        goto end;
+        const uint32_t mid = low + (high - low) / 2;
+        if (run[mid] < value || (inclusive && run[mid] == value))
+        {
+            low = mid + 1;
+        }
+        else
+        {
+            high = mid;
+        }
     }
+    return low;
+}
 
-    //  What is the overall change in column count
-    const int32_t d_row = (int32_t)row_count - (int32_t)count;
-    //  Reallocate the memory for all the new columns
-    if (d_row + data->column_length >= data->columns[0].capacity)
+//  Selects the number with the given rank from sorted runs of all blocks, without merging them. Each pivot is the
+//  weighted median of the middles of what is left of each run, so that every pivot discards at least a quarter of the
+//  numbers which are left.
+static double csv_aggregate_select(const csv_aggregate_job* job, uint32_t rank, uint32_t* bounds, csv_select_candidate* candidates)
+{
+    uint32_t* const low = bounds;
+    uint32_t* const high = bounds + job->block_count;
+    for (uint32_t b = 0; b < job->block_count; ++b)
+    {
+        low[b] = 0;
+        high[b] = job->partials[b].count;
+    }
+    for (;;)
     {
-        for (uint32_t i = 0; i < data->column_count; ++i)
+        uint32_t candidate_count = 0;
+        uint64_t total = 0;
+        for (uint32_t b = 0; b < job->block_count; ++b)
         {
-            jio_csv_column* const column = data->columns + i;
-            const uint32_t new_capacity = column->capacity + (d_row < 8 ? 8 : d_row);
-            jio_string_segment* const elements = jio_realloc(ctx, column->elements, sizeof(*column->elements) * new_capacity);
-            if (!elements)
+            if (low[b] < high[b])
             {
-                JIO_ERROR(ctx, "Could not reallocate memory for column elements");
-                res = JIO_RESULT_BAD_ALLOC;
-                goto end;
+                const double* const run = job->scratch + (size_t)b * CSV_ROWS_PER_TASK;
+                candidates[candidate_count++] = (csv_select_candidate){.value = run[low[b] + (high[b] - low[b]) / 2], .weight = high[b] - low[b]};
+                total += high[b] - low[b];
             }
-            column->elements = elements;
-            column->capacity = new_capacity;
         }
-    }
+        qsort(candidates, candidate_count, sizeof(*candidates), csv_select_candidate_compare);
+        uint32_t c = 0;
+        for (uint64_t weight = candidates[0].weight; 2 * weight < total; weight += candidates[c].weight)
+        {
+            c += 1;
+        }
+        const double pivot = candidates[c].value;
 
-    for (uint32_t i = 0; i < data->column_count; ++i)
-    {
-        jio_csv_column* const column = data->columns + i;
-        memmove(column->elements + begin + row_count, column->elements + end, sizeof(*column->elements) * (data->column_length - end));
-        //  Insert the new elements for each row
-        for (uint32_t j = 0; j < row_count; ++j)
+        uint64_t less = 0, less_equal = 0;
+        for (uint32_t b = 0; b < job->block_count; ++b)
         {
-            column->elements[j + begin] = rows[j][i];
+            const double* const run = job->scratch + (size_t)b * CSV_ROWS_PER_TASK;
+            less += csv_aggregate_rank(run, job->partials[b].count, pivot, false);
+            less_equal += csv_aggregate_rank(run, job->partials[b].count, pivot, true);
+        }
+        if (rank >= less && rank < less_equal)
+        {
+            return pivot;
+        }
+        //  Numbers on the wrong side of the pivot are discarded from every run
+        const bool below = rank < less;
+        for (uint32_t b = 0; b < job->block_count; ++b)
+        {
+            const double* const run = job->scratch + (size_t)b * CSV_ROWS_PER_TASK;
+            const uint32_t r = csv_aggregate_rank(run, job->partials[b].count, pivot, !below);
+            if (below && r < high[b])
+            {
+                high[b] = r;
+            }
+            else if (!below && r > low[b])
+            {
+                low[b] = r;
+            }
         }
-        column->count += d_row;
     }
-    data->column_length += d_row;
-
-end:
-    return res;
 }
 
-jio_result jio_csv_column_index(const jio_csv_data* data, const jio_csv_column* column, uint32_t* p_idx)
+//  Finds percentiles of all rows by selecting the closest ranks from sorted runs of blocks
+static jio_result csv_aggregate_percentiles(const jio_context* ctx, const csv_aggregate_job* job, jio_csv_aggregate_group* group)
 {
-    jio_result res = JIO_RESULT_SUCCESS;
-
-    const uintptr_t idx = column - data->columns;
-    if (idx < data->column_count)
+    const jio_csv_aggregate_info* const info = job->info;
+    const uint32_t count = group->count;
+    if (!count)
     {
-        *p_idx = idx;
+        memset(group->percentiles, 0, sizeof(*group->percentiles) * info->percentile_count);
+        return JIO_RESULT_SUCCESS;
     }
-    else
+    uint32_t* const bounds = jio_alloc_stack(ctx, sizeof(*bounds) * 2 * job->block_count);
+    csv_select_candidate* const candidates = jio_alloc_stack(ctx, sizeof(*candidates) * job->block_count);
+    if (!bounds || !candidates)
     {
-        res = JIO_RESULT_BAD_PTR;
+        JIO_ERROR(ctx, "Could not allocate memory for finding percentiles of csv column");
+        jio_free_stack(ctx, candidates);
+        jio_free_stack(ctx, bounds);
+        return JIO_RESULT_BAD_ALLOC;
     }
-
-    return res;
+    //  Percentiles are interpolated between the closest ranks
+    for (uint32_t i = 0; i < info->percentile_count; ++i)
+    {
+        const double position = info->percentiles[i] * (count - 1);
+        const uint32_t low = (uint32_t)position;
+        const uint32_t high = low + 1 < count ? low + 1 : low;
+        const double low_value = csv_aggregate_select(job, low, bounds, candidates);
+        const double high_value = high != low ? csv_aggregate_select(job, high, bounds, candidates) : low_value;
+        group->percentiles[i] = low_value + (high_value - low_value) * (position - low);
+    }
+    jio_free_stack(ctx, candidates);
+    jio_free_stack(ctx, bounds);
+    return JIO_RESULT_SUCCESS;
 }
 
-jio_result jio_process_csv_exact(
-        const jio_context* ctx, const jio_memory_file* mem_file, const char* separator, uint32_t column_count,
-        const jio_string_segment* headers, bool (** converter_array)(jio_string_segment*, void*), void** param_array)
+//  Finds results of groups, which are reduced here as well, since their rows are not next to each other
+static void csv_aggregate_group_task(void* param, uint32_t index)
 {
+    const csv_aggregate_job* const job = param;
+    const jio_csv_aggregate_info* const info = job->info;
+    for (uint32_t g = job->task_groups[index]; g < job->task_groups[index + 1]; ++g)
     {
-        bool converters_complete = true;
-        for (uint32_t i = 0; i < column_count; ++i)
+        jio_csv_aggregate_group* const group = job->groups + g;
+        const uint32_t* const rows = job->order + job->offsets[g];
+        const uint32_t row_count = job->offsets[g + 1] - job->offsets[g];
+        double* const numbers = job->scratch + job->offsets[g];
+        uint32_t count = 0;
+        for (uint32_t i = 0; i < row_count; ++i)
         {
-            if (converter_array[i] == NULL)
+            if (job->valid[rows[i]])
             {
-                converters_complete = false;
-                JIO_ERROR(ctx, "Converter for column %u (%.*s) was not provided", i, (int)headers[i].len, headers[i].begin);
+                numbers[count++] = job->values[rows[i]];
             }
         }
-        if (!converters_complete)
+        csv_aggregate_partial partial;
+        csv_aggregate_reduce(numbers, count, &partial);
+        group->count = partial.count;
+        group->sum = partial.sum;
+        group->min = partial.min;
+        group->max = partial.max;
+        group->mean = count ? partial.sum / count : 0;
+        if (info->percentile_count)
         {
-            return JIO_RESULT_BAD_CONVERTER;
+            //  Percentiles are interpolated between the closest ranks
+            qsort(numbers, count, sizeof(*numbers), csv_aggregate_compare);
+            for (uint32_t i = 0; i < info->percentile_count; ++i)
+            {
+                if (!count)
+                {
+                    group->percentiles[i] = 0;
+                    continue;
+                }
+                const double position = info->percentiles[i] * (count - 1);
+                const uint32_t low = (uint32_t)position;
+                const uint32_t high = low + 1 < count ? low + 1 : low;
+                group->percentiles[i] = numbers[low] + (numbers[high] - numbers[low]) * (position - low);
+            }
+        }
+        if (info->count_distinct)
+        {
+            uint32_t* const table = job->tables + job->table_offsets[g];
+            const uint32_t mask = job->table_offsets[g + 1] - job->table_offsets[g] - 1;
+            memset(table, 0, sizeof(*table) * (mask + 1));
+            uint32_t distinct = 0;
+            for (uint32_t i = 0; i < row_count; ++i)
+            {
+                const jio_string_segment* const element = job->elements + rows[i];
+                distinct += csv_distinct_insert(job->elements, table, mask, csv_string_hash(element->begin, element->len), rows[i]);
+            }
+            group->distinct_count = distinct;
         }
     }
-    jio_result res;
+}
 
-    //  Parse the first row
-    const char* row_begin = mem_file->ptr;
-    const char* row_end = strchr(row_begin, '\n');
-    jio_string_segment* segments = NULL;
-    //  Count columns in the csv file
-    size_t sep_len = strlen(separator);
+jio_result jio_csv_aggregate(
+        const jio_context* ctx, const jio_csv_data* data, uint32_t column, const jio_csv_aggregate_info* info,
+        uint32_t group_by_column, jio_csv_aggregation* p_aggregation)
+{
+    if (column >= data->column_count || (group_by_column != UINT32_MAX && group_by_column >= data->column_count))
     {
-        const uint32_t real_column_count = count_row_entries(
-                row_begin, row_end ? row_end : (const char*)mem_file->ptr + mem_file->file_size, separator, sep_len);
-        if (real_column_count != column_count)
+        JIO_ERROR(ctx, "Aggregation was to use columns %"PRIu32" and %"PRIu32", but csv data has only %u columns", column, group_by_column, data->column_count);
+        return JIO_RESULT_BAD_INDEX;
+    }
+    for (uint32_t i = 0; i < info->percentile_count; ++i)
+    {
+        if (!(info->percentiles[i] >= 0 && info->percentiles[i] <= 1))
+        {
+            JIO_ERROR(ctx, "Percentile %g is not on [0, 1]", info->percentiles[i]);
+            return JIO_RESULT_BAD_VALUE;
+        }
+    }
+    jio_result res = csv_materialize_column(data, column);
+    if (res != JIO_RESULT_SUCCESS)
+    {
+        return res;
+    }
+    const uint32_t row_count = data->column_length;
+    const uint32_t block_count = (row_count + CSV_ROWS_PER_TASK - 1) / CSV_ROWS_PER_TASK;
+    jio_csv_dictionary dictionary = {0};
+    csv_aggregate_job job =
+            {
+                    .info = info,
+                    .elements = data->columns[column].elements,
+                    .row_count = row_count,
+                    .block_count = block_count,
+                    .grouped = group_by_column != UINT32_MAX,
+            };
+    uint32_t* offsets = NULL;
+    uint32_t* task_groups = NULL;
+    jio_csv_aggregate_group* groups = NULL;
+
+    //  Groups are numbered in order of first appearance of their keys, just as values of a dictionary are
+    uint32_t group_count = 1;
+    if (job.grouped)
+    {
+        if ((res = jio_csv_column_dictionary_encode(ctx, data, group_by_column, &dictionary)))
         {
-            JIO_ERROR(ctx, "Csv file has %"PRIu32" columns, but %"PRIu32" were specified", real_column_count, column_count);
-            res = JIO_RESULT_BAD_CSV_HEADER;
             goto end;
         }
+        group_count = dictionary.value_count;
     }
-    segments = jio_alloc_stack(ctx, sizeof(*segments) * column_count);
-    if (!segments)
+    groups = jio_alloc(ctx, (sizeof(*groups) + sizeof(double) * info->percentile_count) * (group_count ? group_count : 1));
+    job.values = jio_alloc(ctx, sizeof(*job.values) * (row_count ? row_count : 1));
+    job.valid = jio_alloc(ctx, sizeof(*job.valid) * (row_count ? row_count : 1));
+    job.scratch = jio_alloc(ctx, sizeof(*job.scratch) * (row_count ? row_count : 1));
+    job.partials = jio_alloc(ctx, sizeof(*job.partials) * (block_count ? block_count : 1));
+    if (!groups || !job.values || !job.valid || !job.scratch || !job.partials)
     {
+        JIO_ERROR(ctx, "Could not allocate memory for csv aggregation");
         res = JIO_RESULT_BAD_ALLOC;
-        JIO_ERROR(ctx, "Could not allocate memory for csv parsing");
         goto end;
     }
-    if ((res = extract_row_entries(NULL, column_count, row_begin, row_end, separator, sep_len, true, segments)) != JIO_RESULT_SUCCESS)
+    //  Without groups, each block finds its own distinct elements, which are merged afterwards
+    if (!job.grouped && info->count_distinct)
     {
-        JIO_ERROR(ctx, "Failed extracting the headers from CSV file \"%s\", reason: %s", mem_file->name,
-                  jio_result_to_str(res));
-        goto end;
+        job.block_tables = jio_alloc(ctx, sizeof(*job.block_tables) * CSV_DISTINCT_TABLE_SIZE * (block_count ? block_count : 1));
+        job.hashes = jio_alloc(ctx, sizeof(*job.hashes) * (row_count ? row_count : 1));
+        job.distinct_rows = jio_alloc(ctx, sizeof(*job.distinct_rows) * (row_count ? row_count : 1));
+        job.part_offsets = jio_alloc(ctx, sizeof(*job.part_offsets) * (CSV_DISTINCT_PART_COUNT + 1) * (block_count ? block_count : 1));
+        if (!job.block_tables || !job.hashes || !job.distinct_rows || !job.part_offsets)
+        {
+            JIO_ERROR(ctx, "Could not allocate memory for counting distinct elements of csv column");
+            res = JIO_RESULT_BAD_ALLOC;
+            goto end;
+        }
     }
-    for (uint32_t i = 0; i < column_count; ++i)
+    memset(groups, 0, sizeof(*groups) * group_count);
+    for (uint32_t i = 0; i < group_count; ++i)
     {
-        if (!jio_string_segment_equal(segments + i, headers + i))
+        groups[i].key = job.grouped ? dictionary.values[i] : (jio_string_segment){.begin = NULL, .len = 0};
+        groups[i].percentiles = info->percentile_count ? (double*)(groups + group_count) + (size_t)i * info->percentile_count : NULL;
+    }
+    job.groups = groups;
+    jio_parallel_for(ctx, block_count, csv_aggregate_parse_task, &job);
+    if (!job.grouped)
+    {
+        groups[0].row_count = row_count;
+        for (uint32_t i = 0; i < block_count; ++i)
+        {
+            const csv_aggregate_partial* const partial = job.partials + i;
+            if (!partial->count)
+            {
+                continue;
+            }
+            groups[0].min = groups[0].count && groups[0].min < partial->min ? groups[0].min : partial->min;
+            groups[0].max = groups[0].count && groups[0].max > partial->max ? groups[0].max : partial->max;
+            groups[0].count += partial->count;
+            groups[0].sum += partial->sum;
+        }
+        groups[0].mean = groups[0].count ? groups[0].sum / groups[0].count : 0;
+        if (info->percentile_count && (res = csv_aggregate_percentiles(ctx, &job, groups)))
         {
-            JIO_ERROR(ctx, "Column %u had a header \"%.*s\", but \"%.*s\" was expected", i + 1, (int)segments[i].len, segments[i].begin, (int)headers[i].len, headers[i].begin);
             goto end;
         }
+        if (info->count_distinct && (res = csv_aggregate_count_distinct(ctx, &job, groups)))
+        {
+            goto end;
+        }
+        goto done;
     }
 
-    uint32_t row_count = 0;
-    while (row_end)
+    //  Rows are sorted by their group with a counting sort, keeping their order within each group
+    uint32_t* const order = jio_alloc(ctx, sizeof(*order) * (row_count ? row_count : 1));
+    offsets = jio_alloc(ctx, sizeof(*offsets) * 2 * ((size_t)group_count + 1));
+    uint32_t task_count = block_count < group_count ? block_count : group_count;
+    task_count = task_count ? task_count : 1;
+    task_groups = jio_alloc(ctx, sizeof(*task_groups) * (task_count + 1));
+    job.order = order;
+    if (!order || !offsets || !task_groups)
+    {
+        JIO_ERROR(ctx, "Could not allocate memory for csv aggregation");
+        res = JIO_RESULT_BAD_ALLOC;
+        goto end;
+    }
+    memset(offsets, 0, sizeof(*offsets) * (group_count + 1));
+    for (uint32_t i = 0; i < row_count; ++i)
+    {
+        offsets[jio_csv_dictionary_code(&dictionary, i) + 1] += 1;
+    }
+    uint32_t* const table_offsets = offsets + group_count + 1;
+    table_offsets[0] = 0;
+    for (uint32_t i = 0; i < group_count; ++i)
     {
-        if ((res = extract_row_entries(NULL, column_count, row_begin, row_end, separator, sep_len, true, segments)))
+        groups[i].row_count = offsets[i + 1];
+        //  Tables are at most half full
+        uint32_t table_size = 2;
+        while (info->count_distinct && table_size < 2 * offsets[i + 1])
         {
-            JIO_ERROR(ctx, "Failed parsing row %u of CSV file \"%s\", reason: %s", row_count + 1, mem_file->name, jio_result_to_str(res));
-            goto end;
+            table_size <<= 1;
         }
-        for (uint32_t i = 0; row_count && i < column_count; ++i)
+        table_offsets[i + 1] = table_offsets[i] + (info->count_distinct ? table_size : 0);
+        offsets[i + 1] += offsets[i];
+    }
+    for (uint32_t i = 0; i < row_count; ++i)
+    {
+        const uint32_t group = jio_csv_dictionary_code(&dictionary, i);
+        order[offsets[group]] = i;
+        offsets[group] += 1;
+    }
+    for (uint32_t i = group_count; i > 0; --i)
+    {
+        offsets[i] = offsets[i - 1];
+    }
+    offsets[0] = 0;
+    job.offsets = offsets;
+    job.table_offsets = table_offsets;
+    if (info->count_distinct)
+    {
+        job.tables = jio_alloc(ctx, sizeof(*job.tables) * (table_offsets[group_count] ? table_offsets[group_count] : 1));
+        if (!job.tables)
         {
-            if (!converter_array[i](segments + i, param_array[i]))
-            {
-                JIO_ERROR(ctx, "Element %"PRIu32" in row %"PRIu32" could not be converted", i + 1, row_count + 1);
-                res = JIO_RESULT_BAD_VALUE;
-                goto end;
-            }
+            JIO_ERROR(ctx, "Could not allocate memory for counting distinct elements of csv column");
+            res = JIO_RESULT_BAD_ALLOC;
+            goto end;
         }
+    }
 
-        row_count += 1;
-        //  Move to the next row
-        row_begin = row_end + 1;
-        row_end = strchr(row_end + 1, '\n');
+    //  Tasks take groups with roughly the same number of rows
+    for (uint32_t i = 0, g = 0; i < task_count; ++i)
+    {
+        const uint64_t first_row = (uint64_t)row_count * i / task_count;
+        while (g < group_count && offsets[g] < first_row)
+        {
+            g += 1;
+        }
+        task_groups[i] = g;
     }
+    task_groups[task_count] = group_count;
+    job.task_groups = task_groups;
+    jio_parallel_for(ctx, task_count, csv_aggregate_group_task, &job);
+
+done:
+    p_aggregation->group_count = group_count;
+    p_aggregation->groups = groups;
+    groups = NULL;
 
 end:
-    jio_free_stack(ctx, segments);
+    jio_free(ctx, job.part_offsets);
+    jio_free(ctx, job.distinct_rows);
+    jio_free(ctx, job.hashes);
+    jio_free(ctx, job.block_tables);
+    jio_free(ctx, job.tables);
+    jio_free(ctx, task_groups);
+    jio_free(ctx, offsets);
+    jio_free(ctx, (uint32_t*)job.order);
+    jio_free(ctx, job.partials);
+    jio_free(ctx, job.scratch);
+    jio_free(ctx, job.valid);
+    jio_free(ctx, job.values);
+    jio_free(ctx, groups);
+    jio_csv_dictionary_release(ctx, &dictionary);
     return res;
 }
 
-jio_result jio_csv_print_size(
-        const jio_csv_data* const data, size_t* const p_size, const size_t separator_length, const uint32_t extra_padding, const bool same_width)
+void jio_csv_aggregation_release(const jio_context* ctx, jio_csv_aggregation* aggregation)
 {
-    jio_result res = JIO_RESULT_SUCCESS;
+    jio_free(ctx, aggregation->groups);
+    memset(aggregation, 0, sizeof(*aggregation));
+}
 
+typedef struct csv_rebase_job_T csv_rebase_job;
+struct csv_rebase_job_T
+{
+    jio_csv_column* columns;
+    uintptr_t old_begin;                    //  Address where the file was mapped before
+    size_t old_size;                        //  Size of the old mapping
+    const char* new_begin;                  //  Address where the file is mapped now
+};
 
-    size_t total_chars = 0;
-    if (!same_width)
+static inline void csv_rebase_segment(const csv_rebase_job* job, jio_string_segment* segment)
+{
+    const uintptr_t offset = (uintptr_t)segment->begin - job->old_begin;
+    if (offset < job->old_size)
     {
-        for (uint32_t i = 0; i < data->column_count; ++i)
-        {
-            const jio_csv_column* const column = data->columns + i;
-            total_chars += column->header.len;
+        segment->begin = job->new_begin + offset;
+    }
+}
+
+static void csv_rebase_task(void* param, uint32_t index)
+{
+    const csv_rebase_job* const job = param;
+    jio_csv_column* const column = job->columns + index;
+    csv_rebase_segment(job, &column->header);
+    for (uint32_t i = 0; i < column->count; ++i)
+    {
+        csv_rebase_segment(job, column->elements + i);
+    }
+}
+
+jio_result jio_csv_parse_append(const jio_context* ctx, jio_csv_data* data, jio_memory_file* mem_file)
+{
+    csv_append_state* const append = data->append;
+    if (!append)
+    {
+        JIO_ERROR(ctx, "Rows can only be appended to csv data which was parsed from a file without filters");
+        return JIO_RESULT_BAD_VALUE;
+    }
+    if (append->column_count != data->column_count)
+    {
+        JIO_ERROR(ctx, "Csv data has %u columns, but %"PRIu32" were parsed from the file", data->column_count, append->column_count);
+        return JIO_RESULT_BAD_VALUE;
+    }
+    jio_result res;
+    if ((res = csv_make_eager(data)))
+    {
+        return res;
+    }
 
-            for (uint32_t j = 0; j < column->count; ++j)
+    //  Elements which point into the file must be moved along with it
+    const csv_rebase_job rebase_job =
             {
-                total_chars += column->elements[j].len;
-            }
-        }
+                    .columns = data->columns,
+                    .old_begin = (uintptr_t)mem_file->ptr,
+                    .old_size = mem_file->file_size,
+            };
+    if ((res = jio_memory_file_remap(mem_file)))
+    {
+        return res;
+    }
+    if ((uintptr_t)mem_file->ptr != rebase_job.old_begin)
+    {
+        csv_rebase_job job = rebase_job;
+        job.new_begin = mem_file->ptr;
+        jio_parallel_for(ctx, data->column_count, csv_rebase_task, &job);
+    }
 
-        //  characters needed to pad entries
-        total_chars += (extra_padding) * (data->column_length + 1) * data->column_count;
+    //  Only lines which ended are parsed
+    const char* const file_begin = mem_file->ptr;
+    const char* const file_end = file_begin + mem_file->file_size;
+    const char* const begin = file_begin + append->offset;
+    const char* end = memchr(begin, 0, file_end - begin);
+    if (!end)
+    {
+        end = file_end;
     }
-    else
+    while (end != begin && end[-1] != '\n')
+    {
+        end -= 1;
+    }
+    if (end == begin)
+    {
+        return JIO_RESULT_SUCCESS;
+    }
+    uint64_t line_count = 0;
+    for (const char* ptr = begin; ptr != end; ptr = (const char*)memchr(ptr, '\n', end - ptr) + 1)
+    {
+        line_count += 1;
+    }
+
+    //  Row parsed from a line which had not ended is replaced, but is kept until all new rows are parsed
+    const bool replace = append->has_partial && data->column_length;
+    const uint32_t first = data->column_length - (replace ? 1 : 0);
+    if (first + line_count >= UINT32_MAX)
+    {
+        JIO_ERROR(ctx, "Csv data can not have more than %"PRIu32" rows", UINT32_MAX);
+        return JIO_RESULT_BAD_ALLOC;
+    }
+    const uint32_t required = (uint32_t)(first + line_count);
+    if (data->column_count && required >= data->columns[0].capacity)
     {
-        // Find the maximum width of any entry
-        uint32_t width = 0;
+        const uint32_t new_capacity = csv_grow_row_capacity(data->columns[0].capacity, required, 64);
         for (uint32_t i = 0; i < data->column_count; ++i)
         {
-            const jio_csv_column* const column = data->columns + i;
-            if (column->header.len > width)
-            {
-                width = column->header.len;
-            }
-            for (uint32_t j = 0; j < column->count; ++j)
+            if (csv_column_resize(data, i, new_capacity) != JIO_RESULT_SUCCESS)
             {
-                if (column->elements[j].len > width)
-                {
-                    width = column->elements[j].len;
-                }
+                JIO_ERROR(ctx, "Could not reallocate column %u to fit additional %"PRIu64" rows", i, line_count);
+                return JIO_RESULT_BAD_ALLOC;
             }
         }
-        //  characters needed to fit entries
-        total_chars = (width + extra_padding) * (data->column_length + 1) * data->column_count;
     }
-    //  characters needed for separators
-    total_chars += (data->column_count - 1) * (data->column_length + 1) * separator_length;
-    //  Characters needed for new line characters
-    total_chars += (data->column_length);
-
-    *p_size = total_chars + 1;
-
-    return res;
-}
-
-static size_t print_entry(char* restrict buffer, const char* restrict src, size_t n, uint32_t extra_padding, uint32_t min_width, bool align_left)
-{
-    uint32_t same_pad = 0;
-    if (n < min_width)
+    for (uint32_t i = 0; i < data->column_count; ++i)
     {
-        same_pad = min_width - n;
+        if ((res = csv_column_prepare(data, i, first)))
+        {
+            return res;
+        }
     }
-    if (align_left)
+
+    jio_string_segment* const row = jio_alloc_stack(ctx, sizeof(*row) * 2 * (data->column_count ? data->column_count : 1));
+    if (!row)
     {
-        memcpy(buffer, src, n);
-        memset(buffer + n, ' ', same_pad + extra_padding);
+        JIO_ERROR(ctx, "Could not allocate memory for csv parsing");
+        return JIO_RESULT_BAD_ALLOC;
     }
-    else
+    jio_string_segment* const partial = row + data->column_count;
+    for (uint32_t i = 0; replace && i < data->column_count; ++i)
     {
-        memset(buffer, ' ', same_pad + extra_padding);
-        memcpy(buffer + same_pad + extra_padding, src, n);
+        partial[i] = data->columns[i].elements[first];
     }
-    return same_pad + extra_padding + n;
-}
 
-jio_result jio_csv_print(
-        const jio_csv_data* data, size_t* p_usage, char* restrict buffer, const char* separator, uint32_t extra_padding, bool same_width,
-        bool align_left)
-{
-    jio_result res = JIO_RESULT_SUCCESS;
-    size_t min_width = 0;
-    if (same_width)
+    uint32_t row_count = first;
+    for (const char* row_begin = begin; row_begin != end;)
     {
-        for (uint32_t i = 0; i < data->column_count; ++i)
+        const char* const row_end = memchr(row_begin, '\n', end - row_begin);
+        if (row_end != row_begin)
         {
-            const jio_csv_column* const column = data->columns + i;
-            if (column->header.len > min_width)
-            {
-                min_width = column->header.len;
-            }
-            for (uint32_t j = 0; j < column->count; ++j)
+            if ((res = extract_row_entries(ctx, append->file_column_count, row_begin, row_end, append->separator, append->sep_len, append->trim_whitespace, row, 1, append->slots)))
             {
-                if (column->elements[j].len > min_width)
+                JIO_ERROR(ctx, "Failed parsing row at byte %zu of CSV file \"%s\", reason: %s", (size_t)(row_begin - file_begin), mem_file->name, jio_result_to_str(res));
+                //  Data is left as it was
+                for (uint32_t i = 0; replace && i < data->column_count; ++i)
                 {
-                    min_width = column->elements[j].len;
+                    data->columns[i].elements[first] = partial[i];
                 }
+                jio_free_stack(ctx, row);
+                return res;
+            }
+            for (uint32_t i = 0; i < data->column_count; ++i)
+            {
+                data->columns[i].elements[row_count] = row[i];
             }
+            row_count += 1;
         }
+        row_begin = row_end + 1;
     }
 
-    const size_t sep_len = strlen(separator);
-    //  Print headers
-    char* pos = buffer;
-    pos += print_entry(pos, data->columns[0].header.begin, data->columns[0].header.len, extra_padding, min_width, align_left);
-    for (uint32_t i = 1; i < data->column_count; ++i)
-    {
-        memcpy(pos, separator, sep_len); pos += sep_len;
-        pos += print_entry(pos, data->columns[i].header.begin, data->columns[i].header.len, extra_padding, min_width, align_left);
-    }
-    *pos = '\n'; ++pos;
-
-    //  Now to print all entries to the buffer
-    for (uint32_t i = 0; i < data->column_length; ++i)
+    for (uint32_t i = 0; i < data->column_count; ++i)
     {
-        pos += print_entry(pos, data->columns[0].elements[i].begin, data->columns[0].elements[i].len, extra_padding, min_width, align_left);
-        for (uint32_t j = 1; j < data->column_count; ++j)
+        jio_csv_column* const column = data->columns + i;
+        if (replace)
         {
-            const jio_string_segment segment = data->columns[j].elements[i];
-            memcpy(pos, separator, sep_len); pos += sep_len;
-            pos += print_entry(pos, segment.begin, segment.len, extra_padding, min_width, align_left);
+            csv_stats_remove(data, i, partial + i, 1);
         }
-        *pos = '\n'; ++pos;
+        csv_stats_add(data, i, column->elements + first, row_count - first);
+        column->count = row_count;
     }
-    *pos = 0;
-
-    if (p_usage)
+    data->column_length = row_count;
+    if (replace)
     {
-        *p_usage = pos - buffer;
+        csv_indices_invalidate(data, UINT32_MAX);
     }
-
-    return res;
+    else
+    {
+        csv_indices_rows_added(data, first, row_count - first);
+    }
+    append->offset = end - file_begin;
+    append->has_partial = false;
+    jio_free_stack(ctx, row);
+    return JIO_RESULT_SUCCESS;
 }
@@ -0,0 +1,653 @@
+//
+// Created by jan on 19.10.2026.
+//
+
+#include <inttypes.h>
+#include <string.h>
+#include <assert.h>
+#include "../include/jio/iocsv.h"
+#include "internal.h"
+
+//  Elements are stored in fixed-size leaf blocks of a B+ tree, where each inner node knows how many elements each of its
+//  children holds. That way an element can be found, inserted, or removed at any position in O(log n).
+#define CHUNKED_LEAF_CAPACITY 256
+#define CHUNKED_INNER_CAPACITY 64
+
+typedef struct chunked_leaf_T chunked_leaf;
+struct chunked_leaf_T
+{
+    uint32_t count;
+    jio_string_segment elements[CHUNKED_LEAF_CAPACITY];
+};
+
+typedef struct chunked_inner_T chunked_inner;
+struct chunked_inner_T
+{
+    uint32_t count;                                 //  Total number of elements in the subtree
+    uint32_t child_count;                           //  Number of children
+    uint32_t counts[CHUNKED_INNER_CAPACITY];        //  Number of elements in each child's subtree
+    void* children[CHUNKED_INNER_CAPACITY];         //  Children, which are leaves if height of the node is 1
+};
+
+struct jio_csv_chunked_column_T
+{
+    jio_string_segment header;      //  Optional header
+    uint32_t height;                //  Height of the tree (0 means root is a leaf)
+    void* root;                     //  Root node of the tree
+    //  Nodes are allocated before an insertion begins, so that it can not fail after the tree was modified
+    chunked_leaf* spare_leaf;       //  Leaf to use when a leaf is split
+    chunked_inner* spare_inners;    //  Inner nodes to use when an inner node is split, linked through children[0]
+    uint32_t spare_inner_count;     //  Number of spare inner nodes
+};
+
+static inline uint32_t node_count(const void* node, uint32_t height)
+{
+    return height ? ((const chunked_inner*)node)->count : ((const chunked_leaf*)node)->count;
+}
+
+static void node_destroy(const jio_context* ctx, void* node, uint32_t height)
+{
+    if (height)
+    {
+        chunked_inner* const inner = node;
+        for (uint32_t i = 0; i < inner->child_count; ++i)
+        {
+            node_destroy(ctx, inner->children[i], height - 1);
+        }
+    }
+    jio_free(ctx, node);
+}
+
+//  Destroys all nodes of the subtree, except the given leaf
+static void node_destroy_except(const jio_context* ctx, void* node, uint32_t height, const chunked_leaf* keep)
+{
+    if (height)
+    {
+        chunked_inner* const inner = node;
+        for (uint32_t i = 0; i < inner->child_count; ++i)
+        {
+            node_destroy_except(ctx, inner->children[i], height - 1, keep);
+        }
+    }
+    if (node != keep)
+    {
+        jio_free(ctx, node);
+    }
+}
+
+//  Finds the leaf which holds the element at index, along with the position of the element within it
+static const chunked_leaf* find_leaf(const jio_csv_chunked_column* column, uint32_t index, uint32_t* p_pos)
+{
+    const void* node = column->root;
+    for (uint32_t h = column->height; h; --h)
+    {
+        const chunked_inner* const inner = node;
+        uint32_t i = 0;
+        while (index >= inner->counts[i])
+        {
+            index -= inner->counts[i];
+            i += 1;
+        }
+        node = inner->children[i];
+    }
+    *p_pos = index;
+    return node;
+}
+
+static jio_result reserve_nodes(const jio_context* ctx, jio_csv_chunked_column* column)
+{
+    if (!column->spare_leaf)
+    {
+        column->spare_leaf = jio_alloc(ctx, sizeof(*column->spare_leaf));
+        if (!column->spare_leaf)
+        {
+            JIO_ERROR(ctx, "Could not allocate memory for chunked column block");
+            return JIO_RESULT_BAD_ALLOC;
+        }
+    }
+    //  Each level of the tree may be split, along with the root
+    while (column->spare_inner_count < column->height + 1)
+    {
+        chunked_inner* const inner = jio_alloc(ctx, sizeof(*inner));
+        if (!inner)
+        {
+            JIO_ERROR(ctx, "Could not allocate memory for chunked column node");
+            return JIO_RESULT_BAD_ALLOC;
+        }
+        inner->children[0] = column->spare_inners;
+        column->spare_inners = inner;
+        column->spare_inner_count += 1;
+    }
+    return JIO_RESULT_SUCCESS;
+}
+
+static chunked_leaf* take_leaf(jio_csv_chunked_column* column)
+{
+    chunked_leaf* const leaf = column->spare_leaf;
+    assert(leaf);
+    column->spare_leaf = NULL;
+    return leaf;
+}
+
+static chunked_inner* take_inner(jio_csv_chunked_column* column)
+{
+    chunked_inner* const inner = column->spare_inners;
+    assert(inner);
+    column->spare_inners = inner->children[0];
+    column->spare_inner_count -= 1;
+    return inner;
+}
+
+//  Inserts the element at position in the subtree. If the node had to be split, the new right sibling is returned
+//  through p_split, otherwise it is set to NULL. Splitting at the end puts the element in the new node on its own, so
+//  that appending leaves all nodes full.
+static void node_insert(
+        jio_csv_chunked_column* column, void* node, uint32_t height, uint32_t pos, const jio_string_segment* element,
+        void** p_split)
+{
+    *p_split = NULL;
+    if (!height)
+    {
+        chunked_leaf* const leaf = node;
+        if (leaf->count < CHUNKED_LEAF_CAPACITY)
+        {
+            memmove(leaf->elements + pos + 1, leaf->elements + pos, sizeof(*leaf->elements) * (leaf->count - pos));
+            leaf->elements[pos] = *element;
+            leaf->count += 1;
+            return;
+        }
+        chunked_leaf* const new_leaf = take_leaf(column);
+        if (pos == CHUNKED_LEAF_CAPACITY)
+        {
+            new_leaf->count = 1;
+            new_leaf->elements[0] = *element;
+        }
+        else
+        {
+            const uint32_t half = CHUNKED_LEAF_CAPACITY / 2;
+            memcpy(new_leaf->elements, leaf->elements + half, sizeof(*leaf->elements) * (CHUNKED_LEAF_CAPACITY - half));
+            new_leaf->count = CHUNKED_LEAF_CAPACITY - half;
+            leaf->count = half;
+            chunked_leaf* const target = pos <= half ? leaf : new_leaf;
+            const uint32_t target_pos = pos <= half ? pos : pos - half;
+            memmove(target->elements + target_pos + 1, target->elements + target_pos, sizeof(*target->elements) * (target->count - target_pos));
+            target->elements[target_pos] = *element;
+            target->count += 1;
+        }
+        *p_split = new_leaf;
+        return;
+    }
+
+    chunked_inner* const inner = node;
+    //  When position is at the boundary of two children, element goes at the end of the first one
+    uint32_t i = 0;
+    while (i + 1 < inner->child_count && pos > inner->counts[i])
+    {
+        pos -= inner->counts[i];
+        i += 1;
+    }
+    void* child_split;
+    node_insert(column, inner->children[i], height - 1, pos, element, &child_split);
+    inner->count += 1;
+    if (!child_split)
+    {
+        inner->counts[i] += 1;
+        return;
+    }
+    inner->counts[i] = node_count(inner->children[i], height - 1);
+    const uint32_t split_count = node_count(child_split, height - 1);
+
+    //  Insert the new child after the one which was split
+    chunked_inner* target = inner;
+    uint32_t target_pos = i + 1;
+    if (inner->child_count == CHUNKED_INNER_CAPACITY)
+    {
+        chunked_inner* const new_inner = take_inner(column);
+        new_inner->count = 0;
+        if (target_pos == CHUNKED_INNER_CAPACITY)
+        {
+            new_inner->child_count = 0;
+            target = new_inner;
+            target_pos = 0;
+        }
+        else
+        {
+            const uint32_t half = CHUNKED_INNER_CAPACITY / 2;
+            new_inner->child_count = CHUNKED_INNER_CAPACITY - half;
+            memcpy(new_inner->children, inner->children + half, sizeof(*inner->children) * new_inner->child_count);
+            memcpy(new_inner->counts, inner->counts + half, sizeof(*inner->counts) * new_inner->child_count);
+            inner->child_count = half;
+            for (uint32_t j = 0; j < new_inner->child_count; ++j)
+            {
+                new_inner->count += new_inner->counts[j];
+            }
+            inner->count -= new_inner->count;
+            if (target_pos > half)
+            {
+                target = new_inner;
+                target_pos -= half;
+            }
+        }
+        *p_split = new_inner;
+    }
+    memmove(target->children + target_pos + 1, target->children + target_pos, sizeof(*target->children) * (target->child_count - target_pos));
+    memmove(target->counts + target_pos + 1, target->counts + target_pos, sizeof(*target->counts) * (target->child_count - target_pos));
+    target->children[target_pos] = child_split;
+    target->counts[target_pos] = split_count;
+    target->child_count += 1;
+    if (target != inner)
+    {
+        //  Split element count was already counted in the parent, so move it over
+        inner->count -= split_count;
+        target->count += split_count;
+    }
+}
+
+//  Merges the child at index i + 1 into the child at index i if both fit into one node
+static void inner_try_merge(const jio_context* ctx, chunked_inner* inner, uint32_t height, uint32_t i)
+{
+    void* const left = inner->children[i];
+    void* const right = inner->children[i + 1];
+    if (height == 1)
+    {
+        chunked_leaf* const l = left, * const r = right;
+        if (l->count + r->count > CHUNKED_LEAF_CAPACITY)
+        {
+            return;
+        }
+        memcpy(l->elements + l->count, r->elements, sizeof(*r->elements) * r->count);
+        l->count += r->count;
+    }
+    else
+    {
+        chunked_inner* const l = left, * const r = right;
+        if (l->child_count + r->child_count > CHUNKED_INNER_CAPACITY)
+        {
+            return;
+        }
+        memcpy(l->children + l->child_count, r->children, sizeof(*r->children) * r->child_count);
+        memcpy(l->counts + l->child_count, r->counts, sizeof(*r->counts) * r->child_count);
+        l->child_count += r->child_count;
+        l->count += r->count;
+    }
+    jio_free(ctx, right);
+    inner->counts[i] += inner->counts[i + 1];
+    memmove(inner->children + i + 1, inner->children + i + 2, sizeof(*inner->children) * (inner->child_count - i - 2));
+    memmove(inner->counts + i + 1, inner->counts + i + 2, sizeof(*inner->counts) * (inner->child_count - i - 2));
+    inner->child_count -= 1;
+}
+
+//  Removes elements on the interval [begin, begin + count) from the subtree. Children which become empty are removed and
+//  neighbouring children which fit into a single node are merged.
+static void node_remove(const jio_context* ctx, void* node, uint32_t height, uint32_t begin, uint32_t count)
+{
+    if (!height)
+    {
+        chunked_leaf* const leaf = node;
+        memmove(leaf->elements + begin, leaf->elements + begin + count, sizeof(*leaf->elements) * (leaf->count - begin - count));
+        leaf->count -= count;
+        return;
+    }
+
+    chunked_inner* const inner = node;
+    inner->count -= count;
+    uint32_t offset = 0;
+    uint32_t first = UINT32_MAX, last = 0;
+    for (uint32_t i = 0; i < inner->child_count && count; ++i)
+    {
+        const uint32_t child_count = inner->counts[i];
+        if (begin < offset + child_count)
+        {
+            const uint32_t local_begin = begin - offset;
+            const uint32_t local_count = child_count - local_begin < count ? child_count - local_begin : count;
+            node_remove(ctx, inner->children[i], height - 1, local_begin, local_count);
+            inner->counts[i] -= local_count;
+            begin += local_count;
+            count -= local_count;
+            if (first == UINT32_MAX)
+            {
+                first = i;
+            }
+            last = i;
+        }
+        offset += child_count;
+    }
+    if (first == UINT32_MAX)
+    {
+        return;
+    }
+
+    //  Remove children which became empty
+    uint32_t j = first;
+    for (uint32_t i = first; i < inner->child_count; ++i)
+    {
+        if (i <= last && inner->counts[i] == 0)
+        {
+            node_destroy(ctx, inner->children[i], height - 1);
+            continue;
+        }
+        inner->children[j] = inner->children[i];
+        inner->counts[j] = inner->counts[i];
+        j += 1;
+    }
+    inner->child_count = j;
+
+    //  Merge the children around where elements were removed, if they fit together
+    const uint32_t merge_begin = first ? first - 1 : 0;
+    for (uint32_t i = merge_begin; i + 1 < inner->child_count && i <= first + 1;)
+    {
+        const uint32_t before = inner->child_count;
+        inner_try_merge(ctx, inner, height, i);
+        if (before == inner->child_count)
+        {
+            i += 1;
+        }
+    }
+}
+
+static jio_result chunked_column_insert_one(
+        const jio_context* ctx, jio_csv_chunked_column* column, uint32_t position, const jio_string_segment* element)
+{
+    const jio_result res = reserve_nodes(ctx, column);
+    if (res != JIO_RESULT_SUCCESS)
+    {
+        return res;
+    }
+    void* split;
+    node_insert(column, column->root, column->height, position, element, &split);
+    if (!split)
+    {
+        return JIO_RESULT_SUCCESS;
+    }
+    //  Root was split, so tree grows in height
+    chunked_inner* const new_root = take_inner(column);
+    new_root->child_count = 2;
+    new_root->children[0] = column->root;
+    new_root->children[1] = split;
+    new_root->counts[0] = node_count(column->root, column->height);
+    new_root->counts[1] = node_count(split, column->height);
+    new_root->count = new_root->counts[0] + new_root->counts[1];
+    column->root = new_root;
+    column->height += 1;
+    return JIO_RESULT_SUCCESS;
+}
+
+//  Appends as many elements as fit into the last leaf, giving the number which were appended. This takes a single descent
+//  of the tree for the whole block, instead of one for each element.
+static uint32_t chunked_column_fill_last(jio_csv_chunked_column* column, uint32_t count, const jio_string_segment* elements)
+{
+    void* node = column->root;
+    for (uint32_t h = column->height; h; --h)
+    {
+        const chunked_inner* const inner = node;
+        node = inner->children[inner->child_count - 1];
+    }
+    chunked_leaf* const leaf = node;
+    const uint32_t n = CHUNKED_LEAF_CAPACITY - leaf->count < count ? CHUNKED_LEAF_CAPACITY - leaf->count : count;
+    memcpy(leaf->elements + leaf->count, elements, sizeof(*elements) * n);
+    leaf->count += n;
+    node = column->root;
+    for (uint32_t h = column->height; h; --h)
+    {
+        chunked_inner* const inner = node;
+        inner->count += n;
+        inner->counts[inner->child_count - 1] += n;
+        node = inner->children[inner->child_count - 1];
+    }
+    return n;
+}
+
+//  Lowers the tree while its root has only one child
+static void chunked_column_shrink(const jio_context* ctx, jio_csv_chunked_column* column)
+{
+    while (column->height)
+    {
+        chunked_inner* const root = column->root;
+        if (root->child_count > 1)
+        {
+            break;
+        }
+        column->root = root->children[0];
+        column->height -= 1;
+        jio_free(ctx, root);
+    }
+}
+
+//  Removes elements which were inserted before an insertion failed, which gives back the elements the column had. Nodes
+//  are only freed, so this can not fail.
+static void chunked_column_rollback(
+        const jio_context* ctx, jio_csv_chunked_column* column, uint32_t position, uint32_t inserted, uint32_t total)
+{
+    if (!inserted)
+    {
+        return;
+    }
+    if (total)
+    {
+        node_remove(ctx, column->root, column->height, position, inserted);
+        chunked_column_shrink(ctx, column);
+        return;
+    }
+    //  Removing everything from the tree would leave no nodes, so its first leaf is kept as the root
+    void* node = column->root;
+    for (uint32_t h = column->height; h; --h)
+    {
+        node = ((chunked_inner*)node)->children[0];
+    }
+    chunked_leaf* const leaf = node;
+    node_destroy_except(ctx, column->root, column->height, leaf);
+    leaf->count = 0;
+    column->root = leaf;
+    column->height = 0;
+}
+
+jio_result jio_csv_chunked_column_create(
+        const jio_context* ctx, const jio_csv_column* src, jio_csv_chunked_column** pp_column)
+{
+    jio_csv_chunked_column* const column = jio_alloc(ctx, sizeof(*column));
+    chunked_leaf* const root = jio_alloc(ctx, sizeof(*root));
+    if (!column || !root)
+    {
+        jio_free(ctx, column);
+        jio_free(ctx, root);
+        JIO_ERROR(ctx, "Could not allocate memory for chunked column");
+        return JIO_RESULT_BAD_ALLOC;
+    }
+    root->count = 0;
+    column->root = root;
+    column->height = 0;
+    column->spare_leaf = NULL;
+    column->spare_inners = NULL;
+    column->spare_inner_count = 0;
+    column->header = src ? src->header : (jio_string_segment){.begin = NULL, .len = 0};
+    if (src)
+    {
+        const jio_result res = jio_csv_chunked_column_insert(ctx, column, UINT32_MAX, src->count, src->elements);
+        if (res != JIO_RESULT_SUCCESS)
+        {
+            jio_csv_chunked_column_destroy(ctx, column);
+            return res;
+        }
+    }
+    *pp_column = column;
+    return JIO_RESULT_SUCCESS;
+}
+
+void jio_csv_chunked_column_destroy(const jio_context* ctx, jio_csv_chunked_column* column)
+{
+    node_destroy(ctx, column->root, column->height);
+    jio_free(ctx, column->spare_leaf);
+    while (column->spare_inners)
+    {
+        chunked_inner* const inner = column->spare_inners;
+        column->spare_inners = inner->children[0];
+        jio_free(ctx, inner);
+    }
+    jio_free(ctx, column);
+}
+
+uint32_t jio_csv_chunked_column_count(const jio_csv_chunked_column* column)
+{
+    return node_count(column->root, column->height);
+}
+
+jio_string_segment jio_csv_chunked_column_header(const jio_csv_chunked_column* column)
+{
+    return column->header;
+}
+
+jio_result jio_csv_chunked_column_get(const jio_csv_chunked_column* column, uint32_t index, jio_string_segment* p_element)
+{
+    if (index >= jio_csv_chunked_column_count(column))
+    {
+        return JIO_RESULT_BAD_INDEX;
+    }
+    uint32_t pos;
+    const chunked_leaf* const leaf = find_leaf(column, index, &pos);
+    *p_element = leaf->elements[pos];
+    return JIO_RESULT_SUCCESS;
+}
+
+jio_result jio_csv_chunked_column_set(jio_csv_chunked_column* column, uint32_t index, jio_string_segment element)
+{
+    if (index >= jio_csv_chunked_column_count(column))
+    {
+        return JIO_RESULT_BAD_INDEX;
+    }
+    uint32_t pos;
+    chunked_leaf* const leaf = (chunked_leaf*)find_leaf(column, index, &pos);
+    leaf->elements[pos] = element;
+    return JIO_RESULT_SUCCESS;
+}
+
+jio_result jio_csv_chunked_column_block(
+        const jio_csv_chunked_column* column, uint32_t index, const jio_string_segment** p_elements, uint32_t* p_count)
+{
+    if (index >= jio_csv_chunked_column_count(column))
+    {
+        return JIO_RESULT_BAD_INDEX;
+    }
+    uint32_t pos;
+    const chunked_leaf* const leaf = find_leaf(column, index, &pos);
+    *p_elements = leaf->elements + pos;
+    *p_count = leaf->count - pos;
+    return JIO_RESULT_SUCCESS;
+}
+
+jio_result jio_csv_chunked_column_copy(
+        const jio_csv_chunked_column* column, uint32_t begin, uint32_t count, jio_string_segment* out)
+{
+    const uint32_t total = jio_csv_chunked_column_count(column);
+    if (begin > total || count > total - begin)
+    {
+        return JIO_RESULT_BAD_INDEX;
+    }
+    while (count)
+    {
+        const jio_string_segment* elements;
+        uint32_t n;
+        (void)jio_csv_chunked_column_block(column, begin, &elements, &n);
+        if (n > count)
+        {
+            n = count;
+        }
+        memcpy(out, elements, sizeof(*out) * n);
+        out += n;
+        begin += n;
+        count -= n;
+    }
+    return JIO_RESULT_SUCCESS;
+}
+
+jio_result jio_csv_chunked_column_insert(
+        const jio_context* ctx, jio_csv_chunked_column* column, uint32_t position, uint32_t count,
+        const jio_string_segment* elements)
+{
+    const uint32_t total = jio_csv_chunked_column_count(column);
+    if (position == UINT32_MAX)
+    {
+        position = total;
+    }
+    if (position > total)
+    {
+        JIO_ERROR(ctx, "Elements were to be inserted at position %"PRIu32", but chunked column has only %"PRIu32" elements", position, total);
+        return JIO_RESULT_BAD_INDEX;
+    }
+    if (count > UINT32_MAX - total)
+    {
+        JIO_ERROR(ctx, "Chunked column can not have more than %"PRIu32" elements", UINT32_MAX);
+        return JIO_RESULT_BAD_INDEX;
+    }
+    //  When appending, the last leaf is filled directly and only the element which does not fit goes through the tree
+    uint32_t inserted = 0;
+    while (inserted < count)
+    {
+        if (position == total)
+        {
+            inserted += chunked_column_fill_last(column, count - inserted, elements + inserted);
+            if (inserted == count)
+            {
+                break;
+            }
+        }
+        const jio_result res = chunked_column_insert_one(ctx, column, position + inserted, elements + inserted);
+        if (res != JIO_RESULT_SUCCESS)
+        {
+            chunked_column_rollback(ctx, column, position, inserted, total);
+            return res;
+        }
+        inserted += 1;
+    }
+    return JIO_RESULT_SUCCESS;
+}
+
+jio_result jio_csv_chunked_column_remove(
+        const jio_context* ctx, jio_csv_chunked_column* column, uint32_t position, uint32_t count)
+{
+    const uint32_t total = jio_csv_chunked_column_count(column);
+    if (position > total || count > total - position)
+    {
+        JIO_ERROR(ctx, "Range of elements to remove is [%"PRIu32", %"PRIu64"), but chunked column only has %"PRIu32" elements", position, (uint64_t)position + count, total);
+        return JIO_RESULT_BAD_INDEX;
+    }
+    if (!count)
+    {
+        return JIO_RESULT_SUCCESS;
+    }
+    if (count == total && column->height)
+    {
+        //  Everything is removed, so the tree is replaced with an empty leaf
+        const jio_result res = reserve_nodes(ctx, column);
+        if (res != JIO_RESULT_SUCCESS)
+        {
+            return res;
+        }
+        node_destroy(ctx, column->root, column->height);
+        chunked_leaf* const leaf = take_leaf(column);
+        leaf->count = 0;
+        column->root = leaf;
+        column->height = 0;
+        return JIO_RESULT_SUCCESS;
+    }
+    node_remove(ctx, column->root, column->height, position, count);
+    chunked_column_shrink(ctx, column);
+    return JIO_RESULT_SUCCESS;
+}
+
+jio_result jio_csv_chunked_column_to_column(
+        const jio_context* ctx, const jio_csv_chunked_column* column, jio_csv_column* p_out)
+{
+    const uint32_t count = jio_csv_chunked_column_count(column);
+    jio_string_segment* const elements = jio_alloc(ctx, sizeof(*elements) * (count ? count : 1));
+    if (!elements)
+    {
+        JIO_ERROR(ctx, "Could not allocate memory for column elements");
+        return JIO_RESULT_BAD_ALLOC;
+    }
+    (void)jio_csv_chunked_column_copy(column, 0, count, elements);
+    p_out->header = column->header;
+    p_out->count = count;
+    p_out->capacity = count ? count : 1;
+    p_out->elements = elements;
+    return JIO_RESULT_SUCCESS;
+}
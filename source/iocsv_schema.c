@@ -0,0 +1,32 @@
+//
+// Created by jan on 19.10.2026.
+//
+
+#include <inttypes.h>
+#include <stdio.h>
+#include "../include/jio/iocsv_schema.h"
+#include "internal.h"
+
+void jio_csv_schema_report_error(
+        const jio_context* ctx, const jio_memory_file* mem_file, const char* function, jio_result res, uint32_t row,
+        const char* column, size_t offset)
+{
+    const char* const name = jio_memory_file_get_info(mem_file).full_name;
+    char what[32] = "headers";
+    if (row)
+    {
+        (void)snprintf(what, sizeof(what), "row %"PRIu32, row);
+    }
+    if (res == JIO_RESULT_BAD_ALLOC)
+    {
+        JIO_ERROR_FN(ctx, "Row %"PRIu32" of CSV file \"%s\" (byte %zu) does not fit into the array of rows", function, row, name, offset);
+    }
+    else if (column)
+    {
+        JIO_ERROR_FN(ctx, "Failed parsing %s of CSV file \"%s\" at column \"%s\" (byte %zu), reason: %s", function, what, name, column, offset, jio_result_to_str(res));
+    }
+    else
+    {
+        JIO_ERROR_FN(ctx, "Failed parsing %s of CSV file \"%s\" after its last column (byte %zu), reason: %s", function, what, name, offset, jio_result_to_str(res));
+    }
+}
@@ -0,0 +1,308 @@
+//
+// Created by jan on 19.10.2026.
+//
+
+#include <float.h>
+#include <inttypes.h>
+#include <locale.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "../include/jio/iocsv.h"
+#include "internal.h"
+
+//  Size of the buffer used when none is specified
+#define CSV_WRITER_DEFAULT_BUFFER_SIZE (64 << 10)
+
+struct jio_csv_writer_T
+{
+    const jio_context* ctx;
+    bool (* sink)(void* param, const char* data, size_t size);
+    void* param;
+    FILE* file;                             //  File which the writer writes to (NULL if it uses a sink)
+    char* separator;                        //  Copy of the separator
+    size_t sep_len;                         //  Length of the separator
+    bool row_started;                       //  Was any entry written to the current row
+    size_t used;                            //  Number of bytes in the buffer
+    size_t capacity;                        //  Size of the buffer
+    char* buffer;
+};
+
+static bool csv_writer_file_sink(void* param, const char* data, size_t size)
+{
+    return fwrite(data, 1, size, param) == size;
+}
+
+jio_result jio_csv_writer_flush(jio_csv_writer* writer)
+{
+    if (!writer->used)
+    {
+        return JIO_RESULT_SUCCESS;
+    }
+    if (!writer->sink(writer->param, writer->buffer, writer->used))
+    {
+        JIO_ERROR(writer->ctx, "Csv writer could not write %zu bytes to its sink", writer->used);
+        return JIO_RESULT_BAD_ACCESS;
+    }
+    writer->used = 0;
+    return JIO_RESULT_SUCCESS;
+}
+
+static jio_result csv_writer_put(jio_csv_writer* writer, const char* data, size_t size)
+{
+    if (writer->capacity - writer->used < size)
+    {
+        const jio_result res = jio_csv_writer_flush(writer);
+        if (res != JIO_RESULT_SUCCESS)
+        {
+            return res;
+        }
+        //  Data which would not fit into the buffer anyway is given to the sink directly
+        if (size >= writer->capacity)
+        {
+            if (!writer->sink(writer->param, data, size))
+            {
+                JIO_ERROR(writer->ctx, "Csv writer could not write %zu bytes to its sink", size);
+                return JIO_RESULT_BAD_ACCESS;
+            }
+            return JIO_RESULT_SUCCESS;
+        }
+    }
+    memcpy(writer->buffer + writer->used, data, size);
+    writer->used += size;
+    return JIO_RESULT_SUCCESS;
+}
+
+//  Writes the separator if the entry is not the first in the row
+static inline jio_result csv_writer_begin_entry(jio_csv_writer* writer)
+{
+    if (!writer->row_started)
+    {
+        writer->row_started = true;
+        return JIO_RESULT_SUCCESS;
+    }
+    return csv_writer_put(writer, writer->separator, writer->sep_len);
+}
+
+static jio_result csv_writer_create(
+        const jio_context* ctx, const char* separator, size_t buffer_size, jio_csv_writer** pp_writer)
+{
+    if (!buffer_size)
+    {
+        buffer_size = CSV_WRITER_DEFAULT_BUFFER_SIZE;
+    }
+    const size_t sep_len = strlen(separator);
+    if (!sep_len)
+    {
+        JIO_ERROR(ctx, "Csv writer needs a separator which is not empty");
+        return JIO_RESULT_BAD_VALUE;
+    }
+    jio_csv_writer* const writer = jio_alloc(ctx, sizeof(*writer));
+    char* const memory = jio_alloc(ctx, buffer_size + sep_len + 1);
+    if (!writer || !memory)
+    {
+        jio_free(ctx, writer);
+        jio_free(ctx, memory);
+        JIO_ERROR(ctx, "Could not allocate memory for csv writer");
+        return JIO_RESULT_BAD_ALLOC;
+    }
+    memset(writer, 0, sizeof(*writer));
+    writer->ctx = ctx;
+    writer->buffer = memory;
+    writer->capacity = buffer_size;
+    writer->separator = memory + buffer_size;
+    memcpy(writer->separator, separator, sep_len + 1);
+    writer->sep_len = sep_len;
+    *pp_writer = writer;
+    return JIO_RESULT_SUCCESS;
+}
+
+jio_result jio_csv_writer_create(
+        const jio_context* ctx, const char* separator, size_t buffer_size,
+        bool (* sink)(void* param, const char* data, size_t size), void* param, jio_csv_writer** pp_writer)
+{
+    jio_csv_writer* writer;
+    const jio_result res = csv_writer_create(ctx, separator, buffer_size, &writer);
+    if (res != JIO_RESULT_SUCCESS)
+    {
+        return res;
+    }
+    writer->sink = sink;
+    writer->param = param;
+    *pp_writer = writer;
+    return JIO_RESULT_SUCCESS;
+}
+
+jio_result jio_csv_writer_create_file(
+        const jio_context* ctx, const char* filename, const char* separator, size_t buffer_size,
+        jio_csv_writer** pp_writer)
+{
+    FILE* const file = fopen(filename, "wb");
+    if (!file)
+    {
+        JIO_ERROR(ctx, "Could not open file \"%s\" for writing", filename);
+        return JIO_RESULT_BAD_PATH;
+    }
+    //  Output is already buffered by the writer
+    setvbuf(file, NULL, _IONBF, 0);
+    jio_csv_writer* writer;
+    const jio_result res = csv_writer_create(ctx, separator, buffer_size, &writer);
+    if (res != JIO_RESULT_SUCCESS)
+    {
+        fclose(file);
+        return res;
+    }
+    writer->sink = csv_writer_file_sink;
+    writer->param = file;
+    writer->file = file;
+    *pp_writer = writer;
+    return JIO_RESULT_SUCCESS;
+}
+
+jio_result jio_csv_writer_destroy(jio_csv_writer* writer)
+{
+    const jio_context* const ctx = writer->ctx;
+    jio_result res = jio_csv_writer_flush(writer);
+    if (writer->file && fclose(writer->file) != 0 && res == JIO_RESULT_SUCCESS)
+    {
+        JIO_ERROR(ctx, "Could not close the file of csv writer");
+        res = JIO_RESULT_BAD_ACCESS;
+    }
+    jio_free(ctx, writer->buffer);
+    jio_free(ctx, writer);
+    return res;
+}
+
+//  Writes digits of the integer from the back, ending at end, and gives where they begin
+static char* csv_writer_format_integer(char* end, uint64_t magnitude, bool negative)
+{
+    char* pos = end;
+    do
+    {
+        *--pos = (char)('0' + magnitude % 10);
+        magnitude /= 10;
+    } while (magnitude);
+    if (negative)
+    {
+        *--pos = '-';
+    }
+    return pos;
+}
+
+jio_result jio_csv_writer_write_i64(jio_csv_writer* writer, int64_t value)
+{
+    jio_result res = csv_writer_begin_entry(writer);
+    if (res != JIO_RESULT_SUCCESS)
+    {
+        return res;
+    }
+    char digits[24];
+    const uint64_t magnitude = value < 0 ? (uint64_t)0 - (uint64_t)value : (uint64_t)value;
+    const char* const pos = csv_writer_format_integer(digits + sizeof(digits), magnitude, value < 0);
+    return csv_writer_put(writer, pos, digits + sizeof(digits) - pos);
+}
+
+jio_result jio_csv_writer_write_f64(jio_csv_writer* writer, double value)
+{
+    jio_result res = csv_writer_begin_entry(writer);
+    if (res != JIO_RESULT_SUCCESS)
+    {
+        return res;
+    }
+    //  Values which are not finite are written the same way on every platform
+    if (value != value)
+    {
+        return csv_writer_put(writer, "nan", 3);
+    }
+    const double magnitude = value < 0 ? -value : value;
+    if (magnitude > DBL_MAX)
+    {
+        return value < 0 ? csv_writer_put(writer, "-inf", 4) : csv_writer_put(writer, "inf", 3);
+    }
+    //  Integers below 1e15 are written as integers by "%.15g" as well, so they can skip printf. Negative zero still needs
+    //  its sign, so it is not one of them.
+    char buffer[32];
+    if (magnitude < 1e15 && magnitude == (double)(uint64_t)magnitude && (value != 0 || 1 / value > 0))
+    {
+        const char* const pos = csv_writer_format_integer(buffer + sizeof(buffer), (uint64_t)magnitude, value < 0);
+        return csv_writer_put(writer, pos, buffer + sizeof(buffer) - pos);
+    }
+
+    //  Any decimal with at most 15 significant digits is parsed back to a different normal double, so if printing a
+    //  normal value with 15 digits gives the same value, no shorter text does. Otherwise 16 or 17 digits are needed.
+    //  Subnormal values have less precision, so their shortest text may have fewer digits, which are searched for.
+    int len = 0;
+    for (int precision = magnitude < DBL_MIN ? 1 : 15; precision <= 17; ++precision)
+    {
+        len = snprintf(buffer, sizeof(buffer), "%.*g", precision, value);
+        if (strtod(buffer, NULL) == value)
+        {
+            break;
+        }
+    }
+    //  Both printf and strtod use the decimal point of the current locale, but csv output always uses '.'
+    const char* const decimal_point = localeconv()->decimal_point;
+    if (decimal_point[0] != '.' || decimal_point[1] != 0)
+    {
+        const size_t point_len = strlen(decimal_point);
+        char* const point = point_len ? strstr(buffer, decimal_point) : NULL;
+        if (point)
+        {
+            *point = '.';
+            memmove(point + 1, point + point_len, buffer + len - (point + point_len) + 1);
+            len -= (int)(point_len - 1);
+        }
+    }
+    return csv_writer_put(writer, buffer, (size_t)len);
+}
+
+jio_result jio_csv_writer_write_str(jio_csv_writer* writer, jio_string_segment value)
+{
+    jio_result res = csv_writer_begin_entry(writer);
+    if (res != JIO_RESULT_SUCCESS)
+    {
+        return res;
+    }
+    //  Only entries which contain the separator, quotes, or new lines are quoted
+    bool needs_quotes = false;
+    for (size_t i = 0; i < value.len && !needs_quotes; ++i)
+    {
+        const char c = value.begin[i];
+        needs_quotes = c == '"' || c == '\n' || c == '\r'
+                || (c == *writer->separator && value.len - i >= writer->sep_len && memcmp(value.begin + i, writer->separator, writer->sep_len) == 0);
+    }
+    if (!needs_quotes)
+    {
+        return csv_writer_put(writer, value.begin, value.len);
+    }
+
+    //  Quotes inside are escaped by doubling them
+    if ((res = csv_writer_put(writer, "\"", 1)))
+    {
+        return res;
+    }
+    size_t begin = 0;
+    for (size_t i = 0; i < value.len; ++i)
+    {
+        if (value.begin[i] != '"')
+        {
+            continue;
+        }
+        if ((res = csv_writer_put(writer, value.begin + begin, i + 1 - begin)))
+        {
+            return res;
+        }
+        begin = i;
+    }
+    if ((res = csv_writer_put(writer, value.begin + begin, value.len - begin)))
+    {
+        return res;
+    }
+    return csv_writer_put(writer, "\"", 1);
+}
+
+jio_result jio_csv_writer_end_row(jio_csv_writer* writer)
+{
+    writer->row_started = false;
+    return csv_writer_put(writer, "\n", 1);
+}
@@ -0,0 +1,229 @@
+//
+// Created by jan on 19.10.2026.
+//
+#include "../../../include/jio/iocsv.h"
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include "../test_common.h"
+
+#define ROW_COUNT 70000
+#define REGION_COUNT 50
+
+typedef struct expected_group_T expected_group;
+struct expected_group_T
+{
+    uint32_t row_count;
+    uint32_t count;
+    double sum;
+    double* numbers;
+    jio_string_segment* elements;
+};
+
+static int compare_numbers(const void* a, const void* b)
+{
+    const double x = *(const double*)a;
+    const double y = *(const double*)b;
+    return (x > y) - (x < y);
+}
+
+static int compare_segments(const void* a, const void* b)
+{
+    const jio_string_segment* const x = a;
+    const jio_string_segment* const y = b;
+    const int c = memcmp(x->begin, y->begin, x->len < y->len ? x->len : y->len);
+    return c ? c : (x->len > y->len) - (x->len < y->len);
+}
+
+static bool close_to(double a, double b)
+{
+    const double d = a - b;
+    const double scale = b < 0 ? -b : b;
+    return (d < 0 ? -d : d) <= 1e-9 * scale + 1e-9;
+}
+
+static void check_group(const jio_csv_aggregate_group* group, expected_group* expected, const jio_csv_aggregate_info* info)
+{
+    ASSERT(group->row_count == expected->row_count);
+    ASSERT(group->count == expected->count);
+    ASSERT(close_to(group->sum, expected->sum));
+    qsort(expected->numbers, expected->count, sizeof(*expected->numbers), compare_numbers);
+    if (expected->count)
+    {
+        ASSERT(group->min == expected->numbers[0]);
+        ASSERT(group->max == expected->numbers[expected->count - 1]);
+        ASSERT(close_to(group->mean, expected->sum / expected->count));
+    }
+    for (uint32_t i = 0; i < info->percentile_count; ++i)
+    {
+        const double position = info->percentiles[i] * (expected->count - 1);
+        const uint32_t low = (uint32_t)position;
+        const uint32_t high = low + 1 < expected->count ? low + 1 : low;
+        ASSERT(close_to(group->percentiles[i], expected->numbers[low] + (expected->numbers[high] - expected->numbers[low]) * (position - low)));
+    }
+    if (info->count_distinct)
+    {
+        qsort(expected->elements, expected->row_count, sizeof(*expected->elements), compare_segments);
+        uint32_t distinct = expected->row_count != 0;
+        for (uint32_t i = 1; i < expected->row_count; ++i)
+        {
+            distinct += compare_segments(expected->elements + i - 1, expected->elements + i) != 0;
+        }
+        ASSERT(group->distinct_count == distinct);
+    }
+}
+
+static void fill_expected(const jio_csv_column* amounts, const jio_csv_column* regions, uint32_t group_count, expected_group* expected, const jio_csv_aggregation* aggregation)
+{
+    for (uint32_t i = 0; i < group_count; ++i)
+    {
+        expected[i].row_count = 0;
+        expected[i].count = 0;
+        expected[i].sum = 0;
+    }
+    for (uint32_t i = 0; i < amounts->count; ++i)
+    {
+        uint32_t g = 0;
+        while (regions && (aggregation->groups[g].key.len != regions->elements[i].len || memcmp(aggregation->groups[g].key.begin, regions->elements[i].begin, regions->elements[i].len) != 0))
+        {
+            g += 1;
+            ASSERT(g < group_count);
+        }
+        expected_group* const e = expected + g;
+        e->elements[e->row_count++] = amounts->elements[i];
+        char buffer[64];
+        ASSERT(amounts->elements[i].len < sizeof(buffer));
+        memcpy(buffer, amounts->elements[i].begin, amounts->elements[i].len);
+        buffer[amounts->elements[i].len] = 0;
+        char* end;
+        const double v = strtod(buffer, &end);
+        if (buffer[0] && *end == 0)
+        {
+            e->numbers[e->count++] = v;
+            e->sum += v;
+        }
+    }
+}
+
+int main()
+{
+    jio_context* ctx;
+    const jio_context_create_info create_info =
+            {
+                    .error_callbacks = NULL,
+                    .allocator_callbacks = NULL,
+                    .stack_allocator_callbacks = NULL,
+                    .thread_count = 4,
+            };
+    jio_result res = jio_context_create(&create_info, &ctx);
+    ASSERT(res == JIO_RESULT_SUCCESS);
+
+    srand(41);
+    FILE* f_out = fopen("csv_test_aggregate.csv", "w");
+    ASSERT(f_out);
+    fprintf(f_out, "region,amount,empty\n");
+    for (unsigned i = 0; i < ROW_COUNT; ++i)
+    {
+        fprintf(f_out, "r%d,", rand() % REGION_COUNT);
+        switch (rand() % 8)
+        {
+        case 0:
+            fprintf(f_out, ",x\n");
+            break;
+        case 1:
+            fprintf(f_out, "n/a,x\n");
+            break;
+        case 2:
+            fprintf(f_out, "%d.%02d,x\n", rand() % 1000 - 500, rand() % 100);
+            break;
+        case 3:
+            fprintf(f_out, "%.6e,x\n", (double)rand() / 3.0);
+            break;
+        default:
+            fprintf(f_out, "%d,x\n", rand() % 2000);
+            break;
+        }
+    }
+    fclose(f_out);
+
+    jio_memory_file* csv_file;
+    res = jio_memory_file_create(ctx, "csv_test_aggregate.csv", &csv_file, 0, 0, 0);
+    ASSERT(res == JIO_RESULT_SUCCESS);
+    jio_csv_data* data;
+    res = jio_parse_csv(ctx, csv_file, ",", false, true, &data);
+    ASSERT(res == JIO_RESULT_SUCCESS);
+    const jio_csv_column* regions, * amounts;
+    ASSERT(jio_csv_get_column(data, 0, &regions) == JIO_RESULT_SUCCESS);
+    ASSERT(jio_csv_get_column(data, 1, &amounts) == JIO_RESULT_SUCCESS);
+
+    expected_group expected[REGION_COUNT];
+    for (uint32_t i = 0; i < REGION_COUNT; ++i)
+    {
+        expected[i].numbers = malloc(sizeof(*expected[i].numbers) * ROW_COUNT);
+        expected[i].elements = malloc(sizeof(*expected[i].elements) * ROW_COUNT);
+        ASSERT(expected[i].numbers && expected[i].elements);
+    }
+
+    const double percentiles[7] = {0, 0.25, 0.5, 1, 0.001, 0.3337, 0.999};
+    const jio_csv_aggregate_info full_info = {.count_distinct = true, .percentile_count = 7, .percentiles = percentiles};
+    const jio_csv_aggregate_info plain_info = {0};
+    jio_csv_aggregation aggregation;
+
+    //  Grouped by region
+    res = jio_csv_aggregate(ctx, data, 1, &full_info, 0, &aggregation);
+    ASSERT(res == JIO_RESULT_SUCCESS);
+    ASSERT(aggregation.group_count == REGION_COUNT);
+    fill_expected(amounts, regions, REGION_COUNT, expected, &aggregation);
+    for (uint32_t i = 0; i < REGION_COUNT; ++i)
+    {
+        check_group(aggregation.groups + i, expected + i, &full_info);
+    }
+    jio_csv_aggregation_release(ctx, &aggregation);
+    res = jio_csv_aggregate(ctx, data, 1, &plain_info, 0, &aggregation);
+    ASSERT(res == JIO_RESULT_SUCCESS);
+    fill_expected(amounts, regions, REGION_COUNT, expected, &aggregation);
+    for (uint32_t i = 0; i < REGION_COUNT; ++i)
+    {
+        check_group(aggregation.groups + i, expected + i, &plain_info);
+        ASSERT(aggregation.groups[i].percentiles == NULL);
+    }
+    jio_csv_aggregation_release(ctx, &aggregation);
+
+    //  All rows in one group
+    res = jio_csv_aggregate(ctx, data, 1, &full_info, UINT32_MAX, &aggregation);
+    ASSERT(res == JIO_RESULT_SUCCESS);
+    ASSERT(aggregation.group_count == 1);
+    fill_expected(amounts, NULL, 1, expected, &aggregation);
+    check_group(aggregation.groups, expected, &full_info);
+    jio_csv_aggregation_release(ctx, &aggregation);
+    res = jio_csv_aggregate(ctx, data, 1, &plain_info, UINT32_MAX, &aggregation);
+    ASSERT(res == JIO_RESULT_SUCCESS);
+    fill_expected(amounts, NULL, 1, expected, &aggregation);
+    check_group(aggregation.groups, expected, &plain_info);
+    jio_csv_aggregation_release(ctx, &aggregation);
+
+    //  Column without numbers
+    res = jio_csv_aggregate(ctx, data, 2, &full_info, UINT32_MAX, &aggregation);
+    ASSERT(res == JIO_RESULT_SUCCESS);
+    ASSERT(aggregation.groups[0].count == 0 && aggregation.groups[0].row_count == ROW_COUNT);
+    ASSERT(aggregation.groups[0].distinct_count == 1 && aggregation.groups[0].sum == 0 && aggregation.groups[0].percentiles[2] == 0);
+    jio_csv_aggregation_release(ctx, &aggregation);
+
+    //  Bad arguments
+    const double bad_percentile = 1.5;
+    const jio_csv_aggregate_info bad_info = {.percentile_count = 1, .percentiles = &bad_percentile};
+    ASSERT(jio_csv_aggregate(ctx, data, 1, &bad_info, 0, &aggregation) == JIO_RESULT_BAD_VALUE);
+    ASSERT(jio_csv_aggregate(ctx, data, 3, &plain_info, 0, &aggregation) == JIO_RESULT_BAD_INDEX);
+    ASSERT(jio_csv_aggregate(ctx, data, 1, &plain_info, 3, &aggregation) == JIO_RESULT_BAD_INDEX);
+
+    for (uint32_t i = 0; i < REGION_COUNT; ++i)
+    {
+        free(expected[i].numbers);
+        free(expected[i].elements);
+    }
+    jio_csv_release(ctx, data);
+    jio_memory_file_destroy(csv_file);
+
+    jio_context_destroy(ctx);
+    return 0;
+}
@@ -0,0 +1,173 @@
+//
+// Created by jan on 19.10.2026.
+//
+#include "../../../include/jio/iocsv.h"
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include "../test_common.h"
+
+static const char* const FILE_NAME = "csv_test_append.csv";
+
+static void append_text(const char* text)
+{
+    FILE* const f_out = fopen(FILE_NAME, "a");
+    ASSERT(f_out);
+    fputs(text, f_out);
+    fclose(f_out);
+}
+
+static bool segment_is(const jio_string_segment* segment, const char* str)
+{
+    return segment->len == strlen(str) && memcmp(segment->begin, str, segment->len) == 0;
+}
+
+//  Checks that every row of the data is "<i>,<i * 3>", and returns the row count
+static uint32_t check_rows(const jio_csv_data* data)
+{
+    uint32_t rows, cols;
+    jio_csv_shape(data, &rows, &cols);
+    ASSERT(cols == 2);
+    const jio_csv_column* ids, * values;
+    ASSERT(jio_csv_get_column(data, 0, &ids) == JIO_RESULT_SUCCESS);
+    ASSERT(jio_csv_get_column(data, 1, &values) == JIO_RESULT_SUCCESS);
+    ASSERT(segment_is(&ids->header, "id") && segment_is(&values->header, "value"));
+    ASSERT(ids->count == rows && values->count == rows);
+    for (uint32_t i = 0; i < rows; ++i)
+    {
+        char buffer[32];
+        sprintf(buffer, "%u", i);
+        ASSERT(segment_is(ids->elements + i, buffer));
+        sprintf(buffer, "%u", i * 3);
+        ASSERT(segment_is(values->elements + i, buffer));
+    }
+    return rows;
+}
+
+int main()
+{
+    jio_context* ctx;
+    const jio_context_create_info create_info =
+            {
+                    .error_callbacks = NULL,
+                    .allocator_callbacks = NULL,
+                    .stack_allocator_callbacks = NULL,
+                    .thread_count = 4,
+            };
+    jio_result res = jio_context_create(&create_info, &ctx);
+    ASSERT(res == JIO_RESULT_SUCCESS);
+
+    //  File does not end with a new line, so the last row is parsed again once it does
+    FILE* f_out = fopen(FILE_NAME, "w");
+    ASSERT(f_out);
+    fprintf(f_out, "id,value\n0,0\n1,3\n2,");
+    fclose(f_out);
+
+    jio_memory_file* csv_file;
+    res = jio_memory_file_create(ctx, FILE_NAME, &csv_file, 0, 0, 0);
+    ASSERT(res == JIO_RESULT_SUCCESS);
+    jio_csv_data* data;
+    res = jio_parse_csv(ctx, csv_file, ",", true, true, &data);
+    ASSERT(res == JIO_RESULT_SUCCESS);
+    uint32_t rows;
+    jio_csv_shape(data, &rows, NULL);
+    ASSERT(rows == 3);
+
+    //  Line is still not complete
+    append_text("6");
+    res = jio_csv_parse_append(ctx, data, csv_file);
+    ASSERT(res == JIO_RESULT_SUCCESS);
+    jio_csv_shape(data, &rows, NULL);
+    ASSERT(rows == 3);
+
+    append_text("\n3,9\n4,1");
+    res = jio_csv_parse_append(ctx, data, csv_file);
+    ASSERT(res == JIO_RESULT_SUCCESS);
+    ASSERT(check_rows(data) == 4);
+    jio_csv_stats stats;
+    ASSERT(jio_csv_column_stats(data, 1, &stats) == JIO_RESULT_SUCCESS);
+    ASSERT(stats.count == 4 && stats.max_length == 1 && stats.total_length == 4);
+
+    //  Nothing new
+    res = jio_csv_parse_append(ctx, data, csv_file);
+    ASSERT(res == JIO_RESULT_SUCCESS);
+    ASSERT(check_rows(data) == 4);
+
+    //  Enough to move the file to a different mapping many times over
+    char buffer[64];
+    uint32_t next = 5;
+    append_text("2\n");
+    for (uint32_t round = 0; round < 20; ++round)
+    {
+        f_out = fopen(FILE_NAME, "a");
+        ASSERT(f_out);
+        for (uint32_t i = 0; i < 2000; ++i, ++next)
+        {
+            fprintf(f_out, "%u,%u\n", next, next * 3);
+        }
+        fclose(f_out);
+        res = jio_csv_parse_append(ctx, data, csv_file);
+        ASSERT(res == JIO_RESULT_SUCCESS);
+        ASSERT(check_rows(data) == next);
+    }
+    ASSERT(jio_csv_column_stats(data, 1, &stats) == JIO_RESULT_SUCCESS);
+    ASSERT(stats.count == next);
+    sprintf(buffer, "%u", (next - 1) * 3);
+    ASSERT(stats.max_length == strlen(buffer));
+
+    //  Bad row leaves the data as it was
+    sprintf(buffer, "%u,%u\n%u\n", next, next * 3, next + 1);
+    append_text(buffer);
+    res = jio_csv_parse_append(ctx, data, csv_file);
+    ASSERT(res == JIO_RESULT_BAD_CSV_FORMAT);
+    ASSERT(check_rows(data) == next);
+
+    jio_csv_release(ctx, data);
+
+    //  Data parsed lazily, with only some columns
+    const uint32_t selected[1] = {1};
+    const jio_csv_parse_info info =
+            {
+                    .separator = ",",
+                    .has_headers = true,
+                    .selected_count = 1,
+                    .selected_indices = selected,
+                    .lazy = true,
+            };
+    f_out = fopen(FILE_NAME, "w");
+    ASSERT(f_out);
+    fprintf(f_out, "id,value\n0,0\n");
+    fclose(f_out);
+    res = jio_parse_csv_ex(ctx, csv_file, &info, &data);
+    ASSERT(res == JIO_RESULT_SUCCESS);
+    append_text("1,3\n2,6\n");
+    res = jio_csv_parse_append(ctx, data, csv_file);
+    ASSERT(res == JIO_RESULT_SUCCESS);
+    const jio_csv_column* column;
+    ASSERT(jio_csv_get_column(data, 0, &column) == JIO_RESULT_SUCCESS);
+    ASSERT(column->count == 3);
+    ASSERT(segment_is(&column->header, "value"));
+    ASSERT(segment_is(column->elements + 0, "0"));
+    ASSERT(segment_is(column->elements + 1, "3"));
+    ASSERT(segment_is(column->elements + 2, "6"));
+    jio_csv_release(ctx, data);
+
+    //  Filtered data can not have rows appended
+    const jio_csv_filter filter = {.type = JIO_CSV_FILTER_EQUALS, .column = 0, .value = {.begin = "1", .len = 1}};
+    const jio_csv_parse_info filter_info =
+            {
+                    .separator = ",",
+                    .has_headers = true,
+                    .filter_count = 1,
+                    .filters = &filter,
+            };
+    res = jio_parse_csv_ex(ctx, csv_file, &filter_info, &data);
+    ASSERT(res == JIO_RESULT_SUCCESS);
+    res = jio_csv_parse_append(ctx, data, csv_file);
+    ASSERT(res == JIO_RESULT_BAD_VALUE);
+    jio_csv_release(ctx, data);
+
+    jio_memory_file_destroy(csv_file);
+    jio_context_destroy(ctx);
+    return 0;
+}
@@ -0,0 +1,116 @@
+//
+// Created by jan on 19.10.2026.
+//
+#include "../../../include/jio/iocsv.h"
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include "../test_common.h"
+
+static bool segment_is(const jio_string_segment* segment, const char* str)
+{
+    return segment->len == strlen(str) && memcmp(segment->begin, str, segment->len) == 0;
+}
+
+int main()
+{
+    jio_context* ctx;
+    const jio_context_create_info create_info =
+            {
+                    .error_callbacks = NULL,
+                    .allocator_callbacks = NULL,
+                    .stack_allocator_callbacks = NULL,
+            };
+    jio_result res = jio_context_create(&create_info, &ctx);
+    ASSERT(res == JIO_RESULT_SUCCESS);
+
+    jio_memory_file* csv_file;
+    res = jio_memory_file_create(ctx, "csv_test_simple.csv", &csv_file, 0, 0, 0);
+    ASSERT(res == JIO_RESULT_SUCCESS);
+    jio_csv_data* data;
+    res = jio_parse_csv(ctx, csv_file, ",", true, true, &data);
+    ASSERT(res == JIO_RESULT_SUCCESS);
+
+    //  Contents are copied, so the buffer can be reused
+    char buffer[64];
+    snprintf(buffer, sizeof(buffer), "changed");
+    res = jio_csv_set_cell(ctx, data, 1, 2, (jio_string_segment){.begin = buffer, .len = strlen(buffer)});
+    ASSERT(res == JIO_RESULT_SUCCESS);
+    res = jio_csv_set_cell(ctx, data, 4, 0, (jio_string_segment){.begin = buffer, .len = strlen(buffer)});
+    ASSERT(res == JIO_RESULT_BAD_INDEX);
+
+    jio_string_segment row[4];
+    for (uint32_t i = 0; i < 4; ++i)
+    {
+        snprintf(buffer + 16 * i, 16, "new%u", i);
+        row[i] = (jio_string_segment){.begin = buffer + 16 * i, .len = strlen(buffer + 16 * i)};
+    }
+    const jio_string_segment* rows[2] = {row, row};
+    res = jio_csv_add_rows_copy(ctx, data, 1, 2, rows);
+    ASSERT(res == JIO_RESULT_SUCCESS);
+    memset(buffer, 'x', sizeof(buffer));
+
+    const jio_csv_column* column;
+    res = jio_csv_get_column(data, 1, &column);
+    ASSERT(res == JIO_RESULT_SUCCESS);
+    ASSERT(column->count == 6);
+    ASSERT(segment_is(column->elements + 0, "val2"));
+    ASSERT(segment_is(column->elements + 1, "new1"));
+    ASSERT(segment_is(column->elements + 2, "new1"));
+    ASSERT(segment_is(column->elements + 4, "changed"));
+    //  Without deduplication, each copy is separate
+    ASSERT(column->elements[1].begin != column->elements[2].begin);
+
+    //  With deduplication, equal strings share memory
+    jio_csv_set_deduplication(data, true);
+    const jio_string_segment repeated = {.begin = "repeated", .len = 8};
+    for (uint32_t i = 0; i < 6; ++i)
+    {
+        res = jio_csv_set_cell(ctx, data, 2, i, repeated);
+        ASSERT(res == JIO_RESULT_SUCCESS);
+    }
+    res = jio_csv_get_column(data, 2, &column);
+    ASSERT(res == JIO_RESULT_SUCCESS);
+    for (uint32_t i = 0; i < 6; ++i)
+    {
+        ASSERT(segment_is(column->elements + i, "repeated"));
+        ASSERT(column->elements[i].begin == column->elements[0].begin);
+        ASSERT(column->elements[i].begin != repeated.begin);
+    }
+
+    //  Large strings and columns
+    const size_t large_len = 200000;
+    char* const large = malloc(large_len);
+    ASSERT(large);
+    memset(large, 'a', large_len);
+    jio_string_segment elements[6];
+    for (uint32_t i = 0; i < 6; ++i)
+    {
+        elements[i] = (jio_string_segment){.begin = large, .len = i == 3 ? large_len : i};
+    }
+    const jio_csv_column new_column =
+            {
+                    .header = {.begin = large, .len = 6},
+                    .count = 6,
+                    .capacity = 6,
+                    .elements = elements,
+            };
+    res = jio_csv_add_cols_copy(ctx, data, UINT32_MAX, 1, &new_column);
+    ASSERT(res == JIO_RESULT_SUCCESS);
+    memset(large, 'b', large_len);
+    res = jio_csv_get_column_by_name(ctx, data, "aaaaaa", &column);
+    ASSERT(res == JIO_RESULT_SUCCESS);
+    ASSERT(column->elements != elements);
+    ASSERT(column->elements[3].len == large_len);
+    for (size_t i = 0; i < large_len; ++i)
+    {
+        ASSERT(column->elements[3].begin[i] == 'a');
+    }
+    ASSERT(segment_is(column->elements + 2, "aa"));
+    free(large);
+
+    jio_csv_release(ctx, data);
+    jio_memory_file_destroy(csv_file);
+    jio_context_destroy(ctx);
+    return 0;
+}
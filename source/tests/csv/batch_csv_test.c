@@ -0,0 +1,195 @@
+//
+// Created by jan on 19.10.2026.
+//
+#include "../../../include/jio/iocsv.h"
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include "../test_common.h"
+
+#define ROW_COUNT 1000
+
+static void compare_data(const jio_csv_data* d1, const jio_csv_data* d2)
+{
+    uint32_t rows1, cols1, rows2, cols2;
+    jio_csv_shape(d1, &rows1, &cols1);
+    jio_csv_shape(d2, &rows2, &cols2);
+    ASSERT(rows1 == rows2 && cols1 == cols2);
+    for (uint32_t i = 0; i < cols1; ++i)
+    {
+        const jio_csv_column* c1, * c2;
+        jio_result res = jio_csv_get_column(d1, i, &c1);
+        ASSERT(res == JIO_RESULT_SUCCESS);
+        res = jio_csv_get_column(d2, i, &c2);
+        ASSERT(res == JIO_RESULT_SUCCESS);
+        ASSERT(c1->header.begin == c2->header.begin);
+        ASSERT(c1->count == rows1 && c2->count == rows2);
+        for (uint32_t j = 0; j < rows1; ++j)
+        {
+            ASSERT(c1->elements[j].begin == c2->elements[j].begin);
+            ASSERT(c1->elements[j].len == c2->elements[j].len);
+        }
+    }
+}
+
+int main()
+{
+    jio_context* ctx;
+    const jio_context_create_info create_info =
+            {
+                    .error_callbacks = NULL,
+                    .allocator_callbacks = NULL,
+                    .stack_allocator_callbacks = NULL,
+                    .thread_count = 2,
+            };
+    jio_result res = jio_context_create(&create_info, &ctx);
+    ASSERT(res == JIO_RESULT_SUCCESS);
+
+    FILE* f_out = fopen("csv_test_batch.csv", "w");
+    ASSERT(f_out);
+    fprintf(f_out, "id,name,value\n");
+    for (unsigned i = 0; i < ROW_COUNT; ++i)
+    {
+        fprintf(f_out, "%u,row%u,%u\n", i, i, i * 3);
+    }
+    fclose(f_out);
+
+    jio_memory_file* csv_file;
+    res = jio_memory_file_create(ctx, "csv_test_batch.csv", &csv_file, 0, 0, 0);
+    ASSERT(res == JIO_RESULT_SUCCESS);
+
+    jio_csv_data* batched, * sequential;
+    res = jio_parse_csv(ctx, csv_file, ",", true, true, &batched);
+    ASSERT(res == JIO_RESULT_SUCCESS);
+    res = jio_parse_csv(ctx, csv_file, ",", true, true, &sequential);
+    ASSERT(res == JIO_RESULT_SUCCESS);
+
+    const jio_string_segment new_row[3] =
+            {
+                    {.begin = "new", .len = 3},
+                    {.begin = "new row", .len = 7},
+                    {.begin = "0", .len = 1},
+            };
+    const jio_string_segment* const new_rows[4] = {new_row, new_row, new_row, new_row};
+
+    //  Scattered edits, which are applied to the other data one at a time from the back, so that positions stay valid
+    jio_csv_edit* edit;
+    res = jio_csv_edit_begin(ctx, batched, &edit);
+    ASSERT(res == JIO_RESULT_SUCCESS);
+    srand(7);
+    uint32_t positions[100], kinds[100], counts[100];
+    for (uint32_t i = 0; i < 100; ++i)
+    {
+        positions[i] = i * 10 + rand() % 5;
+        kinds[i] = rand() % 3;
+        counts[i] = 1 + rand() % 4;
+        switch (kinds[i])
+        {
+        case 0:
+            res = jio_csv_edit_add_rows(edit, positions[i], counts[i], new_rows);
+            break;
+        case 1:
+            res = jio_csv_edit_remove_rows(edit, positions[i], counts[i]);
+            break;
+        default:
+            res = jio_csv_edit_replace_rows(edit, positions[i], counts[i], 4 - counts[i], new_rows);
+            break;
+        }
+        ASSERT(res == JIO_RESULT_SUCCESS);
+    }
+    res = jio_csv_edit_commit(edit, true);
+    ASSERT(res == JIO_RESULT_SUCCESS);
+    for (uint32_t i = 100; i != 0; --i)
+    {
+        const uint32_t j = i - 1;
+        switch (kinds[j])
+        {
+        case 0:
+            res = jio_csv_add_rows(ctx, sequential, positions[j], counts[j], new_rows);
+            break;
+        case 1:
+            res = jio_csv_remove_rows(ctx, sequential, positions[j], counts[j]);
+            break;
+        default:
+            res = jio_csv_remove_rows(ctx, sequential, positions[j], counts[j]);
+            ASSERT(res == JIO_RESULT_SUCCESS);
+            res = jio_csv_add_rows(ctx, sequential, positions[j], 4 - counts[j], new_rows);
+            break;
+        }
+        ASSERT(res == JIO_RESULT_SUCCESS);
+    }
+    compare_data(batched, sequential);
+
+    //  Overlapping removals are rejected and leave data unchanged
+    res = jio_csv_edit_begin(ctx, batched, &edit);
+    ASSERT(res == JIO_RESULT_SUCCESS);
+    res = jio_csv_edit_remove_rows(edit, 10, 5);
+    ASSERT(res == JIO_RESULT_SUCCESS);
+    res = jio_csv_edit_remove_rows(edit, 12, 5);
+    ASSERT(res == JIO_RESULT_SUCCESS);
+    res = jio_csv_edit_add_rows(edit, UINT32_MAX, 1, new_rows);
+    ASSERT(res == JIO_RESULT_SUCCESS);
+    res = jio_csv_edit_commit(edit, false);
+    ASSERT(res == JIO_RESULT_BAD_VALUE);
+    compare_data(batched, sequential);
+
+    //  Positions out of range are rejected immediately
+    res = jio_csv_edit_begin(ctx, batched, &edit);
+    ASSERT(res == JIO_RESULT_SUCCESS);
+    res = jio_csv_edit_remove_rows(edit, ROW_COUNT * 2, 1);
+    ASSERT(res == JIO_RESULT_BAD_INDEX);
+    jio_csv_edit_abort(edit);
+
+    //  Column edits along with row edits
+    uint32_t rows, cols;
+    jio_csv_shape(batched, &rows, &cols);
+    jio_string_segment* const flag_elements = malloc(sizeof(*flag_elements) * (rows - 1));
+    ASSERT(flag_elements);
+    for (uint32_t i = 0; i < rows - 1; ++i)
+    {
+        flag_elements[i] = (jio_string_segment){.begin = "flag", .len = 4};
+    }
+    const jio_csv_column flag_column =
+            {
+                    .header = {.begin = "flag", .len = 4},
+                    .count = rows - 1,
+                    .capacity = rows - 1,
+                    .elements = flag_elements,
+            };
+    res = jio_csv_edit_begin(ctx, batched, &edit);
+    ASSERT(res == JIO_RESULT_SUCCESS);
+    res = jio_csv_edit_remove_rows(edit, 0, 1);
+    ASSERT(res == JIO_RESULT_SUCCESS);
+    res = jio_csv_edit_remove_cols(edit, 1, 1);
+    ASSERT(res == JIO_RESULT_SUCCESS);
+    res = jio_csv_edit_add_cols(edit, 0, 1, &flag_column);
+    ASSERT(res == JIO_RESULT_SUCCESS);
+    res = jio_csv_edit_commit(edit, false);
+    ASSERT(res == JIO_RESULT_SUCCESS);
+
+    uint32_t new_rows_count, new_cols;
+    jio_csv_shape(batched, &new_rows_count, &new_cols);
+    ASSERT(new_rows_count == rows - 1);
+    ASSERT(new_cols == 3);
+    const jio_csv_column* column;
+    res = jio_csv_get_column(batched, 0, &column);
+    ASSERT(res == JIO_RESULT_SUCCESS);
+    ASSERT(column->elements == flag_elements);
+    res = jio_csv_get_column_by_name(ctx, batched, "name", &column);
+    ASSERT(res != JIO_RESULT_SUCCESS);
+    res = jio_csv_get_column_by_name(ctx, batched, "value", &column);
+    ASSERT(res == JIO_RESULT_SUCCESS);
+    const jio_csv_column* reference;
+    res = jio_csv_get_column(sequential, 2, &reference);
+    ASSERT(res == JIO_RESULT_SUCCESS);
+    for (uint32_t i = 0; i < rows - 1; ++i)
+    {
+        ASSERT(column->elements[i].begin == reference->elements[i + 1].begin);
+    }
+
+    jio_csv_release(ctx, batched);
+    jio_csv_release(ctx, sequential);
+    jio_memory_file_destroy(csv_file);
+    jio_context_destroy(ctx);
+    return 0;
+}
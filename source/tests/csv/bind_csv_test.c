@@ -0,0 +1,181 @@
+//
+// Created by jan on 19.10.2026.
+//
+#include "../../../include/jio/iocsv.h"
+#include <stdlib.h>
+#include <stdio.h>
+#include <stddef.h>
+#include <inttypes.h>
+#include <string.h>
+#include "../test_common.h"
+
+#define ROW_COUNT 50000
+
+typedef struct record_T record;
+struct record_T
+{
+    int64_t id;
+    int32_t small;
+    uint32_t count;
+    double value;
+    float ratio;
+    jio_string_segment name;
+    uint64_t big;
+    double weight;
+};
+
+static const jio_csv_field RECORD_FIELDS[] =
+        {
+                {.name = "id", .type = JIO_CSV_FIELD_INT64, .offset = offsetof(record, id)},
+                {.name = "small", .type = JIO_CSV_FIELD_INT32, .offset = offsetof(record, small)},
+                {.name = "count", .type = JIO_CSV_FIELD_UINT32, .offset = offsetof(record, count), .has_default = true, .default_value.u64 = 99},
+                {.name = "value", .type = JIO_CSV_FIELD_DOUBLE, .offset = offsetof(record, value)},
+                {.name = "ratio", .type = JIO_CSV_FIELD_FLOAT, .offset = offsetof(record, ratio)},
+                {.name = "name", .type = JIO_CSV_FIELD_STRING, .offset = offsetof(record, name)},
+                {.index = 6, .type = JIO_CSV_FIELD_UINT64, .offset = offsetof(record, big)},
+                {.name = "weight", .type = JIO_CSV_FIELD_DOUBLE, .offset = offsetof(record, weight), .has_default = true, .default_value.f64 = 1.5},
+        };
+
+static void segment_to_string(const jio_string_segment* segment, char* buffer, size_t size)
+{
+    ASSERT(segment->len < size);
+    memcpy(buffer, segment->begin, segment->len);
+    buffer[segment->len] = 0;
+}
+
+static void check_bind_fails(const jio_context* ctx, const char* contents, jio_csv_field field, jio_result expected)
+{
+    FILE* f_out = fopen("csv_test_bind_bad.csv", "w");
+    ASSERT(f_out);
+    fputs(contents, f_out);
+    fclose(f_out);
+    jio_memory_file* csv_file;
+    jio_result res = jio_memory_file_create(ctx, "csv_test_bind_bad.csv", &csv_file, 0, 0, 0);
+    ASSERT(res == JIO_RESULT_SUCCESS);
+    jio_csv_data* data;
+    res = jio_parse_csv(ctx, csv_file, ",", false, true, &data);
+    ASSERT(res == JIO_RESULT_SUCCESS);
+    record rows[4];
+    res = jio_csv_bind_rows(ctx, data, 1, &field, 0, 2, sizeof(*rows), rows);
+    ASSERT(res == expected);
+    jio_csv_release(ctx, data);
+    jio_memory_file_destroy(csv_file);
+}
+
+int main()
+{
+    jio_context* ctx;
+    const jio_context_create_info create_info =
+            {
+                    .error_callbacks = NULL,
+                    .allocator_callbacks = NULL,
+                    .stack_allocator_callbacks = NULL,
+                    .thread_count = 4,
+            };
+    jio_result res = jio_context_create(&create_info, &ctx);
+    ASSERT(res == JIO_RESULT_SUCCESS);
+
+    srand(31);
+    FILE* f_out = fopen("csv_test_bind.csv", "w");
+    ASSERT(f_out);
+    fprintf(f_out, "id,small,count,value,ratio,name,big\n");
+    fprintf(f_out, "-9223372036854775808,-2147483648,4294967295,0.1,-0,,18446744073709551615\n");
+    fprintf(f_out, "9223372036854775807,2147483647,0,-1e-5,3e38,x,00000000000000000000001\n");
+    for (unsigned i = 2; i < ROW_COUNT; ++i)
+    {
+        const int64_t id = ((int64_t)rand() << 32 | rand()) - ((int64_t)1 << 61);
+        const int small = rand() - RAND_MAX / 2;
+        switch (i % 4)
+        {
+        case 0:
+            fprintf(f_out, "%"PRId64",%d,%d,%d.%03d,%g,name %u,%u\n", id, small, rand(), rand() % 10000, rand() % 1000, (double)rand() / RAND_MAX, i, rand());
+            break;
+        case 1:
+            fprintf(f_out, "%"PRId64",%+d,,%.17g,%.9g,,%"PRIu64"\n", id, small, (double)rand() / (double)rand() * 1e12, (double)rand() / 7.0, (uint64_t)rand() << 33 | rand());
+            break;
+        case 2:
+            fprintf(f_out, "%"PRId64",%d,%u,%.6e,.5,\"q\",1e3\n", id, small, i, (double)rand() * 1e-30);
+            break;
+        default:
+            fprintf(f_out, "%"PRId64",%d,%u,%.20g,1.,n,0\n", id, small, i, (double)rand() / 3.0e-200);
+            break;
+        }
+    }
+    fclose(f_out);
+
+    jio_memory_file* csv_file;
+    res = jio_memory_file_create(ctx, "csv_test_bind.csv", &csv_file, 0, 0, 0);
+    ASSERT(res == JIO_RESULT_SUCCESS);
+    jio_csv_data* data;
+    res = jio_parse_csv(ctx, csv_file, ",", false, true, &data);
+    ASSERT(res == JIO_RESULT_SUCCESS);
+
+    //  Big column has an entry which is not an integer
+    record* const rows = malloc(sizeof(*rows) * ROW_COUNT);
+    ASSERT(rows);
+    const uint32_t field_count = sizeof(RECORD_FIELDS) / sizeof(*RECORD_FIELDS);
+    res = jio_csv_bind_rows(ctx, data, field_count, RECORD_FIELDS, 0, ROW_COUNT, sizeof(*rows), rows);
+    ASSERT(res == JIO_RESULT_BAD_VALUE);
+    res = jio_csv_bind_rows(ctx, data, field_count - 2, RECORD_FIELDS, 0, ROW_COUNT, sizeof(*rows), rows);
+    ASSERT(res == JIO_RESULT_SUCCESS);
+    res = jio_csv_bind_rows(ctx, data, field_count, RECORD_FIELDS, 0, 2, sizeof(*rows), rows);
+    ASSERT(res == JIO_RESULT_SUCCESS);
+    res = jio_csv_bind_rows(ctx, data, field_count, RECORD_FIELDS, ROW_COUNT - 1, 2, sizeof(*rows), rows);
+    ASSERT(res == JIO_RESULT_BAD_INDEX);
+
+    ASSERT(rows[0].id == INT64_MIN && rows[1].id == INT64_MAX);
+    ASSERT(rows[0].small == INT32_MIN && rows[1].small == INT32_MAX);
+    ASSERT(rows[0].count == UINT32_MAX && rows[1].count == 0);
+    ASSERT(rows[0].value == 0.1 && rows[1].value == -1e-5);
+    ASSERT(rows[0].ratio == 0 && rows[1].ratio == 3e38f);
+    ASSERT(rows[0].name.len == 0 && rows[1].name.len == 1 && rows[1].name.begin[0] == 'x');
+    ASSERT(rows[0].big == UINT64_MAX && rows[1].big == 1);
+    ASSERT(rows[0].weight == 1.5 && rows[1].weight == 1.5);
+
+    //  Compare the rest against the standard library
+    const jio_csv_column* columns[5];
+    for (uint32_t i = 0; i < 5; ++i)
+    {
+        ASSERT(jio_csv_get_column(data, i, columns + i) == JIO_RESULT_SUCCESS);
+    }
+    const jio_csv_column* name_column;
+    ASSERT(jio_csv_get_column(data, 5, &name_column) == JIO_RESULT_SUCCESS);
+    for (uint32_t i = 0; i < ROW_COUNT; ++i)
+    {
+        char buffer[64];
+        segment_to_string(columns[0]->elements + i, buffer, sizeof(buffer));
+        ASSERT(rows[i].id == strtoll(buffer, NULL, 10));
+        segment_to_string(columns[1]->elements + i, buffer, sizeof(buffer));
+        ASSERT(rows[i].small == strtol(buffer, NULL, 10));
+        segment_to_string(columns[2]->elements + i, buffer, sizeof(buffer));
+        ASSERT(rows[i].count == (buffer[0] ? strtoul(buffer, NULL, 10) : 99));
+        segment_to_string(columns[3]->elements + i, buffer, sizeof(buffer));
+        ASSERT(rows[i].value == strtod(buffer, NULL));
+        segment_to_string(columns[4]->elements + i, buffer, sizeof(buffer));
+        ASSERT(rows[i].ratio == (float)strtod(buffer, NULL));
+        ASSERT(rows[i].name.begin == name_column->elements[i].begin && rows[i].name.len == name_column->elements[i].len);
+    }
+    free(rows);
+    jio_csv_release(ctx, data);
+    jio_memory_file_destroy(csv_file);
+
+    //  Bad elements and columns
+    const jio_csv_field int_field = {.index = 1, .type = JIO_CSV_FIELD_INT32, .offset = offsetof(record, small)};
+    const jio_csv_field uint_field = {.index = 1, .type = JIO_CSV_FIELD_UINT64, .offset = offsetof(record, big)};
+    const jio_csv_field float_field = {.index = 1, .type = JIO_CSV_FIELD_FLOAT, .offset = offsetof(record, ratio)};
+    const jio_csv_field named_field = {.name = "c", .type = JIO_CSV_FIELD_INT32, .offset = offsetof(record, small)};
+    check_bind_fails(ctx, "a,b\n1,2\n3,x\n", int_field, JIO_RESULT_BAD_VALUE);
+    check_bind_fails(ctx, "a,b\n1,2\n3,3000000000\n", int_field, JIO_RESULT_BAD_VALUE);
+    check_bind_fails(ctx, "a,b\n1,2\n3, 4\n", int_field, JIO_RESULT_BAD_VALUE);
+    check_bind_fails(ctx, "a,b\n1,2\n3,\n", int_field, JIO_RESULT_BAD_VALUE);
+    check_bind_fails(ctx, "a,b\n1,2\n3,-4\n", uint_field, JIO_RESULT_BAD_VALUE);
+    check_bind_fails(ctx, "a,b\n1,2\n3,18446744073709551616\n", uint_field, JIO_RESULT_BAD_VALUE);
+    check_bind_fails(ctx, "a,b\n1,2\n3,1e39\n", float_field, JIO_RESULT_BAD_VALUE);
+    check_bind_fails(ctx, "a,b\n1,2\n3,4\n", named_field, JIO_RESULT_BAD_CSV_HEADER);
+    check_bind_fails(ctx, "a\n1\n3\n", int_field, JIO_RESULT_BAD_INDEX);
+    check_bind_fails(ctx, "a,b\n1,2\n3,inf\n", float_field, JIO_RESULT_SUCCESS);
+    check_bind_fails(ctx, "a,b\n1,2\n3,-4\n", int_field, JIO_RESULT_SUCCESS);
+
+    jio_context_destroy(ctx);
+    return 0;
+}
@@ -0,0 +1,108 @@
+//
+// Created by jan on 19.10.2026.
+//
+#include "../../../include/jio/iocsv.h"
+#include <stdlib.h>
+#include <stdio.h>
+#include "../test_common.h"
+
+typedef struct block_state_T block_state;
+struct block_state_T
+{
+    uint32_t block_count;
+    uint32_t row_count;
+    uint32_t stop_after;
+    uint32_t block_rows;
+};
+
+//  Rows of csv_test_simple.csv are "val1, val2, ..." followed by "val11, val12, ...", "val21, ..." and so on
+static jio_string_segment expected_cell(uint32_t row, uint32_t column, char* buffer, size_t size)
+{
+    if (row == 0)
+    {
+        snprintf(buffer, size, "val%u", column + 1);
+    }
+    else
+    {
+        snprintf(buffer, size, "val%u%u", row, column + 1);
+    }
+    return segment(buffer);
+}
+
+static bool check_block(uint32_t column_count, uint32_t row_count, const jio_string_segment* headers, const jio_string_segment* const* columns, void* param)
+{
+    block_state* const state = param;
+    ASSERT(column_count == 4);
+    ASSERT(headers != NULL);
+    //  Every block is full, except for the last one
+    ASSERT(row_count == state->block_rows || state->row_count + row_count == 4);
+    char buffer[16];
+    for (uint32_t i = 0; i < column_count; ++i)
+    {
+        snprintf(buffer, sizeof(buffer), "c%u", i + 1);
+        const jio_string_segment header = segment(buffer);
+        ASSERT(segment_equal(headers + i, &header));
+        //  Rows of a block continue where the previous block ended
+        for (uint32_t j = 0; j < row_count; ++j)
+        {
+            const jio_string_segment expected = expected_cell(state->row_count + j, i, buffer, sizeof(buffer));
+            ASSERT(segment_equal(columns[i] + j, &expected));
+        }
+    }
+    state->block_count += 1;
+    state->row_count += row_count;
+    return state->block_count != state->stop_after;
+}
+
+int main()
+{
+    jio_context* ctx;
+    const jio_context_create_info create_info =
+            {
+                    .error_callbacks = NULL,
+                    .allocator_callbacks = NULL,
+                    .stack_allocator_callbacks = NULL,
+            };
+    jio_result res = jio_context_create(&create_info, &ctx);
+    ASSERT(res == JIO_RESULT_SUCCESS);
+
+    jio_memory_file* csv_file;
+    res = jio_memory_file_create(ctx, "csv_test_simple.csv", &csv_file, 0, 0, 0);
+    ASSERT(res == JIO_RESULT_SUCCESS);
+
+    //  Test incorrect version
+    block_state state = {0};
+    res = jio_process_csv_blocks(ctx, csv_file, ",", true, true, 0, check_block, &state);
+    ASSERT(res == JIO_RESULT_BAD_VALUE);
+    ASSERT(state.block_count == 0);
+
+    //  Test correct version
+    state = (block_state){.block_rows = 3};
+    res = jio_process_csv_blocks(ctx, csv_file, ",", true, true, 3, check_block, &state);
+    ASSERT(res == JIO_RESULT_SUCCESS);
+    ASSERT(state.block_count == 2);
+    ASSERT(state.row_count == 4);
+
+    //  Test blocks of single rows, blocks which exactly fit the rows and blocks larger than the file
+    const uint32_t block_sizes[3] = {1, 4, 10};
+    const uint32_t block_counts[3] = {4, 1, 1};
+    for (unsigned i = 0; i < 3; ++i)
+    {
+        state = (block_state){.block_rows = block_sizes[i]};
+        res = jio_process_csv_blocks(ctx, csv_file, ",", true, true, block_sizes[i], check_block, &state);
+        ASSERT(res == JIO_RESULT_SUCCESS);
+        ASSERT(state.block_count == block_counts[i]);
+        ASSERT(state.row_count == 4);
+    }
+
+    //  Test stopping early
+    state = (block_state){.stop_after = 1, .block_rows = 2};
+    res = jio_process_csv_blocks(ctx, csv_file, ",", true, true, 2, check_block, &state);
+    ASSERT(res == JIO_RESULT_SUCCESS);
+    ASSERT(state.block_count == 1);
+    ASSERT(state.row_count == 2);
+
+    jio_memory_file_destroy(csv_file);
+    jio_context_destroy(ctx);
+    return 0;
+}
@@ -0,0 +1,257 @@
+//
+// Created by jan on 19.10.2026.
+//
+#include "../../../include/jio/iocsv.h"
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include "../test_common.h"
+
+#define MAX_ELEMENTS 20000
+
+//  Elements are identified by their begin pointer, which is just an index into this buffer
+static const char element_values[1 << 20] = {0};
+
+static jio_string_segment make_element(uint32_t id)
+{
+    return (jio_string_segment){.begin = element_values + id, .len = id % 7};
+}
+
+static bool same_element(jio_string_segment a, jio_string_segment b)
+{
+    return a.begin == b.begin && a.len == b.len;
+}
+
+static void check_column(const jio_csv_chunked_column* column, const jio_string_segment* reference, uint32_t count)
+{
+    ASSERT(jio_csv_chunked_column_count(column) == count);
+    uint32_t i = 0;
+    while (i < count)
+    {
+        const jio_string_segment* elements;
+        uint32_t n;
+        jio_result res = jio_csv_chunked_column_block(column, i, &elements, &n);
+        ASSERT(res == JIO_RESULT_SUCCESS);
+        ASSERT(n > 0 && i + n <= count);
+        for (uint32_t j = 0; j < n; ++j)
+        {
+            ASSERT(same_element(elements[j], reference[i + j]));
+        }
+        i += n;
+    }
+}
+
+//  Allocator which fails once it made a number of allocations
+static void* limited_alloc(void* param, size_t size)
+{
+    uint32_t* const p_remaining = param;
+    if (!*p_remaining)
+    {
+        return NULL;
+    }
+    *p_remaining -= 1;
+    return malloc(size);
+}
+
+static void limited_free(void* param, void* ptr)
+{
+    (void)param;
+    free(ptr);
+}
+
+static void* limited_realloc(void* param, void* ptr, size_t new_size)
+{
+    uint32_t* const p_remaining = param;
+    if (!*p_remaining)
+    {
+        return NULL;
+    }
+    *p_remaining -= 1;
+    return realloc(ptr, new_size);
+}
+
+int main()
+{
+    jio_context* ctx;
+    const jio_context_create_info create_info =
+            {
+                    .error_callbacks = NULL,
+                    .allocator_callbacks = NULL,
+                    .stack_allocator_callbacks = NULL,
+            };
+    jio_result res = jio_context_create(&create_info, &ctx);
+    ASSERT(res == JIO_RESULT_SUCCESS);
+
+    jio_string_segment* const reference = malloc(sizeof(*reference) * MAX_ELEMENTS);
+    jio_string_segment* const buffer = malloc(sizeof(*buffer) * MAX_ELEMENTS);
+    ASSERT(reference && buffer);
+
+    //  Create from a column
+    for (uint32_t i = 0; i < 1000; ++i)
+    {
+        reference[i] = make_element(i);
+    }
+    const jio_csv_column src =
+            {
+            .header = {.begin = "header", .len = 6},
+            .count = 1000,
+            .capacity = 1000,
+            .elements = reference,
+            };
+    jio_csv_chunked_column* column;
+    res = jio_csv_chunked_column_create(ctx, &src, &column);
+    ASSERT(res == JIO_RESULT_SUCCESS);
+    const jio_string_segment header = jio_csv_chunked_column_header(column);
+    ASSERT(header.len == 6 && memcmp(header.begin, "header", 6) == 0);
+    uint32_t count = 1000;
+    check_column(column, reference, count);
+
+    //  Test bad indices
+    jio_string_segment element;
+    res = jio_csv_chunked_column_get(column, count, &element);
+    ASSERT(res == JIO_RESULT_BAD_INDEX);
+    res = jio_csv_chunked_column_insert(ctx, column, count + 1, 1, reference);
+    ASSERT(res == JIO_RESULT_BAD_INDEX);
+    res = jio_csv_chunked_column_remove(ctx, column, count - 1, 2);
+    ASSERT(res == JIO_RESULT_BAD_INDEX);
+
+    //  Random insertions and removals compared against a plain array
+    srand(42);
+    uint32_t next_id = 1000;
+    for (uint32_t step = 0; step < 2000; ++step)
+    {
+        const int action = rand() % 3;
+        if (action != 0 && count + 64 < MAX_ELEMENTS)
+        {
+            const uint32_t n = 1 + rand() % 64;
+            const uint32_t pos = rand() % (count + 1);
+            for (uint32_t i = 0; i < n; ++i)
+            {
+                buffer[i] = make_element(next_id++);
+            }
+            res = jio_csv_chunked_column_insert(ctx, column, pos, n, buffer);
+            ASSERT(res == JIO_RESULT_SUCCESS);
+            memmove(reference + pos + n, reference + pos, sizeof(*reference) * (count - pos));
+            memcpy(reference + pos, buffer, sizeof(*reference) * n);
+            count += n;
+        }
+        else if (count)
+        {
+            const uint32_t pos = rand() % count;
+            uint32_t n = 1 + rand() % 40;
+            if (n > count - pos)
+            {
+                n = count - pos;
+            }
+            res = jio_csv_chunked_column_remove(ctx, column, pos, n);
+            ASSERT(res == JIO_RESULT_SUCCESS);
+            memmove(reference + pos, reference + pos + n, sizeof(*reference) * (count - pos - n));
+            count -= n;
+        }
+        if (step % 100 == 0)
+        {
+            check_column(column, reference, count);
+        }
+    }
+    check_column(column, reference, count);
+
+    //  Element access
+    ASSERT(count > 10);
+    res = jio_csv_chunked_column_get(column, count / 2, &element);
+    ASSERT(res == JIO_RESULT_SUCCESS);
+    ASSERT(same_element(element, reference[count / 2]));
+    res = jio_csv_chunked_column_set(column, count / 2, make_element(0));
+    ASSERT(res == JIO_RESULT_SUCCESS);
+    reference[count / 2] = make_element(0);
+    res = jio_csv_chunked_column_copy(column, 3, count - 5, buffer);
+    ASSERT(res == JIO_RESULT_SUCCESS);
+    for (uint32_t i = 0; i < count - 5; ++i)
+    {
+        ASSERT(same_element(buffer[i], reference[3 + i]));
+    }
+
+    //  Conversion back to a column
+    jio_csv_column converted;
+    res = jio_csv_chunked_column_to_column(ctx, column, &converted);
+    ASSERT(res == JIO_RESULT_SUCCESS);
+    ASSERT(converted.count == count);
+    for (uint32_t i = 0; i < count; ++i)
+    {
+        ASSERT(same_element(converted.elements[i], reference[i]));
+    }
+    free(converted.elements);
+
+    //  Removing everything and appending again
+    res = jio_csv_chunked_column_remove(ctx, column, 0, count);
+    ASSERT(res == JIO_RESULT_SUCCESS);
+    ASSERT(jio_csv_chunked_column_count(column) == 0);
+    for (uint32_t i = 0; i < 5000; ++i)
+    {
+        element = make_element(i);
+        res = jio_csv_chunked_column_insert(ctx, column, UINT32_MAX, 1, &element);
+        ASSERT(res == JIO_RESULT_SUCCESS);
+        reference[i] = element;
+    }
+    check_column(column, reference, 5000);
+
+    jio_csv_chunked_column_destroy(ctx, column);
+    jio_context_destroy(ctx);
+
+    //  Insertion which runs out of memory leaves the column as it was
+    uint32_t remaining = UINT32_MAX;
+    const jio_allocator_callbacks limited_callbacks =
+            {
+                    .alloc = limited_alloc,
+                    .free = limited_free,
+                    .realloc = limited_realloc,
+                    .param = &remaining,
+            };
+    const jio_context_create_info limited_info =
+            {
+                    .error_callbacks = NULL,
+                    .allocator_callbacks = &limited_callbacks,
+                    .stack_allocator_callbacks = NULL,
+            };
+    res = jio_context_create(&limited_info, &ctx);
+    ASSERT(res == JIO_RESULT_SUCCESS);
+    for (uint32_t i = 0; i < MAX_ELEMENTS; ++i)
+    {
+        buffer[i] = make_element(i);
+    }
+    bool failed_empty = false, failed_middle = false;
+    for (uint32_t budget = 0; budget < 64; ++budget)
+    {
+        remaining = UINT32_MAX;
+        res = jio_csv_chunked_column_create(ctx, NULL, &column);
+        ASSERT(res == JIO_RESULT_SUCCESS);
+        remaining = budget;
+        res = jio_csv_chunked_column_insert(ctx, column, UINT32_MAX, 10000, buffer);
+        ASSERT(res == JIO_RESULT_SUCCESS || res == JIO_RESULT_BAD_ALLOC);
+        if (res == JIO_RESULT_BAD_ALLOC)
+        {
+            failed_empty = true;
+            check_column(column, buffer, 0);
+            remaining = UINT32_MAX;
+            res = jio_csv_chunked_column_insert(ctx, column, UINT32_MAX, 10000, buffer);
+            ASSERT(res == JIO_RESULT_SUCCESS);
+        }
+        check_column(column, buffer, 10000);
+
+        remaining = budget;
+        res = jio_csv_chunked_column_insert(ctx, column, 5000, 5000, buffer + 15000);
+        ASSERT(res == JIO_RESULT_SUCCESS || res == JIO_RESULT_BAD_ALLOC);
+        if (res == JIO_RESULT_BAD_ALLOC)
+        {
+            failed_middle = true;
+            check_column(column, buffer, 10000);
+        }
+        remaining = UINT32_MAX;
+        jio_csv_chunked_column_destroy(ctx, column);
+    }
+    ASSERT(failed_empty && failed_middle);
+    jio_context_destroy(ctx);
+
+    free(buffer);
+    free(reference);
+    return 0;
+}
@@ -0,0 +1,123 @@
+//
+// Created by jan on 19.10.2026.
+//
+#include "../../../include/jio/iocsv.h"
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include "../test_common.h"
+
+#define ROW_COUNT 60000
+
+static void check_dictionary(const jio_csv_column* column, const jio_csv_dictionary* dictionary)
+{
+    ASSERT(dictionary->count == column->count);
+    ASSERT(segment_equal(&dictionary->header, &column->header));
+    //  Values are distinct and appear in the column in the same order
+    uint32_t next_value = 0;
+    for (uint32_t i = 0; i < column->count; ++i)
+    {
+        const uint32_t code = jio_csv_dictionary_code(dictionary, i);
+        ASSERT(code < dictionary->value_count);
+        ASSERT(code <= next_value);
+        if (code == next_value)
+        {
+            next_value += 1;
+        }
+        ASSERT(segment_equal(dictionary->values + code, column->elements + i));
+    }
+    ASSERT(next_value == dictionary->value_count);
+    for (uint32_t i = 1; i < dictionary->value_count; ++i)
+    {
+        ASSERT(!segment_equal(dictionary->values + i - 1, dictionary->values + i));
+    }
+}
+
+int main()
+{
+    jio_context* ctx;
+    const jio_context_create_info create_info =
+            {
+                    .error_callbacks = NULL,
+                    .allocator_callbacks = NULL,
+                    .stack_allocator_callbacks = NULL,
+                    .thread_count = 4,
+            };
+    jio_result res = jio_context_create(&create_info, &ctx);
+    ASSERT(res == JIO_RESULT_SUCCESS);
+
+    static const char* const statuses[] = {"ok", "failed", "", "pending", "retry"};
+    srand(17);
+    FILE* f_out = fopen("csv_test_dictionary.csv", "w");
+    ASSERT(f_out);
+    fprintf(f_out, "status,host,id\n");
+    for (unsigned i = 0; i < ROW_COUNT; ++i)
+    {
+        fprintf(f_out, "%s,host-%u,%u\n", statuses[rand() % 5], rand() % 1000, i % 30000);
+    }
+    fclose(f_out);
+
+    jio_memory_file* csv_file;
+    res = jio_memory_file_create(ctx, "csv_test_dictionary.csv", &csv_file, 0, 0, 0);
+    ASSERT(res == JIO_RESULT_SUCCESS);
+    jio_csv_data* data;
+    res = jio_parse_csv(ctx, csv_file, ",", true, true, &data);
+    ASSERT(res == JIO_RESULT_SUCCESS);
+
+    jio_csv_dictionary dictionary;
+    res = jio_csv_column_dictionary_encode(ctx, data, 3, &dictionary);
+    ASSERT(res == JIO_RESULT_BAD_INDEX);
+
+    const uint32_t expected_sizes[3] = {1, 2, 2};
+    const uint32_t expected_values[3] = {5, 1000, 30000};
+    for (uint32_t i = 0; i < 3; ++i)
+    {
+        const jio_csv_column* column;
+        ASSERT(jio_csv_get_column(data, i, &column) == JIO_RESULT_SUCCESS);
+        res = jio_csv_column_dictionary_encode(ctx, data, i, &dictionary);
+        ASSERT(res == JIO_RESULT_SUCCESS);
+        ASSERT(dictionary.code_size == expected_sizes[i]);
+        ASSERT(dictionary.value_count == expected_values[i]);
+        check_dictionary(column, &dictionary);
+        jio_csv_dictionary_release(ctx, &dictionary);
+    }
+
+    //  Every value of the column is distinct
+    const jio_csv_column* column;
+    jio_string_segment* const ids = malloc(sizeof(*ids) * ROW_COUNT);
+    char* const id_buffer = malloc(8 * ROW_COUNT);
+    ASSERT(ids && id_buffer);
+    for (uint32_t i = 0; i < ROW_COUNT; ++i)
+    {
+        ids[i].begin = id_buffer + 8 * i;
+        ids[i].len = (size_t)sprintf(id_buffer + 8 * i, "%u", i);
+    }
+    const jio_csv_column unique = {.header = {.begin = "unique", .len = 6}, .count = ROW_COUNT, .capacity = ROW_COUNT, .elements = ids};
+    res = jio_csv_add_cols(ctx, data, 3, 1, &unique);
+    ASSERT(res == JIO_RESULT_SUCCESS);
+    ASSERT(jio_csv_get_column(data, 3, &column) == JIO_RESULT_SUCCESS);
+    res = jio_csv_column_dictionary_encode(ctx, data, 3, &dictionary);
+    ASSERT(res == JIO_RESULT_SUCCESS);
+    ASSERT(dictionary.code_size == 2);
+    ASSERT(dictionary.value_count == ROW_COUNT);
+    for (uint32_t i = 0; i < ROW_COUNT; ++i)
+    {
+        ASSERT(jio_csv_dictionary_code(&dictionary, i) == i);
+    }
+    check_dictionary(column, &dictionary);
+    jio_csv_dictionary_release(ctx, &dictionary);
+
+    //  Empty data
+    res = jio_csv_remove_rows(ctx, data, 0, ROW_COUNT);
+    ASSERT(res == JIO_RESULT_SUCCESS);
+    res = jio_csv_column_dictionary_encode(ctx, data, 0, &dictionary);
+    ASSERT(res == JIO_RESULT_SUCCESS);
+    ASSERT(dictionary.count == 0 && dictionary.value_count == 0);
+    jio_csv_dictionary_release(ctx, &dictionary);
+
+    jio_csv_release(ctx, data);
+    free(id_buffer);
+    jio_memory_file_destroy(csv_file);
+    jio_context_destroy(ctx);
+    return 0;
+}
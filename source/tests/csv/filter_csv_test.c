@@ -0,0 +1,134 @@
+//
+// Created by jan on 19.10.2026.
+//
+#include "../../../include/jio/iocsv.h"
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include "../test_common.h"
+
+static bool keep_odd_ids(uint32_t column_count, const jio_string_segment* row, void* param)
+{
+    (void) param;
+    ASSERT(column_count == 1);
+    return (row[0].begin[row[0].len - 1] - '0') % 2 == 1;
+}
+
+static void print_csv(const jio_csv_data* data)
+{
+    uint32_t rows, cols;
+    jio_csv_shape(data, &rows, &cols);
+    for (uint32_t i = 0; i < cols; ++i)
+    {
+        const jio_csv_column* p_column;
+        const jio_result res = jio_csv_get_column(data, i, &p_column);
+        ASSERT(res == JIO_RESULT_SUCCESS);
+        printf("Column %u has a header \"%.*s\" and length of %u:\n", i, (int)p_column->header.len, p_column->header.begin, p_column->count);
+        for (uint32_t j = 0; j < rows; ++j)
+        {
+            printf("\telement %u: \"%.*s\"\n", j, (int)p_column->elements[j].len, p_column->elements[j].begin);
+        }
+    }
+}
+
+int main()
+{
+    jio_context* ctx;
+    const jio_context_create_info create_info =
+            {
+                    .error_callbacks = NULL,
+                    .allocator_callbacks = NULL,
+                    .stack_allocator_callbacks = NULL,
+            };
+    jio_result res = jio_context_create(&create_info, &ctx);
+    ASSERT(res == JIO_RESULT_SUCCESS);
+
+    jio_memory_file* csv_file;
+    res = jio_memory_file_create(ctx, "csv_test_filter.csv", &csv_file, 0, 0, 0);
+    ASSERT(res == JIO_RESULT_SUCCESS);
+
+    jio_csv_data* csv_data;
+    uint32_t rows, cols;
+    const jio_csv_column* p_column;
+
+    //  Test filtering with equality
+    jio_csv_filter filter =
+            {
+                    .type = JIO_CSV_FILTER_EQUALS,
+                    .column = 1,
+                    .value = {.begin = "ERROR", .len = 5},
+            };
+    jio_csv_parse_info parse_info =
+            {
+                    .separator = ",",
+                    .trim_whitespace = true,
+                    .has_headers = true,
+                    .filter_count = 1,
+                    .filters = &filter,
+            };
+    res = jio_parse_csv_ex(ctx, csv_file, &parse_info, &csv_data);
+    ASSERT(res == JIO_RESULT_SUCCESS);
+    print_csv(csv_data);
+    jio_csv_shape(csv_data, &rows, &cols);
+    ASSERT(rows == 2);
+    ASSERT(cols == 3);
+    res = jio_csv_get_column(csv_data, 0, &p_column);
+    ASSERT(res == JIO_RESULT_SUCCESS);
+    ASSERT(p_column->elements[0].begin[0] == '2');
+    ASSERT(p_column->elements[1].begin[0] == '5');
+    jio_csv_release(ctx, csv_data);
+
+    //  Test filtering with prefix and inverting
+    filter.type = JIO_CSV_FILTER_PREFIX;
+    res = jio_parse_csv_ex(ctx, csv_file, &parse_info, &csv_data);
+    ASSERT(res == JIO_RESULT_SUCCESS);
+    jio_csv_shape(csv_data, &rows, NULL);
+    ASSERT(rows == 3);
+    jio_csv_release(ctx, csv_data);
+    filter.invert = true;
+    res = jio_parse_csv_ex(ctx, csv_file, &parse_info, &csv_data);
+    ASSERT(res == JIO_RESULT_SUCCESS);
+    jio_csv_shape(csv_data, &rows, NULL);
+    ASSERT(rows == 2);
+    jio_csv_release(ctx, csv_data);
+
+    //  Test filtering by range on a column which is not selected, with a callback
+    const uint32_t selected = 0;
+    filter = (jio_csv_filter)
+            {
+                    .type = JIO_CSV_FILTER_RANGE,
+                    .column_name = {.begin = "latency", .len = 7},
+                    .min = 10.0,
+                    .max = 1000.0,
+            };
+    parse_info.selected_count = 1;
+    parse_info.selected_indices = &selected;
+    res = jio_parse_csv_ex(ctx, csv_file, &parse_info, &csv_data);
+    ASSERT(res == JIO_RESULT_SUCCESS);
+    print_csv(csv_data);
+    jio_csv_shape(csv_data, &rows, &cols);
+    ASSERT(rows == 3);
+    ASSERT(cols == 1);
+    jio_csv_release(ctx, csv_data);
+
+    parse_info.row_filter = keep_odd_ids;
+    res = jio_parse_csv_ex(ctx, csv_file, &parse_info, &csv_data);
+    ASSERT(res == JIO_RESULT_SUCCESS);
+    print_csv(csv_data);
+    jio_csv_shape(csv_data, &rows, NULL);
+    ASSERT(rows == 2);
+    res = jio_csv_get_column(csv_data, 0, &p_column);
+    ASSERT(res == JIO_RESULT_SUCCESS);
+    ASSERT(p_column->elements[0].begin[0] == '1');
+    ASSERT(p_column->elements[1].begin[0] == '5');
+    jio_csv_release(ctx, csv_data);
+
+    //  Test the incorrect version
+    filter.column_name = (jio_string_segment){.begin = "latenc", .len = 6};
+    res = jio_parse_csv_ex(ctx, csv_file, &parse_info, &csv_data);
+    ASSERT(res == JIO_RESULT_BAD_CSV_HEADER);
+
+    jio_memory_file_destroy(csv_file);
+    jio_context_destroy(ctx);
+    return 0;
+}
@@ -0,0 +1,120 @@
+//
+// Created by jan on 19.10.2026.
+//
+#include "../../../include/jio/iocsv.h"
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include "../test_common.h"
+
+#define COLUMN_COUNT 5000
+
+static uint32_t column_idx(const jio_context* ctx, const jio_csv_data* data, const char* name)
+{
+    const jio_csv_column* column;
+    const jio_result res = jio_csv_get_column_by_name(ctx, data, name, &column);
+    if (res != JIO_RESULT_SUCCESS)
+    {
+        return UINT32_MAX;
+    }
+    uint32_t idx;
+    ASSERT(jio_csv_column_index(data, column, &idx) == JIO_RESULT_SUCCESS);
+    return idx;
+}
+
+int main()
+{
+    jio_context* ctx;
+    const jio_context_create_info create_info =
+            {
+                    .error_callbacks = NULL,
+                    .allocator_callbacks = NULL,
+                    .stack_allocator_callbacks = NULL,
+            };
+    jio_result res = jio_context_create(&create_info, &ctx);
+    ASSERT(res == JIO_RESULT_SUCCESS);
+
+    FILE* f_out = fopen("csv_test_header.csv", "w");
+    ASSERT(f_out);
+    for (unsigned j = 0; j < 2; ++j)
+    {
+        for (unsigned i = 0; i < COLUMN_COUNT; ++i)
+        {
+            fprintf(f_out, i ? ",%s%u" : "%s%u", j ? "value" : "Col", i);
+        }
+        fprintf(f_out, "\n");
+    }
+    fclose(f_out);
+
+    jio_memory_file* csv_file;
+    res = jio_memory_file_create(ctx, "csv_test_header.csv", &csv_file, 0, 0, 0);
+    ASSERT(res == JIO_RESULT_SUCCESS);
+    jio_csv_data* data;
+    res = jio_parse_csv(ctx, csv_file, ",", true, true, &data);
+    ASSERT(res == JIO_RESULT_SUCCESS);
+
+    char name[32];
+    for (uint32_t i = 0; i < COLUMN_COUNT; ++i)
+    {
+        snprintf(name, sizeof(name), "Col%u", i);
+        ASSERT(column_idx(ctx, data, name) == i);
+    }
+    ASSERT(column_idx(ctx, data, "col12") == UINT32_MAX);
+    ASSERT(column_idx(ctx, data, "Col") == UINT32_MAX);
+
+    //  Case insensitive lookup
+    jio_csv_set_case_insensitive_headers(data, true);
+    ASSERT(column_idx(ctx, data, "col12") == 12);
+    ASSERT(column_idx(ctx, data, "COL4999") == 4999);
+    jio_csv_set_case_insensitive_headers(data, false);
+    ASSERT(column_idx(ctx, data, "col12") == UINT32_MAX);
+
+    //  Index follows column edits
+    res = jio_csv_remove_cols(ctx, data, 10, 5);
+    ASSERT(res == JIO_RESULT_SUCCESS);
+    ASSERT(column_idx(ctx, data, "Col12") == UINT32_MAX);
+    ASSERT(column_idx(ctx, data, "Col15") == 10);
+    ASSERT(column_idx(ctx, data, "Col4999") == COLUMN_COUNT - 6);
+
+    jio_string_segment elements[2] = {{.begin = "a", .len = 1}, {.begin = "b", .len = 1}};
+    const jio_csv_column new_column =
+            {
+                    .header = {.begin = "appended", .len = 8},
+                    .count = 1,
+                    .capacity = 2,
+                    .elements = elements,
+            };
+    res = jio_csv_add_cols_copy(ctx, data, UINT32_MAX, 1, &new_column);
+    ASSERT(res == JIO_RESULT_SUCCESS);
+    ASSERT(column_idx(ctx, data, "appended") == COLUMN_COUNT - 5);
+    ASSERT(column_idx(ctx, data, "Col0") == 0);
+    const jio_csv_column inserted = {.header = {.begin = "inserted", .len = 8}, .count = 1, .capacity = 2, .elements = elements};
+    res = jio_csv_add_cols_copy(ctx, data, 0, 1, &inserted);
+    ASSERT(res == JIO_RESULT_SUCCESS);
+    ASSERT(column_idx(ctx, data, "inserted") == 0);
+    ASSERT(column_idx(ctx, data, "Col0") == 1);
+    ASSERT(column_idx(ctx, data, "appended") == COLUMN_COUNT - 4);
+
+    //  Batch resolve
+    const jio_string_segment names[4] =
+            {
+                    {.begin = "Col3", .len = 4},
+                    {.begin = "missing", .len = 7},
+                    {.begin = "appended", .len = 8},
+                    {.begin = "Col20", .len = 5},
+            };
+    uint32_t indices[4];
+    res = jio_csv_resolve_columns(ctx, data, 4, names, indices);
+    ASSERT(res == JIO_RESULT_BAD_CSV_HEADER);
+    ASSERT(indices[0] == 4);
+    ASSERT(indices[1] == UINT32_MAX);
+    ASSERT(indices[2] == COLUMN_COUNT - 4);
+    ASSERT(indices[3] == 16);
+    res = jio_csv_resolve_columns(ctx, data, 1, names, indices);
+    ASSERT(res == JIO_RESULT_SUCCESS);
+
+    jio_csv_release(ctx, data);
+    jio_memory_file_destroy(csv_file);
+    jio_context_destroy(ctx);
+    return 0;
+}
@@ -0,0 +1,176 @@
+//
+// Created by jan on 19.10.2026.
+//
+#include "../../../include/jio/iocsv.h"
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include "../test_common.h"
+
+#define ROW_COUNT 40000
+#define GROUP_COUNT 100
+#define LOOKUP_COUNT 300
+
+//  Every row is found in the chain of its key, which contains only rows with the same key, in order
+static void check_index(const jio_csv_data* data, uint32_t column_index, jio_csv_index* index)
+{
+    const jio_csv_column* column;
+    ASSERT(jio_csv_get_column(data, column_index, &column) == JIO_RESULT_SUCCESS);
+    for (uint32_t i = 0; i < column->count; ++i)
+    {
+        uint32_t row;
+        ASSERT(jio_csv_index_find(index, column->elements[i], &row) == JIO_RESULT_SUCCESS);
+        bool found = false;
+        uint32_t previous = 0;
+        for (bool first = true; row != UINT32_MAX; row = jio_csv_index_next(index, row), first = false)
+        {
+            ASSERT(row < column->count && (first || row > previous));
+            ASSERT(segment_equal(column->elements + row, column->elements + i));
+            found = found || row == i;
+            previous = row;
+        }
+        ASSERT(found);
+    }
+}
+
+static void check_join(const jio_csv_data* left, uint32_t left_key, const jio_csv_data* right, uint32_t right_key, const jio_csv_join* join)
+{
+    const jio_csv_column* left_column, * right_column;
+    ASSERT(jio_csv_get_column(left, left_key, &left_column) == JIO_RESULT_SUCCESS);
+    ASSERT(jio_csv_get_column(right, right_key, &right_column) == JIO_RESULT_SUCCESS);
+    uint32_t pos = 0;
+    for (uint32_t i = 0; i < left_column->count; ++i)
+    {
+        for (uint32_t j = 0; j < right_column->count; ++j)
+        {
+            if (segment_equal(left_column->elements + i, right_column->elements + j))
+            {
+                ASSERT(pos < join->count);
+                ASSERT(join->left_rows[pos] == i && join->right_rows[pos] == j);
+                pos += 1;
+            }
+        }
+    }
+    ASSERT(pos == join->count);
+}
+
+int main()
+{
+    jio_context* ctx;
+    const jio_context_create_info create_info =
+            {
+                    .error_callbacks = NULL,
+                    .allocator_callbacks = NULL,
+                    .stack_allocator_callbacks = NULL,
+                    .thread_count = 4,
+            };
+    jio_result res = jio_context_create(&create_info, &ctx);
+    ASSERT(res == JIO_RESULT_SUCCESS);
+
+    srand(37);
+    FILE* f_out = fopen("csv_test_index.csv", "w");
+    ASSERT(f_out);
+    fprintf(f_out, "id,group,value\n");
+    for (unsigned i = 0; i < ROW_COUNT; ++i)
+    {
+        fprintf(f_out, "id-%u,g%u,%d\n", i * 7919 % ROW_COUNT, rand() % GROUP_COUNT, rand());
+    }
+    fclose(f_out);
+    f_out = fopen("csv_test_index_lookup.csv", "w");
+    ASSERT(f_out);
+    fprintf(f_out, "name,group\n");
+    for (unsigned i = 0; i < LOOKUP_COUNT; ++i)
+    {
+        fprintf(f_out, "name %u,g%u\n", i, rand() % (2 * GROUP_COUNT));
+    }
+    fclose(f_out);
+
+    jio_memory_file* csv_file, * lookup_file;
+    res = jio_memory_file_create(ctx, "csv_test_index.csv", &csv_file, 0, 0, 0);
+    ASSERT(res == JIO_RESULT_SUCCESS);
+    res = jio_memory_file_create(ctx, "csv_test_index_lookup.csv", &lookup_file, 0, 0, 0);
+    ASSERT(res == JIO_RESULT_SUCCESS);
+    jio_csv_data* data, * lookup;
+    res = jio_parse_csv(ctx, csv_file, ",", false, true, &data);
+    ASSERT(res == JIO_RESULT_SUCCESS);
+    res = jio_parse_csv(ctx, lookup_file, ",", false, true, &lookup);
+    ASSERT(res == JIO_RESULT_SUCCESS);
+
+    jio_csv_index* id_index, * group_index;
+    ASSERT(jio_csv_index_create(ctx, data, 3, &id_index) == JIO_RESULT_BAD_INDEX);
+    ASSERT(jio_csv_index_create(ctx, data, 0, &id_index) == JIO_RESULT_SUCCESS);
+    ASSERT(jio_csv_index_create(ctx, data, 1, &group_index) == JIO_RESULT_SUCCESS);
+    check_index(data, 0, id_index);
+    check_index(data, 1, group_index);
+    uint32_t row;
+    ASSERT(jio_csv_index_find(id_index, segment("id-7919"), &row) == JIO_RESULT_SUCCESS && row == 1);
+    ASSERT(jio_csv_index_next(id_index, row) == UINT32_MAX);
+    ASSERT(jio_csv_index_find(id_index, segment("id-40000"), &row) == JIO_RESULT_SUCCESS && row == UINT32_MAX);
+    ASSERT(jio_csv_index_find(group_index, segment("g"), &row) == JIO_RESULT_SUCCESS && row == UINT32_MAX);
+
+    //  Appended rows are added to the index
+    const jio_string_segment new_row[3] = {segment("id-40000"), segment("g0"), segment("1")};
+    const jio_string_segment* const new_rows[2] = {new_row, new_row};
+    ASSERT(jio_csv_add_rows(ctx, data, UINT32_MAX, 2, new_rows) == JIO_RESULT_SUCCESS);
+    ASSERT(jio_csv_index_find(id_index, segment("id-40000"), &row) == JIO_RESULT_SUCCESS && row == ROW_COUNT);
+    ASSERT(jio_csv_index_next(id_index, row) == ROW_COUNT + 1);
+    check_index(data, 1, group_index);
+
+    //  Other changes cause the index to be rebuilt
+    ASSERT(jio_csv_add_rows(ctx, data, 0, 1, new_rows) == JIO_RESULT_SUCCESS);
+    ASSERT(jio_csv_index_find(id_index, segment("id-40000"), &row) == JIO_RESULT_SUCCESS && row == 0);
+    ASSERT(jio_csv_remove_rows(ctx, data, 0, 1) == JIO_RESULT_SUCCESS);
+    ASSERT(jio_csv_index_find(id_index, segment("id-40000"), &row) == JIO_RESULT_SUCCESS && row == ROW_COUNT);
+    ASSERT(jio_csv_set_cell(ctx, data, 0, 5, segment("changed")) == JIO_RESULT_SUCCESS);
+    ASSERT(jio_csv_index_find(id_index, segment("changed"), &row) == JIO_RESULT_SUCCESS && row == 5);
+    const jio_csv_sort_key key = {.column = 1};
+    ASSERT(jio_csv_sort(ctx, data, 1, &key) == JIO_RESULT_SUCCESS);
+    check_index(data, 0, id_index);
+    check_index(data, 1, group_index);
+
+    //  Key columns follow columns which are moved
+    const jio_csv_column* value_column;
+    ASSERT(jio_csv_get_column(data, 2, &value_column) == JIO_RESULT_SUCCESS);
+    jio_csv_column extra = *value_column;
+    extra.elements = malloc(sizeof(*extra.elements) * extra.count);
+    ASSERT(extra.elements);
+    memcpy(extra.elements, value_column->elements, sizeof(*extra.elements) * extra.count);
+    extra.capacity = extra.count;
+    ASSERT(jio_csv_add_cols(ctx, data, 0, 1, &extra) == JIO_RESULT_SUCCESS);
+    check_index(data, 1, id_index);
+    check_index(data, 2, group_index);
+    ASSERT(jio_csv_remove_cols(ctx, data, 1, 1) == JIO_RESULT_SUCCESS);
+    ASSERT(jio_csv_index_find(id_index, segment("changed"), &row) == JIO_RESULT_BAD_CSV_COLUMN);
+    check_index(data, 1, group_index);
+    jio_csv_index_destroy(id_index);
+
+    //  Join through the existing index, then through a temporary one
+    jio_csv_join join;
+    ASSERT(jio_csv_hash_join(ctx, lookup, 1, data, 1, &join) == JIO_RESULT_SUCCESS);
+    check_join(lookup, 1, data, 1, &join);
+    ASSERT(join.count > 0);
+    jio_csv_join_release(ctx, &join);
+    ASSERT(jio_csv_hash_join(ctx, data, 1, lookup, 1, &join) == JIO_RESULT_SUCCESS);
+    check_join(data, 1, lookup, 1, &join);
+    jio_csv_join_release(ctx, &join);
+    ASSERT(jio_csv_hash_join(ctx, data, 1, lookup, 0, &join) == JIO_RESULT_SUCCESS);
+    ASSERT(join.count == 0);
+    jio_csv_join_release(ctx, &join);
+    ASSERT(jio_csv_hash_join(ctx, data, 3, lookup, 0, &join) == JIO_RESULT_BAD_INDEX);
+
+    //  Stale index is not used by the join, which builds a temporary one instead
+    ASSERT(jio_csv_set_cell(ctx, data, 1, 3, segment("g1")) == JIO_RESULT_SUCCESS);
+    ASSERT(jio_csv_hash_join(ctx, lookup, 1, data, 1, &join) == JIO_RESULT_SUCCESS);
+    check_join(lookup, 1, data, 1, &join);
+    jio_csv_join_release(ctx, &join);
+    check_index(data, 1, group_index);
+
+    //  Remaining index is destroyed with the data
+    jio_csv_release(ctx, lookup);
+    jio_csv_release(ctx, data);
+    jio_memory_file_destroy(lookup_file);
+    jio_memory_file_destroy(csv_file);
+
+    jio_context_destroy(ctx);
+    return 0;
+}
@@ -0,0 +1,161 @@
+//
+// Created by jan on 19.10.2026.
+//
+#include "../../../include/jio/iocsv.h"
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include "../test_common.h"
+
+#define ROW_COUNT 40000
+
+static void compare_columns(const jio_csv_column* c1, const jio_csv_column* c2)
+{
+    ASSERT(c1->count == c2->count);
+    ASSERT(c1->header.len == c2->header.len && memcmp(c1->header.begin, c2->header.begin, c1->header.len) == 0);
+    for (uint32_t i = 0; i < c1->count; ++i)
+    {
+        ASSERT(c1->elements[i].begin == c2->elements[i].begin);
+        ASSERT(c1->elements[i].len == c2->elements[i].len);
+    }
+}
+
+int main()
+{
+    jio_context* ctx;
+    const jio_context_create_info create_info =
+            {
+                    .error_callbacks = NULL,
+                    .allocator_callbacks = NULL,
+                    .stack_allocator_callbacks = NULL,
+                    .thread_count = 4,
+            };
+    jio_result res = jio_context_create(&create_info, &ctx);
+    ASSERT(res == JIO_RESULT_SUCCESS);
+
+    FILE* f_out = fopen("csv_test_lazy.csv", "w");
+    ASSERT(f_out);
+    fprintf(f_out, "id, name , value,flag\n");
+    for (unsigned i = 0; i < ROW_COUNT; ++i)
+    {
+        fprintf(f_out, "%u, row%u ,%u.%u,%s\n", i, i, i * 7, i % 10, i % 3 ? "no" : " yes");
+    }
+    fclose(f_out);
+
+    jio_memory_file* csv_file;
+    res = jio_memory_file_create(ctx, "csv_test_lazy.csv", &csv_file, 0, 0, 0);
+    ASSERT(res == JIO_RESULT_SUCCESS);
+
+    jio_csv_data* eager_data, *lazy_data;
+    res = jio_parse_csv(ctx, csv_file, ",", true, true, &eager_data);
+    ASSERT(res == JIO_RESULT_SUCCESS);
+    jio_csv_parse_info parse_info =
+            {
+                    .separator = ",",
+                    .trim_whitespace = true,
+                    .has_headers = true,
+                    .lazy = true,
+            };
+    res = jio_parse_csv_ex(ctx, csv_file, &parse_info, &lazy_data);
+    ASSERT(res == JIO_RESULT_SUCCESS);
+
+    uint32_t rows, cols;
+    jio_csv_shape(lazy_data, &rows, &cols);
+    ASSERT(rows == ROW_COUNT);
+    ASSERT(cols == 4);
+
+    //  Test columns are parsed the same way as by eager parsing
+    const jio_csv_column* p_eager, *p_lazy;
+    res = jio_csv_get_column_by_name(ctx, lazy_data, "name", &p_lazy);
+    ASSERT(res == JIO_RESULT_SUCCESS);
+    res = jio_csv_get_column(eager_data, 1, &p_eager);
+    ASSERT(res == JIO_RESULT_SUCCESS);
+    compare_columns(p_eager, p_lazy);
+    ASSERT(p_lazy->elements[12345].len == 8 && memcmp(p_lazy->elements[12345].begin, "row12345", 8) == 0);
+
+    //  Test editing, which parses the remaining columns
+    res = jio_csv_remove_rows(ctx, lazy_data, 0, 10);
+    ASSERT(res == JIO_RESULT_SUCCESS);
+    res = jio_csv_remove_rows(ctx, eager_data, 0, 10);
+    ASSERT(res == JIO_RESULT_SUCCESS);
+    for (uint32_t i = 0; i < cols; ++i)
+    {
+        res = jio_csv_get_column(eager_data, i, &p_eager);
+        ASSERT(res == JIO_RESULT_SUCCESS);
+        res = jio_csv_get_column(lazy_data, i, &p_lazy);
+        ASSERT(res == JIO_RESULT_SUCCESS);
+        compare_columns(p_eager, p_lazy);
+    }
+    jio_csv_release(ctx, lazy_data);
+
+    //  Test lazy parsing with selection and filters
+    const uint32_t selected[2] = {3, 0};
+    const jio_csv_filter filter = {.type = JIO_CSV_FILTER_EQUALS, .column = 3, .value = {.begin = "yes", .len = 3}};
+    parse_info.selected_count = 2;
+    parse_info.selected_indices = selected;
+    parse_info.filter_count = 1;
+    parse_info.filters = &filter;
+    res = jio_parse_csv_ex(ctx, csv_file, &parse_info, &lazy_data);
+    ASSERT(res == JIO_RESULT_SUCCESS);
+    jio_csv_shape(lazy_data, &rows, &cols);
+    ASSERT(rows == (ROW_COUNT + 2) / 3);
+    ASSERT(cols == 2);
+    res = jio_csv_get_column(lazy_data, 1, &p_lazy);
+    ASSERT(res == JIO_RESULT_SUCCESS);
+    ASSERT(p_lazy->header.len == 2 && memcmp(p_lazy->header.begin, "id", 2) == 0);
+    ASSERT(p_lazy->elements[2].len == 1 && p_lazy->elements[2].begin[0] == '6');
+    jio_csv_release(ctx, lazy_data);
+
+    //  Test compact parsing, both eager and lazy
+    jio_csv_data* compact_data;
+    parse_info = (jio_csv_parse_info)
+            {
+                    .separator = ",",
+                    .trim_whitespace = true,
+                    .has_headers = true,
+                    .compact = true,
+            };
+    for (unsigned k = 0; k < 2; ++k)
+    {
+        parse_info.lazy = (k == 1);
+        res = jio_parse_csv_ex(ctx, csv_file, &parse_info, &compact_data);
+        ASSERT(res == JIO_RESULT_SUCCESS);
+        {
+            jio_csv_compact_column compact_column;
+            res = jio_csv_get_compact_column(compact_data, 2, &compact_column);
+            ASSERT(res == JIO_RESULT_SUCCESS);
+            ASSERT(compact_column.count == ROW_COUNT);
+            const jio_string_segment segment = jio_csv_compact_cell_segment(&compact_column, 4);
+            ASSERT(segment.len == 4 && memcmp(segment.begin, "28.4", 4) == 0);
+            jio_string_segment expanded[8];
+            jio_csv_compact_expand(&compact_column, 100, 8, expanded);
+            ASSERT(expanded[0].len == 5 && memcmp(expanded[0].begin, "700.0", 5) == 0);
+
+            res = jio_csv_get_column(compact_data, 2, &p_lazy);
+            ASSERT(res == JIO_RESULT_SUCCESS);
+            ASSERT(p_lazy->elements[100].begin == expanded[0].begin);
+            ASSERT(p_lazy->elements[107].len == expanded[7].len);
+        }
+        res = jio_csv_remove_rows(ctx, compact_data, 0, 10);
+        ASSERT(res == JIO_RESULT_SUCCESS);
+        for (uint32_t i = 0; i < 4; ++i)
+        {
+            res = jio_csv_get_column(eager_data, i, &p_eager);
+            ASSERT(res == JIO_RESULT_SUCCESS);
+            res = jio_csv_get_column(compact_data, i, &p_lazy);
+            ASSERT(res == JIO_RESULT_SUCCESS);
+            compare_columns(p_eager, p_lazy);
+        }
+        jio_csv_release(ctx, compact_data);
+    }
+
+    //  Test the incorrect version
+    jio_csv_compact_column compact_column;
+    res = jio_csv_get_compact_column(eager_data, 0, &compact_column);
+    ASSERT(res == JIO_RESULT_BAD_VALUE);
+
+    jio_csv_release(ctx, eager_data);
+    jio_memory_file_destroy(csv_file);
+    jio_context_destroy(ctx);
+    return 0;
+}
@@ -0,0 +1,186 @@
+//
+// Created by jan on 19.10.2026.
+//
+#include "../../../include/jio/iocsv.h"
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include "../test_common.h"
+
+#define ROW_COUNT 20000
+
+static void check_same(const jio_csv_data* a, const jio_csv_data* b)
+{
+    uint32_t rows_a, cols_a, rows_b, cols_b;
+    jio_csv_shape(a, &rows_a, &cols_a);
+    jio_csv_shape(b, &rows_b, &cols_b);
+    ASSERT(rows_a == rows_b && cols_a == cols_b);
+    for (uint32_t i = 0; i < cols_a; ++i)
+    {
+        const jio_csv_column* col_a, * col_b;
+        ASSERT(jio_csv_get_column(a, i, &col_a) == JIO_RESULT_SUCCESS);
+        ASSERT(jio_csv_get_column(b, i, &col_b) == JIO_RESULT_SUCCESS);
+        ASSERT(segment_equal(&col_a->header, &col_b->header));
+        for (uint32_t j = 0; j < rows_a; ++j)
+        {
+            ASSERT(segment_equal(col_a->elements + j, col_b->elements + j));
+        }
+    }
+}
+
+//  Parses the file in steps with the given budgets, returning the number of steps taken
+static uint32_t parse_in_steps(
+        jio_context* ctx, const jio_memory_file* file, const jio_csv_parse_info* info, size_t byte_budget,
+        uint32_t row_budget, jio_csv_data** pp_csv)
+{
+    jio_csv_parser* parser;
+    jio_result res = jio_csv_parser_create(ctx, file, info, &parser);
+    ASSERT(res == JIO_RESULT_SUCCESS);
+    uint32_t steps = 0;
+    size_t last_offset = 0;
+    uint32_t last_rows = 0;
+    bool done = false;
+    while (!done)
+    {
+        res = jio_csv_parser_step(parser, byte_budget, row_budget, &done);
+        ASSERT(res == JIO_RESULT_SUCCESS);
+        steps += 1;
+        size_t offset;
+        uint32_t rows;
+        jio_csv_parser_progress(parser, &offset, &rows);
+        ASSERT(offset > last_offset);
+        ASSERT(rows >= last_rows);
+        if (row_budget)
+        {
+            ASSERT(rows - last_rows <= row_budget);
+        }
+        last_offset = offset;
+        last_rows = rows;
+    }
+    //  Parsing ends at the end of the file, not the end of its mapping
+    ASSERT(last_offset == strlen(jio_memory_file_get_info(file).memory));
+    res = jio_csv_parser_finish(parser, pp_csv);
+    ASSERT(res == JIO_RESULT_SUCCESS);
+    return steps;
+}
+
+static bool reject_odd(uint32_t column_count, const jio_string_segment* row, void* param)
+{
+    (void)column_count;
+    (void)param;
+    //  Id is the second selected column
+    return (row[1].begin[row[1].len - 1] - '0') % 2 == 0;
+}
+
+int main()
+{
+    jio_context* ctx;
+    const jio_context_create_info create_info =
+            {
+                    .error_callbacks = NULL,
+                    .allocator_callbacks = NULL,
+                    .stack_allocator_callbacks = NULL,
+                    .thread_count = 4,
+            };
+    jio_result res = jio_context_create(&create_info, &ctx);
+    ASSERT(res == JIO_RESULT_SUCCESS);
+
+    srand(5);
+    FILE* f_out = fopen("csv_test_parser.csv", "w");
+    ASSERT(f_out);
+    fprintf(f_out, "id, name ,value\n");
+    for (unsigned i = 0; i < ROW_COUNT; ++i)
+    {
+        fprintf(f_out, "%u, name_%u ,%d\n", i, rand() % 100, rand() % 10000 - 5000);
+    }
+    fclose(f_out);
+
+    jio_memory_file* csv_file;
+    res = jio_memory_file_create(ctx, "csv_test_parser.csv", &csv_file, 0, 0, 0);
+    ASSERT(res == JIO_RESULT_SUCCESS);
+
+    jio_csv_parse_info info =
+            {
+                    .separator = ",",
+                    .trim_whitespace = true,
+                    .has_headers = true,
+            };
+    jio_csv_data* expected, * data;
+    res = jio_parse_csv_ex(ctx, csv_file, &info, &expected);
+    ASSERT(res == JIO_RESULT_SUCCESS);
+
+    ASSERT(parse_in_steps(ctx, csv_file, &info, 4096, 0, &data) > 10);
+    check_same(expected, data);
+    jio_csv_release(ctx, data);
+    ASSERT(parse_in_steps(ctx, csv_file, &info, 0, 777, &data) == (ROW_COUNT + 776) / 777);
+    check_same(expected, data);
+    jio_csv_release(ctx, data);
+    ASSERT(parse_in_steps(ctx, csv_file, &info, 0, 0, &data) == 1);
+    check_same(expected, data);
+    jio_csv_release(ctx, data);
+
+    //  Compact data, which is finished before it was completely parsed
+    info.compact = true;
+    jio_csv_parser* parser;
+    res = jio_csv_parser_create(ctx, csv_file, &info, &parser);
+    ASSERT(res == JIO_RESULT_SUCCESS);
+    bool done;
+    res = jio_csv_parser_step(parser, 0, 100, &done);
+    ASSERT(res == JIO_RESULT_SUCCESS && !done);
+    res = jio_csv_parser_finish(parser, &data);
+    ASSERT(res == JIO_RESULT_SUCCESS);
+    check_same(expected, data);
+    jio_csv_release(ctx, data);
+    jio_csv_release(ctx, expected);
+
+    //  Selection and filters
+    const uint32_t selected[2] = {2, 0};
+    info = (jio_csv_parse_info)
+            {
+                    .separator = ",",
+                    .trim_whitespace = true,
+                    .has_headers = true,
+                    .selected_count = 2,
+                    .selected_indices = selected,
+                    .row_filter = reject_odd,
+            };
+    res = jio_parse_csv_ex(ctx, csv_file, &info, &expected);
+    ASSERT(res == JIO_RESULT_SUCCESS);
+    parse_in_steps(ctx, csv_file, &info, 1000, 50, &data);
+    check_same(expected, data);
+    uint32_t rows;
+    jio_csv_shape(data, &rows, NULL);
+    ASSERT(rows == ROW_COUNT / 2);
+    jio_csv_release(ctx, data);
+    jio_csv_release(ctx, expected);
+
+    //  Lazy parsing is not done in steps
+    info.lazy = true;
+    res = jio_csv_parser_create(ctx, csv_file, &info, &parser);
+    ASSERT(res == JIO_RESULT_BAD_VALUE);
+    jio_memory_file_destroy(csv_file);
+
+    //  Errors stop the parser
+    f_out = fopen("csv_test_parser.csv", "w");
+    ASSERT(f_out);
+    fprintf(f_out, "a,b\n1,2\n3,4\n5 6\n7,8\n");
+    fclose(f_out);
+    res = jio_memory_file_create(ctx, "csv_test_parser.csv", &csv_file, 0, 0, 0);
+    ASSERT(res == JIO_RESULT_SUCCESS);
+    info = (jio_csv_parse_info){.separator = ",", .has_headers = true};
+    res = jio_csv_parser_create(ctx, csv_file, &info, &parser);
+    ASSERT(res == JIO_RESULT_SUCCESS);
+    res = jio_csv_parser_step(parser, 0, 2, &done);
+    ASSERT(res == JIO_RESULT_SUCCESS && !done);
+    jio_csv_parser_progress(parser, NULL, &rows);
+    ASSERT(rows == 2);
+    res = jio_csv_parser_step(parser, 0, 2, &done);
+    ASSERT(res == JIO_RESULT_BAD_CSV_FORMAT);
+    res = jio_csv_parser_step(parser, 0, 2, &done);
+    ASSERT(res == JIO_RESULT_BAD_CSV_FORMAT);
+    jio_csv_parser_destroy(parser);
+
+    jio_memory_file_destroy(csv_file);
+    jio_context_destroy(ctx);
+    return 0;
+}
@@ -0,0 +1,64 @@
+//
+// Created by jan on 19.10.2026.
+//
+#include "../../../include/jio/iocsv.h"
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include "../test_common.h"
+
+#define ROW_COUNT 20000
+
+int main()
+{
+    jio_context* serial_ctx, * parallel_ctx;
+    jio_context_create_info create_info =
+            {
+                    .error_callbacks = NULL,
+                    .allocator_callbacks = NULL,
+                    .stack_allocator_callbacks = NULL,
+            };
+    jio_result res = jio_context_create(&create_info, &serial_ctx);
+    ASSERT(res == JIO_RESULT_SUCCESS);
+    create_info.thread_count = 4;
+    res = jio_context_create(&create_info, &parallel_ctx);
+    ASSERT(res == JIO_RESULT_SUCCESS);
+
+    FILE* f_out = fopen("csv_test_print.csv", "w");
+    ASSERT(f_out);
+    fprintf(f_out, "id,name,value\n");
+    for (unsigned i = 0; i < ROW_COUNT; ++i)
+    {
+        fprintf(f_out, "%u,%.*s,%u\n", i, (int)(i % 13), "abcdefghijklmnopqrstuvwxyz", i * 17);
+    }
+    fclose(f_out);
+
+    jio_memory_file* csv_file;
+    res = jio_memory_file_create(serial_ctx, "csv_test_print.csv", &csv_file, 0, 0, 0);
+    ASSERT(res == JIO_RESULT_SUCCESS);
+    jio_csv_data* serial_data, * parallel_data;
+    res = jio_parse_csv(serial_ctx, csv_file, ",", true, true, &serial_data);
+    ASSERT(res == JIO_RESULT_SUCCESS);
+    res = jio_parse_csv(parallel_ctx, csv_file, ",", true, true, &parallel_data);
+    ASSERT(res == JIO_RESULT_SUCCESS);
+
+    for (unsigned i = 0; i < 4; ++i)
+    {
+        const bool same_width = i & 1;
+        const bool align_left = (i >> 1) & 1;
+        size_t serial_usage, parallel_usage;
+        char* const serial = print_data(serial_data, "; ", same_width, align_left, &serial_usage);
+        char* const parallel = print_data(parallel_data, "; ", same_width, align_left, &parallel_usage);
+        ASSERT(serial_usage == parallel_usage);
+        ASSERT(memcmp(serial, parallel, serial_usage + 1) == 0);
+        free(serial);
+        free(parallel);
+    }
+
+    jio_csv_release(serial_ctx, serial_data);
+    jio_csv_release(parallel_ctx, parallel_data);
+    jio_memory_file_destroy(csv_file);
+    jio_context_destroy(parallel_ctx);
+    jio_context_destroy(serial_ctx);
+    return 0;
+}
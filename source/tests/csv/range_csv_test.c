@@ -0,0 +1,142 @@
+//
+// Created by jan on 19.10.2026.
+//
+#include "../../../include/jio/iocsv.h"
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include "../test_common.h"
+
+#define ROW_COUNT 5000
+
+//  Parses the file split at the given offsets and checks that the parts together give the same rows as the whole file
+static void check_split(
+        jio_context* ctx, const jio_memory_file* file, const jio_csv_parse_info* info, const jio_csv_data* expected,
+        uint32_t split_count, const size_t* splits)
+{
+    uint32_t expected_rows, column_count;
+    jio_csv_shape(expected, &expected_rows, &column_count);
+    uint32_t row = 0;
+    for (uint32_t i = 0; i <= split_count; ++i)
+    {
+        const size_t begin = i ? splits[i - 1] : 0;
+        const size_t end = i < split_count ? splits[i] : SIZE_MAX;
+        jio_csv_data* part;
+        jio_result res = jio_parse_csv_range(ctx, file, begin, end, info, &part);
+        ASSERT(res == JIO_RESULT_SUCCESS);
+        uint32_t rows, cols;
+        jio_csv_shape(part, &rows, &cols);
+        ASSERT(cols == column_count);
+        ASSERT(row + rows <= expected_rows);
+        for (uint32_t j = 0; j < cols; ++j)
+        {
+            const jio_csv_column* expected_column, * column;
+            ASSERT(jio_csv_get_column(expected, j, &expected_column) == JIO_RESULT_SUCCESS);
+            ASSERT(jio_csv_get_column(part, j, &column) == JIO_RESULT_SUCCESS);
+            ASSERT(segment_equal(&expected_column->header, &column->header));
+            for (uint32_t k = 0; k < rows; ++k)
+            {
+                ASSERT(segment_equal(expected_column->elements + row + k, column->elements + k));
+            }
+        }
+        row += rows;
+        jio_csv_release(ctx, part);
+    }
+    ASSERT(row == expected_rows);
+}
+
+int main()
+{
+    jio_context* ctx;
+    const jio_context_create_info create_info =
+            {
+                    .error_callbacks = NULL,
+                    .allocator_callbacks = NULL,
+                    .stack_allocator_callbacks = NULL,
+                    .thread_count = 2,
+            };
+    jio_result res = jio_context_create(&create_info, &ctx);
+    ASSERT(res == JIO_RESULT_SUCCESS);
+
+    srand(23);
+    size_t row_offsets[ROW_COUNT];
+    FILE* f_out = fopen("csv_test_range.csv", "w");
+    ASSERT(f_out);
+    fprintf(f_out, "id,text,value\n");
+    for (unsigned i = 0; i < ROW_COUNT; ++i)
+    {
+        row_offsets[i] = (size_t)ftell(f_out);
+        fprintf(f_out, "%u,%.*s,%d\n", i, rand() % 40 + 1, "abcdefghijklmnopqrstuvwxyzABCDEFGHIJKLMNOPQRSTUVWXYZ", rand() % 1000);
+    }
+    const size_t file_size = (size_t)ftell(f_out);
+    fclose(f_out);
+
+    jio_memory_file* file;
+    res = jio_memory_file_create(ctx, "csv_test_range.csv", &file, 0, 0, 0);
+    ASSERT(res == JIO_RESULT_SUCCESS);
+    jio_csv_parse_info info = {.separator = ",", .has_headers = true};
+    jio_csv_data* expected;
+    res = jio_parse_csv_ex(ctx, file, &info, &expected);
+    ASSERT(res == JIO_RESULT_SUCCESS);
+
+    //  Even splits
+    size_t splits[64];
+    for (uint32_t n = 1; n <= 64; n *= 4)
+    {
+        for (uint32_t i = 0; i < n - 1; ++i)
+        {
+            splits[i] = file_size * (i + 1) / n;
+        }
+        check_split(ctx, file, &info, expected, n - 1, splits);
+    }
+
+    //  Splits exactly on rows, inside and right after the header, and empty parts
+    splits[0] = 3;
+    splits[1] = row_offsets[0];
+    splits[2] = row_offsets[0];
+    splits[3] = row_offsets[10];
+    splits[4] = row_offsets[10] + 1;
+    splits[5] = row_offsets[11];
+    splits[6] = row_offsets[ROW_COUNT - 1];
+    splits[7] = file_size;
+    splits[8] = file_size + 100;
+    check_split(ctx, file, &info, expected, 9, splits);
+    jio_csv_data* part;
+    res = jio_parse_csv_range(ctx, file, row_offsets[10], row_offsets[11], &info, &part);
+    ASSERT(res == JIO_RESULT_SUCCESS);
+    uint32_t rows;
+    jio_csv_shape(part, &rows, NULL);
+    ASSERT(rows == 1);
+    jio_csv_release(ctx, part);
+    res = jio_parse_csv_range(ctx, file, 10, 5, &info, &part);
+    ASSERT(res == JIO_RESULT_BAD_INDEX);
+
+    //  Random splits, with lazy and compact parsing, and without headers
+    for (uint32_t i = 0; i < 16; ++i)
+    {
+        splits[i] = (size_t)rand() % file_size;
+        for (uint32_t j = i; j > 0 && splits[j - 1] > splits[j]; --j)
+        {
+            const size_t tmp = splits[j];
+            splits[j] = splits[j - 1];
+            splits[j - 1] = tmp;
+        }
+    }
+    check_split(ctx, file, &info, expected, 16, splits);
+    info.lazy = true;
+    check_split(ctx, file, &info, expected, 16, splits);
+    info.lazy = false;
+    info.compact = true;
+    check_split(ctx, file, &info, expected, 16, splits);
+    jio_csv_release(ctx, expected);
+
+    info = (jio_csv_parse_info){.separator = ",", .has_headers = false};
+    res = jio_parse_csv_ex(ctx, file, &info, &expected);
+    ASSERT(res == JIO_RESULT_SUCCESS);
+    check_split(ctx, file, &info, expected, 16, splits);
+    jio_csv_release(ctx, expected);
+
+    jio_memory_file_destroy(file);
+    jio_context_destroy(ctx);
+    return 0;
+}
@@ -0,0 +1,149 @@
+//
+// Created by jan on 19.10.2026.
+//
+#include "../../../include/jio/iocsv_schema.h"
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include "../test_common.h"
+
+#define ROW_COUNT 10000
+
+#define MEASUREMENT_COLUMNS(X) X(id, UINT) X(station, STRING) X(offset, INT) X(temperature, FLOAT)
+JIO_CSV_DEFINE_SCHEMA(measurement, ';', MEASUREMENT_COLUMNS)
+
+#define PAIR_COLUMNS(X) X(key, STRING) X(value, INT)
+JIO_CSV_DEFINE_SCHEMA(pair, ',', PAIR_COLUMNS)
+
+//  Last error reported through the context, and the function which reported it
+static char last_error[512];
+static char last_function[64];
+
+static void capture_error(void* state, const char* msg, const char* file, int line, const char* function)
+{
+    (void)state;
+    (void)file;
+    (void)line;
+    (void)snprintf(last_error, sizeof(last_error), "%s", msg);
+    (void)snprintf(last_function, sizeof(last_function), "%s", function);
+}
+
+static void write_file(const char* text)
+{
+    FILE* const f_out = fopen("csv_test_schema.csv", "w");
+    ASSERT(f_out);
+    fputs(text, f_out);
+    fclose(f_out);
+}
+
+//  Parses a file of pairs, returning the result and the number of parsed rows. Keys point into the file, so they can
+//  not be read after this returns.
+static jio_result parse_pairs(jio_context* ctx, const char* text, bool has_headers, uint32_t* p_count, pair* rows)
+{
+    write_file(text);
+    jio_memory_file* file;
+    jio_result res = jio_memory_file_create(ctx, "csv_test_schema.csv", &file, 0, 0, 0);
+    ASSERT(res == JIO_RESULT_SUCCESS);
+    res = pair_parse(ctx, file, has_headers, 4, rows, p_count);
+    jio_memory_file_destroy(file);
+    return res;
+}
+
+int main()
+{
+    jio_context* ctx;
+    const jio_error_callbacks error_callbacks = {.report = capture_error, .state = NULL};
+    const jio_context_create_info create_info =
+            {
+                    .error_callbacks = &error_callbacks,
+                    .allocator_callbacks = NULL,
+                    .stack_allocator_callbacks = NULL,
+                    .thread_count = 1,
+            };
+    jio_result res = jio_context_create(&create_info, &ctx);
+    ASSERT(res == JIO_RESULT_SUCCESS);
+    ASSERT(measurement_column_count == 4 && pair_column_count == 2);
+
+    srand(3);
+    int offsets[ROW_COUNT];
+    int temperatures[ROW_COUNT];
+    FILE* f_out = fopen("csv_test_schema.csv", "w");
+    ASSERT(f_out);
+    fprintf(f_out, "id;station;offset;temperature\n");
+    for (unsigned i = 0; i < ROW_COUNT; ++i)
+    {
+        offsets[i] = rand() - RAND_MAX / 2;
+        temperatures[i] = rand() % 1000 - 500;
+        fprintf(f_out, "%u;station %u;%d;%g\n", i, i % 17, offsets[i], (double)temperatures[i] / 4.0);
+        if (i % 1000 == 0)
+        {
+            fprintf(f_out, "\n");
+        }
+    }
+    fclose(f_out);
+
+    jio_memory_file* file;
+    res = jio_memory_file_create(ctx, "csv_test_schema.csv", &file, 0, 0, 0);
+    ASSERT(res == JIO_RESULT_SUCCESS);
+    const uint32_t capacity = jio_memory_file_count_non_empty_lines(file);
+    ASSERT(capacity >= ROW_COUNT);
+    measurement* const rows = malloc(sizeof(*rows) * capacity);
+    ASSERT(rows);
+    uint32_t count;
+    res = measurement_parse(ctx, file, true, capacity, rows, &count);
+    ASSERT(res == JIO_RESULT_SUCCESS);
+    ASSERT(count == ROW_COUNT);
+    for (uint32_t i = 0; i < ROW_COUNT; ++i)
+    {
+        char buffer[32];
+        const int len = sprintf(buffer, "station %u", i % 17);
+        ASSERT(rows[i].id == i);
+        ASSERT(rows[i].station.len == (size_t)len && memcmp(rows[i].station.begin, buffer, len) == 0);
+        ASSERT(rows[i].offset == offsets[i]);
+        ASSERT(rows[i].temperature == (double)temperatures[i] / 4.0);
+    }
+
+    //  Headers are checked only if there are any
+    res = measurement_parse(ctx, file, false, capacity, rows, &count);
+    ASSERT(res == JIO_RESULT_BAD_VALUE);
+    ASSERT(count == 0);
+
+    //  Too little space
+    res = measurement_parse(ctx, file, true, 100, rows, &count);
+    ASSERT(res == JIO_RESULT_BAD_ALLOC);
+    ASSERT(count == 100);
+    ASSERT(strstr(last_error, "Row 101 ") && strcmp(last_function, "measurement_parse") == 0);
+    free(rows);
+    jio_memory_file_destroy(file);
+
+    pair pairs[4];
+    res = parse_pairs(ctx, "key,value\na,-9223372036854775808\nb,9223372036854775807", true, &count, pairs);
+    ASSERT(res == JIO_RESULT_SUCCESS && count == 2);
+    ASSERT(pairs[0].value == INT64_MIN && pairs[1].value == INT64_MAX);
+    ASSERT(pairs[0].key.len == 1 && pairs[1].key.len == 1);
+    res = parse_pairs(ctx, "a,1\nb,9223372036854775808\n", false, &count, pairs);
+    ASSERT(res == JIO_RESULT_BAD_VALUE && count == 1);
+    //  Failures give the row, the column and the byte offset
+    ASSERT(strstr(last_error, "row 2 ") && strstr(last_error, "column \"value\"") && strstr(last_error, "byte 6)"));
+    ASSERT(strcmp(last_function, "pair_parse") == 0);
+    res = parse_pairs(ctx, "key,values\na,1\n", true, &count, pairs);
+    ASSERT(res == JIO_RESULT_BAD_CSV_HEADER && count == 0);
+    ASSERT(strstr(last_error, "headers") && strstr(last_error, "column \"value\""));
+    res = parse_pairs(ctx, "key,value,extra\na,1\n", true, &count, pairs);
+    ASSERT(res == JIO_RESULT_BAD_CSV_HEADER);
+    res = parse_pairs(ctx, "key\na,1\n", true, &count, pairs);
+    ASSERT(res == JIO_RESULT_BAD_CSV_HEADER);
+    res = parse_pairs(ctx, "a,1\nb\nc,3\n", false, &count, pairs);
+    ASSERT(res == JIO_RESULT_BAD_CSV_FORMAT && count == 1);
+    res = parse_pairs(ctx, "a,1\nb,2,3\n", false, &count, pairs);
+    ASSERT(res == JIO_RESULT_BAD_CSV_FORMAT && count == 1);
+    ASSERT(strstr(last_error, "row 2 ") && strstr(last_error, "after its last column"));
+    res = parse_pairs(ctx, ",1\n,2\n", false, &count, pairs);
+    ASSERT(res == JIO_RESULT_SUCCESS && count == 2);
+    ASSERT(pairs[0].key.len == 0 && pairs[1].value == 2);
+    res = parse_pairs(ctx, "a,\n", false, &count, pairs);
+    ASSERT(res == JIO_RESULT_BAD_VALUE && count == 0);
+
+    jio_context_destroy(ctx);
+    return 0;
+}
@@ -4,6 +4,7 @@
 #include "../../../include/jio/iocsv.h"
 #include <stdlib.h>
 #include <stdio.h>
+#include <string.h>
 #include "../test_common.h"
 
 
@@ -43,6 +44,58 @@ int main()
         }
     }
     jio_csv_release(ctx, csv_data);
+
+    //  Test parsing only some columns
+    const uint32_t selected_indices[2] = {3, 1};
+    jio_csv_parse_info parse_info =
+            {
+                    .separator = ",",
+                    .trim_whitespace = true,
+                    .has_headers = true,
+                    .selected_count = 2,
+                    .selected_indices = selected_indices,
+            };
+    res = jio_parse_csv_ex(ctx, csv_file, &parse_info, &csv_data);
+    ASSERT(res == JIO_RESULT_SUCCESS);
+    jio_csv_shape(csv_data, &rows, &cols);
+    ASSERT(rows == 4);
+    ASSERT(cols == 2);
+    const jio_csv_column* p_selected;
+    res = jio_csv_get_column_by_name(ctx, csv_data, "c4", &p_selected);
+    ASSERT(res == JIO_RESULT_SUCCESS);
+    ASSERT(p_selected->count == 4);
+    ASSERT(p_selected->elements[2].len == 5 && memcmp(p_selected->elements[2].begin, "val24", 5) == 0);
+    res = jio_csv_get_column(csv_data, 1, &p_selected);
+    ASSERT(res == JIO_RESULT_SUCCESS);
+    ASSERT(p_selected->header.len == 2 && memcmp(p_selected->header.begin, "c2", 2) == 0);
+    jio_csv_release(ctx, csv_data);
+
+    //  Test selecting by name
+    const jio_string_segment selected_names[1] = {{.begin = "c3", .len = 2}};
+    parse_info.selected_count = 1;
+    parse_info.selected_names = selected_names;
+    res = jio_parse_csv_ex(ctx, csv_file, &parse_info, &csv_data);
+    ASSERT(res == JIO_RESULT_SUCCESS);
+    jio_csv_shape(csv_data, &rows, &cols);
+    ASSERT(rows == 4);
+    ASSERT(cols == 1);
+    res = jio_csv_get_column(csv_data, 0, &p_selected);
+    ASSERT(res == JIO_RESULT_SUCCESS);
+    ASSERT(p_selected->elements[0].len == 4 && memcmp(p_selected->elements[0].begin, "val3", 4) == 0);
+    jio_csv_release(ctx, csv_data);
+
+    //  Test the incorrect versions
+    const jio_string_segment bad_names[1] = {{.begin = "c5", .len = 2}};
+    parse_info.selected_names = bad_names;
+    res = jio_parse_csv_ex(ctx, csv_file, &parse_info, &csv_data);
+    ASSERT(res == JIO_RESULT_BAD_CSV_HEADER);
+    const uint32_t bad_indices[2] = {1, 1};
+    parse_info.selected_count = 2;
+    parse_info.selected_names = NULL;
+    parse_info.selected_indices = bad_indices;
+    res = jio_parse_csv_ex(ctx, csv_file, &parse_info, &csv_data);
+    ASSERT(res == JIO_RESULT_BAD_INDEX);
+
     jio_memory_file_destroy(csv_file);
 
     jio_context_destroy(ctx);
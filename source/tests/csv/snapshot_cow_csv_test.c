@@ -0,0 +1,322 @@
+//
+// Created by jan on 19.10.2026.
+//
+#include "../../../include/jio/iocsv.h"
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include "../test_common.h"
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <pthread.h>
+#endif
+
+#define ROW_COUNT 5000
+#define READER_COUNT 4
+
+//  Checks that the snapshot still prints the same as it did when it was created
+static void check_unchanged(const jio_csv_snapshot* snapshot, const char* text, size_t usage)
+{
+    size_t new_usage;
+    char* const new_text = print_data(jio_csv_snapshot_data(snapshot), ",", false, true, &new_usage);
+    ASSERT(new_usage == usage && memcmp(new_text, text, usage) == 0);
+    free(new_text);
+}
+
+static const jio_string_segment* column_elements(const jio_csv_data* data, uint32_t index)
+{
+    const jio_csv_column* column;
+    ASSERT(jio_csv_get_column(data, index, &column) == JIO_RESULT_SUCCESS);
+    return column->elements;
+}
+
+typedef struct test_thread_T test_thread;
+struct test_thread_T
+{
+    void (* fn)(void* param);
+    void* param;
+#ifdef _WIN32
+    HANDLE handle;
+#else
+    pthread_t handle;
+#endif
+};
+
+#ifdef _WIN32
+static DWORD WINAPI test_thread_main(LPVOID param)
+{
+    const test_thread* const thread = param;
+    thread->fn(thread->param);
+    return 0;
+}
+#else
+static void* test_thread_main(void* param)
+{
+    const test_thread* const thread = param;
+    thread->fn(thread->param);
+    return NULL;
+}
+#endif
+
+//  Calls fn(param) on a new thread
+static void test_thread_start(test_thread* thread, void (* fn)(void* param), void* param)
+{
+    thread->fn = fn;
+    thread->param = param;
+#ifdef _WIN32
+    thread->handle = CreateThread(NULL, 0, test_thread_main, thread, 0, NULL);
+    ASSERT(thread->handle);
+#else
+    ASSERT(pthread_create(&thread->handle, NULL, test_thread_main, thread) == 0);
+#endif
+}
+
+static void test_thread_join(test_thread* thread)
+{
+#ifdef _WIN32
+    ASSERT(WaitForSingleObject(thread->handle, INFINITE) == WAIT_OBJECT_0);
+    CloseHandle(thread->handle);
+#else
+    ASSERT(pthread_join(thread->handle, NULL) == 0);
+#endif
+}
+
+//  Allocators count their calls, which must only come from the thread that modifies the data
+static unsigned long allocator_calls = 0;
+
+static void* counted_alloc(void* param, size_t size)
+{
+    (void)param;
+    allocator_calls += 1;
+    return malloc(size);
+}
+
+static void counted_free(void* param, void* ptr)
+{
+    (void)param;
+    allocator_calls += 1;
+    free(ptr);
+}
+
+static void* counted_realloc(void* param, void* ptr, size_t new_size)
+{
+    (void)param;
+    allocator_calls += 1;
+    return realloc(ptr, new_size);
+}
+
+static void destroy_snapshot(void* param)
+{
+    jio_csv_snapshot_destroy(param);
+}
+
+typedef struct reader_T reader;
+struct reader_T
+{
+    const jio_context* ctx;
+    const jio_csv_data* data;
+    const jio_csv_column* columns[3];       //  Columns found by name
+    jio_csv_stats stats[3];                 //  Stats of each column
+    jio_result res;
+};
+
+//  Looks up columns of snapshot data by name and gets their stats, as any reader thread may do
+static void read_snapshot(void* param)
+{
+    static const char* const names[3] = {"a", "b", "c"};
+    reader* const r = param;
+    r->res = JIO_RESULT_SUCCESS;
+    for (unsigned repeat = 0; repeat < 100; ++repeat)
+    {
+        for (uint32_t i = 0; i < 3; ++i)
+        {
+            jio_result res;
+            if ((res = jio_csv_get_column_by_name(r->ctx, r->data, names[i], r->columns + i)) ||
+                (res = jio_csv_column_stats(r->data, i, r->stats + i)))
+            {
+                r->res = res;
+                return;
+            }
+        }
+    }
+}
+
+//  Reads the snapshot from several threads at once, before anything else used its header index or stats
+static void check_concurrent_reads(const jio_context* ctx, const jio_csv_snapshot* snapshot)
+{
+    reader readers[READER_COUNT];
+    test_thread threads[READER_COUNT];
+    for (unsigned i = 0; i < READER_COUNT; ++i)
+    {
+        readers[i] = (reader){.ctx = ctx, .data = jio_csv_snapshot_data(snapshot)};
+        test_thread_start(threads + i, read_snapshot, readers + i);
+    }
+    for (unsigned i = 0; i < READER_COUNT; ++i)
+    {
+        test_thread_join(threads + i);
+    }
+    const jio_csv_data* const data = jio_csv_snapshot_data(snapshot);
+    for (uint32_t i = 0; i < 3; ++i)
+    {
+        const jio_csv_column* column;
+        ASSERT(jio_csv_get_column(data, i, &column) == JIO_RESULT_SUCCESS);
+        uint64_t total_length = 0;
+        uint32_t max_length = 0;
+        for (uint32_t j = 0; j < column->count; ++j)
+        {
+            total_length += column->elements[j].len;
+            if (column->elements[j].len > max_length)
+            {
+                max_length = column->elements[j].len;
+            }
+        }
+        for (unsigned j = 0; j < READER_COUNT; ++j)
+        {
+            ASSERT(readers[j].res == JIO_RESULT_SUCCESS);
+            ASSERT(readers[j].columns[i] == column);
+            ASSERT(readers[j].stats[i].count == ROW_COUNT);
+            ASSERT(readers[j].stats[i].total_length == total_length);
+            ASSERT(readers[j].stats[i].max_length == max_length);
+        }
+    }
+}
+
+int main()
+{
+    jio_context* ctx;
+    const jio_allocator_callbacks counted_callbacks =
+            {
+                    .alloc = counted_alloc,
+                    .free = counted_free,
+                    .realloc = counted_realloc,
+                    .param = NULL,
+            };
+    const jio_context_create_info create_info =
+            {
+                    .error_callbacks = NULL,
+                    .allocator_callbacks = &counted_callbacks,
+                    .stack_allocator_callbacks = NULL,
+                    .thread_count = 4,
+            };
+    jio_result res = jio_context_create(&create_info, &ctx);
+    ASSERT(res == JIO_RESULT_SUCCESS);
+
+    FILE* f_out = fopen("csv_test_snapshot_cow.csv", "w");
+    ASSERT(f_out);
+    fprintf(f_out, "a,b,c\n");
+    for (unsigned i = 0; i < ROW_COUNT; ++i)
+    {
+        fprintf(f_out, "a%u,b%u,%u\n", i, i % 13, (i * 7919) % ROW_COUNT);
+    }
+    fclose(f_out);
+    jio_memory_file* csv_file;
+    res = jio_memory_file_create(ctx, "csv_test_snapshot_cow.csv", &csv_file, 0, 0, 0);
+    ASSERT(res == JIO_RESULT_SUCCESS);
+    jio_csv_data* data;
+    res = jio_parse_csv(ctx, csv_file, ",", true, true, &data);
+    ASSERT(res == JIO_RESULT_SUCCESS);
+
+    //  Fresh data has no header index or stats yet, which its snapshot must not build while threads read it
+    jio_csv_snapshot* shared;
+    ASSERT(jio_csv_snapshot_create(ctx, data, &shared) == JIO_RESULT_SUCCESS);
+    check_concurrent_reads(ctx, shared);
+
+    //  Snapshot destroyed by another thread is freed by this one, once the data is modified
+    const unsigned long calls_before_destroy = allocator_calls;
+    test_thread destroyer;
+    test_thread_start(&destroyer, destroy_snapshot, shared);
+    test_thread_join(&destroyer);
+    ASSERT(allocator_calls == calls_before_destroy);
+
+    //  Snapshot shares elements with the data and prints the same
+    jio_csv_snapshot* first;
+    ASSERT(jio_csv_snapshot_create(ctx, data, &first) == JIO_RESULT_SUCCESS);
+    const jio_csv_data* const first_data = jio_csv_snapshot_data(first);
+    ASSERT(column_elements(first_data, 1) == column_elements(data, 1));
+    size_t first_usage, data_usage;
+    char* const first_text = print_data(first_data, ",", false, true, &first_usage);
+    char* data_text = print_data(data, ",", false, true, &data_usage);
+    ASSERT(first_usage == data_usage && memcmp(first_text, data_text, data_usage) == 0);
+    free(data_text);
+    jio_csv_stats stats;
+    ASSERT(jio_csv_column_stats(first_data, 0, &stats) == JIO_RESULT_SUCCESS);
+    ASSERT(stats.count == ROW_COUNT);
+    const jio_csv_column* column;
+    ASSERT(jio_csv_get_column_by_name(ctx, first_data, "c", &column) == JIO_RESULT_SUCCESS);
+
+    //  Changing a cell copies only its column
+    const jio_string_segment* const shared_b = column_elements(data, 1);
+    ASSERT(jio_csv_set_cell(ctx, data, 0, 3, segment("changed")) == JIO_RESULT_SUCCESS);
+    ASSERT(column_elements(data, 0) != column_elements(first_data, 0));
+    ASSERT(column_elements(data, 1) == shared_b);
+    ASSERT(column_elements(data, 0)[3].len == 7);
+    check_unchanged(first, first_text, first_usage);
+
+    //  Every kind of modification leaves the snapshot as it was
+    const jio_string_segment new_row[3] = {segment("x"), segment("y"), segment("z")};
+    const jio_string_segment* const rows[1] = {new_row};
+    ASSERT(jio_csv_add_rows(ctx, data, 10, 1, rows) == JIO_RESULT_SUCCESS);
+    check_unchanged(first, first_text, first_usage);
+    ASSERT(jio_csv_remove_rows(ctx, data, 100, 50) == JIO_RESULT_SUCCESS);
+    check_unchanged(first, first_text, first_usage);
+    const jio_csv_sort_key key = {.column = 2, .numeric = true, .descending = true};
+    ASSERT(jio_csv_sort(ctx, data, 1, &key) == JIO_RESULT_SUCCESS);
+    check_unchanged(first, first_text, first_usage);
+    ASSERT(jio_csv_remove_cols(ctx, data, 1, 1) == JIO_RESULT_SUCCESS);
+    check_unchanged(first, first_text, first_usage);
+    uint32_t rows_count, cols_count;
+    jio_csv_shape(data, &rows_count, &cols_count);
+    ASSERT(rows_count == ROW_COUNT + 1 - 50 && cols_count == 2);
+    jio_csv_shape(first_data, &rows_count, &cols_count);
+    ASSERT(rows_count == ROW_COUNT && cols_count == 3);
+
+    //  Rows appended past what snapshots can see are written in place
+    jio_csv_snapshot* second;
+    ASSERT(jio_csv_snapshot_create(ctx, data, &second) == JIO_RESULT_SUCCESS);
+    size_t second_usage;
+    char* const second_text = print_data(jio_csv_snapshot_data(second), ",", false, true, &second_usage);
+    ASSERT(jio_csv_add_rows(ctx, data, UINT32_MAX, 1, rows) == JIO_RESULT_SUCCESS);
+    check_unchanged(second, second_text, second_usage);
+    jio_csv_snapshot* third;
+    ASSERT(jio_csv_snapshot_create(ctx, data, &third) == JIO_RESULT_SUCCESS);
+    size_t third_usage;
+    char* const third_text = print_data(jio_csv_snapshot_data(third), ",", false, true, &third_usage);
+    const jio_string_segment* const appended_to = column_elements(data, 0);
+    ASSERT(column_elements(jio_csv_snapshot_data(third), 0) == appended_to);
+    ASSERT(jio_csv_add_rows(ctx, data, UINT32_MAX, 1, rows) == JIO_RESULT_SUCCESS);
+    ASSERT(column_elements(data, 0) == appended_to);
+    check_unchanged(third, third_text, third_usage);
+    check_unchanged(second, second_text, second_usage);
+
+    //  Snapshots can be destroyed in any order, before or after the data is modified again
+    jio_csv_snapshot_destroy(first);
+    jio_csv_snapshot_destroy(third);
+    ASSERT(jio_csv_set_cell(ctx, data, 1, 0, segment("again")) == JIO_RESULT_SUCCESS);
+    check_unchanged(second, second_text, second_usage);
+    jio_csv_snapshot_destroy(second);
+
+    //  Once no snapshot uses the elements, they are changed in place
+    const jio_string_segment* const unshared = column_elements(data, 0);
+    ASSERT(jio_csv_set_cell(ctx, data, 0, 0, segment("last")) == JIO_RESULT_SUCCESS);
+    ASSERT(column_elements(data, 0) == unshared);
+    jio_csv_shape(data, &rows_count, &cols_count);
+    ASSERT(rows_count == ROW_COUNT + 3 - 50 && cols_count == 2);
+
+    //  Snapshot can outlive the columns it shares
+    ASSERT(jio_csv_snapshot_create(ctx, data, &first) == JIO_RESULT_SUCCESS);
+    ASSERT(jio_csv_remove_cols(ctx, data, 0, 2) == JIO_RESULT_SUCCESS);
+    jio_csv_shape(jio_csv_snapshot_data(first), &rows_count, &cols_count);
+    ASSERT(rows_count == ROW_COUNT + 3 - 50 && cols_count == 2);
+    ASSERT(column_elements(jio_csv_snapshot_data(first), 0)[0].len == 4);
+    jio_csv_snapshot_destroy(first);
+
+    free(third_text);
+    free(second_text);
+    free(first_text);
+    jio_csv_release(ctx, data);
+    jio_memory_file_destroy(csv_file);
+
+    jio_context_destroy(ctx);
+    return 0;
+}
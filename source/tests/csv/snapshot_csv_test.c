@@ -0,0 +1,147 @@
+//
+// Created by jan on 19.10.2026.
+//
+#include "../../../include/jio/iocsv.h"
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include "../test_common.h"
+
+#define ROW_COUNT 30000
+
+static void write_file(const char* name, unsigned seed)
+{
+    FILE* f_out = fopen(name, "w");
+    ASSERT(f_out);
+    fprintf(f_out, "id,name,value\n");
+    for (unsigned i = 0; i < ROW_COUNT; ++i)
+    {
+        fprintf(f_out, "%u,%.*s,%u\n", i, (int)(i % 11), "abcdefghijklmnopqrstuvwxyz", i * seed);
+    }
+    fclose(f_out);
+}
+
+static void compare_data(const jio_csv_data* d1, const jio_csv_data* d2)
+{
+    uint32_t rows1, cols1, rows2, cols2;
+    jio_csv_shape(d1, &rows1, &cols1);
+    jio_csv_shape(d2, &rows2, &cols2);
+    ASSERT(rows1 == rows2 && cols1 == cols2);
+    for (uint32_t i = 0; i < cols1; ++i)
+    {
+        const jio_csv_column* c1, * c2;
+        jio_result res = jio_csv_get_column(d1, i, &c1);
+        ASSERT(res == JIO_RESULT_SUCCESS);
+        res = jio_csv_get_column(d2, i, &c2);
+        ASSERT(res == JIO_RESULT_SUCCESS);
+        ASSERT(c1->header.len == c2->header.len && memcmp(c1->header.begin, c2->header.begin, c1->header.len) == 0);
+        for (uint32_t j = 0; j < rows1; ++j)
+        {
+            ASSERT(c1->elements[j].len == c2->elements[j].len);
+            ASSERT(memcmp(c1->elements[j].begin, c2->elements[j].begin, c1->elements[j].len) == 0);
+        }
+    }
+}
+
+int main()
+{
+    jio_context* ctx;
+    const jio_context_create_info create_info =
+            {
+                    .error_callbacks = NULL,
+                    .allocator_callbacks = NULL,
+                    .stack_allocator_callbacks = NULL,
+                    .thread_count = 2,
+            };
+    jio_result res = jio_context_create(&create_info, &ctx);
+    ASSERT(res == JIO_RESULT_SUCCESS);
+
+    write_file("csv_test_snapshot.csv", 3);
+    jio_memory_file* csv_file;
+    res = jio_memory_file_create(ctx, "csv_test_snapshot.csv", &csv_file, 0, 0, 0);
+    ASSERT(res == JIO_RESULT_SUCCESS);
+    jio_csv_data* data;
+    res = jio_parse_csv(ctx, csv_file, ",", true, true, &data);
+    ASSERT(res == JIO_RESULT_SUCCESS);
+    res = jio_csv_set_cell(ctx, data, 1, 7, (jio_string_segment){.begin = "edited", .len = 6});
+    ASSERT(res == JIO_RESULT_SUCCESS);
+
+    res = jio_csv_save_snapshot(ctx, data, csv_file, "csv_test_snapshot.bin");
+    ASSERT(res == JIO_RESULT_SUCCESS);
+
+    //  Opening and using the snapshot
+    jio_csv_data* snapshot;
+    res = jio_csv_open_snapshot(ctx, "csv_test_snapshot.bin", csv_file, &snapshot);
+    ASSERT(res == JIO_RESULT_SUCCESS);
+    compare_data(data, snapshot);
+    jio_csv_compact_column compact;
+    res = jio_csv_get_compact_column(snapshot, 1, &compact);
+    ASSERT(res == JIO_RESULT_SUCCESS);
+    ASSERT(compact.count == ROW_COUNT);
+    jio_string_segment element;
+    jio_csv_compact_expand(&compact, 7, 1, &element);
+    ASSERT(element.len == 6 && memcmp(element.begin, "edited", 6) == 0);
+    const jio_csv_column* column;
+    res = jio_csv_get_column_by_name(ctx, snapshot, "value", &column);
+    ASSERT(res == JIO_RESULT_SUCCESS);
+    ASSERT(column->elements[10].len == 2 && memcmp(column->elements[10].begin, "30", 2) == 0);
+    size_t size_data, size_snapshot;
+    res = jio_csv_print_size(data, &size_data, 1, 0, false);
+    ASSERT(res == JIO_RESULT_SUCCESS);
+    res = jio_csv_print_size(snapshot, &size_snapshot, 1, 0, false);
+    ASSERT(res == JIO_RESULT_SUCCESS);
+    ASSERT(size_data == size_snapshot);
+
+    //  Snapshot data can still be edited
+    res = jio_csv_remove_rows(ctx, snapshot, 0, 10);
+    ASSERT(res == JIO_RESULT_SUCCESS);
+    res = jio_csv_remove_rows(ctx, data, 0, 10);
+    ASSERT(res == JIO_RESULT_SUCCESS);
+    compare_data(data, snapshot);
+    jio_csv_release(ctx, snapshot);
+    jio_csv_release(ctx, data);
+    jio_memory_file_destroy(csv_file);
+
+    //  Snapshot is stale once the source changes
+    write_file("csv_test_snapshot.csv", 5);
+    res = jio_memory_file_create(ctx, "csv_test_snapshot.csv", &csv_file, 0, 0, 0);
+    ASSERT(res == JIO_RESULT_SUCCESS);
+    res = jio_csv_open_snapshot(ctx, "csv_test_snapshot.bin", csv_file, &snapshot);
+    ASSERT(res == JIO_RESULT_BAD_VALUE);
+    res = jio_csv_open_snapshot(ctx, "csv_test_snapshot.bin", NULL, &snapshot);
+    ASSERT(res == JIO_RESULT_SUCCESS);
+    jio_csv_release(ctx, snapshot);
+
+    //  Files which are not snapshots are rejected
+    res = jio_csv_open_snapshot(ctx, "csv_test_snapshot.csv", NULL, &snapshot);
+    ASSERT(res == JIO_RESULT_BAD_VALUE);
+
+    //  Snapshots which were cut short, or which have cells outside their strings, are rejected
+    FILE* f_in = fopen("csv_test_snapshot.bin", "rb");
+    ASSERT(f_in);
+    fseek(f_in, 0, SEEK_END);
+    const long snapshot_size = ftell(f_in);
+    fseek(f_in, 0, SEEK_SET);
+    unsigned char* const bytes = malloc(snapshot_size);
+    ASSERT(bytes && fread(bytes, 1, snapshot_size, f_in) == (size_t)snapshot_size);
+    fclose(f_in);
+    FILE* f_bad = fopen("csv_test_snapshot_bad.bin", "wb");
+    ASSERT(f_bad && fwrite(bytes, 1, snapshot_size / 2, f_bad) == (size_t)snapshot_size / 2);
+    fclose(f_bad);
+    res = jio_csv_open_snapshot(ctx, "csv_test_snapshot_bad.bin", NULL, &snapshot);
+    ASSERT(res == JIO_RESULT_BAD_VALUE);
+    uint64_t heap_offset;
+    memcpy(&heap_offset, bytes + 48, sizeof(heap_offset));
+    const uint32_t bad_offset = 0xFFFFFFF0;
+    memcpy(bytes + heap_offset - 8, &bad_offset, sizeof(bad_offset));
+    f_bad = fopen("csv_test_snapshot_bad.bin", "wb");
+    ASSERT(f_bad && fwrite(bytes, 1, snapshot_size, f_bad) == (size_t)snapshot_size);
+    fclose(f_bad);
+    res = jio_csv_open_snapshot(ctx, "csv_test_snapshot_bad.bin", NULL, &snapshot);
+    ASSERT(res == JIO_RESULT_BAD_VALUE);
+    free(bytes);
+
+    jio_memory_file_destroy(csv_file);
+    jio_context_destroy(ctx);
+    return 0;
+}
@@ -0,0 +1,226 @@
+//
+// Created by jan on 19.10.2026.
+//
+#include "../../../include/jio/iocsv.h"
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include "../test_common.h"
+
+#define ROW_COUNT 50000
+
+static int compare_strings(const jio_string_segment* a, const jio_string_segment* b)
+{
+    const int cmp = memcmp(a->begin, b->begin, a->len < b->len ? a->len : b->len);
+    if (cmp)
+    {
+        return cmp;
+    }
+    return a->len < b->len ? -1 : (a->len > b->len);
+}
+
+static bool to_number(const jio_string_segment* s, double* p_out)
+{
+    char buffer[64];
+    if (!s->len || s->len >= sizeof(buffer))
+    {
+        return false;
+    }
+    memcpy(buffer, s->begin, s->len);
+    buffer[s->len] = 0;
+    char* end;
+    *p_out = strtod(buffer, &end);
+    return end == buffer + s->len;
+}
+
+static int compare_numbers(const jio_string_segment* a, const jio_string_segment* b)
+{
+    double v_a, v_b;
+    const bool valid_a = to_number(a, &v_a), valid_b = to_number(b, &v_b);
+    if (valid_a != valid_b)
+    {
+        return valid_a ? -1 : +1;
+    }
+    if (!valid_a)
+    {
+        return 0;
+    }
+    return v_a < v_b ? -1 : (v_a > v_b);
+}
+
+//  Numbers in descending order, which are still followed by values which are not numbers
+static int compare_numbers_descending(const jio_string_segment* a, const jio_string_segment* b)
+{
+    double v_a, v_b;
+    const bool valid_a = to_number(a, &v_a), valid_b = to_number(b, &v_b);
+    if (valid_a != valid_b || !valid_a)
+    {
+        return compare_numbers(a, b);
+    }
+    return -compare_numbers(a, b);
+}
+
+static uint32_t parse_id(const jio_string_segment* s)
+{
+    uint32_t v = 0;
+    for (size_t i = 0; i < s->len; ++i)
+    {
+        v = v * 10 + (s->begin[i] - '0');
+    }
+    return v;
+}
+
+int main()
+{
+    jio_context* ctx;
+    const jio_context_create_info create_info =
+            {
+                    .error_callbacks = NULL,
+                    .allocator_callbacks = NULL,
+                    .stack_allocator_callbacks = NULL,
+                    .thread_count = 4,
+            };
+    jio_result res = jio_context_create(&create_info, &ctx);
+    ASSERT(res == JIO_RESULT_SUCCESS);
+
+    //  Groups share a long prefix, so that prefixes of keys are often equal
+    srand(11);
+    FILE* f_out = fopen("csv_test_sort.csv", "w");
+    ASSERT(f_out);
+    fprintf(f_out, "id,group,value,check\n");
+    for (unsigned i = 0; i < ROW_COUNT; ++i)
+    {
+        const int r = rand();
+        const unsigned group = r % 23;
+        if (r % 50 == 0)
+        {
+            fprintf(f_out, "%u,long_group_name_%u,n/a,%u\n", i, group, i * 7);
+        }
+        else
+        {
+            fprintf(f_out, "%u,long_group_name_%u,%g,%u\n", i, group, (double)(rand() % 2000 - 1000) / 8.0, i * 7);
+        }
+    }
+    fclose(f_out);
+
+    jio_memory_file* csv_file;
+    res = jio_memory_file_create(ctx, "csv_test_sort.csv", &csv_file, 0, 0, 0);
+    ASSERT(res == JIO_RESULT_SUCCESS);
+    jio_csv_data* data;
+    res = jio_parse_csv(ctx, csv_file, ",", true, true, &data);
+    ASSERT(res == JIO_RESULT_SUCCESS);
+
+    //  Bad keys
+    jio_csv_sort_key keys[2] = {{.column = 4}};
+    res = jio_csv_sort(ctx, data, 1, keys);
+    ASSERT(res == JIO_RESULT_BAD_INDEX);
+
+    //  Sort by group, then by value in descending order
+    keys[0] = (jio_csv_sort_key){.column = 1, .numeric = false, .descending = false};
+    keys[1] = (jio_csv_sort_key){.column = 2, .numeric = true, .descending = true};
+    res = jio_csv_sort(ctx, data, 2, keys);
+    ASSERT(res == JIO_RESULT_SUCCESS);
+
+    const jio_csv_column* ids, * groups, * values, * checks;
+    ASSERT(jio_csv_get_column(data, 0, &ids) == JIO_RESULT_SUCCESS);
+    ASSERT(jio_csv_get_column(data, 1, &groups) == JIO_RESULT_SUCCESS);
+    ASSERT(jio_csv_get_column(data, 2, &values) == JIO_RESULT_SUCCESS);
+    ASSERT(jio_csv_get_column(data, 3, &checks) == JIO_RESULT_SUCCESS);
+    ASSERT(ids->count == ROW_COUNT);
+    for (uint32_t i = 0; i < ROW_COUNT; ++i)
+    {
+        //  Rows are kept together
+        ASSERT(parse_id(checks->elements + i) == 7 * parse_id(ids->elements + i));
+        if (i == 0)
+        {
+            continue;
+        }
+        int cmp = compare_strings(groups->elements + i - 1, groups->elements + i);
+        ASSERT(cmp <= 0);
+        if (cmp)
+        {
+            continue;
+        }
+        cmp = compare_numbers_descending(values->elements + i - 1, values->elements + i);
+        ASSERT(cmp <= 0);
+        if (cmp)
+        {
+            continue;
+        }
+        //  Stable
+        ASSERT(parse_id(ids->elements + i - 1) < parse_id(ids->elements + i));
+    }
+
+    //  Sort back by id, numerically
+    keys[0] = (jio_csv_sort_key){.column = 0, .numeric = true};
+    res = jio_csv_sort(ctx, data, 1, keys);
+    ASSERT(res == JIO_RESULT_SUCCESS);
+    for (uint32_t i = 0; i < ROW_COUNT; ++i)
+    {
+        ASSERT(parse_id(ids->elements + i) == i);
+    }
+
+    //  Lexicographic order of ids is different
+    keys[0] = (jio_csv_sort_key){.column = 0, .descending = true};
+    res = jio_csv_sort(ctx, data, 1, keys);
+    ASSERT(res == JIO_RESULT_SUCCESS);
+    ASSERT(ids->elements[0].len == 4 && memcmp(ids->elements[0].begin, "9999", 4) == 0);
+    for (uint32_t i = 1; i < ROW_COUNT; ++i)
+    {
+        ASSERT(compare_strings(ids->elements + i - 1, ids->elements + i) > 0);
+    }
+
+    jio_csv_release(ctx, data);
+    jio_memory_file_destroy(csv_file);
+
+    //  Most rows have the same key, so they are all in one bucket, which is sorted in chunks that are merged
+    f_out = fopen("csv_test_sort_same.csv", "w");
+    ASSERT(f_out);
+    fprintf(f_out, "key,id\n");
+    for (unsigned i = 0; i < 20000; ++i)
+    {
+        fprintf(f_out, "%s,%u\n", i % 10 ? "same" : "other", 19999 - i);
+    }
+    fclose(f_out);
+    res = jio_memory_file_create(ctx, "csv_test_sort_same.csv", &csv_file, 0, 0, 0);
+    ASSERT(res == JIO_RESULT_SUCCESS);
+    res = jio_parse_csv(ctx, csv_file, ",", true, true, &data);
+    ASSERT(res == JIO_RESULT_SUCCESS);
+    keys[0] = (jio_csv_sort_key){.column = 0};
+    res = jio_csv_sort(ctx, data, 1, keys);
+    ASSERT(res == JIO_RESULT_SUCCESS);
+    ASSERT(jio_csv_get_column(data, 0, &groups) == JIO_RESULT_SUCCESS);
+    ASSERT(jio_csv_get_column(data, 1, &ids) == JIO_RESULT_SUCCESS);
+    for (uint32_t i = 0; i < 20000; ++i)
+    {
+        ASSERT(groups->elements[i].len == (i < 2000 ? 5 : 4));
+        //  Ids were written in descending order, which stable sorting keeps within each key
+        ASSERT(i == 0 || i == 2000 || parse_id(ids->elements + i - 1) > parse_id(ids->elements + i));
+    }
+    jio_csv_release(ctx, data);
+    jio_memory_file_destroy(csv_file);
+
+    //  Values which are not numbers go last in descending order too
+    f_out = fopen("csv_test_sort_small.csv", "w");
+    ASSERT(f_out);
+    fprintf(f_out, "v,i\n3,0\nx,1\n1,2\n2,3\ny,4\n");
+    fclose(f_out);
+    res = jio_memory_file_create(ctx, "csv_test_sort_small.csv", &csv_file, 0, 0, 0);
+    ASSERT(res == JIO_RESULT_SUCCESS);
+    res = jio_parse_csv(ctx, csv_file, ",", true, true, &data);
+    ASSERT(res == JIO_RESULT_SUCCESS);
+    keys[0] = (jio_csv_sort_key){.column = 0, .numeric = true, .descending = true};
+    res = jio_csv_sort(ctx, data, 1, keys);
+    ASSERT(res == JIO_RESULT_SUCCESS);
+    ASSERT(jio_csv_get_column(data, 0, &values) == JIO_RESULT_SUCCESS);
+    const char expected[] = "321xy";
+    for (uint32_t i = 0; i < 5; ++i)
+    {
+        ASSERT(values->elements[i].len == 1 && values->elements[i].begin[0] == expected[i]);
+    }
+    jio_csv_release(ctx, data);
+    jio_memory_file_destroy(csv_file);
+
+    jio_context_destroy(ctx);
+    return 0;
+}
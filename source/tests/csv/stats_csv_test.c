@@ -0,0 +1,157 @@
+//
+// Created by jan on 19.10.2026.
+//
+#include "../../../include/jio/iocsv.h"
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include "../test_common.h"
+
+#define ROW_COUNT 20000
+
+//  Compares cached stats against ones computed from the elements
+static void check_stats(const jio_csv_data* data)
+{
+    uint32_t rows, cols;
+    jio_csv_shape(data, &rows, &cols);
+    for (uint32_t i = 0; i < cols; ++i)
+    {
+        const jio_csv_column* column;
+        jio_result res = jio_csv_get_column(data, i, &column);
+        ASSERT(res == JIO_RESULT_SUCCESS);
+        uint64_t total = 0;
+        uint32_t max = 0;
+        for (uint32_t j = 0; j < rows; ++j)
+        {
+            total += column->elements[j].len;
+            if (column->elements[j].len > max)
+            {
+                max = column->elements[j].len;
+            }
+        }
+        jio_csv_stats stats;
+        res = jio_csv_column_stats(data, i, &stats);
+        ASSERT(res == JIO_RESULT_SUCCESS);
+        ASSERT(stats.count == rows);
+        ASSERT(stats.total_length == total);
+        ASSERT(stats.max_length == max);
+    }
+}
+
+int main()
+{
+    jio_context* ctx;
+    const jio_context_create_info create_info =
+            {
+                    .error_callbacks = NULL,
+                    .allocator_callbacks = NULL,
+                    .stack_allocator_callbacks = NULL,
+                    .thread_count = 2,
+            };
+    jio_result res = jio_context_create(&create_info, &ctx);
+    ASSERT(res == JIO_RESULT_SUCCESS);
+
+    FILE* f_out = fopen("csv_test_stats.csv", "w");
+    ASSERT(f_out);
+    fprintf(f_out, "id,name,value\n");
+    for (unsigned i = 0; i < ROW_COUNT; ++i)
+    {
+        fprintf(f_out, "%u,%.*s,%u\n", i, (int)(i % 17), "abcdefghijklmnopqrstuvwxyz", i % 100);
+    }
+    fclose(f_out);
+
+    jio_memory_file* csv_file;
+    res = jio_memory_file_create(ctx, "csv_test_stats.csv", &csv_file, 0, 0, 0);
+    ASSERT(res == JIO_RESULT_SUCCESS);
+    jio_csv_parse_info parse_info =
+            {
+                    .separator = ",",
+                    .trim_whitespace = true,
+                    .has_headers = true,
+                    .lazy = true,
+            };
+    jio_csv_data* data;
+    res = jio_parse_csv_ex(ctx, csv_file, &parse_info, &data);
+    ASSERT(res == JIO_RESULT_SUCCESS);
+
+    jio_csv_stats stats;
+    res = jio_csv_column_stats(data, 3, &stats);
+    ASSERT(res == JIO_RESULT_BAD_INDEX);
+    res = jio_csv_column_stats(data, 1, &stats);
+    ASSERT(res == JIO_RESULT_SUCCESS);
+    ASSERT(stats.count == ROW_COUNT);
+    ASSERT(stats.max_length == 16);
+    check_stats(data);
+
+    //  Row edits
+    const jio_string_segment long_row[3] =
+            {
+                    {.begin = "1234567890", .len = 10},
+                    {.begin = "a very long name indeed", .len = 23},
+                    {.begin = "", .len = 0},
+            };
+    const jio_string_segment* rows[2] = {long_row, long_row};
+    res = jio_csv_add_rows(ctx, data, 5, 2, rows);
+    ASSERT(res == JIO_RESULT_SUCCESS);
+    res = jio_csv_column_stats(data, 1, &stats);
+    ASSERT(res == JIO_RESULT_SUCCESS);
+    ASSERT(stats.max_length == 23);
+    check_stats(data);
+    res = jio_csv_remove_rows(ctx, data, 5, 1);
+    ASSERT(res == JIO_RESULT_SUCCESS);
+    check_stats(data);
+    res = jio_csv_replace_rows(ctx, data, 5, 1, 1, rows);
+    ASSERT(res == JIO_RESULT_SUCCESS);
+    check_stats(data);
+    res = jio_csv_remove_rows(ctx, data, 5, 1);
+    ASSERT(res == JIO_RESULT_SUCCESS);
+    res = jio_csv_column_stats(data, 1, &stats);
+    ASSERT(res == JIO_RESULT_SUCCESS);
+    ASSERT(stats.max_length == 16);
+    check_stats(data);
+    res = jio_csv_set_cell(ctx, data, 2, 100, (jio_string_segment){.begin = "abcdefgh", .len = 8});
+    ASSERT(res == JIO_RESULT_SUCCESS);
+    check_stats(data);
+
+    //  Column edits
+    uint32_t row_count;
+    jio_csv_shape(data, &row_count, NULL);
+    jio_string_segment* const elements = malloc(sizeof(*elements) * row_count);
+    ASSERT(elements);
+    for (uint32_t i = 0; i < row_count; ++i)
+    {
+        elements[i] = (jio_string_segment){.begin = "xyz", .len = i % 4};
+    }
+    const jio_csv_column column =
+            {
+                    .header = {.begin = "new", .len = 3},
+                    .count = row_count,
+                    .capacity = row_count,
+                    .elements = elements,
+            };
+    res = jio_csv_add_cols(ctx, data, 1, 1, &column);
+    ASSERT(res == JIO_RESULT_SUCCESS);
+    check_stats(data);
+    res = jio_csv_remove_cols(ctx, data, 0, 1);
+    ASSERT(res == JIO_RESULT_SUCCESS);
+    check_stats(data);
+
+    //  Batched edits
+    jio_csv_edit* edit;
+    res = jio_csv_edit_begin(ctx, data, &edit);
+    ASSERT(res == JIO_RESULT_SUCCESS);
+    const jio_string_segment short_row[3] = {{.begin = "a", .len = 1}, {.begin = "b", .len = 1}, {.begin = "c", .len = 1}};
+    const jio_string_segment* short_rows[1] = {short_row};
+    res = jio_csv_edit_replace_rows(edit, 0, 10, 1, short_rows);
+    ASSERT(res == JIO_RESULT_SUCCESS);
+    res = jio_csv_edit_remove_rows(edit, 100, 50);
+    ASSERT(res == JIO_RESULT_SUCCESS);
+    res = jio_csv_edit_commit(edit, false);
+    ASSERT(res == JIO_RESULT_SUCCESS);
+    check_stats(data);
+
+    jio_csv_release(ctx, data);
+    jio_memory_file_destroy(csv_file);
+    jio_context_destroy(ctx);
+    return 0;
+}
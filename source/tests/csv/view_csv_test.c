@@ -0,0 +1,149 @@
+//
+// Created by jan on 19.10.2026.
+//
+#include "../../../include/jio/iocsv.h"
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include "../test_common.h"
+
+#define ROW_COUNT 40000
+#define FIRST_ROW 1000
+#define VIEW_ROWS 30000
+
+int main()
+{
+    jio_context* ctx;
+    const jio_context_create_info create_info =
+            {
+                    .error_callbacks = NULL,
+                    .allocator_callbacks = NULL,
+                    .stack_allocator_callbacks = NULL,
+                    .thread_count = 4,
+            };
+    jio_result res = jio_context_create(&create_info, &ctx);
+    ASSERT(res == JIO_RESULT_SUCCESS);
+
+    //  Second file holds only what the view should show
+    FILE* f_out = fopen("csv_test_view.csv", "w");
+    FILE* f_sub = fopen("csv_test_view_sub.csv", "w");
+    ASSERT(f_out && f_sub);
+    fprintf(f_out, "a,b,c,d,e\n");
+    fprintf(f_sub, "b,c,d\n");
+    for (unsigned i = 0; i < ROW_COUNT; ++i)
+    {
+        fprintf(f_out, "a%u,b%u,%u,d%u,e\n", i, i % 300, i * 3, i % 7);
+        if (i >= FIRST_ROW && i < FIRST_ROW + VIEW_ROWS)
+        {
+            fprintf(f_sub, "b%u,%u,d%u\n", i % 300, i * 3, i % 7);
+        }
+    }
+    fclose(f_out);
+    fclose(f_sub);
+
+    jio_memory_file* csv_file, * sub_file;
+    res = jio_memory_file_create(ctx, "csv_test_view.csv", &csv_file, 0, 0, 0);
+    ASSERT(res == JIO_RESULT_SUCCESS);
+    res = jio_memory_file_create(ctx, "csv_test_view_sub.csv", &sub_file, 0, 0, 0);
+    ASSERT(res == JIO_RESULT_SUCCESS);
+    const jio_csv_parse_info parse_info =
+            {
+                    .separator = ",",
+                    .has_headers = true,
+                    .lazy = true,
+            };
+    jio_csv_data* data, * sub_data;
+    res = jio_parse_csv_ex(ctx, csv_file, &parse_info, &data);
+    ASSERT(res == JIO_RESULT_SUCCESS);
+    res = jio_parse_csv(ctx, sub_file, ",", false, true, &sub_data);
+    ASSERT(res == JIO_RESULT_SUCCESS);
+
+    jio_csv_view* view;
+    ASSERT(jio_csv_view_create(ctx, data, FIRST_ROW, ROW_COUNT, 1, 3, &view) == JIO_RESULT_BAD_INDEX);
+    ASSERT(jio_csv_view_create(ctx, data, FIRST_ROW, VIEW_ROWS, 3, 3, &view) == JIO_RESULT_BAD_INDEX);
+    ASSERT(jio_csv_view_create(ctx, data, FIRST_ROW, VIEW_ROWS, 1, 3, &view) == JIO_RESULT_SUCCESS);
+    const jio_csv_data* const view_data = jio_csv_view_data(view);
+    uint32_t rows, cols;
+    jio_csv_shape(view_data, &rows, &cols);
+    ASSERT(rows == VIEW_ROWS && cols == 3);
+
+    //  Columns point into the viewed data
+    const jio_csv_column* base_column, * view_column;
+    ASSERT(jio_csv_get_column(data, 2, &base_column) == JIO_RESULT_SUCCESS);
+    ASSERT(jio_csv_get_column(view_data, 1, &view_column) == JIO_RESULT_SUCCESS);
+    ASSERT(view_column->count == VIEW_ROWS && view_column->elements == base_column->elements + FIRST_ROW);
+    ASSERT(jio_csv_get_column(view_data, 3, &view_column) == JIO_RESULT_BAD_INDEX);
+    ASSERT(jio_csv_get_column_by_name(ctx, view_data, "d", &view_column) == JIO_RESULT_SUCCESS);
+    ASSERT(view_column->header.len == 1 && view_column->header.begin[0] == 'd');
+    ASSERT(jio_csv_get_column_by_name(ctx, view_data, "a", &view_column) == JIO_RESULT_BAD_CSV_HEADER);
+
+    //  View is printed the same as data with only its rows and columns
+    size_t view_usage, sub_usage;
+    char* const view_text = print_data(view_data, ",", false, true, &view_usage);
+    char* const sub_text = print_data(sub_data, ",", false, true, &sub_usage);
+    ASSERT(view_usage == sub_usage && memcmp(view_text, sub_text, view_usage) == 0);
+    free(view_text);
+    free(sub_text);
+    for (uint32_t i = 0; i < 3; ++i)
+    {
+        jio_csv_stats view_stats, sub_stats;
+        ASSERT(jio_csv_column_stats(view_data, i, &view_stats) == JIO_RESULT_SUCCESS);
+        ASSERT(jio_csv_column_stats(sub_data, i, &sub_stats) == JIO_RESULT_SUCCESS);
+        ASSERT(view_stats.count == sub_stats.count && view_stats.max_length == sub_stats.max_length && view_stats.total_length == sub_stats.total_length);
+    }
+
+    //  Typed access works on views
+    jio_csv_aggregation aggregation;
+    const jio_csv_aggregate_info info = {.count_distinct = true};
+    ASSERT(jio_csv_aggregate(ctx, view_data, 1, &info, 2, &aggregation) == JIO_RESULT_SUCCESS);
+    ASSERT(aggregation.group_count == 7);
+    double sum = 0;
+    uint32_t count = 0;
+    for (uint32_t i = 0; i < aggregation.group_count; ++i)
+    {
+        sum += aggregation.groups[i].sum;
+        count += aggregation.groups[i].count;
+    }
+    ASSERT(count == VIEW_ROWS);
+    ASSERT(sum == 3.0 * ((double)(FIRST_ROW + VIEW_ROWS - 1) * (FIRST_ROW + VIEW_ROWS) / 2 - (double)(FIRST_ROW - 1) * FIRST_ROW / 2));
+    jio_csv_aggregation_release(ctx, &aggregation);
+    uint32_t* const values = malloc(sizeof(*values) * VIEW_ROWS);
+    ASSERT(values);
+    const jio_csv_field field = {.name = "c", .type = JIO_CSV_FIELD_UINT32};
+    ASSERT(jio_csv_bind_rows(ctx, view_data, 1, &field, 0, VIEW_ROWS, sizeof(*values), values) == JIO_RESULT_SUCCESS);
+    for (uint32_t i = 0; i < VIEW_ROWS; ++i)
+    {
+        ASSERT(values[i] == 3 * (FIRST_ROW + i));
+    }
+    free(values);
+
+    //  Views of views
+    jio_csv_view* inner;
+    ASSERT(jio_csv_view_create(ctx, view_data, 10, 20, 1, 2, &inner) == JIO_RESULT_SUCCESS);
+    const jio_csv_data* const inner_data = jio_csv_view_data(inner);
+    ASSERT(jio_csv_get_column(inner_data, 0, &view_column) == JIO_RESULT_SUCCESS);
+    ASSERT(view_column->count == 20 && view_column->elements == base_column->elements + FIRST_ROW + 10);
+    ASSERT(jio_csv_get_column_by_name(ctx, inner_data, "b", &view_column) == JIO_RESULT_BAD_CSV_HEADER);
+    jio_csv_view* empty;
+    ASSERT(jio_csv_view_create(ctx, inner_data, 20, 0, 2, 0, &empty) == JIO_RESULT_SUCCESS);
+    jio_csv_shape(jio_csv_view_data(empty), &rows, &cols);
+    ASSERT(rows == 0 && cols == 0);
+    jio_csv_view_destroy(empty);
+    jio_csv_view_destroy(inner);
+    jio_csv_view_destroy(view);
+
+    //  Element of the view is the same as that of the data
+    ASSERT(jio_csv_view_create(ctx, data, ROW_COUNT - 1, 1, 0, 1, &view) == JIO_RESULT_SUCCESS);
+    ASSERT(jio_csv_get_column(jio_csv_view_data(view), 0, &view_column) == JIO_RESULT_SUCCESS);
+    const jio_string_segment last = segment("a39999");
+    ASSERT(view_column->elements[0].len == last.len && memcmp(view_column->elements[0].begin, last.begin, last.len) == 0);
+    jio_csv_view_destroy(view);
+
+    jio_csv_release(ctx, sub_data);
+    jio_csv_release(ctx, data);
+    jio_memory_file_destroy(sub_file);
+    jio_memory_file_destroy(csv_file);
+
+    jio_context_destroy(ctx);
+    return 0;
+}
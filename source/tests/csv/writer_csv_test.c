@@ -0,0 +1,218 @@
+//
+// Created by jan on 19.10.2026.
+//
+#include "../../../include/jio/iocsv.h"
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include "../test_common.h"
+
+#define ROW_COUNT 10000
+
+typedef struct output_T output;
+struct output_T
+{
+    char* data;
+    size_t size;
+    size_t capacity;
+    unsigned calls;
+};
+
+static bool output_sink(void* param, const char* data, size_t size)
+{
+    output* const out = param;
+    if (out->size + size > out->capacity)
+    {
+        out->capacity = 2 * (out->size + size);
+        out->data = realloc(out->data, out->capacity);
+        ASSERT(out->data);
+    }
+    memcpy(out->data + out->size, data, size);
+    out->size += size;
+    out->calls += 1;
+    return true;
+}
+
+static bool failing_sink(void* param, const char* data, size_t size)
+{
+    (void)param;
+    (void)data;
+    (void)size;
+    return false;
+}
+
+static void check_output(output* out, const char* expected)
+{
+    ASSERT(out->size == strlen(expected) && memcmp(out->data, expected, out->size) == 0);
+    out->size = 0;
+}
+
+int main()
+{
+    jio_context* ctx;
+    const jio_context_create_info create_info =
+            {
+                    .error_callbacks = NULL,
+                    .allocator_callbacks = NULL,
+                    .stack_allocator_callbacks = NULL,
+                    .thread_count = 1,
+            };
+    jio_result res = jio_context_create(&create_info, &ctx);
+    ASSERT(res == JIO_RESULT_SUCCESS);
+
+    //  Small buffer, so that it is flushed often
+    output out = {0};
+    jio_csv_writer* writer;
+    res = jio_csv_writer_create(ctx, ",", 16, output_sink, &out, &writer);
+    ASSERT(res == JIO_RESULT_SUCCESS);
+    ASSERT(jio_csv_writer_write_i64(writer, 0) == JIO_RESULT_SUCCESS);
+    ASSERT(jio_csv_writer_write_i64(writer, -42) == JIO_RESULT_SUCCESS);
+    ASSERT(jio_csv_writer_write_i64(writer, INT64_MIN) == JIO_RESULT_SUCCESS);
+    ASSERT(jio_csv_writer_write_i64(writer, INT64_MAX) == JIO_RESULT_SUCCESS);
+    ASSERT(jio_csv_writer_end_row(writer) == JIO_RESULT_SUCCESS);
+    ASSERT(jio_csv_writer_flush(writer) == JIO_RESULT_SUCCESS);
+    check_output(&out, "0,-42,-9223372036854775808,9223372036854775807\n");
+
+    ASSERT(jio_csv_writer_write_f64(writer, 0.1) == JIO_RESULT_SUCCESS);
+    ASSERT(jio_csv_writer_write_f64(writer, 0.1 + 0.2) == JIO_RESULT_SUCCESS);
+    ASSERT(jio_csv_writer_write_f64(writer, 1.5) == JIO_RESULT_SUCCESS);
+    ASSERT(jio_csv_writer_write_f64(writer, -2) == JIO_RESULT_SUCCESS);
+    ASSERT(jio_csv_writer_write_f64(writer, 1e300) == JIO_RESULT_SUCCESS);
+    ASSERT(jio_csv_writer_end_row(writer) == JIO_RESULT_SUCCESS);
+    ASSERT(jio_csv_writer_flush(writer) == JIO_RESULT_SUCCESS);
+    check_output(&out, "0.1,0.30000000000000004,1.5,-2,1e+300\n");
+
+    //  Subnormal values have fewer digits, values which are not finite have the same text everywhere
+    const double special[] = {5e-324, 1e-310, 2.2250738585072014e-308, 0.0 / 0.0, 1.0 / 0.0, -1.0 / 0.0, -0.0, 1e15, 123456, 0.5e-300};
+    for (uint32_t i = 0; i < sizeof(special) / sizeof(*special); ++i)
+    {
+        ASSERT(jio_csv_writer_write_f64(writer, special[i]) == JIO_RESULT_SUCCESS);
+    }
+    ASSERT(jio_csv_writer_end_row(writer) == JIO_RESULT_SUCCESS);
+    ASSERT(jio_csv_writer_flush(writer) == JIO_RESULT_SUCCESS);
+    check_output(&out, "5e-324,1e-310,2.2250738585072014e-308,nan,inf,-inf,-0,1e+15,123456,5e-301\n");
+
+    ASSERT(jio_csv_writer_write_str(writer, segment("plain")) == JIO_RESULT_SUCCESS);
+    ASSERT(jio_csv_writer_write_str(writer, segment("a,b")) == JIO_RESULT_SUCCESS);
+    ASSERT(jio_csv_writer_write_str(writer, segment("say \"hi\"")) == JIO_RESULT_SUCCESS);
+    ASSERT(jio_csv_writer_write_str(writer, segment("")) == JIO_RESULT_SUCCESS);
+    ASSERT(jio_csv_writer_write_str(writer, segment("two\nlines")) == JIO_RESULT_SUCCESS);
+    ASSERT(jio_csv_writer_write_str(writer, segment("a long entry which does not fit into the buffer")) == JIO_RESULT_SUCCESS);
+    ASSERT(jio_csv_writer_end_row(writer) == JIO_RESULT_SUCCESS);
+    ASSERT(jio_csv_writer_destroy(writer) == JIO_RESULT_SUCCESS);
+    check_output(&out, "plain,\"a,b\",\"say \"\"hi\"\"\",,\"two\nlines\",a long entry which does not fit into the buffer\n");
+    ASSERT(out.calls > 3);
+
+    //  Separators longer than a character
+    res = jio_csv_writer_create(ctx, "::", 0, output_sink, &out, &writer);
+    ASSERT(res == JIO_RESULT_SUCCESS);
+    ASSERT(jio_csv_writer_write_str(writer, segment("a:b")) == JIO_RESULT_SUCCESS);
+    ASSERT(jio_csv_writer_write_str(writer, segment("a::b")) == JIO_RESULT_SUCCESS);
+    ASSERT(jio_csv_writer_write_i64(writer, 7) == JIO_RESULT_SUCCESS);
+    ASSERT(jio_csv_writer_end_row(writer) == JIO_RESULT_SUCCESS);
+    ASSERT(jio_csv_writer_destroy(writer) == JIO_RESULT_SUCCESS);
+    check_output(&out, "a:b::\"a::b\"::7\n");
+    free(out.data);
+
+    //  Sink which fails
+    res = jio_csv_writer_create(ctx, ",", 0, failing_sink, NULL, &writer);
+    ASSERT(res == JIO_RESULT_SUCCESS);
+    ASSERT(jio_csv_writer_write_i64(writer, 1) == JIO_RESULT_SUCCESS);
+    ASSERT(jio_csv_writer_destroy(writer) == JIO_RESULT_BAD_ACCESS);
+
+    //  Values written to a file are parsed back exactly
+    srand(29);
+    static double values[ROW_COUNT];
+    static int64_t ids[ROW_COUNT];
+    res = jio_csv_writer_create_file(ctx, "csv_test_writer.csv", ",", 0, &writer);
+    ASSERT(res == JIO_RESULT_SUCCESS);
+    ASSERT(jio_csv_writer_write_str(writer, segment("id")) == JIO_RESULT_SUCCESS);
+    ASSERT(jio_csv_writer_write_str(writer, segment("value")) == JIO_RESULT_SUCCESS);
+    ASSERT(jio_csv_writer_end_row(writer) == JIO_RESULT_SUCCESS);
+    for (uint32_t i = 0; i < ROW_COUNT; ++i)
+    {
+        ids[i] = ((int64_t)rand() << 32 | rand()) - ((int64_t)1 << 60);
+        values[i] = (double)rand() / (double)rand() * (rand() % 2 ? 1e-7 : 1e9);
+        ASSERT(jio_csv_writer_write_i64(writer, ids[i]) == JIO_RESULT_SUCCESS);
+        ASSERT(jio_csv_writer_write_f64(writer, values[i]) == JIO_RESULT_SUCCESS);
+        ASSERT(jio_csv_writer_end_row(writer) == JIO_RESULT_SUCCESS);
+    }
+    ASSERT(jio_csv_writer_destroy(writer) == JIO_RESULT_SUCCESS);
+
+    jio_memory_file* file;
+    res = jio_memory_file_create(ctx, "csv_test_writer.csv", &file, 0, 0, 0);
+    ASSERT(res == JIO_RESULT_SUCCESS);
+    jio_csv_data* data;
+    res = jio_parse_csv(ctx, file, ",", false, true, &data);
+    ASSERT(res == JIO_RESULT_SUCCESS);
+    const jio_csv_column* id_column, * value_column;
+    ASSERT(jio_csv_get_column(data, 0, &id_column) == JIO_RESULT_SUCCESS);
+    ASSERT(jio_csv_get_column(data, 1, &value_column) == JIO_RESULT_SUCCESS);
+    ASSERT(id_column->count == ROW_COUNT);
+    for (uint32_t i = 0; i < ROW_COUNT; ++i)
+    {
+        char buffer[32];
+        ASSERT(id_column->elements[i].len < sizeof(buffer));
+        memcpy(buffer, id_column->elements[i].begin, id_column->elements[i].len);
+        buffer[id_column->elements[i].len] = 0;
+        ASSERT(strtoll(buffer, NULL, 10) == ids[i]);
+        ASSERT(value_column->elements[i].len < sizeof(buffer));
+        memcpy(buffer, value_column->elements[i].begin, value_column->elements[i].len);
+        buffer[value_column->elements[i].len] = 0;
+        ASSERT(strtod(buffer, NULL) == values[i]);
+    }
+    jio_csv_release(ctx, data);
+    jio_memory_file_destroy(file);
+
+    //  Parser does not handle quotes, so only output without quoted entries is parsed back as it was written
+    const jio_string_segment plain[2][2] = {{segment("name"), segment("note")}, {segment("a b"), segment("it's fine")}};
+    res = jio_csv_writer_create_file(ctx, "csv_test_writer_plain.csv", ",", 0, &writer);
+    ASSERT(res == JIO_RESULT_SUCCESS);
+    for (uint32_t i = 0; i < 2; ++i)
+    {
+        ASSERT(jio_csv_writer_write_str(writer, plain[i][0]) == JIO_RESULT_SUCCESS);
+        ASSERT(jio_csv_writer_write_str(writer, plain[i][1]) == JIO_RESULT_SUCCESS);
+        ASSERT(jio_csv_writer_end_row(writer) == JIO_RESULT_SUCCESS);
+    }
+    //  Quoted entry without the separator or new lines keeps its quotes
+    ASSERT(jio_csv_writer_write_str(writer, segment("c")) == JIO_RESULT_SUCCESS);
+    ASSERT(jio_csv_writer_write_str(writer, segment("say \"hi\"")) == JIO_RESULT_SUCCESS);
+    ASSERT(jio_csv_writer_end_row(writer) == JIO_RESULT_SUCCESS);
+    ASSERT(jio_csv_writer_destroy(writer) == JIO_RESULT_SUCCESS);
+    res = jio_memory_file_create(ctx, "csv_test_writer_plain.csv", &file, 0, 0, 0);
+    ASSERT(res == JIO_RESULT_SUCCESS);
+    res = jio_parse_csv(ctx, file, ",", false, true, &data);
+    ASSERT(res == JIO_RESULT_SUCCESS);
+    for (uint32_t i = 0; i < 2; ++i)
+    {
+        const jio_csv_column* column;
+        ASSERT(jio_csv_get_column(data, i, &column) == JIO_RESULT_SUCCESS);
+        ASSERT(segment_equal(&column->header, plain[0] + i));
+        ASSERT(column->count == 2);
+        ASSERT(segment_equal(column->elements + 0, plain[1] + i));
+    }
+    const jio_csv_column* note_column;
+    ASSERT(jio_csv_get_column(data, 1, &note_column) == JIO_RESULT_SUCCESS);
+    const jio_string_segment quoted = segment("\"say \"\"hi\"\"\"");
+    ASSERT(segment_equal(note_column->elements + 1, &quoted));
+    jio_csv_release(ctx, data);
+    jio_memory_file_destroy(file);
+
+    //  Quoted entry with the separator is split by the parser, so the row has too many entries
+    res = jio_csv_writer_create_file(ctx, "csv_test_writer_quoted.csv", ",", 0, &writer);
+    ASSERT(res == JIO_RESULT_SUCCESS);
+    ASSERT(jio_csv_writer_write_str(writer, segment("name")) == JIO_RESULT_SUCCESS);
+    ASSERT(jio_csv_writer_write_str(writer, segment("note")) == JIO_RESULT_SUCCESS);
+    ASSERT(jio_csv_writer_end_row(writer) == JIO_RESULT_SUCCESS);
+    ASSERT(jio_csv_writer_write_str(writer, segment("a")) == JIO_RESULT_SUCCESS);
+    ASSERT(jio_csv_writer_write_str(writer, segment("b,c")) == JIO_RESULT_SUCCESS);
+    ASSERT(jio_csv_writer_end_row(writer) == JIO_RESULT_SUCCESS);
+    ASSERT(jio_csv_writer_destroy(writer) == JIO_RESULT_SUCCESS);
+    res = jio_memory_file_create(ctx, "csv_test_writer_quoted.csv", &file, 0, 0, 0);
+    ASSERT(res == JIO_RESULT_SUCCESS);
+    ASSERT(jio_parse_csv(ctx, file, ",", false, true, &data) == JIO_RESULT_BAD_CSV_FORMAT);
+    jio_memory_file_destroy(file);
+
+    jio_context_destroy(ctx);
+    return 0;
+}
@@ -20,4 +20,39 @@
 
 #define ASSERT(x) if (!(x)) {fputs("Failed assertion \"" #x "\"\n", stderr); DBG_STOP; exit(EXIT_FAILURE);} (void)0
 
+//  Helpers for tests of csv data, which are only there if iocsv.h is included first
+#ifdef JIO_IOCSV_H
+#include <stdlib.h>
+#include <string.h>
+
+static inline bool segment_equal(const jio_string_segment* a, const jio_string_segment* b)
+{
+    return a->len == b->len && (!a->len || memcmp(a->begin, b->begin, a->len) == 0);
+}
+
+static inline jio_string_segment segment(const char* str)
+{
+    return (jio_string_segment){.begin = str, .len = strlen(str)};
+}
+
+//  Prints the data into a new buffer, checking that nothing is written past the size given by jio_csv_print_size
+static inline char* print_data(
+        const jio_csv_data* data, const char* separator, bool same_width, bool align_left, size_t* p_usage)
+{
+    size_t size;
+    jio_result res = jio_csv_print_size(data, &size, strlen(separator), 1, same_width);
+    ASSERT(res == JIO_RESULT_SUCCESS);
+    //  Extra space is filled, so that writing past the reported size is detected
+    char* const buffer = malloc(size + 16);
+    ASSERT(buffer);
+    memset(buffer, '#', size + 16);
+    res = jio_csv_print(data, p_usage, buffer, separator, 1, same_width, align_left);
+    ASSERT(res == JIO_RESULT_SUCCESS);
+    ASSERT(*p_usage + 1 == size);
+    ASSERT(buffer[*p_usage] == 0);
+    ASSERT(buffer[size] == '#');
+    return buffer;
+}
+#endif
+
 #endif //JIO_TEST_COMMON_H